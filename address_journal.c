@@ -0,0 +1,935 @@
+//////////////////////////////////////////////////////////////////////////////////
+// address_journal.c for Cosmos+ OpenSSD
+// Copyright (c) 2017 Hanyang University ENC Lab.
+// Contributed by Yong Ho Song <yhsong@enc.hanyang.ac.kr>
+//				  Jaewook Kwak <jwkwak@enc.hanyang.ac.kr>
+//
+// This file is part of Cosmos+ OpenSSD.
+//
+// Cosmos+ OpenSSD is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3, or (at your option)
+// any later version.
+//
+// Cosmos+ OpenSSD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Cosmos+ OpenSSD; see the file COPYING.
+// If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Company: ENC Lab. <http://enc.hanyang.ac.kr>
+// Engineer: Jaewook Kwak <jwkwak@enc.hanyang.ac.kr>
+//
+// Project Name: Cosmos+ OpenSSD
+// Design Name: Cosmos+ Firmware
+// Module Name: Address Map Journal
+// File Name: address_journal.c
+//
+// Version: v1.0.0
+//
+// Description:
+//   - save checkpoints of the address maps to the reserved blocks
+//   - journal the map updates made after the latest checkpoint
+//   - recover the address maps at boot from the checkpoint and the journal
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Revision History:
+//
+// * v1.0.0
+//   - First draft
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <assert.h>
+#include <string.h>
+#include "debug.h"
+#ifdef NSC_SIMULATOR
+#include "sim/xil_printf.h"
+#else
+#include "xil_printf.h"
+#endif
+
+#include "memory_map.h"
+
+ADDR_JOURNAL_STATE addrJournal;
+
+// the physical blocks reserved for the checkpoint slots and the journal on each die
+static unsigned short addrMapPhyBlock[USER_DIES][ADDR_MAP_PBLK_PER_DIE];
+
+#define ADDR_JOURNAL_PAGE_BUF(iBuf) ((P_ADDR_JOURNAL_PAGE)(ADDR_JOURNAL_BUFFER_ADDR + (iBuf)*ADDR_MAP_PAGE_BUF_BYTES))
+
+/**
+ * The maps saved in a checkpoint are two contiguous regions: the slice maps with the block
+ * map and the valid slice bitmap, and the die map with the GC victim lists. The physical block map and the bbt info
+ * between them are rebuilt from the bbt at boot.
+ *
+ * In demand paged mode, the logical slice map is not in DRAM, its translation pages are
+ * copied to the first `ADDR_MAP_TRANS_SAVED_PAGES` pages of the checkpoint instead, which
+ * keeps the same layout as the resident map.
+ */
+#if (ADDR_MAP_MODE == ADDR_MAP_MODE_DEMAND)
+#define ADDR_MAP_TRANS_SAVED_PAGES ADDR_MAP_TRANS_PAGES
+#define ADDR_MAP_BLOCK_MAPS_ADDR   VIRTUAL_SLICE_MAP_ADDR
+#else
+#define ADDR_MAP_TRANS_SAVED_PAGES 0
+#define ADDR_MAP_BLOCK_MAPS_ADDR   LOGICAL_SLICE_MAP_ADDR
+#endif
+#define ADDR_MAP_BLOCK_MAPS_BYTES (VALID_SLICE_BITMAP_ADDR + sizeof(VALID_SLICE_BITMAP) - ADDR_MAP_BLOCK_MAPS_ADDR)
+#define ADDR_MAP_DIE_MAPS_BYTES   (GC_VICTIM_MAP_ADDR + sizeof(GC_VICTIM_MAP) - VIRTUAL_DIE_MAP_ADDR)
+#define ADDR_MAP_BYTES                                                                                            \
+    (ADDR_MAP_TRANS_SAVED_PAGES * BYTES_PER_DATA_REGION_OF_PAGE + ADDR_MAP_BLOCK_MAPS_BYTES + ADDR_MAP_DIE_MAPS_BYTES)
+
+#define ADDR_MAP_BYTES2PAGES(bytes) (((bytes) + BYTES_PER_DATA_REGION_OF_PAGE - 1) / BYTES_PER_DATA_REGION_OF_PAGE)
+#define ADDR_MAP_BLOCK_MAPS_PAGES   ADDR_MAP_BYTES2PAGES(ADDR_MAP_BLOCK_MAPS_BYTES)
+#define ADDR_MAP_PAGES                                                                                            \
+    (ADDR_MAP_TRANS_SAVED_PAGES + ADDR_MAP_BLOCK_MAPS_PAGES + ADDR_MAP_BYTES2PAGES(ADDR_MAP_DIE_MAPS_BYTES))
+
+/**
+ * @brief Reserve the physical blocks for the address map checkpoints and journal.
+ *
+ * The blocks are searched from the last block of LUN 0 downward, so they are taken from
+ * the reserved blocks for remapping and never map to any virtual block. They are marked
+ * bad to keep `RemapBadBlock()` away, but kept normal in the bbt by
+ * `UpdateBadBlockTableForGrownBadBlock()`, thus the same blocks are found at next boot.
+ *
+ * @note Must be called after the bbt is recovered and before `RemapBadBlock()`.
+ */
+void ReserveAddrMapBlocks()
+{
+    unsigned int dieNo, phyBlockNo, reservedCnt;
+
+    ASSERT(ADDR_MAP_PAGES < ADDR_MAP_SLOT_PAGES, "address maps (%u pages) exceed a checkpoint slot", ADDR_MAP_PAGES);
+
+    for (dieNo = 0; dieNo < USER_DIES; dieNo++)
+    {
+        reservedCnt = 0;
+        for (phyBlockNo = TOTAL_BLOCKS_PER_LUN - 1;
+             phyBlockNo >= USER_BLOCKS_PER_LUN && reservedCnt < ADDR_MAP_PBLK_PER_DIE; phyBlockNo--)
+        {
+            if (PBLK_ENTRY(dieNo, phyBlockNo)->bad)
+                continue;
+
+            pr_debug("Die[%u]: Reserve PBlk[%u] for address maps.", dieNo, phyBlockNo);
+            addrMapPhyBlock[dieNo][reservedCnt++] = phyBlockNo;
+            PBLK_ENTRY(dieNo, phyBlockNo)->bad    = 1;
+        }
+
+        ASSERT(reservedCnt == ADDR_MAP_PBLK_PER_DIE, "Die[%u]: not enough reserved blocks for address maps", dieNo);
+    }
+}
+
+/**
+ * @brief Check whether the given physical block is reserved for the address maps.
+ *
+ * @param dieNo the die number of the given block.
+ * @param phyBlockNo the physical block number.
+ * @return unsigned int 1 if the block is reserved by `ReserveAddrMapBlocks()`, otherwise 0.
+ */
+unsigned int IsAddrMapBlock(unsigned int dieNo, unsigned int phyBlockNo)
+{
+    unsigned int iPblk;
+
+    for (iPblk = 0; iPblk < ADDR_MAP_PBLK_PER_DIE; iPblk++)
+        if (addrMapPhyBlock[dieNo][iPblk] == phyBlockNo)
+            return 1;
+    return 0;
+}
+
+/**
+ * @brief Issue a NAND request on a page of a checkpoint slot or the journal.
+ *
+ * @param reqCode `REQ_CODE_READ` or `REQ_CODE_WRITE`.
+ * @param firstPblkIdx the index of the first reserved block of the slot or the journal.
+ * @param pageIdx the striped page index, check `address_journal.h` for the placement.
+ * @param bufAddr the address of the page buffer (data region followed by spare region).
+ */
+void IssueAddrMapPageReq(unsigned int reqCode, unsigned int firstPblkIdx, unsigned int pageIdx, unsigned int bufAddr)
+{
+    unsigned int reqSlotTag, dieNo, pageOfDie, phyBlockNo;
+
+    dieNo      = pageIdx % USER_DIES;
+    pageOfDie  = pageIdx / USER_DIES;
+    phyBlockNo = addrMapPhyBlock[dieNo][firstPblkIdx + pageOfDie / USER_PAGES_PER_BLOCK];
+
+    reqSlotTag = GetFromFreeReqQ();
+
+    REQ_ENTRY(reqSlotTag)->reqType                       = REQ_TYPE_NAND;
+    REQ_ENTRY(reqSlotTag)->reqCode                       = reqCode;
+    REQ_ENTRY(reqSlotTag)->reqOpt.dataBufFormat          = REQ_OPT_DATA_BUF_ADDR;
+    REQ_ENTRY(reqSlotTag)->reqOpt.nandAddr               = REQ_OPT_NAND_ADDR_PHY_ORG;
+    REQ_ENTRY(reqSlotTag)->reqOpt.nandEcc                = REQ_OPT_NAND_ECC_ON;
+    REQ_ENTRY(reqSlotTag)->reqOpt.nandEccWarning         = REQ_OPT_NAND_ECC_WARNING_OFF;
+    REQ_ENTRY(reqSlotTag)->reqOpt.rowAddrDependencyCheck = REQ_OPT_ROW_ADDR_DEPENDENCY_NONE;
+    REQ_ENTRY(reqSlotTag)->reqOpt.blockSpace             = REQ_OPT_BLOCK_SPACE_TOTAL;
+    REQ_ENTRY(reqSlotTag)->dataBufInfo.addr              = bufAddr;
+    REQ_ENTRY(reqSlotTag)->nandInfo.physicalCh           = VDIE2PCH(dieNo);
+    REQ_ENTRY(reqSlotTag)->nandInfo.physicalWay          = VDIE2PWAY(dieNo);
+    REQ_ENTRY(reqSlotTag)->nandInfo.physicalBlock        = phyBlockNo;
+    REQ_ENTRY(reqSlotTag)->nandInfo.physicalPage         = pageOfDie % USER_PAGES_PER_BLOCK;
+
+    SelectLowLevelReqQ(reqSlotTag);
+}
+
+/**
+ * @brief Erase the reserved blocks `[firstPblkIdx, firstPblkIdx + pblkCnt)` of every die.
+ */
+void EraseAddrMapBlocks(unsigned int firstPblkIdx, unsigned int pblkCnt)
+{
+    unsigned int reqSlotTag, dieNo, iPblk;
+
+    for (iPblk = firstPblkIdx; iPblk < firstPblkIdx + pblkCnt; iPblk++)
+        for (dieNo = 0; dieNo < USER_DIES; dieNo++)
+        {
+            reqSlotTag = GetFromFreeReqQ();
+
+            REQ_ENTRY(reqSlotTag)->reqType                       = REQ_TYPE_NAND;
+            REQ_ENTRY(reqSlotTag)->reqCode                       = REQ_CODE_ERASE;
+            REQ_ENTRY(reqSlotTag)->reqOpt.nandAddr               = REQ_OPT_NAND_ADDR_PHY_ORG;
+            REQ_ENTRY(reqSlotTag)->reqOpt.dataBufFormat          = REQ_OPT_DATA_BUF_NONE;
+            REQ_ENTRY(reqSlotTag)->reqOpt.rowAddrDependencyCheck = REQ_OPT_ROW_ADDR_DEPENDENCY_NONE;
+            REQ_ENTRY(reqSlotTag)->reqOpt.blockSpace             = REQ_OPT_BLOCK_SPACE_TOTAL;
+            REQ_ENTRY(reqSlotTag)->nandInfo.physicalCh           = VDIE2PCH(dieNo);
+            REQ_ENTRY(reqSlotTag)->nandInfo.physicalWay          = VDIE2PWAY(dieNo);
+            REQ_ENTRY(reqSlotTag)->nandInfo.physicalBlock        = addrMapPhyBlock[dieNo][iPblk];
+            REQ_ENTRY(reqSlotTag)->nandInfo.physicalPage         = 0; // dummy
+
+            SelectLowLevelReqQ(reqSlotTag);
+        }
+
+    SyncAllLowLevelReqDone();
+}
+
+/**
+ * @brief Get the DRAM address of the given page of the saved maps.
+ *
+ * @param mapPageNo the index of the page in the checkpoint, after the translation pages.
+ * @param bytes the number of valid bytes in the page, the last page of a region may be partial.
+ * @return unsigned int the address of the first byte of the page.
+ */
+static unsigned int AddrMapPageAddr(unsigned int mapPageNo, unsigned int *bytes)
+{
+    unsigned int regionAddr, regionBytes, offset;
+
+    mapPageNo -= ADDR_MAP_TRANS_SAVED_PAGES;
+    if (mapPageNo < ADDR_MAP_BLOCK_MAPS_PAGES)
+    {
+        regionAddr  = ADDR_MAP_BLOCK_MAPS_ADDR;
+        regionBytes = ADDR_MAP_BLOCK_MAPS_BYTES;
+    }
+    else
+    {
+        mapPageNo -= ADDR_MAP_BLOCK_MAPS_PAGES;
+        regionAddr  = VIRTUAL_DIE_MAP_ADDR;
+        regionBytes = ADDR_MAP_DIE_MAPS_BYTES;
+    }
+
+    offset = mapPageNo * BYTES_PER_DATA_REGION_OF_PAGE;
+    *bytes = (regionBytes - offset < BYTES_PER_DATA_REGION_OF_PAGE) ? regionBytes - offset
+                                                                      : BYTES_PER_DATA_REGION_OF_PAGE;
+    return regionAddr + offset;
+}
+
+/**
+ * @brief Write the address maps to the checkpoint slot not holding the latest checkpoint.
+ *
+ * The maps are copied to the (uncached) page buffers and programmed one page per die at a
+ * time, then a header page commits the checkpoint. The journal is erased only after the
+ * commit, so a power loss in the middle leaves the previous checkpoint and its journal.
+ *
+ * The maps must not change during the checkpoint, thus this function is only called when
+ * no request is being transformed, and all the programs in flight are waited for first.
+ * The GC victims are out of the victim lists until they are erased, so the GCs in progress
+ * are finished first.
+ */
+void SaveAddrMapCheckpoint()
+{
+    unsigned int slot, mapPageNo, mapAddr, bytes, bufAddr;
+    P_ADDR_MAP_CHECKPOINT_HEADER header;
+
+    SyncGarbageCollection();
+    SyncAllLowLevelReqDone();
+
+    // the records of the open journal page are dropped, the checkpoint includes the erases
+    SettlePendingFreeBlocks();
+
+    slot = (addrJournal.epoch + 1) % ADDR_MAP_SLOT_COUNT;
+    EraseAddrMapBlocks(ADDR_MAP_SLOT_PBLK_IDX(slot), ADDR_MAP_PBLK_PER_SLOT);
+
+#if (ADDR_MAP_MODE == ADDR_MAP_MODE_DEMAND)
+    SaveAddrMapCachePages(ADDR_MAP_SLOT_PBLK_IDX(slot));
+#endif
+
+    for (mapPageNo = ADDR_MAP_TRANS_SAVED_PAGES; mapPageNo < ADDR_MAP_PAGES; mapPageNo++)
+    {
+        bufAddr = ADDR_MAP_CHECKPOINT_BUF(mapPageNo % USER_DIES);
+        mapAddr = AddrMapPageAddr(mapPageNo, &bytes);
+        memcpy((void *)bufAddr, (void *)mapAddr, bytes);
+        IssueAddrMapPageReq(REQ_CODE_WRITE, ADDR_MAP_SLOT_PBLK_IDX(slot), mapPageNo, bufAddr);
+
+        // the page buffers are reused after the pages on all the dies are programmed
+        if (mapPageNo % USER_DIES == USER_DIES - 1)
+            SyncAllLowLevelReqDone();
+    }
+    SyncAllLowLevelReqDone();
+
+    bufAddr = ADDR_MAP_CHECKPOINT_BUF(ADDR_MAP_PAGES % USER_DIES);
+    memset((void *)bufAddr, 0, BYTES_PER_DATA_REGION_OF_PAGE);
+    header             = (P_ADDR_MAP_CHECKPOINT_HEADER)bufAddr;
+    header->magic      = ADDR_MAP_CHECKPOINT_MAGIC;
+    header->epoch      = addrJournal.epoch + 1;
+    header->mapPageCnt = ADDR_MAP_PAGES;
+    header->mapBytes   = ADDR_MAP_BYTES;
+    header->writeSeq   = addrJournal.writeSeq;
+    IssueAddrMapPageReq(REQ_CODE_WRITE, ADDR_MAP_SLOT_PBLK_IDX(slot), ADDR_MAP_PAGES, bufAddr);
+    SyncAllLowLevelReqDone();
+
+    // the journal of the previous checkpoint is obsolete now
+    EraseAddrMapBlocks(ADDR_JOURNAL_PBLK_IDX, ADDR_JOURNAL_PBLK_PER_DIE);
+
+    addrJournal.epoch++;
+    addrJournal.pageCnt = 0;
+    addrJournal.checkpointCnt++;
+    ADDR_JOURNAL_PAGE_BUF(addrJournal.openBuf)->recordCnt = 0;
+
+    pr_info("Address map checkpoint %u saved to slot %u (%u pages)", addrJournal.epoch, slot, ADDR_MAP_PAGES + 1);
+}
+
+/**
+ * @brief Take a new checkpoint if the journal is long enough.
+ *
+ * @param hostIdle whether there is no pending host command, the checkpoint is delayed
+ * until the host is idle unless the journal grows to `ADDR_JOURNAL_FORCE_CHECKPOINT_PAGES`.
+ */
+void SaveAddrMapInBackground(unsigned int hostIdle)
+{
+    if (!addrJournal.enabled)
+        return;
+
+    if (addrJournal.pageCnt >= (hostIdle ? ADDR_JOURNAL_CHECKPOINT_PAGES : ADDR_JOURNAL_FORCE_CHECKPOINT_PAGES))
+        SaveAddrMapCheckpoint();
+}
+
+/**
+ * @brief Program the open journal page and switch to the other page buffer.
+ *
+ * The programs and erases issued so far are waited for before the program, so a journal
+ * page never reaches the flash before the slices and the erases its records point to, and
+ * the other page buffer (the previous journal page) is free to be reused. The reads do not
+ * affect the journal, thus they are left running.
+ */
+static void ProgramAddrJournalPage()
+{
+    P_ADDR_JOURNAL_PAGE page = ADDR_JOURNAL_PAGE_BUF(addrJournal.openBuf);
+
+    ASSERT(addrJournal.pageCnt < ADDR_JOURNAL_MAX_PAGES, "address map journal overflow");
+
+    SyncAllProgramReqDone();
+
+    page->magic    = ADDR_JOURNAL_MAGIC;
+    page->epoch    = addrJournal.epoch;
+    page->pageNo   = addrJournal.pageCnt;
+    page->writeSeq = addrJournal.writeSeq;
+    IssueAddrMapPageReq(REQ_CODE_WRITE, ADDR_JOURNAL_PBLK_IDX, addrJournal.pageCnt, (unsigned int)page);
+    addrJournal.pageCnt++;
+
+    addrJournal.openBuf                                   = (addrJournal.openBuf + 1) % ADDR_JOURNAL_BUF_COUNT;
+    ADDR_JOURNAL_PAGE_BUF(addrJournal.openBuf)->recordCnt = 0;
+}
+
+/**
+ * @brief Append a record to the open journal page.
+ *
+ * A full page is programmed lazily by the next append, by then the request of its last
+ * record has been issued.
+ */
+static void AppendAddrJournalRecord(unsigned int logicalSliceAddr, unsigned int virtualSliceAddr)
+{
+    P_ADDR_JOURNAL_PAGE page;
+
+    if (!addrJournal.enabled)
+        return;
+
+    page = ADDR_JOURNAL_PAGE_BUF(addrJournal.openBuf);
+    if (page->recordCnt == ADDR_JOURNAL_RECORDS_PER_PAGE)
+    {
+        ProgramAddrJournalPage();
+        page = ADDR_JOURNAL_PAGE_BUF(addrJournal.openBuf);
+    }
+
+    page->record[page->recordCnt].logicalSliceAddr = logicalSliceAddr;
+    page->record[page->recordCnt].virtualSliceAddr = virtualSliceAddr;
+    page->recordCnt++;
+    addrJournal.recordCnt++;
+}
+
+/**
+ * @brief Journal the new mapping of a logical slice.
+ *
+ * The mapping is given the next write sequence number, which should be copied to the
+ * `writeSeq` of the write request from `addrJournal.writeSeq`.
+ *
+ * @param logicalSliceAddr the logical slice written.
+ * @param virtualSliceAddr the new virtual slice of the logical slice.
+ */
+void JournalAddrTrans(unsigned int logicalSliceAddr, unsigned int virtualSliceAddr)
+{
+    // the page programmed by this append carries the sequence number of its last record
+    AppendAddrJournalRecord(logicalSliceAddr, virtualSliceAddr);
+    addrJournal.writeSeq++;
+}
+
+/**
+ * @brief Journal the erase of a block.
+ *
+ * @param dieNo the die number of the erased block.
+ * @param blockNo the virtual block number of the erased block.
+ */
+void JournalBlockErase(unsigned int dieNo, unsigned int blockNo)
+{
+    AppendAddrJournalRecord(ADDR_JOURNAL_LSA_ERASE, Vorg2VsaTranslation(dieNo, blockNo, 0));
+}
+
+/**
+ * @brief Journal a free block taken as the current block of a write stream.
+ *
+ * The stream of a block is not known from its slices, so it is journaled before the first
+ * slice of the block, check `FindFreeVirtualSlice()`.
+ */
+void JournalBlockOpen(unsigned int dieNo, unsigned int blockNo, unsigned int stream)
+{
+    AppendAddrJournalRecord(ADDR_JOURNAL_LSA_OPEN | stream, Vorg2VsaTranslation(dieNo, blockNo, 0));
+}
+
+/**
+ * @brief Journal a run of logical slices deallocated by host.
+ *
+ * @param startLsa the first deallocated slice.
+ * @param sliceCnt number of slices, check `DeallocateLogicalSlices()`.
+ */
+void JournalDeallocate(unsigned int startLsa, unsigned int sliceCnt)
+{
+    AppendAddrJournalRecord(ADDR_JOURNAL_LSA_DEALLOC | startLsa, sliceCnt);
+}
+
+/**
+ * @brief Program the open journal page and wait until the journal is durable.
+ *
+ * Called for the NVMe Flush command, and before a GC victim is erased, since the valid
+ * slices of the victim are only reachable through the journal records of their copies.
+ * The blocks erased so far are journaled now, so they are sorted into the free block lists.
+ */
+void FlushAddrJournal()
+{
+    if (!addrJournal.enabled)
+        return;
+
+    if (ADDR_JOURNAL_PAGE_BUF(addrJournal.openBuf)->recordCnt)
+        ProgramAddrJournalPage();
+    SyncAllProgramReqDone();
+    SettlePendingFreeBlocks();
+}
+
+/**
+ * @brief Fill the spare region of a slice to be programmed.
+ *
+ * Called by `IssueNandReq()` right before the program, since the spare buffer of a GC
+ * temp entry is overwritten by the read of the victim slice.
+ *
+ * @param reqSlotTag the WRITE request on VSA.
+ * @param spareDataBufAddr the spare data buffer of the request.
+ */
+void StampSliceSpare(unsigned int reqSlotTag, unsigned int spareDataBufAddr)
+{
+    P_SLICE_SPARE_INFO spare = (P_SLICE_SPARE_INFO)spareDataBufAddr;
+    unsigned int virtualSliceAddr = REQ_ENTRY(reqSlotTag)->nandInfo.virtualSliceAddr;
+    P_VIRTUAL_BLOCK_ENTRY block   = VBLK_ENTRY(VSA2VDIE(virtualSliceAddr), VSA2VBLK(virtualSliceAddr));
+
+    spare->magic            = SLICE_SPARE_MAGIC;
+    spare->logicalSliceAddr = REQ_ENTRY(reqSlotTag)->logicalSliceAddr;
+    spare->writeSeq         = REQ_ENTRY(reqSlotTag)->nandInfo.writeSeq;
+    spare->eraseCnt         = block->eraseCnt;
+    spare->stream           = block->stream;
+}
+
+/**
+ * @brief Read the header page of the given checkpoint slot.
+ *
+ * @return unsigned int the epoch of the checkpoint in the slot, 0 if it is not committed.
+ */
+static unsigned int ReadAddrMapCheckpointHeader(unsigned int slot)
+{
+    P_ADDR_MAP_CHECKPOINT_HEADER header;
+
+    header = (P_ADDR_MAP_CHECKPOINT_HEADER)ADDR_MAP_CHECKPOINT_BUF(slot);
+    IssueAddrMapPageReq(REQ_CODE_READ, ADDR_MAP_SLOT_PBLK_IDX(slot), ADDR_MAP_PAGES, (unsigned int)header);
+    SyncAllLowLevelReqDone();
+
+    if (header->magic != ADDR_MAP_CHECKPOINT_MAGIC || header->mapPageCnt != ADDR_MAP_PAGES ||
+        header->mapBytes != ADDR_MAP_BYTES)
+        return 0;
+    return header->epoch;
+}
+
+/**
+ * @brief Load the maps from the given checkpoint slot.
+ */
+static void LoadAddrMapCheckpoint(unsigned int slot)
+{
+    unsigned int mapPageNo, roundPageNo, mapAddr, bytes;
+
+#if (ADDR_MAP_MODE == ADDR_MAP_MODE_DEMAND)
+    // the translation pages are read on demand
+    ResetAddrMapCache(ADDR_MAP_TRANS_IN_SLOT, ADDR_MAP_SLOT_PBLK_IDX(slot));
+#endif
+
+    for (roundPageNo = ADDR_MAP_TRANS_SAVED_PAGES; roundPageNo < ADDR_MAP_PAGES; roundPageNo += USER_DIES)
+    {
+        for (mapPageNo = roundPageNo; mapPageNo < ADDR_MAP_PAGES && mapPageNo < roundPageNo + USER_DIES; mapPageNo++)
+            IssueAddrMapPageReq(REQ_CODE_READ, ADDR_MAP_SLOT_PBLK_IDX(slot), mapPageNo,
+                                ADDR_MAP_CHECKPOINT_BUF(mapPageNo % USER_DIES));
+        SyncAllLowLevelReqDone();
+
+        for (mapPageNo = roundPageNo; mapPageNo < ADDR_MAP_PAGES && mapPageNo < roundPageNo + USER_DIES; mapPageNo++)
+        {
+            mapAddr = AddrMapPageAddr(mapPageNo, &bytes);
+            memcpy((void *)mapAddr, (void *)ADDR_MAP_CHECKPOINT_BUF(mapPageNo % USER_DIES), bytes);
+        }
+    }
+}
+
+/**
+ * @brief Take a free block as the current block of a stream, as `FindFreeVirtualSlice()` did.
+ *
+ * The blocks are taken from the free block lists in the same order as before the power
+ * loss, so the free block lists and the current blocks end up the same.
+ */
+static void ReplayBlockOpen(unsigned int dieNo, unsigned int blockNo, unsigned int stream)
+{
+    if (VBLK_ENTRY(dieNo, blockNo)->free)
+        SelectiveGetFromFbList(dieNo, blockNo, GET_FREE_BLOCK_GC);
+    VBLK_ENTRY(dieNo, blockNo)->stream      = stream;
+    VDIE_ENTRY(dieNo)->currentBlock[stream] = blockNo;
+}
+
+/**
+ * @brief Mark the given slice allocated, as `FindFreeVirtualSlice()` did.
+ *
+ * The block of the slice is normally opened by a journal record before, but the blocks
+ * found by the spare scan are opened at their first slice.
+ *
+ * @param virtualSliceAddr the allocated slice.
+ * @param stream the write stream of the block, used if the block is still free.
+ */
+static void ReplaySliceAlloc(unsigned int virtualSliceAddr, unsigned int stream)
+{
+    unsigned int dieNo, blockNo, pageNo;
+
+    dieNo   = VSA2VDIE(virtualSliceAddr);
+    blockNo = VSA2VBLK(virtualSliceAddr);
+    pageNo  = VSA2VPAGE(virtualSliceAddr);
+
+    if (VBLK_ENTRY(dieNo, blockNo)->free)
+        ReplayBlockOpen(dieNo, blockNo, stream);
+    if (VBLK_ENTRY(dieNo, blockNo)->currentPage <= pageNo)
+        VBLK_ENTRY(dieNo, blockNo)->currentPage = pageNo + 1;
+}
+
+/**
+ * @brief Apply a journal record to the maps, as `AddrTransWrite()`, `EraseBlock()`,
+ * `FindFreeVirtualSlice()` or `DeallocateLogicalSlices()` did.
+ */
+static void ReplayAddrJournalRecord(P_ADDR_JOURNAL_RECORD record)
+{
+    unsigned int dieNo, blockNo;
+
+    if (record->logicalSliceAddr == ADDR_JOURNAL_LSA_ERASE)
+    {
+        dieNo   = VSA2VDIE(record->virtualSliceAddr);
+        blockNo = VSA2VBLK(record->virtualSliceAddr);
+
+        // the victim was taken from the victim list by `GarbageCollection()`
+        SelectiveGetFromGcVictimList(dieNo, blockNo);
+        ResetErasedBlockMap(dieNo, blockNo);
+        return;
+    }
+
+    if (record->logicalSliceAddr >= ADDR_JOURNAL_LSA_OPEN &&
+        record->logicalSliceAddr < ADDR_JOURNAL_LSA_OPEN + WRITE_STREAM_COUNT)
+    {
+        ReplayBlockOpen(VSA2VDIE(record->virtualSliceAddr), VSA2VBLK(record->virtualSliceAddr),
+                        record->logicalSliceAddr - ADDR_JOURNAL_LSA_OPEN);
+        return;
+    }
+
+    if (record->logicalSliceAddr & ADDR_JOURNAL_LSA_DEALLOC)
+    {
+        DeallocateLogicalSlices(record->logicalSliceAddr & ~ADDR_JOURNAL_LSA_DEALLOC, record->virtualSliceAddr);
+        return;
+    }
+
+    InvalidateOldVsa(record->logicalSliceAddr);
+    ReplaySliceAlloc(record->virtualSliceAddr,
+                     VBLK_ENTRY(VSA2VDIE(record->virtualSliceAddr), VSA2VBLK(record->virtualSliceAddr))->stream);
+
+    SET_LSA2VSA(record->logicalSliceAddr, record->virtualSliceAddr);
+    VSA2LSA(record->virtualSliceAddr) = record->logicalSliceAddr;
+    SET_VSA_VALID(record->virtualSliceAddr);
+}
+
+/**
+ * @brief Replay the journal pages of the loaded checkpoint.
+ *
+ * @return unsigned int the number of journal pages replayed.
+ */
+static unsigned int ReplayAddrJournal()
+{
+    unsigned int pageNo, roundPageNo, iRecord;
+    P_ADDR_JOURNAL_PAGE page;
+
+    for (roundPageNo = 0; roundPageNo < ADDR_JOURNAL_MAX_PAGES; roundPageNo += USER_DIES)
+    {
+        for (pageNo = roundPageNo; pageNo < roundPageNo + USER_DIES; pageNo++)
+            IssueAddrMapPageReq(REQ_CODE_READ, ADDR_JOURNAL_PBLK_IDX, pageNo,
+                                ADDR_MAP_CHECKPOINT_BUF(pageNo % USER_DIES));
+        SyncAllLowLevelReqDone();
+
+        for (pageNo = roundPageNo; pageNo < roundPageNo + USER_DIES; pageNo++)
+        {
+            page = (P_ADDR_JOURNAL_PAGE)ADDR_MAP_CHECKPOINT_BUF(pageNo % USER_DIES);
+
+            // the journal ends at the first page not written after the checkpoint
+            if (page->magic != ADDR_JOURNAL_MAGIC || page->epoch != addrJournal.epoch || page->pageNo != pageNo ||
+                page->recordCnt > ADDR_JOURNAL_RECORDS_PER_PAGE)
+                return pageNo;
+
+            for (iRecord = 0; iRecord < page->recordCnt; iRecord++)
+                ReplayAddrJournalRecord(&page->record[iRecord]);
+            addrJournal.writeSeq = page->writeSeq;
+        }
+    }
+
+    return ADDR_JOURNAL_MAX_PAGES;
+}
+
+/**
+ * @brief The cursor of the spare region scan on a die.
+ */
+typedef struct _SLICE_SPARE_SCAN_CURSOR
+{
+    unsigned int blockCnt;                           // number of blocks to scan
+    unsigned int block[ADDR_JOURNAL_SCAN_BLOCKS];    // the current blocks, then the next free blocks in order
+    unsigned int startPage[ADDR_JOURNAL_SCAN_BLOCKS]; // the pages before are in the journal
+    unsigned int iBlock;                             // the block being scanned
+    unsigned int pageNo;                             // the page being scanned
+} SLICE_SPARE_SCAN_CURSOR;
+
+/**
+ * The write sequence numbers of the scanned slices, 0 if not recovered from the spare. The
+ * reserved data buffer is only used by boot time requests, and large enough for the table.
+ */
+#define SLICE_SPARE_SCAN_SEQ_ADDR RESERVED_DATA_BUFFER_BASE_ADDR
+#define SLICE_SPARE_SCAN_SEQ(iDie, iBlk, iPage)                                                                       \
+    (((unsigned int *)SLICE_SPARE_SCAN_SEQ_ADDR)[((iDie)*ADDR_JOURNAL_SCAN_BLOCKS + (iBlk)) * USER_PAGES_PER_BLOCK +  \
+                                                 (iPage)])
+
+static SLICE_SPARE_SCAN_CURSOR sliceSpareScanCursor[USER_DIES];
+
+/**
+ * @brief Get the write sequence number of the given slice found by the spare scan.
+ *
+ * @return unsigned int 0 if the slice is not recovered from the spare regions.
+ */
+static unsigned int ScannedSliceWriteSeq(unsigned int virtualSliceAddr)
+{
+    SLICE_SPARE_SCAN_CURSOR *cursor = &sliceSpareScanCursor[VSA2VDIE(virtualSliceAddr)];
+    unsigned int iBlk;
+
+    for (iBlk = 0; iBlk < cursor->blockCnt; iBlk++)
+        if (cursor->block[iBlk] == VSA2VBLK(virtualSliceAddr))
+            return SLICE_SPARE_SCAN_SEQ(VSA2VDIE(virtualSliceAddr), iBlk, VSA2VPAGE(virtualSliceAddr));
+    return 0;
+}
+
+/**
+ * @brief Issue a read on the page of the spare scan cursor of the given die.
+ */
+static void IssueSliceSpareScanReq(unsigned int dieNo)
+{
+    SLICE_SPARE_SCAN_CURSOR *cursor = &sliceSpareScanCursor[dieNo];
+    unsigned int reqSlotTag;
+
+    reqSlotTag = GetFromFreeReqQ();
+
+    REQ_ENTRY(reqSlotTag)->reqType                       = REQ_TYPE_NAND;
+    REQ_ENTRY(reqSlotTag)->reqCode                       = REQ_CODE_READ;
+    REQ_ENTRY(reqSlotTag)->reqOpt.dataBufFormat          = REQ_OPT_DATA_BUF_ADDR;
+    REQ_ENTRY(reqSlotTag)->reqOpt.nandAddr               = REQ_OPT_NAND_ADDR_VSA;
+    REQ_ENTRY(reqSlotTag)->reqOpt.nandEcc                = REQ_OPT_NAND_ECC_ON;
+    REQ_ENTRY(reqSlotTag)->reqOpt.nandEccWarning         = REQ_OPT_NAND_ECC_WARNING_OFF;
+    REQ_ENTRY(reqSlotTag)->reqOpt.rowAddrDependencyCheck = REQ_OPT_ROW_ADDR_DEPENDENCY_NONE;
+    REQ_ENTRY(reqSlotTag)->reqOpt.blockSpace             = REQ_OPT_BLOCK_SPACE_MAIN;
+    REQ_ENTRY(reqSlotTag)->dataBufInfo.addr              = ADDR_MAP_CHECKPOINT_BUF(dieNo);
+    REQ_ENTRY(reqSlotTag)->nandInfo.virtualSliceAddr =
+        Vorg2VsaTranslation(dieNo, cursor->block[cursor->iBlock], cursor->pageNo);
+
+    SelectLowLevelReqQ(reqSlotTag);
+}
+
+/**
+ * @brief Recover the slices programmed after the last journal page from the spare regions.
+ *
+ * The current blocks of each die are scanned first, then the next free blocks in the order
+ * they are taken, one page per die at a time, so all the dies are read in parallel. Only
+ * the spare region of each page is examined. The slices of a block are programmed in
+ * allocation order, so the scan of a block ends at its first slice not written after the
+ * journal, but the blocks of the other streams may still be written.
+ *
+ * A logical slice may be recovered more than once, the copy with the largest write
+ * sequence number wins, and the others are counted as invalid slices of their blocks.
+ *
+ * @return unsigned int the number of slices recovered.
+ */
+static unsigned int ScanSliceSpare()
+{
+    SLICE_SPARE_SCAN_CURSOR *cursor;
+    P_SLICE_SPARE_INFO spare;
+    unsigned int dieNo, blockNo, stream, virtualSliceAddr, oldVirtualSliceAddr, journaledSeq, scanningCnt,
+        scannedCnt;
+
+    ASSERT(USER_DIES * ADDR_JOURNAL_SCAN_BLOCKS * USER_PAGES_PER_BLOCK * sizeof(unsigned int) <=
+           MONITOR_START_ADDR - RESERVED_DATA_BUFFER_BASE_ADDR);
+    memset((void *)SLICE_SPARE_SCAN_SEQ_ADDR, 0,
+           USER_DIES * ADDR_JOURNAL_SCAN_BLOCKS * USER_PAGES_PER_BLOCK * sizeof(unsigned int));
+
+    scanningCnt = 0;
+    for (dieNo = 0; dieNo < USER_DIES; dieNo++)
+    {
+        cursor           = &sliceSpareScanCursor[dieNo];
+        cursor->blockCnt = 0;
+
+        for (stream = 0; stream < WRITE_STREAM_COUNT; stream++)
+        {
+            blockNo = VDIE_ENTRY(dieNo)->currentBlock[stream];
+            if (blockNo != BLOCK_NONE && VBLK_ENTRY(dieNo, blockNo)->currentPage < USER_PAGES_PER_BLOCK)
+            {
+                cursor->startPage[cursor->blockCnt] = VBLK_ENTRY(dieNo, blockNo)->currentPage;
+                cursor->block[cursor->blockCnt++]   = blockNo;
+            }
+        }
+
+        blockNo = VDIE_ENTRY(dieNo)->headFreeBlock;
+        while (blockNo != BLOCK_NONE && cursor->blockCnt < ADDR_JOURNAL_SCAN_BLOCKS)
+        {
+            cursor->startPage[cursor->blockCnt] = 0;
+            cursor->block[cursor->blockCnt++]   = blockNo;
+            blockNo                             = VBLK_NEXT_IDX(dieNo, blockNo);
+        }
+
+        cursor->iBlock = 0;
+        cursor->pageNo = cursor->startPage[0];
+        if (cursor->blockCnt)
+            scanningCnt++;
+    }
+
+    journaledSeq = addrJournal.writeSeq;
+    scannedCnt   = 0;
+    while (scanningCnt)
+    {
+        for (dieNo = 0; dieNo < USER_DIES; dieNo++)
+            if (sliceSpareScanCursor[dieNo].iBlock < sliceSpareScanCursor[dieNo].blockCnt)
+                IssueSliceSpareScanReq(dieNo);
+        SyncAllLowLevelReqDone();
+
+        for (dieNo = 0; dieNo < USER_DIES; dieNo++)
+        {
+            cursor = &sliceSpareScanCursor[dieNo];
+            if (cursor->iBlock == cursor->blockCnt)
+                continue;
+
+            blockNo          = cursor->block[cursor->iBlock];
+            virtualSliceAddr = Vorg2VsaTranslation(dieNo, blockNo, cursor->pageNo);
+            spare = (P_SLICE_SPARE_INFO)(ADDR_MAP_CHECKPOINT_BUF(dieNo) + BYTES_PER_DATA_REGION_OF_PAGE);
+
+            // the slices of a block are programmed in allocation order, the first hole ends the block
+            if (spare->magic != SLICE_SPARE_MAGIC || spare->logicalSliceAddr >= SLICES_PER_SSD ||
+                spare->eraseCnt != VBLK_ENTRY(dieNo, blockNo)->eraseCnt || spare->writeSeq <= journaledSeq ||
+                spare->stream >= WRITE_STREAM_COUNT)
+            {
+                if (++cursor->iBlock < cursor->blockCnt)
+                    cursor->pageNo = cursor->startPage[cursor->iBlock];
+                else
+                    scanningCnt--;
+                continue;
+            }
+
+            SLICE_SPARE_SCAN_SEQ(dieNo, cursor->iBlock, cursor->pageNo) = spare->writeSeq;
+            ReplaySliceAlloc(virtualSliceAddr, spare->stream);
+            VSA2LSA(virtualSliceAddr) = spare->logicalSliceAddr;
+
+            oldVirtualSliceAddr = LSA2VSA(spare->logicalSliceAddr);
+            if (oldVirtualSliceAddr != VSA_NONE && ScannedSliceWriteSeq(oldVirtualSliceAddr) > spare->writeSeq)
+            {
+                // a newer copy has been recovered on another die, this one is stale
+                SelectiveGetFromGcVictimList(dieNo, blockNo);
+                VBLK_ENTRY(dieNo, blockNo)->invalidSliceCnt++;
+                PutToGcVictimList(dieNo, blockNo, VBLK_ENTRY(dieNo, blockNo)->invalidSliceCnt);
+            }
+            else
+            {
+                InvalidateOldVsa(spare->logicalSliceAddr);
+                SET_LSA2VSA(spare->logicalSliceAddr, virtualSliceAddr);
+                SET_VSA_VALID(virtualSliceAddr);
+            }
+
+            if (spare->writeSeq > addrJournal.writeSeq)
+                addrJournal.writeSeq = spare->writeSeq;
+            scannedCnt++;
+
+            if (++cursor->pageNo == USER_PAGES_PER_BLOCK && ++cursor->iBlock < cursor->blockCnt)
+                cursor->pageNo = cursor->startPage[cursor->iBlock];
+            else if (cursor->iBlock == cursor->blockCnt)
+                scanningCnt--;
+        }
+    }
+
+    return scannedCnt;
+}
+
+/**
+ * @brief Make the blocks possibly written after the last recovered slice usable again.
+ *
+ * The pages after the last recovered slice of an open block may be partially programmed.
+ * The current blocks of each die are closed, and the first `ADDR_JOURNAL_UNCLEAN_ERASE_BLOCKS`
+ * free blocks, which are the next ones to be taken as they were before the power loss, are
+ * erased again.
+ */
+static void RecoverFromUncleanShutdown()
+{
+    unsigned int dieNo, blockNo, stream, iBlk, reqSlotTag;
+
+    for (dieNo = 0; dieNo < USER_DIES; dieNo++)
+    {
+        for (stream = 0; stream < WRITE_STREAM_COUNT; stream++)
+            if (VDIE_ENTRY(dieNo)->currentBlock[stream] != BLOCK_NONE)
+                VBLK_ENTRY(dieNo, VDIE_ENTRY(dieNo)->currentBlock[stream])->currentPage = USER_PAGES_PER_BLOCK;
+
+        blockNo = VDIE_ENTRY(dieNo)->headFreeBlock;
+        for (iBlk = 0; iBlk < ADDR_JOURNAL_UNCLEAN_ERASE_BLOCKS && blockNo != BLOCK_NONE; iBlk++)
+        {
+            reqSlotTag = GetFromFreeReqQ();
+
+            REQ_ENTRY(reqSlotTag)->reqType                       = REQ_TYPE_NAND;
+            REQ_ENTRY(reqSlotTag)->reqCode                       = REQ_CODE_ERASE;
+            REQ_ENTRY(reqSlotTag)->reqOpt.nandAddr               = REQ_OPT_NAND_ADDR_VSA;
+            REQ_ENTRY(reqSlotTag)->reqOpt.dataBufFormat          = REQ_OPT_DATA_BUF_NONE;
+            REQ_ENTRY(reqSlotTag)->reqOpt.rowAddrDependencyCheck = REQ_OPT_ROW_ADDR_DEPENDENCY_NONE;
+            REQ_ENTRY(reqSlotTag)->reqOpt.blockSpace             = REQ_OPT_BLOCK_SPACE_MAIN;
+            REQ_ENTRY(reqSlotTag)->nandInfo.virtualSliceAddr     = Vorg2VsaTranslation(dieNo, blockNo, 0);
+
+            SelectLowLevelReqQ(reqSlotTag);
+
+            VBLK_ENTRY(dieNo, blockNo)->eraseCnt++;
+            blockNo = VBLK_NEXT_IDX(dieNo, blockNo);
+        }
+    }
+
+    SyncAllLowLevelReqDone();
+}
+
+/**
+ * @brief Rebuild the row address dependency table from the recovered block maps.
+ *
+ * The table only follows the pages issued since power on, without this the erase of a block
+ * programmed before the power cycle would wait forever for its pages to be programmed.
+ */
+static void RecoverRowAddrDepTable()
+{
+    unsigned int dieNo, blockNo;
+    P_ROW_ADDR_DEPENDENCY_ENTRY rowAddrDep;
+
+    for (dieNo = 0; dieNo < USER_DIES; dieNo++)
+        for (blockNo = 0; blockNo < USER_BLOCKS_PER_DIE; blockNo++)
+        {
+            rowAddrDep = ROW_ADDR_DEP_ENTRY(Vdie2PchTranslation(dieNo), Vdie2PwayTranslation(dieNo), blockNo);
+
+            rowAddrDep->permittedProgPage   = VBLK_ENTRY(dieNo, blockNo)->currentPage;
+            rowAddrDep->blockedReadReqCnt   = 0;
+            rowAddrDep->blockedEraseReqFlag = 0;
+        }
+}
+
+/**
+ * @brief Recover the address maps from the latest checkpoint, its journal and the spare
+ * regions of the open blocks.
+ *
+ * This function should be called after the block maps and the GC victim lists are built
+ * for an empty device (`InitAddressMap()`, `InitGcVictimMap()`), they are overwritten by
+ * the checkpoint. If no checkpoint is found, the maps are left empty and a checkpoint is
+ * taken right away.
+ *
+ * A normal shutdown ends with a checkpoint, so any journal page or any slice found by the
+ * spare scan means an unclean shutdown, then a new checkpoint is taken after the recovery,
+ * since the journal may end with a partially programmed page. The row address dependency
+ * table is then rebuilt from the recovered write positions of the blocks.
+ */
+void RecoverAddrMap()
+{
+    unsigned int slot, epoch, latestSlot, latestEpoch;
+
+    addrJournal.enabled       = 0;
+    addrJournal.epoch         = 0;
+    addrJournal.pageCnt       = 0;
+    addrJournal.openBuf       = 0;
+    addrJournal.checkpointCnt = 0;
+    addrJournal.recordCnt     = 0;
+    addrJournal.replayedCnt   = 0;
+    addrJournal.scannedCnt    = 0;
+    addrJournal.writeSeq      = 0;
+    ADDR_JOURNAL_PAGE_BUF(addrJournal.openBuf)->recordCnt = 0;
+
+    latestSlot  = ADDR_MAP_SLOT_COUNT;
+    latestEpoch = 0;
+    for (slot = 0; slot < ADDR_MAP_SLOT_COUNT; slot++)
+    {
+        epoch = ReadAddrMapCheckpointHeader(slot);
+        if (epoch > latestEpoch)
+        {
+            latestSlot  = slot;
+            latestEpoch = epoch;
+        }
+    }
+
+    if (latestSlot == ADDR_MAP_SLOT_COUNT)
+    {
+        xil_printf("[ address map checkpoint does not exist. ]\r\n");
+        InitSliceMap();
+        addrJournal.enabled = 1;
+        SaveAddrMapCheckpoint();
+        return;
+    }
+
+    addrJournal.epoch    = latestEpoch;
+    addrJournal.writeSeq = ((P_ADDR_MAP_CHECKPOINT_HEADER)ADDR_MAP_CHECKPOINT_BUF(latestSlot))->writeSeq;
+    LoadAddrMapCheckpoint(latestSlot);
+
+    addrJournal.pageCnt     = ReplayAddrJournal();
+    addrJournal.replayedCnt = addrJournal.pageCnt;
+    addrJournal.scannedCnt  = ScanSliceSpare();
+    addrJournal.enabled     = 1;
+
+    xil_printf("[ address map checkpoint %u loaded, %u journal pages replayed, %u slices scanned. ]\r\n",
+               latestEpoch, addrJournal.replayedCnt, addrJournal.scannedCnt);
+
+    if (addrJournal.replayedCnt || addrJournal.scannedCnt)
+    {
+        pr_warn("Address maps recovered from an unclean shutdown");
+        RecoverFromUncleanShutdown();
+        SaveAddrMapCheckpoint();
+    }
+    RecoverRowAddrDepTable();
+}
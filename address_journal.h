@@ -0,0 +1,206 @@
+//////////////////////////////////////////////////////////////////////////////////
+// address_journal.h for Cosmos+ OpenSSD
+// Copyright (c) 2017 Hanyang University ENC Lab.
+// Contributed by Yong Ho Song <yhsong@enc.hanyang.ac.kr>
+//				  Jaewook Kwak <jwkwak@enc.hanyang.ac.kr>
+//
+// This file is part of Cosmos+ OpenSSD.
+//
+// Cosmos+ OpenSSD is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3, or (at your option)
+// any later version.
+//
+// Cosmos+ OpenSSD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Cosmos+ OpenSSD; see the file COPYING.
+// If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Company: ENC Lab. <http://enc.hanyang.ac.kr>
+// Engineer: Jaewook Kwak <jwkwak@enc.hanyang.ac.kr>
+//
+// Project Name: Cosmos+ OpenSSD
+// Design Name: Cosmos+ Firmware
+// Module Name: Address Map Journal
+// File Name: address_journal.h
+//
+// Version: v1.0.0
+//
+// Description:
+//   - layout of the address map checkpoints and the map journal in flash
+//   - data structures of the journal pages kept in DRAM
+//   - metadata written to the spare region of each programmed slice
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Revision History:
+//
+// * v1.0.0
+//   - First draft
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef ADDRESS_JOURNAL_H_
+#define ADDRESS_JOURNAL_H_
+
+#include "ftl_config.h"
+#include "address_map_cache.h"
+#include "write_stream.h"
+
+/**
+ * The address maps (slice maps, block map, die map and GC victim lists) are persisted as
+ * periodic checkpoints plus a journal of the map updates made after the checkpoint.
+ *
+ * Each die reserves `ADDR_MAP_PBLK_PER_DIE` physical blocks for them, taken from the top
+ * of the reserved (remapping) blocks of LUN 0 by `ReserveAddrMapBlocks()`:
+ *
+ * - `ADDR_MAP_SLOT_COUNT` checkpoint slots of `ADDR_MAP_PBLK_PER_SLOT` blocks, written in
+ *   turn so the previous checkpoint survives until the new one is committed.
+ * - `ADDR_JOURNAL_PBLK_PER_DIE` journal blocks.
+ * - `ADDR_MAP_SWAP_PBLK_PER_DIE` blocks for the translation pages written back by the
+ *   demand paged logical slice map, none in resident mode, check `address_map_cache.h`.
+ *
+ * Both checkpoint and journal pages are striped over all the dies, page `i` is placed on
+ * die `i % USER_DIES`, so they are written and read with full die parallelism.
+ */
+#define ADDR_MAP_SLOT_COUNT       2
+#define ADDR_MAP_PBLK_PER_SLOT    2
+#define ADDR_JOURNAL_PBLK_PER_DIE 1
+#define ADDR_MAP_PBLK_PER_DIE                                                                                     \
+    (ADDR_MAP_SLOT_COUNT * ADDR_MAP_PBLK_PER_SLOT + ADDR_JOURNAL_PBLK_PER_DIE + ADDR_MAP_SWAP_PBLK_PER_DIE)
+
+#define ADDR_MAP_SLOT_PBLK_IDX(slot) ((slot)*ADDR_MAP_PBLK_PER_SLOT)
+#define ADDR_JOURNAL_PBLK_IDX        (ADDR_MAP_SLOT_COUNT * ADDR_MAP_PBLK_PER_SLOT)
+#define ADDR_MAP_SWAP_PBLK_IDX       (ADDR_JOURNAL_PBLK_IDX + ADDR_JOURNAL_PBLK_PER_DIE)
+
+#define ADDR_MAP_SLOT_PAGES    (USER_DIES * ADDR_MAP_PBLK_PER_SLOT * USER_PAGES_PER_BLOCK)
+#define ADDR_JOURNAL_MAX_PAGES (USER_DIES * ADDR_JOURNAL_PBLK_PER_DIE * USER_PAGES_PER_BLOCK)
+
+/**
+ * A new checkpoint is taken once the journal grows to `ADDR_JOURNAL_CHECKPOINT_PAGES`
+ * pages and the host is idle, or to `ADDR_JOURNAL_FORCE_CHECKPOINT_PAGES` pages anyway.
+ * The boot time is bounded by the journal length instead of the capacity.
+ */
+#ifndef ADDR_JOURNAL_CHECKPOINT_PAGES
+#define ADDR_JOURNAL_CHECKPOINT_PAGES 256
+#endif
+#define ADDR_JOURNAL_FORCE_CHECKPOINT_PAGES (4 * ADDR_JOURNAL_CHECKPOINT_PAGES)
+
+#if ADDR_JOURNAL_FORCE_CHECKPOINT_PAGES >= ADDR_JOURNAL_MAX_PAGES
+#error "the journal must be checkpointed before it fills its blocks, lower `ADDR_JOURNAL_CHECKPOINT_PAGES`"
+#endif
+
+/**
+ * After an unclean shutdown, the slices programmed after the last journal page are found
+ * by scanning the spare regions of the open blocks: the current block of each write stream
+ * of each die and its first `ADDR_JOURNAL_UNCLEAN_ERASE_BLOCKS` free blocks, which are the
+ * next ones to be taken by any stream. The free blocks found empty are erased again, they
+ * may be partially programmed.
+ */
+#define ADDR_JOURNAL_UNCLEAN_ERASE_BLOCKS (WRITE_STREAM_COUNT + 1)
+#define ADDR_JOURNAL_SCAN_BLOCKS          (WRITE_STREAM_COUNT + ADDR_JOURNAL_UNCLEAN_ERASE_BLOCKS)
+
+#define ADDR_MAP_CHECKPOINT_MAGIC 0x4C325043 // "L2PC"
+#define ADDR_JOURNAL_MAGIC        0x4C32504A // "L2PJ"
+#define SLICE_SPARE_MAGIC         0x4C325053 // "L2PS"
+
+#define ADDR_JOURNAL_LSA_ERASE   0xfffffffe // the record of a block erase, the VSA is the first slice of the block
+#define ADDR_JOURNAL_LSA_OPEN    0xfffffff0 // ORed to the stream taking a new block, the VSA is the first slice of it
+#define ADDR_JOURNAL_LSA_DEALLOC 0x80000000 // ORed to the first slice of a deallocated run, the VSA is the count
+
+typedef struct _ADDR_JOURNAL_RECORD
+{
+    unsigned int logicalSliceAddr;
+    unsigned int virtualSliceAddr;
+} ADDR_JOURNAL_RECORD, *P_ADDR_JOURNAL_RECORD;
+
+#define ADDR_JOURNAL_HEADER_BYTES 24
+#define ADDR_JOURNAL_RECORDS_PER_PAGE                                                                             \
+    ((BYTES_PER_DATA_REGION_OF_PAGE - ADDR_JOURNAL_HEADER_BYTES) / sizeof(ADDR_JOURNAL_RECORD))
+
+/**
+ * @brief The data region of a journal page.
+ *
+ * The records are replayed in order, a page is valid only if it carries the magic and the
+ * epoch of the checkpoint being recovered, and the journal ends at the first invalid page.
+ */
+typedef struct _ADDR_JOURNAL_PAGE
+{
+    unsigned int magic;
+    unsigned int epoch;     // the checkpoint this page is based on
+    unsigned int pageNo;    // index of this page in the journal
+    unsigned int recordCnt; // number of valid records
+    unsigned int writeSeq;  // the write sequence number of the last record
+    unsigned int reserved0;
+    ADDR_JOURNAL_RECORD record[ADDR_JOURNAL_RECORDS_PER_PAGE];
+} ADDR_JOURNAL_PAGE, *P_ADDR_JOURNAL_PAGE;
+
+/**
+ * @brief The commit page of a checkpoint, written after all the map pages are done.
+ */
+typedef struct _ADDR_MAP_CHECKPOINT_HEADER
+{
+    unsigned int magic;
+    unsigned int epoch;      // increased by one for each checkpoint
+    unsigned int mapPageCnt; // number of map pages before this page
+    unsigned int mapBytes;   // size of the saved maps, a different layout is not loadable
+    unsigned int writeSeq;   // the write sequence number of the last slice in the maps
+} ADDR_MAP_CHECKPOINT_HEADER, *P_ADDR_MAP_CHECKPOINT_HEADER;
+
+/**
+ * @brief The metadata written to the spare region of each slice programmed by the FTL.
+ *
+ * The write sequence number is assigned when the slice is mapped, so the latest copy of a
+ * logical slice has the largest one, and the erase count stamps the block generation.
+ */
+typedef struct _SLICE_SPARE_INFO
+{
+    unsigned int magic;
+    unsigned int logicalSliceAddr;
+    unsigned int writeSeq;
+    unsigned int eraseCnt; // erase count of the block when this slice is programmed
+    unsigned int stream;   // the write stream of the block, `WRITE_STREAM_*`
+} SLICE_SPARE_INFO, *P_SLICE_SPARE_INFO;
+
+#define ADDR_JOURNAL_BUF_COUNT  2 // a full page is programmed while the records go to the other one
+#define ADDR_MAP_PAGE_BUF_BYTES (BYTES_PER_DATA_REGION_OF_PAGE + BYTES_PER_SPARE_REGION_OF_PAGE)
+
+#define ADDR_MAP_CHECKPOINT_BUF(iDie) (ADDR_MAP_CHECKPOINT_BUF_ADDR + (iDie)*ADDR_MAP_PAGE_BUF_BYTES)
+
+typedef struct _ADDR_JOURNAL_STATE
+{
+    unsigned int epoch;         // epoch of the latest checkpoint
+    unsigned int pageCnt;       // journal pages programmed since the latest checkpoint
+    unsigned int openBuf;       // the page buffer receiving the new records
+    unsigned int enabled;       // 0 until the maps are recovered
+    unsigned int checkpointCnt; // checkpoints taken since boot
+    unsigned int recordCnt;     // records appended since boot
+    unsigned int replayedCnt;   // journal pages replayed at the last recovery
+    unsigned int scannedCnt;    // slices recovered from the spare regions at the last recovery
+    unsigned int writeSeq;      // the write sequence number of the latest mapped slice
+} ADDR_JOURNAL_STATE, *P_ADDR_JOURNAL_STATE;
+
+void ReserveAddrMapBlocks();
+unsigned int IsAddrMapBlock(unsigned int dieNo, unsigned int phyBlockNo);
+void IssueAddrMapPageReq(unsigned int reqCode, unsigned int firstPblkIdx, unsigned int pageIdx, unsigned int bufAddr);
+void EraseAddrMapBlocks(unsigned int firstPblkIdx, unsigned int pblkCnt);
+
+void RecoverAddrMap();
+void SaveAddrMapCheckpoint();
+void SaveAddrMapInBackground(unsigned int hostIdle);
+
+void JournalAddrTrans(unsigned int logicalSliceAddr, unsigned int virtualSliceAddr);
+void JournalBlockErase(unsigned int dieNo, unsigned int blockNo);
+void JournalBlockOpen(unsigned int dieNo, unsigned int blockNo, unsigned int stream);
+void JournalDeallocate(unsigned int startLsa, unsigned int sliceCnt);
+void FlushAddrJournal();
+void StampSliceSpare(unsigned int reqSlotTag, unsigned int spareDataBufAddr);
+
+extern ADDR_JOURNAL_STATE addrJournal;
+
+#endif /* ADDRESS_JOURNAL_H_ */
@@ -0,0 +1,481 @@
+//////////////////////////////////////////////////////////////////////////////////
+// address_map_cache.c for Cosmos+ OpenSSD
+// Copyright (c) 2017 Hanyang University ENC Lab.
+// Contributed by Yong Ho Song <yhsong@enc.hanyang.ac.kr>
+//				  Jaewook Kwak <jwkwak@enc.hanyang.ac.kr>
+//
+// This file is part of Cosmos+ OpenSSD.
+//
+// Cosmos+ OpenSSD is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3, or (at your option)
+// any later version.
+//
+// Cosmos+ OpenSSD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Cosmos+ OpenSSD; see the file COPYING.
+// If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Company: ENC Lab. <http://enc.hanyang.ac.kr>
+// Engineer: Jaewook Kwak <jwkwak@enc.hanyang.ac.kr>
+//
+// Project Name: Cosmos+ OpenSSD
+// Design Name: Cosmos+ Firmware
+// Module Name: Address Map Cache
+// File Name: address_map_cache.c
+//
+// Version: v1.0.0
+//
+// Description:
+//   - look up and update the logical slice map through the translation page cache
+//   - write back the dirty translation pages to the swap area in batches
+//   - copy the translation pages to the checkpoint slots
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Revision History:
+//
+// * v1.0.0
+//   - First draft
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <assert.h>
+#include <string.h>
+#include "debug.h"
+
+#include "memory_map.h"
+
+unsigned int addrMapCacheEntryCount = ADDR_MAP_CACHE_DEFAULT_ENTRY_COUNT;
+ADDR_MAP_CACHE_STATE addrMapCache;
+
+#if (ADDR_MAP_MODE == ADDR_MAP_MODE_DEMAND)
+
+/**
+ * In demand paged mode, the translation pages live in the latest checkpoint slot, and the
+ * ones written back after the checkpoint in the swap area. The global translation
+ * directory (`ADDR_MAP_DIR`) tells where each of them is, and which cache entry holds it.
+ *
+ * A miss reads the translation page synchronously, only the die holding it is waited for.
+ * The swap area is never needed for recovery: a checkpoint copies all the translation
+ * pages to its slot, and the journal replays the updates made after it through the cache.
+ */
+
+P_ADDR_MAP_DIR addrMapDirPtr;
+P_ADDR_MAP_CACHE_MAP addrMapCacheMapPtr;
+
+static unsigned int swapUsedSegments; // bitmap of the swap segments written since erased
+
+#define TRANS_DIR_ENTRY(iTransPage) (&addrMapDirPtr->transPage[(iTransPage)])
+#define MAP_CACHE_ENTRY(iEntry)     (&addrMapCacheMapPtr->cacheEntry[(iEntry)])
+#define MAP_CACHE_FRAME(iEntry)     (ADDR_MAP_CACHE_BUFFER_ADDR + (iEntry)*ADDR_MAP_PAGE_BUF_BYTES)
+#define MAP_SWAP_BUF(iDie)          (ADDR_MAP_SWAP_BUFFER_ADDR + (iDie)*ADDR_MAP_PAGE_BUF_BYTES)
+#define SWAP_PAGE_OWNER(swapPage)   (addrMapCacheMapPtr->swapTransPage[(swapPage)])
+#define SWAP_PAGE2SEGMENT(swapPage) ((swapPage) / ADDR_MAP_SWAP_SEGMENT_PAGES)
+
+/**
+ * @brief Initialize the translation page cache.
+ *
+ * The number of entries is taken from `addrMapCacheEntryCount`, which can be set before
+ * boot (default `ADDR_MAP_CACHE_DEFAULT_ENTRY_COUNT`). The directory and the entries are
+ * set up later by `ResetAddrMapCache()` once the maps are recovered.
+ */
+void InitAddrMapCache()
+{
+    ASSERT(ADDR_MAP_TRANS_PAGES < ADDR_MAP_TRANS_PAGE_NONE, "too many translation pages");
+    // the live pages of a segment and a batch must fit in the segment being filled
+    ASSERT(ADDR_MAP_TRANS_PAGES + ADDR_MAP_CACHE_WRITE_BACK_BATCH <= ADDR_MAP_SWAP_SEGMENT_PAGES,
+           "swap segment (%u pages) too small", ADDR_MAP_SWAP_SEGMENT_PAGES);
+    // the segment being cleaned must be neither the one being filled nor the one just filled
+    ASSERT(ADDR_MAP_SWAP_PBLK_PER_DIE >= 3 && ADDR_MAP_SWAP_PBLK_PER_DIE <= 32, "invalid swap area size");
+
+    addrMapDirPtr      = (P_ADDR_MAP_DIR)ADDR_MAP_DIR_ADDR;
+    addrMapCacheMapPtr = (P_ADDR_MAP_CACHE_MAP)ADDR_MAP_CACHE_MAP_ADDR;
+
+    if (addrMapCacheEntryCount < ADDR_MAP_CACHE_MIN_ENTRY_COUNT ||
+        addrMapCacheEntryCount > ADDR_MAP_CACHE_MAX_ENTRY_COUNT)
+    {
+        pr_warn("Invalid number of address map cache entries %u, use %u instead", addrMapCacheEntryCount,
+                ADDR_MAP_CACHE_DEFAULT_ENTRY_COUNT);
+        addrMapCacheEntryCount = ADDR_MAP_CACHE_DEFAULT_ENTRY_COUNT;
+    }
+    pr_info("Address map cache: %u of %u translation pages", addrMapCacheEntryCount, ADDR_MAP_TRANS_PAGES);
+
+    addrMapCache.hitCnt       = 0;
+    addrMapCache.missCnt      = 0;
+    addrMapCache.writeBackCnt = 0;
+    addrMapCache.relocateCnt  = 0;
+}
+
+/**
+ * @brief Erase the used swap segments, no swap page is referenced afterward.
+ */
+static void EraseAddrMapSwap()
+{
+    unsigned int segment;
+
+    for (segment = 0; segment < ADDR_MAP_SWAP_PBLK_PER_DIE; segment++)
+        if (swapUsedSegments & (1 << segment))
+            EraseAddrMapBlocks(ADDR_MAP_SWAP_PBLK_IDX + segment, 1);
+
+    memset(addrMapCacheMapPtr->swapTransPage, 0xff, sizeof(addrMapCacheMapPtr->swapTransPage));
+    swapUsedSegments      = 0;
+    addrMapCache.swapHead = 0;
+}
+
+/**
+ * @brief Drop all the cached translation pages and point the directory to the given location.
+ *
+ * @param location `ADDR_MAP_TRANS_UNMAPPED` for an empty device, or `ADDR_MAP_TRANS_IN_SLOT`
+ * after the checkpoint in the given slot is loaded.
+ * @param slotPblkIdx the first reserved block of the slot holding the translation pages.
+ */
+void ResetAddrMapCache(unsigned int location, unsigned int slotPblkIdx)
+{
+    unsigned int iTransPage, iEntry;
+
+    for (iTransPage = 0; iTransPage < ADDR_MAP_TRANS_PAGES; iTransPage++)
+    {
+        TRANS_DIR_ENTRY(iTransPage)->flashPage  = iTransPage;
+        TRANS_DIR_ENTRY(iTransPage)->location   = location;
+        TRANS_DIR_ENTRY(iTransPage)->cacheEntry = ADDR_MAP_CACHE_ENTRY_NONE;
+    }
+
+    for (iEntry = 0; iEntry < addrMapCacheEntryCount; iEntry++)
+    {
+        MAP_CACHE_ENTRY(iEntry)->transPage = ADDR_MAP_TRANS_PAGE_NONE;
+        MAP_CACHE_ENTRY(iEntry)->dirty     = 0;
+        MAP_CACHE_ENTRY(iEntry)->prevEntry = (iEntry == 0) ? ADDR_MAP_CACHE_ENTRY_NONE : iEntry - 1;
+        MAP_CACHE_ENTRY(iEntry)->nextEntry =
+            (iEntry == addrMapCacheEntryCount - 1) ? ADDR_MAP_CACHE_ENTRY_NONE : iEntry + 1;
+    }
+    addrMapCache.headEntry = 0;
+    addrMapCache.tailEntry = addrMapCacheEntryCount - 1;
+
+    // the swap area may be left written by the last run
+    swapUsedSegments = (1 << ADDR_MAP_SWAP_PBLK_PER_DIE) - 1;
+    EraseAddrMapSwap();
+
+    addrMapCache.slotPblkIdx = slotPblkIdx;
+}
+
+/**
+ * @brief Wait for the requests on the given die, including a translation page read.
+ *
+ * The requests of a die are completed in order, and no request is added meanwhile except
+ * the ones released from the dependency queues.
+ */
+static void SyncAddrMapDieReqDone(unsigned int dieNo)
+{
+    while (nandReqQ[VDIE2PCH(dieNo)][VDIE2PWAY(dieNo)].headReq != REQ_SLOT_TAG_NONE)
+    {
+        CheckDoneNvmeDmaReq();
+        SchedulingNandReq();
+    }
+}
+
+static void UnlinkAddrMapCacheEntry(unsigned int iEntry)
+{
+    P_ADDR_MAP_CACHE_ENTRY entry = MAP_CACHE_ENTRY(iEntry);
+
+    if (entry->prevEntry != ADDR_MAP_CACHE_ENTRY_NONE)
+        MAP_CACHE_ENTRY(entry->prevEntry)->nextEntry = entry->nextEntry;
+    else
+        addrMapCache.headEntry = entry->nextEntry;
+
+    if (entry->nextEntry != ADDR_MAP_CACHE_ENTRY_NONE)
+        MAP_CACHE_ENTRY(entry->nextEntry)->prevEntry = entry->prevEntry;
+    else
+        addrMapCache.tailEntry = entry->prevEntry;
+}
+
+static void PutToAddrMapCacheHead(unsigned int iEntry)
+{
+    P_ADDR_MAP_CACHE_ENTRY entry = MAP_CACHE_ENTRY(iEntry);
+
+    entry->prevEntry = ADDR_MAP_CACHE_ENTRY_NONE;
+    entry->nextEntry = addrMapCache.headEntry;
+    if (addrMapCache.headEntry != ADDR_MAP_CACHE_ENTRY_NONE)
+        MAP_CACHE_ENTRY(addrMapCache.headEntry)->prevEntry = iEntry;
+    else
+        addrMapCache.tailEntry = iEntry;
+    addrMapCache.headEntry = iEntry;
+}
+
+static void CleanAddrMapSwapSegment(unsigned int segment);
+
+/**
+ * @brief Take the next page of the swap area for the given translation page.
+ *
+ * Once the head enters a segment, the next segment (the oldest one) is cleaned, so it is
+ * erased before the head reaches it.
+ */
+static unsigned int AllocateAddrMapSwapPage(unsigned int transPage)
+{
+    unsigned int swapPage;
+
+    swapPage              = addrMapCache.swapHead;
+    addrMapCache.swapHead = (swapPage + 1) % ADDR_MAP_SWAP_PAGES;
+
+    swapUsedSegments |= 1 << SWAP_PAGE2SEGMENT(swapPage);
+    SWAP_PAGE_OWNER(swapPage) = transPage;
+
+    if (swapPage % ADDR_MAP_SWAP_SEGMENT_PAGES == 0)
+        CleanAddrMapSwapSegment((SWAP_PAGE2SEGMENT(swapPage) + 1) % ADDR_MAP_SWAP_PBLK_PER_DIE);
+
+    return swapPage;
+}
+
+/**
+ * @brief Point the directory entry of the given translation page to its new swap page.
+ */
+static void MoveAddrMapTransPage(unsigned int transPage, unsigned int swapPage)
+{
+    P_ADDR_MAP_DIR_ENTRY dirEntry = TRANS_DIR_ENTRY(transPage);
+
+    if (dirEntry->location == ADDR_MAP_TRANS_IN_SWAP && SWAP_PAGE_OWNER(dirEntry->flashPage) == transPage)
+        SWAP_PAGE_OWNER(dirEntry->flashPage) = ADDR_MAP_TRANS_PAGE_NONE;
+
+    dirEntry->location  = ADDR_MAP_TRANS_IN_SWAP;
+    dirEntry->flashPage = swapPage;
+}
+
+/**
+ * @brief Move the live translation pages out of the given swap segment and erase it.
+ *
+ * A cached page is just marked dirty, the cache holds the latest copy and it will be
+ * written back on eviction. The others are read and programmed at the swap head, one
+ * page per die at a time.
+ */
+static void CleanAddrMapSwapSegment(unsigned int segment)
+{
+    unsigned int swapPage, transPage, newSwapPage[USER_DIES], transPages[USER_DIES], pageCnt, iPage;
+
+    if (!(swapUsedSegments & (1 << segment)))
+        return;
+
+    pageCnt = 0;
+    for (swapPage = segment * ADDR_MAP_SWAP_SEGMENT_PAGES; swapPage < (segment + 1) * ADDR_MAP_SWAP_SEGMENT_PAGES;
+         swapPage++)
+    {
+        transPage = SWAP_PAGE_OWNER(swapPage);
+        if (transPage == ADDR_MAP_TRANS_PAGE_NONE)
+            continue;
+        SWAP_PAGE_OWNER(swapPage) = ADDR_MAP_TRANS_PAGE_NONE;
+
+        if (TRANS_DIR_ENTRY(transPage)->cacheEntry != ADDR_MAP_CACHE_ENTRY_NONE)
+        {
+            MAP_CACHE_ENTRY(TRANS_DIR_ENTRY(transPage)->cacheEntry)->dirty = 1;
+            continue;
+        }
+
+        // the head is in the previous segment, thus the reads and the programs never overlap
+        newSwapPage[pageCnt] = AllocateAddrMapSwapPage(transPage);
+        transPages[pageCnt]  = transPage;
+        SyncAddrMapDieReqDone(newSwapPage[pageCnt] % USER_DIES);
+        IssueAddrMapPageReq(REQ_CODE_READ, ADDR_MAP_SWAP_PBLK_IDX, swapPage,
+                            MAP_SWAP_BUF(newSwapPage[pageCnt] % USER_DIES));
+
+        if (++pageCnt == USER_DIES || newSwapPage[pageCnt - 1] % USER_DIES == USER_DIES - 1)
+        {
+            SyncAllLowLevelReqDone();
+            for (iPage = 0; iPage < pageCnt; iPage++)
+            {
+                IssueAddrMapPageReq(REQ_CODE_WRITE, ADDR_MAP_SWAP_PBLK_IDX, newSwapPage[iPage],
+                                    MAP_SWAP_BUF(newSwapPage[iPage] % USER_DIES));
+                TRANS_DIR_ENTRY(transPages[iPage])->flashPage = newSwapPage[iPage];
+            }
+            addrMapCache.relocateCnt += pageCnt;
+            pageCnt = 0;
+        }
+    }
+
+    SyncAllLowLevelReqDone();
+    for (iPage = 0; iPage < pageCnt; iPage++)
+    {
+        IssueAddrMapPageReq(REQ_CODE_WRITE, ADDR_MAP_SWAP_PBLK_IDX, newSwapPage[iPage],
+                            MAP_SWAP_BUF(newSwapPage[iPage] % USER_DIES));
+        TRANS_DIR_ENTRY(transPages[iPage])->flashPage = newSwapPage[iPage];
+    }
+    addrMapCache.relocateCnt += pageCnt;
+
+    EraseAddrMapBlocks(ADDR_MAP_SWAP_PBLK_IDX + segment, 1);
+    swapUsedSegments &= ~(1 << segment);
+}
+
+/**
+ * @brief Write back the dirty translation pages near the LRU end of the cache.
+ *
+ * Up to `ADDR_MAP_CACHE_WRITE_BACK_BATCH` dirty pages are found in the least recently used
+ * quarter of the cache, they are copied to the swap page buffers and programmed to
+ * consecutive swap pages, which are on different dies. The pages stay cached as clean.
+ */
+static void WriteBackAddrMapCache()
+{
+    unsigned int iEntry, scanCnt, batchCnt, transPage, swapPage, dieNo;
+    P_ADDR_MAP_CACHE_ENTRY entry;
+
+    scanCnt  = addrMapCacheEntryCount / 4;
+    batchCnt = 0;
+    for (iEntry = addrMapCache.tailEntry; iEntry != ADDR_MAP_CACHE_ENTRY_NONE && scanCnt; iEntry = entry->prevEntry)
+    {
+        entry = MAP_CACHE_ENTRY(iEntry);
+        scanCnt--;
+        if (!entry->dirty)
+            continue;
+
+        transPage = entry->transPage;
+        swapPage  = AllocateAddrMapSwapPage(transPage);
+        dieNo     = swapPage % USER_DIES;
+
+        // the buffer is still being programmed by the last batch
+        SyncAddrMapDieReqDone(dieNo);
+        memcpy((void *)MAP_SWAP_BUF(dieNo), (void *)MAP_CACHE_FRAME(iEntry), BYTES_PER_DATA_REGION_OF_PAGE);
+        IssueAddrMapPageReq(REQ_CODE_WRITE, ADDR_MAP_SWAP_PBLK_IDX, swapPage, MAP_SWAP_BUF(dieNo));
+
+        MoveAddrMapTransPage(transPage, swapPage);
+        entry->dirty = 0;
+        addrMapCache.writeBackCnt++;
+
+        if (++batchCnt == ADDR_MAP_CACHE_WRITE_BACK_BATCH)
+            break;
+    }
+}
+
+/**
+ * @brief Get the cached copy of the given translation page, read it on a miss.
+ *
+ * @return unsigned int * the entries of the translation page.
+ */
+static unsigned int *GetAddrMapTransPage(unsigned int transPage)
+{
+    P_ADDR_MAP_DIR_ENTRY dirEntry = TRANS_DIR_ENTRY(transPage);
+    P_ADDR_MAP_CACHE_ENTRY entry;
+    unsigned int iEntry, slotPblkIdx;
+
+    iEntry = dirEntry->cacheEntry;
+    if (iEntry != ADDR_MAP_CACHE_ENTRY_NONE)
+    {
+        addrMapCache.hitCnt++;
+        if (addrMapCache.headEntry != iEntry)
+        {
+            UnlinkAddrMapCacheEntry(iEntry);
+            PutToAddrMapCacheHead(iEntry);
+        }
+        return (unsigned int *)MAP_CACHE_FRAME(iEntry);
+    }
+
+    addrMapCache.missCnt++;
+
+    // evict the least recently used entry
+    iEntry = addrMapCache.tailEntry;
+    entry  = MAP_CACHE_ENTRY(iEntry);
+    if (entry->transPage != ADDR_MAP_TRANS_PAGE_NONE)
+    {
+        if (entry->dirty)
+            WriteBackAddrMapCache();
+        ASSERT(!entry->dirty, "translation page %u not written back", entry->transPage);
+        TRANS_DIR_ENTRY(entry->transPage)->cacheEntry = ADDR_MAP_CACHE_ENTRY_NONE;
+    }
+
+    UnlinkAddrMapCacheEntry(iEntry);
+    PutToAddrMapCacheHead(iEntry);
+    entry->transPage     = transPage;
+    entry->dirty         = 0;
+    dirEntry->cacheEntry = iEntry;
+
+    if (dirEntry->location == ADDR_MAP_TRANS_UNMAPPED)
+        memset((void *)MAP_CACHE_FRAME(iEntry), 0xff, BYTES_PER_DATA_REGION_OF_PAGE);
+    else
+    {
+        slotPblkIdx =
+            (dirEntry->location == ADDR_MAP_TRANS_IN_SLOT) ? addrMapCache.slotPblkIdx : ADDR_MAP_SWAP_PBLK_IDX;
+        IssueAddrMapPageReq(REQ_CODE_READ, slotPblkIdx, dirEntry->flashPage, MAP_CACHE_FRAME(iEntry));
+        SyncAddrMapDieReqDone(dirEntry->flashPage % USER_DIES);
+    }
+
+    return (unsigned int *)MAP_CACHE_FRAME(iEntry);
+}
+
+/**
+ * @brief Get the virtual slice address mapped to the given logical slice.
+ */
+unsigned int GetAddrMapEntry(unsigned int logicalSliceAddr)
+{
+    return GetAddrMapTransPage(LSA2TRANS_PAGE(logicalSliceAddr))[LSA2TRANS_OFFSET(logicalSliceAddr)];
+}
+
+/**
+ * @brief Map the given logical slice to the given virtual slice.
+ */
+void SetAddrMapEntry(unsigned int logicalSliceAddr, unsigned int virtualSliceAddr)
+{
+    unsigned int transPage = LSA2TRANS_PAGE(logicalSliceAddr);
+    unsigned int *entries  = GetAddrMapTransPage(transPage);
+
+    if (entries[LSA2TRANS_OFFSET(logicalSliceAddr)] != virtualSliceAddr)
+    {
+        entries[LSA2TRANS_OFFSET(logicalSliceAddr)]                    = virtualSliceAddr;
+        MAP_CACHE_ENTRY(TRANS_DIR_ENTRY(transPage)->cacheEntry)->dirty = 1;
+    }
+}
+
+/**
+ * @brief Copy all the translation pages to the checkpoint slot being written.
+ *
+ * Translation page `i` is programmed to the page `i` of the slot, from the cache if cached,
+ * otherwise read from the previous slot or the swap area first. Afterward all the pages are
+ * found in the new slot, and the swap area is erased.
+ *
+ * @param slotPblkIdx the first reserved block of the new checkpoint slot, already erased.
+ */
+void SaveAddrMapCachePages(unsigned int slotPblkIdx)
+{
+    unsigned int roundPage, transPage, bufAddr;
+    P_ADDR_MAP_DIR_ENTRY dirEntry;
+
+    for (roundPage = 0; roundPage < ADDR_MAP_TRANS_PAGES; roundPage += USER_DIES)
+    {
+        for (transPage = roundPage; transPage < roundPage + USER_DIES && transPage < ADDR_MAP_TRANS_PAGES; transPage++)
+        {
+            dirEntry = TRANS_DIR_ENTRY(transPage);
+            bufAddr  = ADDR_MAP_CHECKPOINT_BUF(transPage % USER_DIES);
+
+            if (dirEntry->cacheEntry != ADDR_MAP_CACHE_ENTRY_NONE)
+            {
+                memcpy((void *)bufAddr, (void *)MAP_CACHE_FRAME(dirEntry->cacheEntry), BYTES_PER_DATA_REGION_OF_PAGE);
+                MAP_CACHE_ENTRY(dirEntry->cacheEntry)->dirty = 0;
+            }
+            else if (dirEntry->location == ADDR_MAP_TRANS_UNMAPPED)
+                memset((void *)bufAddr, 0xff, BYTES_PER_DATA_REGION_OF_PAGE);
+            else if (dirEntry->location == ADDR_MAP_TRANS_IN_SLOT)
+                IssueAddrMapPageReq(REQ_CODE_READ, addrMapCache.slotPblkIdx, dirEntry->flashPage, bufAddr);
+            else
+                IssueAddrMapPageReq(REQ_CODE_READ, ADDR_MAP_SWAP_PBLK_IDX, dirEntry->flashPage, bufAddr);
+        }
+        SyncAllLowLevelReqDone();
+
+        for (transPage = roundPage; transPage < roundPage + USER_DIES && transPage < ADDR_MAP_TRANS_PAGES; transPage++)
+            IssueAddrMapPageReq(REQ_CODE_WRITE, slotPblkIdx, transPage, ADDR_MAP_CHECKPOINT_BUF(transPage % USER_DIES));
+        SyncAllLowLevelReqDone();
+    }
+
+    // an unmapped page never written is still cheaper to rebuild than to read
+    for (transPage = 0; transPage < ADDR_MAP_TRANS_PAGES; transPage++)
+        if (TRANS_DIR_ENTRY(transPage)->location != ADDR_MAP_TRANS_UNMAPPED ||
+            TRANS_DIR_ENTRY(transPage)->cacheEntry != ADDR_MAP_CACHE_ENTRY_NONE)
+        {
+            TRANS_DIR_ENTRY(transPage)->location  = ADDR_MAP_TRANS_IN_SLOT;
+            TRANS_DIR_ENTRY(transPage)->flashPage = transPage;
+        }
+    addrMapCache.slotPblkIdx = slotPblkIdx;
+
+    EraseAddrMapSwap();
+}
+
+#endif /* ADDR_MAP_MODE */
@@ -0,0 +1,179 @@
+//////////////////////////////////////////////////////////////////////////////////
+// address_map_cache.h for Cosmos+ OpenSSD
+// Copyright (c) 2017 Hanyang University ENC Lab.
+// Contributed by Yong Ho Song <yhsong@enc.hanyang.ac.kr>
+//				  Jaewook Kwak <jwkwak@enc.hanyang.ac.kr>
+//
+// This file is part of Cosmos+ OpenSSD.
+//
+// Cosmos+ OpenSSD is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3, or (at your option)
+// any later version.
+//
+// Cosmos+ OpenSSD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Cosmos+ OpenSSD; see the file COPYING.
+// If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Company: ENC Lab. <http://enc.hanyang.ac.kr>
+// Engineer: Jaewook Kwak <jwkwak@enc.hanyang.ac.kr>
+//
+// Project Name: Cosmos+ OpenSSD
+// Design Name: Cosmos+ Firmware
+// Module Name: Address Map Cache
+// File Name: address_map_cache.h
+//
+// Version: v1.0.0
+//
+// Description:
+//   - select whether the logical slice map is resident in DRAM or demand paged
+//   - data structures of the translation page cache and the translation directory
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Revision History:
+//
+// * v1.0.0
+//   - First draft
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef ADDRESS_MAP_CACHE_H_
+#define ADDRESS_MAP_CACHE_H_
+
+#include "ftl_config.h"
+
+/**
+ * The logical slice map (L2P) is either fully resident in DRAM, or demand paged (DFTL):
+ * split into translation pages kept in flash, with only a few of them cached in DRAM.
+ * Set `ADDR_MAP_MODE` to one of the following values (default resident).
+ *
+ * - `ADDR_MAP_MODE_RESIDENT`: the whole map is kept at `LOGICAL_SLICE_MAP_ADDR`.
+ * - `ADDR_MAP_MODE_DEMAND`: `addrMapCacheEntryCount` translation pages are cached at
+ *   `ADDR_MAP_CACHE_BUFFER_ADDR`, and the others are found through the global translation
+ *   directory, check `address_map_cache.c`.
+ *
+ * Translation page `i` holds the entries of the logical slices `[i * 4096, (i + 1) * 4096)`,
+ * exactly the page `i` of the logical slice map saved in a checkpoint, so both modes share
+ * the same checkpoint layout.
+ */
+#define ADDR_MAP_MODE_RESIDENT 0
+#define ADDR_MAP_MODE_DEMAND   1
+
+#ifndef ADDR_MAP_MODE
+#define ADDR_MAP_MODE ADDR_MAP_MODE_RESIDENT
+#endif
+
+#define ADDR_MAP_ENTRIES_PER_TRANS_PAGE (BYTES_PER_DATA_REGION_OF_PAGE / sizeof(unsigned int))
+#define ADDR_MAP_TRANS_PAGES            (SLICES_PER_SSD / ADDR_MAP_ENTRIES_PER_TRANS_PAGE)
+
+#define LSA2TRANS_PAGE(lsa)   ((lsa) / ADDR_MAP_ENTRIES_PER_TRANS_PAGE)
+#define LSA2TRANS_OFFSET(lsa) ((lsa) % ADDR_MAP_ENTRIES_PER_TRANS_PAGE)
+
+/**
+ * The number of cached translation pages (`addrMapCacheEntryCount`) is set at boot, the
+ * buffer is allocated for `ADDR_MAP_CACHE_MAX_ENTRY_COUNT` pages.
+ */
+#define ADDR_MAP_CACHE_MAX_ENTRY_COUNT 1024 // 16 MB, an eighth of the resident map
+#define ADDR_MAP_CACHE_MIN_ENTRY_COUNT 16
+
+#ifndef ADDR_MAP_CACHE_DEFAULT_ENTRY_COUNT
+#define ADDR_MAP_CACHE_DEFAULT_ENTRY_COUNT 256
+#endif
+
+/**
+ * When a dirty page is to be evicted, up to `ADDR_MAP_CACHE_WRITE_BACK_BATCH` dirty pages
+ * near the LRU end are written back together, one per die, and stay cached as clean.
+ */
+#define ADDR_MAP_CACHE_WRITE_BACK_BATCH USER_DIES
+
+/**
+ * The translation pages written back since the latest checkpoint are appended to the swap
+ * area, `ADDR_MAP_SWAP_PBLK_PER_DIE` blocks on each die reserved with the checkpoint slots.
+ * Its pages are striped over the dies, and each row of blocks is a segment, cleaned and
+ * erased as a whole when the area wraps around. The swap area is not needed to recover the
+ * maps (the journal is), so it is erased after each checkpoint and at boot.
+ */
+#if (ADDR_MAP_MODE == ADDR_MAP_MODE_DEMAND)
+#define ADDR_MAP_SWAP_PBLK_PER_DIE 4
+#else
+#define ADDR_MAP_SWAP_PBLK_PER_DIE 0
+#endif
+#define ADDR_MAP_SWAP_SEGMENT_PAGES (USER_DIES * USER_PAGES_PER_BLOCK)
+#define ADDR_MAP_SWAP_PAGES         (ADDR_MAP_SWAP_PBLK_PER_DIE * ADDR_MAP_SWAP_SEGMENT_PAGES)
+
+#define ADDR_MAP_TRANS_PAGE_NONE   0xffff
+#define ADDR_MAP_CACHE_ENTRY_NONE  0xffff
+#define ADDR_MAP_TRANS_UNMAPPED    0 // never written, all the entries are `VSA_NONE`
+#define ADDR_MAP_TRANS_IN_SLOT     1 // the page of the latest checkpoint slot
+#define ADDR_MAP_TRANS_IN_SWAP     2 // a page of the swap area
+
+/**
+ * @brief The location of a translation page.
+ */
+typedef struct _ADDR_MAP_DIR_ENTRY
+{
+    unsigned int flashPage : 24; // page index in the checkpoint slot or the swap area
+    unsigned int location : 2;   // `ADDR_MAP_TRANS_UNMAPPED`, `_IN_SLOT` or `_IN_SWAP`
+    unsigned int reserved0 : 6;
+    unsigned int cacheEntry : 16; // the cache entry holding this page, or `ADDR_MAP_CACHE_ENTRY_NONE`
+    unsigned int reserved1 : 16;
+} ADDR_MAP_DIR_ENTRY, *P_ADDR_MAP_DIR_ENTRY;
+
+/**
+ * @brief The global translation directory (GTD).
+ */
+typedef struct _ADDR_MAP_DIR
+{
+    ADDR_MAP_DIR_ENTRY transPage[ADDR_MAP_TRANS_PAGES];
+} ADDR_MAP_DIR, *P_ADDR_MAP_DIR;
+
+typedef struct _ADDR_MAP_CACHE_ENTRY
+{
+    unsigned int transPage : 16; // the cached translation page, or `ADDR_MAP_TRANS_PAGE_NONE`
+    unsigned int dirty : 1;      // modified after being read or written back
+    unsigned int reserved0 : 15;
+    unsigned int prevEntry : 16;
+    unsigned int nextEntry : 16;
+} ADDR_MAP_CACHE_ENTRY, *P_ADDR_MAP_CACHE_ENTRY;
+
+/**
+ * @brief The metadata of the cached translation pages and the swap area.
+ *
+ * The entries are kept in an LRU list, the most recently used one at the head. The owner
+ * of each swap page is recorded to find the live pages of a segment to be cleaned.
+ */
+typedef struct _ADDR_MAP_CACHE_MAP
+{
+    ADDR_MAP_CACHE_ENTRY cacheEntry[ADDR_MAP_CACHE_MAX_ENTRY_COUNT];
+    unsigned short swapTransPage[ADDR_MAP_SWAP_PAGES];
+} ADDR_MAP_CACHE_MAP, *P_ADDR_MAP_CACHE_MAP;
+
+typedef struct _ADDR_MAP_CACHE_STATE
+{
+    unsigned int headEntry;   // the most recently used entry
+    unsigned int tailEntry;   // the least recently used entry
+    unsigned int slotPblkIdx; // the first reserved block of the latest checkpoint slot
+    unsigned int swapHead;    // the next swap page to be written
+    unsigned int hitCnt;
+    unsigned int missCnt;
+    unsigned int writeBackCnt; // translation pages written back on eviction
+    unsigned int relocateCnt;  // translation pages moved by the swap area cleaning
+} ADDR_MAP_CACHE_STATE, *P_ADDR_MAP_CACHE_STATE;
+
+void InitAddrMapCache();
+void ResetAddrMapCache(unsigned int location, unsigned int slotPblkIdx);
+unsigned int GetAddrMapEntry(unsigned int logicalSliceAddr);
+void SetAddrMapEntry(unsigned int logicalSliceAddr, unsigned int virtualSliceAddr);
+void SaveAddrMapCachePages(unsigned int slotPblkIdx);
+
+extern unsigned int addrMapCacheEntryCount;
+extern ADDR_MAP_CACHE_STATE addrMapCache;
+
+#endif /* ADDRESS_MAP_CACHE_H_ */
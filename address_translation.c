@@ -46,8 +46,13 @@
 //////////////////////////////////////////////////////////////////////////////////
 
 #include <assert.h>
+#include <string.h>
 #include "debug.h"
+#ifdef NSC_SIMULATOR
+#include "sim/xil_printf.h"
+#else
 #include "xil_printf.h"
+#endif
 
 #include "memory_map.h"
 #include "address_translation.h"
@@ -56,6 +61,7 @@
 P_LOGICAL_SLICE_MAP logicalSliceMapPtr;
 P_VIRTUAL_SLICE_MAP virtualSliceMapPtr;
 P_VIRTUAL_BLOCK_MAP virtualBlockMapPtr;
+P_VALID_SLICE_BITMAP validSliceBitmapPtr;
 P_VIRTUAL_DIE_MAP virtualDieMapPtr;
 P_PHY_BLOCK_MAP phyBlockMapPtr;
 P_BAD_BLOCK_TABLE_INFO_MAP bbtInfoMapPtr;
@@ -66,6 +72,13 @@ unsigned int mbPerbadBlockSpace;
 static unsigned char targetCh  = 0;
 static unsigned char targetWay = 0;
 unsigned char sliceAllocationTargetDie; // the destination die of next slice command
+unsigned int dieSelectionSkipCnt;       // host writes not sent to the round robin die for its load
+
+#if (DIE_SELECTION_POLICY == DIE_SELECTION_LOAD_AWARE)
+// host slices given to each die beyond the least written die, check `FindLeastLoadedDie()`
+static unsigned short dieAllocLead[USER_DIES];
+static unsigned int zeroLeadDieCnt = USER_DIES;
+#endif
 
 extern bool nmcInterleaving;
 extern uint32_t nmcPagesUsed;
@@ -79,11 +92,12 @@ extern uint32_t nmcPagesUsed;
  * - Read/Remake the bad block table of each die
  * - Replace bad blocks with the reserved blocks in the same die
  * - Initialize V2P table and free block list
- * - Choose a free block as the current working block for each die
+ * - Reset the current working blocks of each die, which are opened on their first write
  *
  * This function, only initialize the base addresses of these maps, the physical block map
- * and some bad blocks info. The other maps will be initialized in `InitBlockDieMap()` and
- * `InitSliceMap()`, check the two functions for further initialization.
+ * and some bad blocks info. The other maps will be initialized in `InitBlockDieMap()`, and
+ * the slice maps are recovered (or initialized by `InitSliceMap()`) in `RecoverAddrMap()`
+ * after the GC victim lists are built, check these functions for further initialization.
  *
  * @todo To initialize the physical block map,
  *
@@ -92,45 +106,59 @@ void InitAddressMap()
 {
     unsigned int blockNo, dieNo;
 
+#if (ADDR_MAP_MODE == ADDR_MAP_MODE_DEMAND)
+    InitAddrMapCache();
+#else
     logicalSliceMapPtr = (P_LOGICAL_SLICE_MAP)LOGICAL_SLICE_MAP_ADDR;
-    virtualSliceMapPtr = (P_VIRTUAL_SLICE_MAP)VIRTUAL_SLICE_MAP_ADDR;
-    virtualBlockMapPtr = (P_VIRTUAL_BLOCK_MAP)VIRTUAL_BLOCK_MAP_ADDR;
-    virtualDieMapPtr   = (P_VIRTUAL_DIE_MAP)VIRTUAL_DIE_MAP_ADDR;
-    phyBlockMapPtr     = (P_PHY_BLOCK_MAP)PHY_BLOCK_MAP_ADDR;
-    bbtInfoMapPtr      = (P_BAD_BLOCK_TABLE_INFO_MAP)BAD_BLOCK_TABLE_INFO_MAP_ADDR;
-    channelInfo        = (P_CH_INFO)CH_INFO_BUFFER_ADDR;
+#endif
+    virtualSliceMapPtr  = (P_VIRTUAL_SLICE_MAP)VIRTUAL_SLICE_MAP_ADDR;
+    virtualBlockMapPtr  = (P_VIRTUAL_BLOCK_MAP)VIRTUAL_BLOCK_MAP_ADDR;
+    validSliceBitmapPtr = (P_VALID_SLICE_BITMAP)VALID_SLICE_BITMAP_ADDR;
+    virtualDieMapPtr    = (P_VIRTUAL_DIE_MAP)VIRTUAL_DIE_MAP_ADDR;
+    phyBlockMapPtr      = (P_PHY_BLOCK_MAP)PHY_BLOCK_MAP_ADDR;
+    bbtInfoMapPtr       = (P_BAD_BLOCK_TABLE_INFO_MAP)BAD_BLOCK_TABLE_INFO_MAP_ADDR;
+    channelInfo         = (P_CH_INFO)CH_INFO_BUFFER_ADDR;
 
     // reset physical block mapping and bad block info
     for (dieNo = 0; dieNo < USER_DIES; dieNo++)
     {
         // the blocks should not be remapped to any other blocks before remmaping
         for (blockNo = 0; blockNo < TOTAL_BLOCKS_PER_DIE; blockNo++)
+        {
             phyBlockMapPtr->phyBlock[dieNo][blockNo].remappedPhyBlock = blockNo;
+            phyBlockMapPtr->phyBlock[dieNo][blockNo].bad              = BLOCK_STATE_NORMAL;
+        }
 
         bbtInfoMapPtr->bbtInfo[dieNo].phyBlock       = 0;
         bbtInfoMapPtr->bbtInfo[dieNo].grownBadUpdate = BBT_INFO_GROWN_BAD_UPDATE_NONE;
     }
 
     // by default, the request start from the first die
-    sliceAllocationTargetDie = FindDieForFreeSliceAllocation();
+    ResetTargetDie();
 
-    InitSliceMap();
     InitBlockDieMap();
 }
 
 /**
  * @brief Initialize Logical and Virtual Slick Map.
  *
- * This function simply initialize all the slice addresses in the both map to NONE.
+ * This function simply initialize all the slice addresses in the both map to NONE and
+ * clears the valid slice bitmap. In demand paged mode, all the translation pages are marked
+ * unmapped instead.
  */
 void InitSliceMap()
 {
     int sliceAddr;
+
+#if (ADDR_MAP_MODE == ADDR_MAP_MODE_DEMAND)
+    ResetAddrMapCache(ADDR_MAP_TRANS_UNMAPPED, 0);
+#else
     for (sliceAddr = 0; sliceAddr < SLICES_PER_SSD; sliceAddr++)
-    {
         logicalSliceMapPtr->logicalSlice[sliceAddr].virtualSliceAddr = VSA_NONE;
+#endif
+    for (sliceAddr = 0; sliceAddr < SLICES_PER_SSD; sliceAddr++)
         virtualSliceMapPtr->virtualSlice[sliceAddr].logicalSliceAddr = LSA_NONE;
-    }
+    memset(validSliceBitmapPtr, 0, sizeof(VALID_SLICE_BITMAP));
 }
 
 /**
@@ -325,8 +353,12 @@ void InitBlockMap()
 
             virtualBlockMapPtr->block[dieNo][virtualBlockNo].free            = 1;
             virtualBlockMapPtr->block[dieNo][virtualBlockNo].invalidSliceCnt = 0;
+            virtualBlockMapPtr->block[dieNo][virtualBlockNo].deallocating    = 0;
+            virtualBlockMapPtr->block[dieNo][virtualBlockNo].pendingFree     = 0;
+            virtualBlockMapPtr->block[dieNo][virtualBlockNo].collecting      = 0;
             virtualBlockMapPtr->block[dieNo][virtualBlockNo].currentPage     = 0;
             virtualBlockMapPtr->block[dieNo][virtualBlockNo].eraseCnt        = 0;
+            virtualBlockMapPtr->block[dieNo][virtualBlockNo].modifiedSeq     = 0;
 
             // bad block should not be added to free block list
             if (virtualBlockMapPtr->block[dieNo][virtualBlockNo].bad)
@@ -349,25 +381,18 @@ void InitBlockMap()
 }
 
 /**
- * @brief Get a default free block for each die.
+ * @brief Reset the current block of each write stream on each die.
+ *
+ * No block is taken here, a stream takes its first block on its first write, check
+ * `FindFreeVirtualSlice()`.
  */
 void InitCurrentBlockOfDieMap()
 {
-    unsigned int dieNo, chNo, wayNo;
+    unsigned int dieNo, stream;
 
     for (dieNo = 0; dieNo < USER_DIES; dieNo++)
-    {
-        virtualDieMapPtr->die[dieNo].currentBlock = GetFromFbList(dieNo, GET_FREE_BLOCK_NORMAL);
-        if (virtualDieMapPtr->die[dieNo].currentBlock == BLOCK_FAIL)
-        {
-            assert(!"[WARNING] There is no free block [WARNING]");
-            chNo  = Vdie2PchTranslation(dieNo);
-            wayNo = Vdie2PwayTranslation(dieNo);
-            xil_printf("[WARNING] There is no free block on Ch %d Way %d (Die %d)!\r\n", chNo, wayNo, dieNo);
-        }
-
-        pr_info("Allocate VBlk %u for Die[%u]", VDIE_ENTRY(dieNo)->currentBlock, dieNo);
-    }
+        for (stream = 0; stream < WRITE_STREAM_COUNT; stream++)
+            VDIE_ENTRY(dieNo)->currentBlock[stream] = BLOCK_NONE;
 }
 
 /**
@@ -428,6 +453,70 @@ void ReadBadBlockTable(unsigned int tempBbtBufAddr[], unsigned int tempBbtBufEnt
     SyncAllLowLevelReqDone();
 }
 
+/**
+ * The bad block marks of each die are scanned in batches of `BAD_BLOCK_SCAN_BATCH_BLOCKS`
+ * blocks, and the two marked rows of each block are read into their own buffer. The data
+ * buffer is not used until the address map is initialized, so the batches are put there.
+ */
+#define BAD_BLOCK_SCAN_BATCH_BLOCKS 4
+#define BAD_BLOCK_SCAN_BUF_ADDR(dieNo, iBlock, iMark)                                                             \
+    (DATA_BUFFER_BASE_ADDR +                                                                                      \
+     ((((dieNo) * BAD_BLOCK_SCAN_BATCH_BLOCKS + (iBlock)) * 2 + (iMark)) * BYTES_PER_NAND_ROW))
+#define BAD_BLOCK_SCAN_BATCH_SIZE(startBlockNo)                                                                   \
+    ((TOTAL_BLOCKS_PER_DIE - (startBlockNo) < BAD_BLOCK_SCAN_BATCH_BLOCKS) ? TOTAL_BLOCKS_PER_DIE - (startBlockNo) \
+                                                                           : BAD_BLOCK_SCAN_BATCH_BLOCKS)
+
+/**
+ * @brief Check whether all the requests issued to the given die are done.
+ *
+ * @note Unlike `GetDieLoad()`, this doesn't touch the temp data buffers, which are not
+ * initialized before the address map.
+ */
+static unsigned int IsDieReqDone(unsigned int dieNo)
+{
+    unsigned int chNo  = Vdie2PchTranslation(dieNo);
+    unsigned int wayNo = Vdie2PwayTranslation(dieNo);
+
+    return !nandReqQ[chNo][wayNo].reqCnt && !blockedByRowAddrDepReqQ[chNo][wayNo].reqCnt &&
+           (dieStateTablePtr->dieState[chNo][wayNo].dieState != DIE_STATE_EXE);
+}
+
+/**
+ * @brief Issue the raw reads of the bad block marks of a batch of blocks on the given die.
+ *
+ * @param dieNo the die to be scanned.
+ * @param startBlockNo the first physical block of the batch.
+ */
+static void ReadBadBlockMarks(unsigned int dieNo, unsigned int startBlockNo)
+{
+    unsigned int iBlock, iMark, reqSlotTag;
+
+    for (iBlock = 0; iBlock < BAD_BLOCK_SCAN_BATCH_SIZE(startBlockNo); iBlock++)
+        for (iMark = 0; iMark < 2; iMark++)
+        {
+            reqSlotTag = GetFromFreeReqQ();
+
+            reqPoolPtr->reqPool[reqSlotTag].reqType                       = REQ_TYPE_NAND;
+            reqPoolPtr->reqPool[reqSlotTag].reqCode                       = REQ_CODE_READ;
+            reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat          = REQ_OPT_DATA_BUF_ADDR;
+            reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandAddr               = REQ_OPT_NAND_ADDR_PHY_ORG;
+            reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandEcc                = REQ_OPT_NAND_ECC_OFF;
+            reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandEccWarning         = REQ_OPT_NAND_ECC_WARNING_OFF;
+            reqPoolPtr->reqPool[reqSlotTag].reqOpt.rowAddrDependencyCheck = REQ_OPT_ROW_ADDR_DEPENDENCY_NONE;
+            reqPoolPtr->reqPool[reqSlotTag].reqOpt.blockSpace             = REQ_OPT_BLOCK_SPACE_TOTAL;
+
+            reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.addr = BAD_BLOCK_SCAN_BUF_ADDR(dieNo, iBlock, iMark);
+
+            reqPoolPtr->reqPool[reqSlotTag].nandInfo.physicalCh    = Vdie2PchTranslation(dieNo);
+            reqPoolPtr->reqPool[reqSlotTag].nandInfo.physicalWay   = Vdie2PwayTranslation(dieNo);
+            reqPoolPtr->reqPool[reqSlotTag].nandInfo.physicalBlock = startBlockNo + iBlock;
+            reqPoolPtr->reqPool[reqSlotTag].nandInfo.physicalPage  = iMark ? BAD_BLOCK_MARK_PAGE1
+                                                                           : BAD_BLOCK_MARK_PAGE0;
+
+            SelectLowLevelReqQ(reqSlotTag);
+        }
+}
+
 /**
  * @brief Build the bbt for those dies whose bbt doesn't exist.
  *
@@ -440,131 +529,74 @@ void ReadBadBlockTable(unsigned int tempBbtBufAddr[], unsigned int tempBbtBufEnt
  *
  * If only of the 4 bytes are not 0xFF, we can view this block as bad block.
  *
- * @todo why check these 4 bytes, why ECC and row addr dep off?
- * @todo the update in the second for is redundant, it can be merged to next part
- *
- * @warning `tempBbtBufEntrySize` and `tempReadBufEntrySize` not used
+ * Each die is scanned on its own: both marked rows of a batch of blocks are read at once,
+ * and the next batch is issued as soon as the die finished the previous one, instead of
+ * waiting for all the dies after each row. So the ways keep reading their arrays while the
+ * other ways of the same channel are transferring, and the scan is bound by the channels.
  *
- * @bug `blockChecker` not initialized
+ * @todo why check these 4 bytes, why ECC and row addr dep off?
  *
  * @param dieState the flags that indicate whether the bbt of that die should be rebuilt.
  * @param tempBbtBufAddr the addresses of the bbt of each die.
- * @param tempBbtBufEntrySize the size of the data and metadata region of a page.
- * @param tempReadBufAddr the buffer addresses for storing the pages to be read.
- * @param tempReadBufEntrySize the size of a whole page (data + metadata + ECC).
  */
-void FindBadBlock(unsigned char dieState[], unsigned int tempBbtBufAddr[], unsigned int tempBbtBufEntrySize,
-                  unsigned int tempReadBufAddr[], unsigned int tempReadBufEntrySize)
+void FindBadBlock(unsigned char dieState[], unsigned int tempBbtBufAddr[])
 {
-    unsigned int phyBlockNo, chNo, wayNo, dieNo, reqSlotTag;
-    unsigned char blockChecker[USER_DIES];
-    unsigned char *markPointer0;
-    unsigned char *markPointer1;
-    unsigned char *bbtUpdater;
+    unsigned int dieNo, iBlock, phyBlockNo, blockCnt, scanDieCnt;
+    unsigned int nextBlockNo[USER_DIES]; // the first block of the batch being read on each die
+    unsigned char blockChecker, *markPointer0, *markPointer1;
 
-    /**
-     * Check all the blocks on the SSD
-     *
-     * @note Check multiple dies at the same time to speed up and reduce the buffer size.
-     */
-    for (phyBlockNo = 0; phyBlockNo < TOTAL_BLOCKS_PER_DIE; phyBlockNo++)
-    {
-        // Read the first page of the specified block of each die
-        for (dieNo = 0; dieNo < USER_DIES; dieNo++)
-            if (!dieState[dieNo])
-            {
-                blockChecker[dieNo] = BLOCK_STATE_NORMAL;
+    ASSERT(BAD_BLOCK_SCAN_BUF_ADDR(USER_DIES, 0, 0) <= TEMPORARY_DATA_BUFFER_BASE_ADDR,
+           "the data buffer is too small for scanning bad blocks");
 
-                reqSlotTag = GetFromFreeReqQ();
-
-                reqPoolPtr->reqPool[reqSlotTag].reqType                       = REQ_TYPE_NAND;
-                reqPoolPtr->reqPool[reqSlotTag].reqCode                       = REQ_CODE_READ;
-                reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat          = REQ_OPT_DATA_BUF_ADDR;
-                reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandAddr               = REQ_OPT_NAND_ADDR_PHY_ORG;
-                reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandEcc                = REQ_OPT_NAND_ECC_OFF;
-                reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandEccWarning         = REQ_OPT_NAND_ECC_WARNING_OFF;
-                reqPoolPtr->reqPool[reqSlotTag].reqOpt.rowAddrDependencyCheck = REQ_OPT_ROW_ADDR_DEPENDENCY_NONE;
-                reqPoolPtr->reqPool[reqSlotTag].reqOpt.blockSpace             = REQ_OPT_BLOCK_SPACE_TOTAL;
-
-                reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.addr = tempReadBufAddr[dieNo];
-
-                reqPoolPtr->reqPool[reqSlotTag].nandInfo.physicalCh    = Vdie2PchTranslation(dieNo);
-                reqPoolPtr->reqPool[reqSlotTag].nandInfo.physicalWay   = Vdie2PwayTranslation(dieNo);
-                reqPoolPtr->reqPool[reqSlotTag].nandInfo.physicalBlock = phyBlockNo;
-                reqPoolPtr->reqPool[reqSlotTag].nandInfo.physicalPage  = BAD_BLOCK_MARK_PAGE0;
+    scanDieCnt = 0;
+    for (dieNo = 0; dieNo < USER_DIES; dieNo++)
+    {
+        nextBlockNo[dieNo] = 0;
+        if (!dieState[dieNo])
+        {
+            ReadBadBlockMarks(dieNo, 0);
+            scanDieCnt++;
+        }
+    }
 
-                SelectLowLevelReqQ(reqSlotTag);
-            }
-        SyncAllLowLevelReqDone();
+    while (scanDieCnt)
+    {
+        SchedulingNandReq();
 
-        // Read the last page of the specified block of each die if needed
         for (dieNo = 0; dieNo < USER_DIES; dieNo++)
         {
-            chNo  = Vdie2PchTranslation(dieNo);
-            wayNo = Vdie2PwayTranslation(dieNo);
+            if (dieState[dieNo] || (nextBlockNo[dieNo] >= TOTAL_BLOCKS_PER_DIE) || !IsDieReqDone(dieNo))
+                continue;
 
-            if (!dieState[dieNo])
+            // determine whether the blocks of the finished batch are bad blocks and update the bbt
+            blockCnt = BAD_BLOCK_SCAN_BATCH_SIZE(nextBlockNo[dieNo]);
+            for (iBlock = 0; iBlock < blockCnt; iBlock++)
             {
-                markPointer0 = (unsigned char *)(tempReadBufAddr[dieNo] + BAD_BLOCK_MARK_BYTE0);
-                markPointer1 = (unsigned char *)(tempReadBufAddr[dieNo] + BAD_BLOCK_MARK_BYTE1);
-
-                if ((*markPointer0 == CLEAN_DATA_IN_BYTE) && (*markPointer1 == CLEAN_DATA_IN_BYTE))
+                phyBlockNo   = nextBlockNo[dieNo] + iBlock;
+                markPointer0 = (unsigned char *)(BAD_BLOCK_SCAN_BUF_ADDR(dieNo, iBlock, 0));
+                markPointer1 = (unsigned char *)(BAD_BLOCK_SCAN_BUF_ADDR(dieNo, iBlock, 1));
+
+                // the blocks failed to be erased by `EraseTotalBlockSpace()` are bad already
+                blockChecker = phyBlockMapPtr->phyBlock[dieNo][phyBlockNo].bad;
+                if ((markPointer0[BAD_BLOCK_MARK_BYTE0] != CLEAN_DATA_IN_BYTE) ||
+                    (markPointer0[BAD_BLOCK_MARK_BYTE1] != CLEAN_DATA_IN_BYTE) ||
+                    (markPointer1[BAD_BLOCK_MARK_BYTE0] != CLEAN_DATA_IN_BYTE) ||
+                    (markPointer1[BAD_BLOCK_MARK_BYTE1] != CLEAN_DATA_IN_BYTE))
                 {
-                    reqSlotTag = GetFromFreeReqQ();
-
-                    reqPoolPtr->reqPool[reqSlotTag].reqType               = REQ_TYPE_NAND;
-                    reqPoolPtr->reqPool[reqSlotTag].reqCode               = REQ_CODE_READ;
-                    reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat  = REQ_OPT_DATA_BUF_ADDR;
-                    reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandAddr       = REQ_OPT_NAND_ADDR_PHY_ORG;
-                    reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandEcc        = REQ_OPT_NAND_ECC_OFF;
-                    reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandEccWarning = REQ_OPT_NAND_ECC_WARNING_OFF;
-                    reqPoolPtr->reqPool[reqSlotTag].reqOpt.rowAddrDependencyCheck = REQ_OPT_ROW_ADDR_DEPENDENCY_NONE;
-                    reqPoolPtr->reqPool[reqSlotTag].reqOpt.blockSpace = REQ_OPT_BLOCK_SPACE_TOTAL;
-
-                    reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.addr = tempReadBufAddr[dieNo];
-
-                    reqPoolPtr->reqPool[reqSlotTag].nandInfo.physicalCh    = chNo;
-                    reqPoolPtr->reqPool[reqSlotTag].nandInfo.physicalWay   = wayNo;
-                    reqPoolPtr->reqPool[reqSlotTag].nandInfo.physicalBlock = phyBlockNo;
-                    reqPoolPtr->reqPool[reqSlotTag].nandInfo.physicalPage  = BAD_BLOCK_MARK_PAGE1;
-
-                    SelectLowLevelReqQ(reqSlotTag);
+                    pr_info("C/W[%u/%u]: bad block at PBlk %u (0x%x)", Vdie2PchTranslation(dieNo),
+                            Vdie2PwayTranslation(dieNo), phyBlockNo, phyBlockNo);
+                    blockChecker = BLOCK_STATE_BAD;
                 }
-                else
-                {
-                    pr_info("C/W[%u/%u]: bad block at PBlk %u (0x%x)", chNo, wayNo, phyBlockNo, phyBlockNo);
 
-                    blockChecker[dieNo] = BLOCK_STATE_BAD;
-                }
+                *(unsigned char *)(tempBbtBufAddr[dieNo] + phyBlockNo) = blockChecker;
+                phyBlockMapPtr->phyBlock[dieNo][phyBlockNo].bad        = blockChecker;
             }
-        }
-
-        SyncAllLowLevelReqDone();
-
-        // determine whether these blocks are bad blocks and update the bbt
-        for (dieNo = 0; dieNo < USER_DIES; dieNo++)
-        {
-            chNo  = Vdie2PchTranslation(dieNo);
-            wayNo = Vdie2PwayTranslation(dieNo);
-
-            if (!dieState[dieNo])
-            {
-                markPointer0 = (unsigned char *)(tempReadBufAddr[dieNo] + BAD_BLOCK_MARK_BYTE0);
-                markPointer1 = (unsigned char *)(tempReadBufAddr[dieNo] + BAD_BLOCK_MARK_BYTE1);
-
-                if (!((*markPointer0 == CLEAN_DATA_IN_BYTE) && (*markPointer1 == CLEAN_DATA_IN_BYTE)))
-                    if (blockChecker[dieNo] == BLOCK_STATE_NORMAL)
-                    {
-
-                        pr_info("C/W[%u/%u]: bad block at PBlk %u (0x%x)", chNo, wayNo, phyBlockNo, phyBlockNo);
-                        blockChecker[dieNo] = BLOCK_STATE_BAD;
-                    }
 
-                // update the bbt this block
-                bbtUpdater  = (unsigned char *)(tempBbtBufAddr[dieNo] + phyBlockNo);
-                *bbtUpdater = blockChecker[dieNo];
-                phyBlockMapPtr->phyBlock[dieNo][phyBlockNo].bad = blockChecker[dieNo];
-            }
+            nextBlockNo[dieNo] += blockCnt;
+            if (nextBlockNo[dieNo] < TOTAL_BLOCKS_PER_DIE)
+                ReadBadBlockMarks(dieNo, nextBlockNo[dieNo]);
+            else
+                scanDieCnt--;
         }
     }
 }
@@ -686,24 +718,17 @@ void SaveBadBlockTable(unsigned char dieState[], unsigned int tempBbtBufAddr[],
 void RecoverBadBlockTable(unsigned int tempBufAddr)
 {
     unsigned int chNo, wayNo, dieNo, phyBlockNo;
-    unsigned int bbtMaker, tempBbtBufBaseAddr, tempBbtBufEntrySize, tempReadBufBaseAddr, tempReadBufEntrySize;
-    unsigned int tempBbtBufAddr[USER_DIES];  // buffer addresses for storing the bbt pages
-    unsigned int tempReadBufAddr[USER_DIES]; // buffer addresses for finding bad blocks
-    unsigned char dieState[USER_DIES];       // whether the bbt of this die should be rebuilt
+    unsigned int bbtMaker, tempBbtBufBaseAddr, tempBbtBufEntrySize;
+    unsigned int tempBbtBufAddr[USER_DIES]; // buffer addresses for storing the bbt pages
+    unsigned char dieState[USER_DIES];      // whether the bbt of this die should be rebuilt
     unsigned char *bbtTableChecker;
 
     // data buffer allocation
     tempBbtBufBaseAddr  = tempBufAddr;
     tempBbtBufEntrySize = BYTES_PER_DATA_REGION_OF_PAGE + BYTES_PER_SPARE_REGION_OF_PAGE;
-    tempReadBufBaseAddr =
-        tempBbtBufBaseAddr + USER_DIES * USED_PAGES_FOR_BAD_BLOCK_TABLE_PER_DIE * tempBbtBufEntrySize;
-    tempReadBufEntrySize = BYTES_PER_NAND_ROW;
     for (dieNo = 0; dieNo < USER_DIES; dieNo++)
-    {
         tempBbtBufAddr[dieNo] =
             tempBbtBufBaseAddr + dieNo * USED_PAGES_FOR_BAD_BLOCK_TABLE_PER_DIE * tempBbtBufEntrySize;
-        tempReadBufAddr[dieNo] = tempReadBufBaseAddr + dieNo * tempReadBufEntrySize;
-    }
 
     // read the bbt of each die into bbt buffer
     ReadBadBlockTable(tempBbtBufAddr, tempBbtBufEntrySize);
@@ -751,7 +776,7 @@ void RecoverBadBlockTable(unsigned int tempBufAddr)
     // Create bbt for those dies whose bbt not found.
     if (bbtMaker == BAD_BLOCK_TABLE_MAKER_TRIGGER)
     {
-        FindBadBlock(dieState, tempBbtBufAddr, tempBbtBufEntrySize, tempReadBufAddr, tempReadBufEntrySize);
+        FindBadBlock(dieState, tempBbtBufAddr);
         SaveBadBlockTable(dieState, tempBbtBufAddr, tempBbtBufEntrySize);
     }
 
@@ -761,35 +786,137 @@ void RecoverBadBlockTable(unsigned int tempBufAddr)
 }
 
 /**
- * @brief Erase all the blocks on user dies and wait until done.
+ * The blocks to be erased by `SweepEraseBlocks()`:
+ *
+ * - `ERASE_SWEEP_TOTAL_BLOCKS`: all the physical blocks, before the bbt is recovered.
+ * - `ERASE_SWEEP_USER_BLOCKS`: all the good virtual blocks not held by NMC.
+ * - `ERASE_SWEEP_USED_BLOCKS`: the good virtual blocks not held by NMC that are not free,
+ *   since a block is always erased before being put to the free block list.
  */
-void EraseTotalBlockSpace()
+#define ERASE_SWEEP_TOTAL_BLOCKS   0
+#define ERASE_SWEEP_USER_BLOCKS    1
+#define ERASE_SWEEP_USED_BLOCKS    2
+#define ERASE_SWEEP_REPORT_PERCENT 10
+
+static unsigned int IsEraseSweepTarget(unsigned int dieNo, unsigned int blockNo, unsigned int sweep)
 {
-    unsigned int blockNo, dieNo, reqSlotTag;
+    unsigned int phyBlockNo;
 
-    xil_printf("Erase total block space...wait for a minute...\r\n");
+    if (sweep == ERASE_SWEEP_TOTAL_BLOCKS)
+        return 1;
+    if (VBLK_ENTRY(dieNo, blockNo)->bad || ((sweep == ERASE_SWEEP_USED_BLOCKS) && VBLK_ENTRY(dieNo, blockNo)->free))
+        return 0;
+
+    phyBlockNo = phyBlockMapPtr->phyBlock[dieNo][Vblock2PblockOfTbsTranslation(blockNo)].remappedPhyBlock;
+    return !nmcPhyBlockUsed(dieNo, phyBlockNo);
+}
+
+static void IssueSweepErase(unsigned int dieNo, unsigned int blockNo, unsigned int sweep)
+{
+    unsigned int reqSlotTag;
+
+    reqSlotTag = GetFromFreeReqQ();
+
+    reqPoolPtr->reqPool[reqSlotTag].reqType              = REQ_TYPE_NAND;
+    reqPoolPtr->reqPool[reqSlotTag].reqCode              = REQ_CODE_ERASE;
+    reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat = REQ_OPT_DATA_BUF_NONE;
+
+    if (sweep == ERASE_SWEEP_TOTAL_BLOCKS)
+    {
+        reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandAddr               = REQ_OPT_NAND_ADDR_PHY_ORG;
+        reqPoolPtr->reqPool[reqSlotTag].reqOpt.rowAddrDependencyCheck = REQ_OPT_ROW_ADDR_DEPENDENCY_NONE;
+        reqPoolPtr->reqPool[reqSlotTag].reqOpt.blockSpace             = REQ_OPT_BLOCK_SPACE_TOTAL;
+
+        reqPoolPtr->reqPool[reqSlotTag].nandInfo.physicalCh    = Vdie2PchTranslation(dieNo);
+        reqPoolPtr->reqPool[reqSlotTag].nandInfo.physicalWay   = Vdie2PwayTranslation(dieNo);
+        reqPoolPtr->reqPool[reqSlotTag].nandInfo.physicalBlock = blockNo;
+        reqPoolPtr->reqPool[reqSlotTag].nandInfo.physicalPage  = 0;
+    }
+    else
+    {
+        reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandAddr               = REQ_OPT_NAND_ADDR_VSA;
+        reqPoolPtr->reqPool[reqSlotTag].reqOpt.rowAddrDependencyCheck = REQ_OPT_ROW_ADDR_DEPENDENCY_CHECK;
+        reqPoolPtr->reqPool[reqSlotTag].reqOpt.blockSpace             = REQ_OPT_BLOCK_SPACE_MAIN;
+
+        reqPoolPtr->reqPool[reqSlotTag].nandInfo.virtualSliceAddr  = Vorg2VsaTranslation(dieNo, blockNo, 0);
+        reqPoolPtr->reqPool[reqSlotTag].nandInfo.programmedPageCnt = VBLK_ENTRY(dieNo, blockNo)->currentPage;
+    }
+
+    SelectLowLevelReqQ(reqSlotTag);
+}
+
+/**
+ * @brief Erase the given kind of blocks on all the user dies and wait until done.
+ *
+ * Each die keeps one erase outstanding and takes its next block as soon as the previous
+ * erase is done, so all the dies are erasing all the time, and a die with fewer blocks to
+ * erase doesn't wait for the others after each block number.
+ *
+ * A block failed to be erased is marked bad in the physical block map by the scheduler,
+ * check `ExecuteNandReq()`.
+ *
+ * @param sweep `ERASE_SWEEP_*`, the blocks to be erased.
+ * @return unsigned int the number of erased blocks.
+ */
+static unsigned int SweepEraseBlocks(unsigned int sweep)
+{
+    unsigned int dieNo, blockNo, blockCnt, targetCnt, erasedCnt, reportCnt, sweepDieCnt;
+    unsigned int nextBlockNo[USER_DIES]; // the next block to be checked on each die
+
+    blockCnt  = (sweep == ERASE_SWEEP_TOTAL_BLOCKS) ? TOTAL_BLOCKS_PER_DIE : USER_BLOCKS_PER_DIE;
+    targetCnt = 0;
+    for (dieNo = 0; dieNo < USER_DIES; dieNo++)
+        for (blockNo = 0; blockNo < blockCnt; blockNo++)
+            targetCnt += IsEraseSweepTarget(dieNo, blockNo, sweep);
+
+    for (dieNo = 0; dieNo < USER_DIES; dieNo++)
+        nextBlockNo[dieNo] = 0;
+    sweepDieCnt = USER_DIES;
+    erasedCnt   = 0;
+    reportCnt   = 0;
+
+    while (sweepDieCnt)
+    {
+        SchedulingNandReq();
 
-    for (blockNo = 0; blockNo < TOTAL_BLOCKS_PER_DIE; blockNo++)
         for (dieNo = 0; dieNo < USER_DIES; dieNo++)
         {
-            reqSlotTag = GetFromFreeReqQ();
+            if ((nextBlockNo[dieNo] == BLOCK_NONE) || !IsDieReqDone(dieNo))
+                continue;
 
-            reqPoolPtr->reqPool[reqSlotTag].reqType                       = REQ_TYPE_NAND;
-            reqPoolPtr->reqPool[reqSlotTag].reqCode                       = REQ_CODE_ERASE;
-            reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandAddr               = REQ_OPT_NAND_ADDR_PHY_ORG;
-            reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat          = REQ_OPT_DATA_BUF_NONE;
-            reqPoolPtr->reqPool[reqSlotTag].reqOpt.rowAddrDependencyCheck = REQ_OPT_ROW_ADDR_DEPENDENCY_NONE;
-            reqPoolPtr->reqPool[reqSlotTag].reqOpt.blockSpace             = REQ_OPT_BLOCK_SPACE_TOTAL;
+            for (blockNo = nextBlockNo[dieNo]; blockNo < blockCnt; blockNo++)
+                if (IsEraseSweepTarget(dieNo, blockNo, sweep))
+                    break;
 
-            reqPoolPtr->reqPool[reqSlotTag].nandInfo.physicalCh    = Vdie2PchTranslation(dieNo);
-            reqPoolPtr->reqPool[reqSlotTag].nandInfo.physicalWay   = Vdie2PwayTranslation(dieNo);
-            reqPoolPtr->reqPool[reqSlotTag].nandInfo.physicalBlock = blockNo;
-            reqPoolPtr->reqPool[reqSlotTag].nandInfo.physicalPage  = 0;
+            if (blockNo == blockCnt)
+            {
+                nextBlockNo[dieNo] = BLOCK_NONE;
+                sweepDieCnt--;
+                continue;
+            }
 
-            SelectLowLevelReqQ(reqSlotTag);
+            IssueSweepErase(dieNo, blockNo, sweep);
+            nextBlockNo[dieNo] = blockNo + 1;
+
+            if (++erasedCnt * 100 >= (reportCnt + ERASE_SWEEP_REPORT_PERCENT) * targetCnt)
+            {
+                reportCnt = erasedCnt * 100 / targetCnt;
+                xil_printf("[ erasing %u%% (%u of %u blocks) ]\r\n", reportCnt, erasedCnt, targetCnt);
+            }
         }
+    }
 
     SyncAllLowLevelReqDone();
+    return erasedCnt;
+}
+
+/**
+ * @brief Erase all the blocks on user dies and wait until done.
+ */
+void EraseTotalBlockSpace()
+{
+    xil_printf("Erase total block space...wait for a minute...\r\n");
+    SweepEraseBlocks(ERASE_SWEEP_TOTAL_BLOCKS);
     xil_printf("Done.\r\n");
 }
 
@@ -798,30 +925,75 @@ void EraseTotalBlockSpace()
  */
 void EraseUserBlockSpace()
 {
-    unsigned int blockNo, dieNo, reqSlotTag;
-
     xil_printf("Erase User block space...wait for a minute...\r\n");
+    SweepEraseBlocks(ERASE_SWEEP_USER_BLOCKS);
+    xil_printf("Done.\r\n");
+}
 
-    for (blockNo = 0; blockNo < USER_BLOCKS_PER_DIE; blockNo++)
-        for (dieNo = 0; dieNo < USER_DIES; dieNo++)
-            if (!virtualBlockMapPtr->block[dieNo][blockNo].bad)
-            {
-                reqSlotTag = GetFromFreeReqQ();
+/**
+ * @brief Erase the user blocks that may hold data and rebuild the block maps as empty.
+ *
+ * A block failed to be erased in the sweep is taken out of use like the bad blocks, and
+ * persisted by the next `UpdateBadBlockTableForGrownBadBlock()`. The erase counts are kept
+ * for wear leveling.
+ *
+ * @note All the requests must be done and the address journal must be disabled, so the
+ * free block lists are rebuilt in the order of erase counts.
+ *
+ * @return unsigned int the number of grown bad blocks found in the sweep.
+ */
+unsigned int FormatBlockMap()
+{
+    unsigned int dieNo, blockNo, phyBlockNo, erased, erasedCnt, grownBadCnt;
 
-                reqPoolPtr->reqPool[reqSlotTag].reqType                       = REQ_TYPE_NAND;
-                reqPoolPtr->reqPool[reqSlotTag].reqCode                       = REQ_CODE_ERASE;
-                reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandAddr               = REQ_OPT_NAND_ADDR_VSA;
-                reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat          = REQ_OPT_DATA_BUF_NONE;
-                reqPoolPtr->reqPool[reqSlotTag].reqOpt.rowAddrDependencyCheck = REQ_OPT_ROW_ADDR_DEPENDENCY_NONE;
-                reqPoolPtr->reqPool[reqSlotTag].reqOpt.blockSpace             = REQ_OPT_BLOCK_SPACE_MAIN;
+    erasedCnt   = SweepEraseBlocks(ERASE_SWEEP_USED_BLOCKS);
+    grownBadCnt = 0;
 
-                reqPoolPtr->reqPool[reqSlotTag].nandInfo.virtualSliceAddr = Vorg2VsaTranslation(dieNo, blockNo, 0);
+    InitDieMap();
+    for (dieNo = 0; dieNo < USER_DIES; dieNo++)
+        for (blockNo = 0; blockNo < USER_BLOCKS_PER_DIE; blockNo++)
+        {
+            erased     = IsEraseSweepTarget(dieNo, blockNo, ERASE_SWEEP_USED_BLOCKS);
+            phyBlockNo = phyBlockMapPtr->phyBlock[dieNo][Vblock2PblockOfTbsTranslation(blockNo)].remappedPhyBlock;
 
-                SelectLowLevelReqQ(reqSlotTag);
+            if (erased && phyBlockMapPtr->phyBlock[dieNo][phyBlockNo].bad)
+            {
+                pr_warn("C/W[%u/%u]: grown bad block at PBlk %u", Vdie2PchTranslation(dieNo),
+                        Vdie2PwayTranslation(dieNo), phyBlockNo);
+                VBLK_ENTRY(dieNo, blockNo)->bad = BLOCK_STATE_BAD;
+                grownBadCnt++;
             }
 
-    SyncAllLowLevelReqDone();
-    xil_printf("Done.\r\n");
+            if (VBLK_ENTRY(dieNo, blockNo)->bad)
+            {
+                VBLK_ENTRY(dieNo, blockNo)->prevBlock = BLOCK_NONE;
+                VBLK_ENTRY(dieNo, blockNo)->nextBlock = BLOCK_NONE;
+                continue;
+            }
+
+            if (erased)
+            {
+                VBLK_ENTRY(dieNo, blockNo)->eraseCnt++;
+                wearLeveling.erasedCnt[dieNo]++;
+            }
+
+            VBLK_ENTRY(dieNo, blockNo)->free            = 1;
+            VBLK_ENTRY(dieNo, blockNo)->invalidSliceCnt = 0;
+            VBLK_ENTRY(dieNo, blockNo)->deallocating    = 0;
+            VBLK_ENTRY(dieNo, blockNo)->pendingFree     = 0;
+            VBLK_ENTRY(dieNo, blockNo)->collecting      = 0;
+            VBLK_ENTRY(dieNo, blockNo)->currentPage     = 0;
+            VBLK_ENTRY(dieNo, blockNo)->modifiedSeq     = 0;
+
+            // the blocks held by NMC are not erased and never put to the free block list
+            if (!nmcPhyBlockUsed(dieNo, phyBlockNo))
+                PutToFbList(dieNo, blockNo);
+        }
+
+    InitCurrentBlockOfDieMap();
+
+    xil_printf("[ %u blocks erased, %u grown bad blocks found. ]\r\n", erasedCnt, grownBadCnt);
+    return grownBadCnt;
 }
 
 /**
@@ -839,9 +1011,13 @@ void InitBlockDieMap()
     unsigned int dieNo;
     unsigned char eraseFlag = 1;
 
+#ifdef NSC_SIMULATOR
+    char input = 'n'; // no UART on the host, keep the bad block table as on a normal boot
+#else
     xil_printf("Press 'X' to re-make the bad block table.\r\n");
 
     char input = inbyte();
+#endif
     if (input == 'X')
     {
         xil_printf("[WARNING!!!] Start re-making bad block table\r\n");
@@ -879,6 +1055,9 @@ void InitBlockDieMap()
             PBLK_ENTRY(dieNo, NMC_MAPPING_DIR_PBLKS[i])->bad = 1;
         }
     }
+
+    // take the blocks of address map checkpoints and journal out of the remapping candidates
+    ReserveAddrMapBlocks();
     RemapBadBlock();
 
     // initialize and recover NMC mappings before creating free block list3
@@ -913,7 +1092,7 @@ unsigned int AddrTransRead(unsigned int logicalSliceAddr)
 
     if (logicalSliceAddr < SLICES_PER_SSD)
     {
-        virtualSliceAddr = logicalSliceMapPtr->logicalSlice[logicalSliceAddr].virtualSliceAddr;
+        virtualSliceAddr = LSA2VSA(logicalSliceAddr);
 
         if (virtualSliceAddr != VSA_NONE)
             return virtualSliceAddr;
@@ -941,16 +1120,23 @@ unsigned int AddrTransRead(unsigned int logicalSliceAddr)
  */
 unsigned int AddrTransWrite(unsigned int logicalSliceAddr)
 {
-    unsigned int virtualSliceAddr;
+    unsigned int virtualSliceAddr, stream;
 
     if (logicalSliceAddr < SLICES_PER_SSD)
     {
+        if (nmcInterleaving)
+            stream = WRITE_STREAM_NMC;
+        else
+            stream = ClassifyWriteStream(logicalSliceAddr, LSA2VSA(logicalSliceAddr) != VSA_NONE);
+
         InvalidateOldVsa(logicalSliceAddr);
 
-        virtualSliceAddr = FindFreeVirtualSlice();
+        virtualSliceAddr = FindFreeVirtualSlice(stream);
 
-        logicalSliceMapPtr->logicalSlice[logicalSliceAddr].virtualSliceAddr = virtualSliceAddr;
+        SET_LSA2VSA(logicalSliceAddr, virtualSliceAddr);
         virtualSliceMapPtr->virtualSlice[virtualSliceAddr].logicalSliceAddr = logicalSliceAddr;
+        SET_VSA_VALID(virtualSliceAddr);
+        JournalAddrTrans(logicalSliceAddr, virtualSliceAddr);
 
         pr_debug("Allocate VSA[%u] for LSA[%u]", virtualSliceAddr, logicalSliceAddr);
         return virtualSliceAddr;
@@ -959,6 +1145,65 @@ unsigned int AddrTransWrite(unsigned int logicalSliceAddr)
         assert(!"[WARNING] Logical address is larger than maximum logical address served by SSD [WARNING]");
 }
 
+/**
+ * @brief Take a free block as the new current block of the given stream on the die.
+ *
+ * The host and NMC streams run GC in the foreground until a free block other than the
+ * reserved ones is available, when the GC in the background could not keep up with them.
+ * The GC stream may take the reserved blocks, so a GC always has a block to copy the valid
+ * slices of its victim to.
+ *
+ * @param dieNo the die to take the free block from.
+ * @param stream `WRITE_STREAM_*`.
+ * @return unsigned int the new current block.
+ */
+static unsigned int OpenCurrentBlock(unsigned int dieNo, unsigned int stream)
+{
+    unsigned int blockNo;
+
+    if (stream == WRITE_STREAM_GC)
+        blockNo = GetFromFbList(dieNo, GET_FREE_BLOCK_GC);
+    else
+        while ((blockNo = GetFromFbList(dieNo, GET_FREE_BLOCK_NORMAL)) == BLOCK_FAIL)
+            GarbageCollection(dieNo);
+    ASSERT(blockNo != BLOCK_FAIL, "Die[%u]: There is no available block for stream %u", dieNo, stream);
+
+    VBLK_ENTRY(dieNo, blockNo)->stream      = stream;
+    VDIE_ENTRY(dieNo)->currentBlock[stream] = blockNo;
+    JournalBlockOpen(dieNo, blockNo, stream);
+    writeStream.blockCnt[stream]++;
+
+    // NMC: record the PBN of the new block if in NMC mode
+    if (stream == WRITE_STREAM_NMC)
+        nmcRecordBlock(dieNo, blockNo);
+
+    pr_debug("Die[%u]: Open VBlk %u for stream %u", dieNo, blockNo, stream);
+    return blockNo;
+}
+
+/**
+ * @brief Take the next free page of the current block of the given stream on the die.
+ *
+ * @param dieNo the die to allocate the slice on.
+ * @param stream `WRITE_STREAM_*`.
+ * @return unsigned int the VSA of the allocated slice.
+ */
+static unsigned int AllocateStreamSlice(unsigned int dieNo, unsigned int stream)
+{
+    unsigned int blockNo, pageNo;
+
+    // if the current block is full or not opened yet, assign a free block as new current block
+    blockNo = VDIE_ENTRY(dieNo)->currentBlock[stream];
+    if (blockNo == BLOCK_NONE || VBLK_ENTRY(dieNo, blockNo)->currentPage == USER_PAGES_PER_BLOCK)
+        blockNo = OpenCurrentBlock(dieNo, stream);
+
+    pageNo = VBLK_ENTRY(dieNo, blockNo)->currentPage++;
+    ASSERT(pageNo < USER_PAGES_PER_BLOCK, "Die[%u]: Current page management fail on VBlk %u", dieNo, blockNo);
+
+    writeStream.sliceCnt[stream]++;
+    return Vorg2VsaTranslation(dieNo, blockNo, pageNo);
+}
+
 /**
  * @brief Select a free physical page (virtual slice).
  *
@@ -976,15 +1221,17 @@ unsigned int AddrTransWrite(unsigned int logicalSliceAddr)
  *
  *  - `VIRTUAL_DIE_ENTRY::currentBlock`:
  *
- *      The current working block of the target die.
+ *      The current working block of each write stream on the target die.
  *
- *      Each die maintains a current working block and will select a page from the current
- *      working block of target die to serve the write request. Once all the pages of the
- *      current working block are used, the fw will select a new free block from the free
- *      block list as the new current working block of that die.
+ *      Each die maintains a current working block per stream and will select a page from
+ *      the current working block of the given stream to serve the write request, so the
+ *      slices of different streams never share a block. Once all the pages of the current
+ *      working block are used, the fw will select a new free block from the free block
+ *      list as the new current working block of that stream.
  *
- *      If there the free block list of that die is empty, the fw will try to release
- *      invalid blocks by doing GC.
+ *      The free blocks are normally released by the GC in the background, but if the
+ *      free block list of that die is empty, the fw will try to release invalid blocks
+ *      by doing GC in the foreground.
  *
  *      Check `GetFromFbList()` and `GarbageCollection()` for the details.
  *
@@ -997,88 +1244,135 @@ unsigned int AddrTransWrite(unsigned int logicalSliceAddr)
  *
  * @sa `VIRTUAL_DIE_ENTRY`, `VIRTUAL_BLOCK_ENTRY`, `FindDieForFreeSliceAllocation()`.
  *
- * @warning why the `currentPage` might be full after GC?
- * @warning why assign dieNo before return? redundant?
- *
+ * @param stream the write stream of the request, `WRITE_STREAM_*`.
  * @return unsigned int the VSA for the request.
  */
-unsigned int FindFreeVirtualSlice()
+unsigned int FindFreeVirtualSlice(unsigned int stream)
 {
-    unsigned int currentBlock, virtualSliceAddr, dieNo;
+    unsigned int virtualSliceAddr;
 
-    dieNo        = sliceAllocationTargetDie;
-    currentBlock = virtualDieMapPtr->die[dieNo].currentBlock;
+    virtualSliceAddr         = AllocateStreamSlice(sliceAllocationTargetDie, stream);
+    sliceAllocationTargetDie = FindDieForFreeSliceAllocation(); // sliceAllocationTargetDie should be updated
+    return virtualSliceAddr;
+}
 
-    // if the currently used block is full, assign a free block as new current block
-    if (virtualBlockMapPtr->block[dieNo][currentBlock].currentPage == USER_PAGES_PER_BLOCK)
-    {
-        currentBlock = GetFromFbList(dieNo, GET_FREE_BLOCK_NORMAL);
+/**
+ * @brief Select a free virtual slice on the given die for a slice copied by GC.
+ *
+ * The GC copies go to the GC stream of the die, check `GarbageCollection()`.
+ *
+ * @param copyTargetDieNo the die of the GC victim.
+ * @return unsigned int the VSA to copy the slice to.
+ */
+unsigned int FindFreeVirtualSliceForGc(unsigned int copyTargetDieNo)
+{
+    return AllocateStreamSlice(copyTargetDieNo, WRITE_STREAM_GC);
+}
 
-        if (currentBlock != BLOCK_FAIL)
-            virtualDieMapPtr->die[dieNo].currentBlock = currentBlock;
-        else
-        {
-            GarbageCollection(dieNo);
-            currentBlock = virtualDieMapPtr->die[dieNo].currentBlock;
+/**
+ * @brief Stop writing to the given block if it is the current block of any stream.
+ *
+ * Called before the block is erased, its stream takes a new block at its next write.
+ *
+ * @param dieNo the die number of the block.
+ * @param blockNo the block number on the specified die.
+ */
+void CloseCurrentBlock(unsigned int dieNo, unsigned int blockNo)
+{
+    unsigned int stream;
 
-            // FIXME: why need to check whether `currentPage` is full?
-            if (virtualBlockMapPtr->block[dieNo][currentBlock].currentPage == USER_PAGES_PER_BLOCK)
-            {
-                currentBlock = GetFromFbList(dieNo, GET_FREE_BLOCK_NORMAL);
-                if (currentBlock != BLOCK_FAIL)
-                    virtualDieMapPtr->die[dieNo].currentBlock = currentBlock;
-                else
-                    assert(!"[WARNING] There is no available block [WARNING]");
-            }
-            else if (virtualBlockMapPtr->block[dieNo][currentBlock].currentPage > USER_PAGES_PER_BLOCK)
-                assert(!"[WARNING] Current page management fail [WARNING]");
-        }
+    for (stream = 0; stream < WRITE_STREAM_COUNT; stream++)
+        if (VDIE_ENTRY(dieNo)->currentBlock[stream] == blockNo)
+            VDIE_ENTRY(dieNo)->currentBlock[stream] = BLOCK_NONE;
+}
 
-        // NMC: record the PBN of the new block if in NMC mode
-        nmcRecordBlock(dieNo, currentBlock);
-    }
-    else if (virtualBlockMapPtr->block[dieNo][currentBlock].currentPage > USER_PAGES_PER_BLOCK)
-        assert(!"[WARNING] Current page management fail [WARNING]");
+#if (DIE_SELECTION_POLICY == DIE_SELECTION_LOAD_AWARE)
+/**
+ * @brief Estimate the pending work of the given die.
+ *
+ * The running, queued and blocked requests of the die are counted, an erase counted as
+ * `DIE_LOAD_ERASE_WEIGHT` requests, plus `DIE_LOAD_GC_WEIGHT` while a GC on the die is still
+ * copying the valid slices of its victim.
+ *
+ * @param dieNo the die to check.
+ * @return unsigned int 0 if the die is idle, or the weighted number of its requests.
+ */
+static unsigned int GetDieLoad(unsigned int dieNo)
+{
+    unsigned int chNo  = Vdie2PchTranslation(dieNo);
+    unsigned int wayNo = Vdie2PwayTranslation(dieNo);
+    unsigned int load;
 
-    virtualSliceAddr =
-        Vorg2VsaTranslation(dieNo, currentBlock, virtualBlockMapPtr->block[dieNo][currentBlock].currentPage);
-    virtualBlockMapPtr->block[dieNo][currentBlock].currentPage++;
-    sliceAllocationTargetDie = FindDieForFreeSliceAllocation(); // sliceAllocationTargetDie should be updated
-    dieNo                    = sliceAllocationTargetDie;        // don't merge the 2 lines
-    return virtualSliceAddr;
+    load = nandReqQ[chNo][wayNo].reqCnt + blockedByRowAddrDepReqQ[chNo][wayNo].reqCnt;
+    load += (nandReqQ[chNo][wayNo].eraseReqCnt + blockedByRowAddrDepReqQ[chNo][wayNo].eraseReqCnt) *
+            (DIE_LOAD_ERASE_WEIGHT - 1);
+
+    // the running request keeps the die busy until it is done, the others may not start yet
+    if (dieStateTablePtr->dieState[chNo][wayNo].dieState == DIE_STATE_EXE)
+        load++;
+
+    // the copies of a GC are issued a few at a time until its victim is erased
+    if (gcState.die[dieNo].victimBlock != BLOCK_NONE)
+        load += DIE_LOAD_GC_WEIGHT;
+
+    return load;
 }
 
-unsigned int FindFreeVirtualSliceForGc(unsigned int copyTargetDieNo, unsigned int victimBlockNo)
+/**
+ * @brief Select the die with the least pending work for the next host write.
+ *
+ * The dies are checked in round robin order from the die following the previous target,
+ * and the round robin die is credited `DIE_SELECTION_MIN_GAIN`, so it is kept unless
+ * another die has more than that less work. The first idle die is taken immediately.
+ *
+ * The previous target is called right after a slice is allocated on it, but the write of
+ * that slice is not queued yet, so one more request is counted on it.
+ *
+ * The dies given `DIE_SELECTION_MAX_LEAD` slices more than the least written die are not
+ * selected, so at least the least written dies can always be selected.
+ *
+ * @return unsigned int the target die number.
+ */
+static unsigned int FindLeastLoadedDie()
 {
-    unsigned int currentBlock, virtualSliceAddr, dieNo;
+    unsigned int roundRobinDie, targetDie, dieNo, iDie, load, minLoad;
 
-    dieNo = copyTargetDieNo;
-    if (victimBlockNo == virtualDieMapPtr->die[dieNo].currentBlock)
+    roundRobinDie = Pcw2VdieTranslation(targetCh, targetWay);
+    targetDie     = DIE_NONE;
+    minLoad       = 0xffffffff;
+    for (iDie = 0; iDie < USER_DIES; iDie++)
     {
-        virtualDieMapPtr->die[dieNo].currentBlock = GetFromFbList(dieNo, GET_FREE_BLOCK_GC);
-        if (virtualDieMapPtr->die[dieNo].currentBlock == BLOCK_FAIL)
-            assert(!"[WARNING] There is no available block [WARNING]");
+        dieNo = (roundRobinDie + iDie) % USER_DIES;
+        if (dieAllocLead[dieNo] >= DIE_SELECTION_MAX_LEAD)
+            continue;
+
+        load = GetDieLoad(dieNo) + (dieNo == sliceAllocationTargetDie);
+        if (!iDie)
+            load = (load > DIE_SELECTION_MIN_GAIN) ? load - DIE_SELECTION_MIN_GAIN : 0;
+
+        if (load < minLoad)
+        {
+            minLoad   = load;
+            targetDie = dieNo;
+            if (!load)
+                break;
+        }
     }
-    currentBlock = virtualDieMapPtr->die[dieNo].currentBlock;
+    ASSERT(targetDie != DIE_NONE, "no die can be selected for the next write");
 
-    if (virtualBlockMapPtr->block[dieNo][currentBlock].currentPage == USER_PAGES_PER_BLOCK)
-    {
+    dieSelectionSkipCnt += (targetDie != roundRobinDie);
 
-        currentBlock = GetFromFbList(dieNo, GET_FREE_BLOCK_GC);
+    // once every die has been given a slice, take one slice off each lead
+    if (!dieAllocLead[targetDie]++ && !--zeroLeadDieCnt)
+        for (dieNo = 0; dieNo < USER_DIES; dieNo++)
+            zeroLeadDieCnt += !--dieAllocLead[dieNo];
 
-        if (currentBlock != BLOCK_FAIL)
-            virtualDieMapPtr->die[dieNo].currentBlock = currentBlock;
-        else
-            assert(!"[WARNING] There is no available block [WARNING]");
-    }
-    else if (virtualBlockMapPtr->block[dieNo][currentBlock].currentPage > USER_PAGES_PER_BLOCK)
-        assert(!"[WARNING] Current page management fail [WARNING]");
+    targetCh  = Vdie2PchTranslation((targetDie + 1) % USER_DIES);
+    targetWay = Vdie2PwayTranslation((targetDie + 1) % USER_DIES);
 
-    virtualSliceAddr =
-        Vorg2VsaTranslation(dieNo, currentBlock, virtualBlockMapPtr->block[dieNo][currentBlock].currentPage);
-    virtualBlockMapPtr->block[dieNo][currentBlock].currentPage++;
-    return virtualSliceAddr;
+    return targetDie;
 }
+#endif
 
 /**
  * @brief Update and get the die number to serve the next write request.
@@ -1087,14 +1381,23 @@ unsigned int FindFreeVirtualSliceForGc(unsigned int copyTargetDieNo, unsigned in
  * channels to take advantage of the channel parallelism. If all the channels' same way
  * are used, select the next way of each channel to use the die parallelism.
  *
- * @warning As paper the mentioned, may not perform well if latency largely varied.
+ * The strict interleaving may not perform well if latency largely varied, e.g. the writes
+ * queued behind the erase or GC of a die, so the die with the least pending work is taken
+ * instead if `DIE_SELECTION_POLICY` is `DIE_SELECTION_LOAD_AWARE`. The NMC block
+ * interleaving always takes the strict interleaving, as the NMC files are striped.
  *
  * @return unsigned int The target die number.
  */
 unsigned int FindDieForFreeSliceAllocation()
 {
-    unsigned int targetDie = Pcw2VdieTranslation(targetCh, targetWay);
+    unsigned int targetDie;
+
+#if (DIE_SELECTION_POLICY == DIE_SELECTION_LOAD_AWARE)
+    if (!nmcInterleaving)
+        return FindLeastLoadedDie();
+#endif
 
+    targetDie = Pcw2VdieTranslation(targetCh, targetWay);
     if (targetCh != (USER_CHANNELS - 1))
         targetCh = targetCh + 1;
     else
@@ -1113,10 +1416,16 @@ unsigned int FindDieForFreeSliceAllocation()
     return targetDie;
 }
 
+/**
+ * @brief Make the first die the target of the next write, and the second one the next
+ * target in round robin.
+ *
+ * @note The die loads are not checked, the request queues and buffers may not be ready.
+ */
 void ResetTargetDie()
 {
-    targetCh                 = 0;
-    targetWay                = 0;
+    targetCh                 = Vdie2PchTranslation(1 % USER_DIES);
+    targetWay                = Vdie2PwayTranslation(1 % USER_DIES);
     sliceAllocationTargetDie = 0;
 }
 
@@ -1137,7 +1446,7 @@ void InvalidateOldVsa(unsigned int logicalSliceAddr)
 {
     unsigned int virtualSliceAddr, dieNo, blockNo;
 
-    virtualSliceAddr = logicalSliceMapPtr->logicalSlice[logicalSliceAddr].virtualSliceAddr;
+    virtualSliceAddr = LSA2VSA(logicalSliceAddr);
 
     if (virtualSliceAddr != VSA_NONE)
     {
@@ -1147,15 +1456,90 @@ void InvalidateOldVsa(unsigned int logicalSliceAddr)
         dieNo   = Vsa2VdieTranslation(virtualSliceAddr);
         blockNo = Vsa2VblockTranslation(virtualSliceAddr);
 
+        CLEAR_VSA_VALID(virtualSliceAddr);
+
+        // the victim of a GC in progress is not in any victim list until it is erased
+        if (virtualBlockMapPtr->block[dieNo][blockNo].collecting)
+        {
+            virtualBlockMapPtr->block[dieNo][blockNo].invalidSliceCnt++;
+            SET_LSA2VSA(logicalSliceAddr, VSA_NONE);
+            return;
+        }
+
         // unlink
         SelectiveGetFromGcVictimList(dieNo, blockNo);
         virtualBlockMapPtr->block[dieNo][blockNo].invalidSliceCnt++;
-        logicalSliceMapPtr->logicalSlice[logicalSliceAddr].virtualSliceAddr = VSA_NONE;
+        SET_LSA2VSA(logicalSliceAddr, VSA_NONE);
 
         PutToGcVictimList(dieNo, blockNo, virtualBlockMapPtr->block[dieNo][blockNo].invalidSliceCnt);
     }
 }
 
+/**
+ * @brief Unmap a run of logical slices deallocated by host (Dataset Management).
+ *
+ * Like `InvalidateOldVsa()`, the valid slices are counted as invalid slices of their
+ * blocks, but each block is taken from its GC victim list only once, at its first slice,
+ * and put back to the list of its final invalid slice count after the whole run, so a
+ * run of slices on the same block moves the block only once. The victims of the GCs in
+ * progress are not in the lists, their slices are only counted.
+ *
+ * The run is journaled as a single record, replayed by calling this function again.
+ *
+ * @param startLsa the first logical slice to be deallocated.
+ * @param sliceCnt number of slices, at most `DEALLOCATE_SLICES_PER_PASS`.
+ * @return unsigned int the number of slices that were mapped.
+ */
+unsigned int DeallocateLogicalSlices(unsigned int startLsa, unsigned int sliceCnt)
+{
+    static unsigned int touchedBlockVsa[DEALLOCATE_SLICES_PER_PASS];
+    unsigned int logicalSliceAddr, virtualSliceAddr, dieNo, blockNo, touchedBlockCnt, mappedCnt, iBlk;
+
+    ASSERT(sliceCnt <= DEALLOCATE_SLICES_PER_PASS && startLsa + sliceCnt <= SLICES_PER_SSD,
+           "invalid deallocate run: LSA %u, %u slices", startLsa, sliceCnt);
+
+    touchedBlockCnt = 0;
+    mappedCnt       = 0;
+    for (logicalSliceAddr = startLsa; logicalSliceAddr < startLsa + sliceCnt; logicalSliceAddr++)
+    {
+        virtualSliceAddr = LSA2VSA(logicalSliceAddr);
+        if (virtualSliceAddr == VSA_NONE)
+            continue;
+
+        SET_LSA2VSA(logicalSliceAddr, VSA_NONE);
+        mappedCnt++;
+
+        // a stale mapping, the slice is already counted as invalid
+        if (VSA2LSA(virtualSliceAddr) != logicalSliceAddr)
+            continue;
+
+        CLEAR_VSA_VALID(virtualSliceAddr);
+        dieNo   = VSA2VDIE(virtualSliceAddr);
+        blockNo = VSA2VBLK(virtualSliceAddr);
+        if (!VBLK_ENTRY(dieNo, blockNo)->deallocating && !VBLK_ENTRY(dieNo, blockNo)->collecting)
+        {
+            SelectiveGetFromGcVictimList(dieNo, blockNo);
+            VBLK_ENTRY(dieNo, blockNo)->deallocating = 1;
+            touchedBlockVsa[touchedBlockCnt++]       = Vorg2VsaTranslation(dieNo, blockNo, 0);
+        }
+        VBLK_ENTRY(dieNo, blockNo)->invalidSliceCnt++;
+    }
+
+    for (iBlk = 0; iBlk < touchedBlockCnt; iBlk++)
+    {
+        dieNo   = VSA2VDIE(touchedBlockVsa[iBlk]);
+        blockNo = VSA2VBLK(touchedBlockVsa[iBlk]);
+
+        VBLK_ENTRY(dieNo, blockNo)->deallocating = 0;
+        PutToGcVictimList(dieNo, blockNo, VBLK_ENTRY(dieNo, blockNo)->invalidSliceCnt);
+    }
+
+    if (mappedCnt)
+        JournalDeallocate(startLsa, sliceCnt);
+
+    return mappedCnt;
+}
+
 /**
  * @brief Erase the specified block of the specified die and discard its LSAs.
  *
@@ -1174,7 +1558,7 @@ void InvalidateOldVsa(unsigned int logicalSliceAddr)
  */
 void EraseBlock(unsigned int dieNo, unsigned int blockNo)
 {
-    unsigned int pageNo, virtualSliceAddr, reqSlotTag;
+    unsigned int reqSlotTag;
 
     reqSlotTag = GetFromFreeReqQ();
 
@@ -1190,12 +1574,29 @@ void EraseBlock(unsigned int dieNo, unsigned int blockNo)
 
     SelectLowLevelReqQ(reqSlotTag);
 
+    JournalBlockErase(dieNo, blockNo);
+    ResetErasedBlockMap(dieNo, blockNo);
+    wearLeveling.erasedCnt[dieNo]++;
+}
+
+/**
+ * @brief Reset the block map entry of an erased block and move it to the free block list.
+ *
+ * @param dieNo the die number of the erased block.
+ * @param blockNo the block number on the specified die.
+ */
+void ResetErasedBlockMap(unsigned int dieNo, unsigned int blockNo)
+{
+    unsigned int pageNo, virtualSliceAddr;
+
     // block map indicated blockNo initialization
     virtualBlockMapPtr->block[dieNo][blockNo].free = 1;
     virtualBlockMapPtr->block[dieNo][blockNo].eraseCnt++;
     virtualBlockMapPtr->block[dieNo][blockNo].invalidSliceCnt = 0;
     virtualBlockMapPtr->block[dieNo][blockNo].currentPage     = 0;
+    memset(VBLK_VALID_BITS(dieNo, blockNo), 0, sizeof(VBLK_VALID_BITS(dieNo, blockNo)));
 
+    CloseCurrentBlock(dieNo, blockNo);
     PutToFbList(dieNo, blockNo);
 
     for (pageNo = 0; pageNo < USER_PAGES_PER_BLOCK; pageNo++)
@@ -1206,34 +1607,126 @@ void EraseBlock(unsigned int dieNo, unsigned int blockNo)
 }
 
 /**
- * @brief Append the given virtual block to the free block list of its die.
+ * @brief Link the given free block between two neighbors in the free block list of its die.
+ *
+ * @param dieNo the die number of the given block.
+ * @param blockNo VBN of the block to be linked.
+ * @param prevBlock the block to precede the given block, or `BLOCK_NONE` for the head.
+ * @param nextBlock the block to follow the given block, or `BLOCK_NONE` for the tail.
+ */
+static void LinkToFbList(unsigned int dieNo, unsigned int blockNo, unsigned int prevBlock, unsigned int nextBlock)
+{
+    VBLK_ENTRY(dieNo, blockNo)->prevBlock = prevBlock;
+    VBLK_ENTRY(dieNo, blockNo)->nextBlock = nextBlock;
+
+    if (prevBlock == BLOCK_NONE)
+        VDIE_ENTRY(dieNo)->headFreeBlock = blockNo;
+    else
+        VBLK_ENTRY(dieNo, prevBlock)->nextBlock = blockNo;
+
+    if (nextBlock == BLOCK_NONE)
+        VDIE_ENTRY(dieNo)->tailFreeBlock = blockNo;
+    else
+        VBLK_ENTRY(dieNo, nextBlock)->prevBlock = blockNo;
+}
+
+/**
+ * @brief Insert the given free block after the settled blocks not more worn than it.
+ *
+ * The list is searched from the tail, since a block just erased is usually one of the
+ * most worn blocks of its die.
+ *
+ * @param dieNo the die number of the given block.
+ * @param blockNo VBN of the block to be inserted.
+ */
+static void InsertToFbList(unsigned int dieNo, unsigned int blockNo)
+{
+    unsigned int prevBlock, nextBlock;
+
+    nextBlock = BLOCK_NONE;
+    prevBlock = VDIE_ENTRY(dieNo)->tailFreeBlock;
+    while (prevBlock != BLOCK_NONE && (VBLK_ENTRY(dieNo, prevBlock)->pendingFree ||
+                                       VBLK_ENTRY(dieNo, prevBlock)->eraseCnt > VBLK_ENTRY(dieNo, blockNo)->eraseCnt))
+    {
+        nextBlock = prevBlock;
+        prevBlock = VBLK_PREV_IDX(dieNo, prevBlock);
+    }
+
+    LinkToFbList(dieNo, blockNo, prevBlock, nextBlock);
+}
+
+/**
+ * @brief Add the given virtual block to the free block list of its die.
+ *
+ * The free block list is sorted by erase count, the blocks with the same erase count in
+ * the order they were added, so `GetFromFbList()` takes the least worn free block without
+ * any search.
+ *
+ * While the journal is enabled, the erase record of the block is not durable yet, so the
+ * block is appended to the tail as a pending free block instead, and sorted later by
+ * `SettlePendingFreeBlocks()`. The blocks taken from the list before the power loss must
+ * be the first ones of the list rebuilt by the replay, check `ScanSliceSpare()`.
  *
  * @param dieNo the die number of the given block.
  * @param blockNo VBN of the specified block.
  */
 void PutToFbList(unsigned int dieNo, unsigned int blockNo)
 {
-    if (virtualDieMapPtr->die[dieNo].tailFreeBlock != BLOCK_NONE)
+    if (addrJournal.enabled)
     {
-        virtualBlockMapPtr->block[dieNo][blockNo].prevBlock = virtualDieMapPtr->die[dieNo].tailFreeBlock;
-        virtualBlockMapPtr->block[dieNo][blockNo].nextBlock = BLOCK_NONE;
-        virtualBlockMapPtr->block[dieNo][virtualDieMapPtr->die[dieNo].tailFreeBlock].nextBlock = blockNo;
-        virtualDieMapPtr->die[dieNo].tailFreeBlock                                             = blockNo;
+        VBLK_ENTRY(dieNo, blockNo)->pendingFree = 1;
+        LinkToFbList(dieNo, blockNo, VDIE_ENTRY(dieNo)->tailFreeBlock, BLOCK_NONE);
     }
     else
-    {
-        virtualBlockMapPtr->block[dieNo][blockNo].prevBlock = BLOCK_NONE;
-        virtualBlockMapPtr->block[dieNo][blockNo].nextBlock = BLOCK_NONE;
-        virtualDieMapPtr->die[dieNo].headFreeBlock          = blockNo;
-        virtualDieMapPtr->die[dieNo].tailFreeBlock          = blockNo;
-    }
+        InsertToFbList(dieNo, blockNo);
 
     virtualDieMapPtr->die[dieNo].freeBlockCnt++;
 }
 
+/**
+ * @brief Sort the pending free blocks of all the dies into their free block lists.
+ *
+ * Called once the journal is durable (`FlushAddrJournal()`) or replaced by a checkpoint,
+ * so the replay after a power loss sorts the same blocks in the same order.
+ */
+void SettlePendingFreeBlocks()
+{
+    unsigned int dieNo, blockNo, nextBlock;
+
+    for (dieNo = 0; dieNo < USER_DIES; dieNo++)
+    {
+        // the pending blocks are at the tail, in the order they were erased
+        blockNo = VDIE_ENTRY(dieNo)->tailFreeBlock;
+        if (blockNo == BLOCK_NONE || !VBLK_ENTRY(dieNo, blockNo)->pendingFree)
+            continue;
+        while (VBLK_PREV_IDX(dieNo, blockNo) != BLOCK_NONE && VBLK_PREV_ENTRY(dieNo, blockNo)->pendingFree)
+            blockNo = VBLK_PREV_IDX(dieNo, blockNo);
+
+        for (; blockNo != BLOCK_NONE; blockNo = nextBlock)
+        {
+            nextBlock = VBLK_NEXT_IDX(dieNo, blockNo);
+
+            if (VBLK_PREV_IDX(dieNo, blockNo) == BLOCK_NONE)
+                VDIE_ENTRY(dieNo)->headFreeBlock = nextBlock;
+            else
+                VBLK_PREV_ENTRY(dieNo, blockNo)->nextBlock = nextBlock;
+            if (nextBlock == BLOCK_NONE)
+                VDIE_ENTRY(dieNo)->tailFreeBlock = VBLK_PREV_IDX(dieNo, blockNo);
+            else
+                VBLK_NEXT_ENTRY(dieNo, blockNo)->prevBlock = VBLK_PREV_IDX(dieNo, blockNo);
+
+            VBLK_ENTRY(dieNo, blockNo)->pendingFree = 0;
+            InsertToFbList(dieNo, blockNo);
+        }
+    }
+}
+
 /**
  * @brief Pop the first block in the free block list of the specified die.
  *
+ * The first block is the least worn settled free block, the pending free blocks are only
+ * taken once all the settled ones are used, check `PutToFbList()`.
+ *
  * @note Each die will reserve some free blocks (`VIRTUAL_DIE_ENTRY::freeBlockCnt`), so if
  * the number of free blocks is less then the number of preserved blocks, `BLOCK_FAIL`
  * will be returned.
@@ -1275,7 +1768,8 @@ unsigned int GetFromFbList(unsigned int dieNo, unsigned int getFreeBlockOption)
         virtualDieMapPtr->die[dieNo].tailFreeBlock = BLOCK_NONE;
     }
 
-    virtualBlockMapPtr->block[dieNo][evictedBlockNo].free = 0;
+    virtualBlockMapPtr->block[dieNo][evictedBlockNo].free        = 0;
+    virtualBlockMapPtr->block[dieNo][evictedBlockNo].pendingFree = 0;
     virtualDieMapPtr->die[dieNo].freeBlockCnt--;
 
     virtualBlockMapPtr->block[dieNo][evictedBlockNo].nextBlock = BLOCK_NONE;
@@ -1327,7 +1821,7 @@ void UpdateBadBlockTableForGrownBadBlock(unsigned int tempBufAddr)
             {
                 bbtUpdater = (unsigned char *)(tempBbtBufAddr[dieNo] + phyBlockNo);
 
-                if (phyBlockNo != bbtInfoMapPtr->bbtInfo[dieNo].phyBlock)
+                if (phyBlockNo != bbtInfoMapPtr->bbtInfo[dieNo].phyBlock && !IsAddrMapBlock(dieNo, phyBlockNo))
                     *bbtUpdater = phyBlockMapPtr->phyBlock[dieNo][phyBlockNo].bad;
                 else
                     *bbtUpdater = BLOCK_STATE_NORMAL;
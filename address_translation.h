@@ -49,6 +49,8 @@
 #include "stdint.h"
 #include "ftl_config.h"
 #include "nvme/nvme.h"
+#include "address_map_cache.h"
+#include "write_stream.h"
 
 /* LSA for Logical Slice Address */
 
@@ -68,6 +70,35 @@
 
 #define RESERVED_FREE_BLOCK_COUNT 0x1
 
+/**
+ * The die to serve the next host write is selected by one of the following policies, set
+ * `DIE_SELECTION_POLICY` (default load aware). The NMC block interleaving always stripes
+ * the writes in round robin, check `FindDieForFreeSliceAllocation()`.
+ *
+ * - `DIE_SELECTION_ROUND_ROBIN`: interleave the writes over the channels, then the ways.
+ * - `DIE_SELECTION_LOAD_AWARE`: keep the round robin die unless another die has more than
+ *   `DIE_SELECTION_MIN_GAIN` less pending work, check `GetDieLoad()`. So the writes are
+ *   still striped while the dies are evenly loaded, but not queued behind an erase or GC.
+ *
+ * A die is skipped by the load aware policy once it has been given `DIE_SELECTION_MAX_LEAD`
+ * slices more than the least written die, so the dies still take the same share of writes
+ * in the long run and no die runs out of free blocks for being preferred.
+ */
+#define DIE_SELECTION_ROUND_ROBIN 0
+#define DIE_SELECTION_LOAD_AWARE  1
+
+#ifndef DIE_SELECTION_POLICY
+#define DIE_SELECTION_POLICY DIE_SELECTION_LOAD_AWARE
+#endif
+
+#define DIE_LOAD_ERASE_WEIGHT  10                     // a block erase takes about as long as 10 page programs
+#define DIE_LOAD_GC_WEIGHT     (SLICES_PER_BLOCK / 4) // the copies of a victim with a quarter of it valid
+#define DIE_SELECTION_MIN_GAIN 4
+#define DIE_SELECTION_MAX_LEAD USER_PAGES_PER_BLOCK
+
+// the slices unmapped by one call of `DeallocateLogicalSlices()`, which is journaled as one record
+#define DEALLOCATE_SLICES_PER_PASS 1024
+
 #define GET_FREE_BLOCK_NORMAL 0x0 // get free block for normal request
 #define GET_FREE_BLOCK_GC     0x1 // get free block for gc request
 
@@ -236,11 +267,16 @@ typedef struct _VIRTUAL_BLOCK_ENTRY
     unsigned int bad : 1;              // 1 indicates that this block is bad block
     unsigned int free : 1;             // 1 indicates that this block is free block
     unsigned int invalidSliceCnt : 16; // how many invalid slices in this block
-    unsigned int reserved0 : 10;       //
+    unsigned int deallocating : 1;     // taken from its GC victim list by `DeallocateLogicalSlices()`
+    unsigned int stream : 2;           // the write stream (`WRITE_STREAM_*`) this block was opened for
+    unsigned int pendingFree : 1;      // free, but its erase is not journaled yet, check `PutToFbList()`
+    unsigned int collecting : 1;       // taken from its GC victim list by a GC not finished yet
+    unsigned int reserved0 : 5;        //
     unsigned int currentPage : 16;     // the current working page number of this block
     unsigned int eraseCnt : 16;        // how many times this block have been erased
     unsigned int prevBlock : 16;       // VBN of the prev block in free/victim block list
     unsigned int nextBlock : 16;       // VBN of the next block in free/victim block list
+    unsigned int modifiedSeq;          // `addrJournal.writeSeq` when put to its GC victim list
 } VIRTUAL_BLOCK_ENTRY, *P_VIRTUAL_BLOCK_ENTRY;
 
 /**
@@ -251,6 +287,19 @@ typedef struct _VIRTUAL_BLOCK_MAP
     VIRTUAL_BLOCK_ENTRY block[USER_DIES][USER_BLOCKS_PER_DIE];
 } VIRTUAL_BLOCK_MAP, *P_VIRTUAL_BLOCK_MAP;
 
+#define VALID_SLICE_BITMAP_WORDS ((SLICES_PER_BLOCK + 31) / 32)
+
+/**
+ * @brief The valid slices of all the blocks, one bit per slice, check `SET_VSA_VALID()`.
+ *
+ * A bit is set when its slice is mapped and cleared when the slice is invalidated, so GC
+ * finds the valid slices of a victim without probing the logical slice map.
+ */
+typedef struct _VALID_SLICE_BITMAP
+{
+    unsigned int block[USER_DIES][USER_BLOCKS_PER_DIE][VALID_SLICE_BITMAP_WORDS];
+} VALID_SLICE_BITMAP, *P_VALID_SLICE_BITMAP;
+
 /**
  * @brief The metadata for this die.
  *
@@ -258,7 +307,8 @@ typedef struct _VIRTUAL_BLOCK_MAP
  */
 typedef struct _VIRTUAL_DIE_ENTRY
 {
-    unsigned int currentBlock : 16;  // the current working block number of this die
+    /* the current working block of each write stream, `BLOCK_NONE` until its first write */
+    unsigned short currentBlock[WRITE_STREAM_COUNT];
     unsigned int headFreeBlock : 16; // virtual block map index of the first free block of this die
     unsigned int tailFreeBlock : 16; // virtual block map index of the last free block of this die
     unsigned int freeBlockCnt : 16;  // how many free blocks on this die
@@ -347,6 +397,7 @@ typedef struct _CH_INFO
 void InitAddressMap();
 void InitSliceMap();
 void InitBlockDieMap();
+unsigned int FormatBlockMap();
 
 unsigned int AddrTransRead(unsigned int logicalSliceAddr);
 unsigned int AddrTransWrite(unsigned int logicalSliceAddr);
@@ -355,15 +406,19 @@ void UnstashCurrentBlock();
 
 void nmcEnableBlkInterleaving();
 void nmcDisableBlkInterleaving();
-unsigned int FindFreeVirtualSlice();
-unsigned int FindFreeVirtualSliceForGc(unsigned int copyTargetDieNo, unsigned int victimBlockNo);
+unsigned int FindFreeVirtualSlice(unsigned int stream);
+unsigned int FindFreeVirtualSliceForGc(unsigned int copyTargetDieNo);
+void CloseCurrentBlock(unsigned int dieNo, unsigned int blockNo);
 unsigned int FindDieForFreeSliceAllocation();
 void ResetTargetDie();
 
 void InvalidateOldVsa(unsigned int logicalSliceAddr);
+unsigned int DeallocateLogicalSlices(unsigned int startLsa, unsigned int sliceCnt);
 void EraseBlock(unsigned int dieNo, unsigned int blockNo);
+void ResetErasedBlockMap(unsigned int dieNo, unsigned int blockNo);
 
 void PutToFbList(unsigned int dieNo, unsigned int blockNo);
+void SettlePendingFreeBlocks();
 unsigned int GetFromFbList(unsigned int dieNo, unsigned int getFreeBlockOption);
 uint32_t SelectiveGetFromFbList(uint32_t dieNo, uint32_t targetBlk, uint32_t mode);
 
@@ -378,11 +433,13 @@ extern P_CH_INFO channelInfo;
 extern P_LOGICAL_SLICE_MAP logicalSliceMapPtr;
 extern P_VIRTUAL_SLICE_MAP virtualSliceMapPtr;
 extern P_VIRTUAL_BLOCK_MAP virtualBlockMapPtr;
+extern P_VALID_SLICE_BITMAP validSliceBitmapPtr;
 extern P_VIRTUAL_DIE_MAP virtualDieMapPtr;
 extern P_PHY_BLOCK_MAP phyBlockMapPtr;
 extern P_BAD_BLOCK_TABLE_INFO_MAP bbtInfoMapPtr;
 
 extern unsigned char sliceAllocationTargetDie;
+extern unsigned int dieSelectionSkipCnt;
 extern unsigned int mbPerbadBlockSpace;
 
 /* -------------------------------------------------------------------------- */
@@ -400,13 +457,33 @@ extern unsigned int mbPerbadBlockSpace;
 #define VBLK_NEXT_IDX(iDie, iBlk)   (VBLK_ENTRY((iDie), (iBlk))->nextBlock)
 #define VBLK_PREV_ENTRY(iDie, iBlk) (VBLK_ENTRY((iDie), VBLK_PREV_IDX((iDie), (iBlk))))
 #define VBLK_NEXT_ENTRY(iDie, iBlk) (VBLK_ENTRY((iDie), VBLK_NEXT_IDX((iDie), (iBlk))))
+#define VBLK_VALID_BITS(iDie, iBlk) (validSliceBitmapPtr->block[(iDie)][(iBlk)])
 #define PBLK_ENTRY(iDie, iBlk)      (&phyBlockMapPtr->phyBlock[(iDie)][(iBlk)])
 
-#define LSA_ENTRY(lsa) (&logicalSliceMapPtr->logicalSlice[(lsa)])
+/**
+ * The logical slice map is only accessed through `LSA2VSA()` and `SET_LSA2VSA()`, which go
+ * through the translation page cache in demand paged mode, check `address_map_cache.h`.
+ */
+#if (ADDR_MAP_MODE == ADDR_MAP_MODE_DEMAND)
+#define LSA2VSA(lsa)          (GetAddrMapEntry((lsa)))
+#define SET_LSA2VSA(lsa, vsa) (SetAddrMapEntry((lsa), (vsa)))
+#else
+#define LSA_ENTRY(lsa)        (&logicalSliceMapPtr->logicalSlice[(lsa)])
+#define LSA2VSA(lsa)          (LSA_ENTRY((lsa))->virtualSliceAddr)
+#define SET_LSA2VSA(lsa, vsa) (LSA2VSA((lsa)) = (vsa))
+#endif
 #define VSA_ENTRY(vsa) (&virtualSliceMapPtr->virtualSlice[(vsa)])
-#define LSA2VSA(lsa)   (LSA_ENTRY((lsa))->virtualSliceAddr)
 #define VSA2LSA(vsa)   (VSA_ENTRY((vsa))->logicalSliceAddr)
 
+/**
+ * The valid slice bitmap follows the slice maps: `SET_VSA_VALID()` whenever a slice is
+ * mapped to its logical slice, and `CLEAR_VSA_VALID()` whenever it is invalidated.
+ */
+#define VSA_VALID_WORD(vsa)  (VBLK_VALID_BITS(VSA2VDIE((vsa)), VSA2VBLK((vsa)))[VSA2VPAGE((vsa)) / 32])
+#define VSA_VALID_MASK(vsa)  (1U << (VSA2VPAGE((vsa)) % 32))
+#define SET_VSA_VALID(vsa)   (VSA_VALID_WORD((vsa)) |= VSA_VALID_MASK((vsa)))
+#define CLEAR_VSA_VALID(vsa) (VSA_VALID_WORD((vsa)) &= ~VSA_VALID_MASK((vsa)))
+
 #define VDIE2PCH(iDie)              (Vdie2PchTranslation((iDie)))
 #define VDIE2PWAY(iDie)             (Vdie2PwayTranslation((iDie)))
 #define VSA2VDIE(vsa)               (Vsa2VdieTranslation((vsa)))
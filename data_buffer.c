@@ -43,8 +43,13 @@
 //   - First draft
 //////////////////////////////////////////////////////////////////////////////////
 
+#ifdef NSC_SIMULATOR
+#include "sim/xil_printf.h"
+#else
 #include "xil_printf.h"
+#endif
 #include <assert.h>
+#include <string.h>
 #include "debug.h"
 
 #include "memory_map.h"
@@ -55,39 +60,132 @@ P_DATA_BUF_MAP dataBufMapPtr;
 DATA_BUF_LRU_LIST dataBufLruList;
 P_DATA_BUF_HASH_TABLE dataBufHashTablePtr;
 P_TEMPORARY_DATA_BUF_MAP tempDataBufMapPtr;
+P_DATA_BUF_GHOST_MAP dataBufGhostMapPtr;
+DATA_BUF_ARC_STATE dataBufArc;
+DATA_BUF_READ_AHEAD_LIST dataBufReadAheadList;
+DATA_BUF_STATISTICS dataBufStat;
+unsigned int dataBufEntryCount = DATA_BUF_DEFAULT_ENTRY_COUNT;
+unsigned int dataBufHashSlotMask;
+static unsigned int dataBufBgFlushing; // the dirty count crossed the high watermark
 
 P_PARTIAL_DATA_MAP dataPartialResult;
 P_SPECIAL_DATA_HEADER specialDataHeader;
 /**
- * @brief Initialization process of the Data buffer.
- *
- * Three buffer related lists will be initialized in this function
+ * @brief Initialize the data buffer entries and the lists of them.
  *
- * There are `16 x NUM_DIES` entries in the `dataBuf`, and all the elements of `dataBuf`
+ * There are `dataBufEntryCount` entries in the `dataBuf`, and all the elements of `dataBuf`
  * will be initialized to:
  *
  * - logicalSliceAddr: not belongs to any request yet, thus just point to LSA_NONE (0xffffffff)
  * - prevEntry points to prev element of the `dataBuf` array (except for head)
  * - nextEntry points to next element of the `dataBuf` array (except for tail)
- * - hashPrevEntry points to DATA_BUF_NONE, because it doesn't belongs to any bucket yet
- * - hashNextEntry points to DATA_BUF_NONE, because it doesn't belongs to any bucket yet
  * - dirty flag is not set
  * - blockingReqTail: no blocking request at the beginning, thus points to none
  * - dontCache: this buffer entry should not be cached (be inserted into hash list)
  *
- * There are `16 x NUM_DIES` entries in the `dataBufHashTable`, and all the elements will
- * be initialized to empty bucket, so:
- *
- * - headEntry and tailEntry both point to DATA_BUF_NONE (0xffff = 65535)
- *
- * There are `NUM_DIES` entries in the `tempDataBuf`, and all the elements of it will be
- * initialized to:
+ * The hash table uses the smallest power of 2 slots not less than twice of the entries,
+ * and all the slots are initialized to empty slot, so:
  *
- * - blockingReqTail: no blocking request at the beginning, thus points to none
+ * - bufEntry points to DATA_BUF_NONE (0xffff = 65535)
  *
  * And the head/tail of `dataBufLruList` points to the first/last entry of `dataBuf`, this
  * means the initial `dataBufLruList` contains all the data buffer entries, therefore the
  * data buffer should be allocated from the last element of `dataBuf` array.
+ *
+ * For ARC, all the data buffer entries belong to T1 at the beginning, and all the ghost
+ * entries are linked into the free ghost list.
+ *
+ * No entry is filled by read-ahead at the beginning.
+ */
+static void InitDataBufEntries()
+{
+    unsigned int bufEntry;
+
+    for (bufEntry = 0; bufEntry < dataBufEntryCount; bufEntry++)
+    {
+        dataBufMapPtr->dataBuf[bufEntry].logicalSliceAddr = LSA_NONE;
+        dataBufMapPtr->dataBuf[bufEntry].prevEntry        = bufEntry - 1;
+        dataBufMapPtr->dataBuf[bufEntry].nextEntry        = bufEntry + 1;
+        dataBufMapPtr->dataBuf[bufEntry].dirty            = DATA_BUF_CLEAN;
+        dataBufMapPtr->dataBuf[bufEntry].phyReq           = DATA_BUF_FOR_LOG_REQ;
+        dataBufMapPtr->dataBuf[bufEntry].dontCache        = DATA_BUF_KEEP_CACHE;
+        dataBufMapPtr->dataBuf[bufEntry].blockingReqTail  = REQ_SLOT_TAG_NONE;
+        dataBufMapPtr->dataBuf[bufEntry].arcList          = DATA_BUF_ARC_T1;
+        dataBufMapPtr->dataBuf[bufEntry].validSectors     = DATA_BUF_ALL_SECTORS_VALID;
+        dataBufMapPtr->dataBuf[bufEntry].readAhead        = 0;
+        dataBufMapPtr->dataBuf[bufEntry].dirtyPrevEntry   = DATA_BUF_NONE;
+        dataBufMapPtr->dataBuf[bufEntry].dirtyNextEntry   = DATA_BUF_NONE;
+    }
+
+    dataBufMapPtr->dataBuf[0].prevEntry                     = DATA_BUF_NONE;
+    dataBufMapPtr->dataBuf[dataBufEntryCount - 1].nextEntry = DATA_BUF_NONE;
+    dataBufLruList.headEntry                                = 0;
+    dataBufLruList.tailEntry                                = dataBufEntryCount - 1;
+
+    for (dataBufHashSlotMask = 1; dataBufHashSlotMask < 2 * dataBufEntryCount; dataBufHashSlotMask <<= 1)
+        ;
+    dataBufHashSlotMask--;
+
+    for (bufEntry = 0; bufEntry <= dataBufHashSlotMask; bufEntry++)
+    {
+        dataBufHashTablePtr->slot[bufEntry].logicalSliceAddr = LSA_NONE;
+        dataBufHashTablePtr->slot[bufEntry].bufEntry         = DATA_BUF_NONE;
+        dataBufHashTablePtr->slot[bufEntry].phyReq           = 0;
+        dataBufHashTablePtr->slot[bufEntry].probeDist        = 0;
+    }
+
+    for (bufEntry = 0; bufEntry < DATA_BUF_DIRTY_LIST_COUNT; bufEntry++)
+    {
+        dataBufMapPtr->dirtyList[bufEntry].headEntry = DATA_BUF_NONE;
+        dataBufMapPtr->dirtyList[bufEntry].tailEntry = DATA_BUF_NONE;
+    }
+    dataBufMapPtr->dirtyCnt = 0;
+
+    for (bufEntry = 0; bufEntry < dataBufEntryCount; bufEntry++)
+    {
+        GHOST_ENTRY(bufEntry)->logicalSliceAddr = LSA_NONE;
+        GHOST_ENTRY(bufEntry)->prevEntry        = DATA_BUF_NONE;
+        GHOST_ENTRY(bufEntry)->nextEntry        = bufEntry + 1;
+        GHOST_ENTRY(bufEntry)->hashPrevEntry    = DATA_BUF_NONE;
+        GHOST_ENTRY(bufEntry)->hashNextEntry    = DATA_BUF_NONE;
+    }
+    GHOST_ENTRY(dataBufEntryCount - 1)->nextEntry = DATA_BUF_NONE;
+
+    for (bufEntry = 0; bufEntry <= (dataBufHashSlotMask >> 1); bufEntry++)
+    {
+        GHOST_H_ENTRY(bufEntry)->headEntry = DATA_BUF_NONE;
+        GHOST_H_ENTRY(bufEntry)->tailEntry = DATA_BUF_NONE;
+    }
+
+    dataBufArc.t1HeadEntry    = dataBufLruList.headEntry;
+    dataBufArc.freeGhostEntry = 0;
+    dataBufArc.t1Cnt          = dataBufEntryCount;
+    dataBufArc.t2Cnt          = 0;
+    dataBufArc.t1Target       = 0;
+    for (bufEntry = DATA_BUF_ARC_T1; bufEntry <= DATA_BUF_ARC_T2; bufEntry++)
+    {
+        dataBufArc.ghostList[bufEntry].headEntry = DATA_BUF_NONE;
+        dataBufArc.ghostList[bufEntry].tailEntry = DATA_BUF_NONE;
+        dataBufArc.ghostCnt[bufEntry]            = 0;
+    }
+
+    dataBufReadAheadList.headEntry = DATA_BUF_NONE;
+    dataBufReadAheadList.cnt       = 0;
+
+    dataBufBgFlushing = 0;
+}
+
+/**
+ * @brief Initialization process of the Data buffer.
+ *
+ * The number of data buffer entries is taken from `dataBufEntryCount`, which can be set
+ * before boot (default `DATA_BUF_DEFAULT_ENTRY_COUNT`), then the entries, the hash table
+ * and the lists are initialized by `InitDataBufEntries()`.
+ *
+ * There are `TEMP_DATA_BUF_ENTRY_COUNT_PER_DIE` entries of each die in the `tempDataBuf`,
+ * and all the elements of it will be initialized to:
+ *
+ * - blockingReqTail: no blocking request at the beginning, thus points to none
  */
 void InitDataBuf()
 {
@@ -96,6 +194,7 @@ void InitDataBuf()
     dataBufMapPtr       = (P_DATA_BUF_MAP)DATA_BUFFER_MAP_ADDR;
     dataBufHashTablePtr = (P_DATA_BUF_HASH_TABLE)DATA_BUFFFER_HASH_TABLE_ADDR;
     tempDataBufMapPtr   = (P_TEMPORARY_DATA_BUF_MAP)TEMPORARY_DATA_BUFFER_MAP_ADDR;
+    dataBufGhostMapPtr  = (P_DATA_BUF_GHOST_MAP)DATA_BUFFER_GHOST_MAP_ADDR;
     dataPartialResult   = (P_PARTIAL_DATA_MAP)PARTIAL_DATA_BUFFER_MAP_ADDR;
 
     dataPartialResult->partial_dataBuf[0].verify_data_address = 0x30000000;
@@ -103,101 +202,712 @@ void InitDataBuf()
     specialDataHeader   = (P_SPECIAL_DATA_HEADER)SPECIAL_DATA_HEADER_ADDR;
     dataPartialResult->partial_dataBuf[0].receive_data_address = 0x30000000;
 
-    for (bufEntry = 0; bufEntry < AVAILABLE_DATA_BUFFER_ENTRY_COUNT; bufEntry++)
+    if (dataBufEntryCount < DATA_BUF_MIN_ENTRY_COUNT || dataBufEntryCount > DATA_BUF_MAX_ENTRY_COUNT)
     {
-        dataBufMapPtr->dataBuf[bufEntry].logicalSliceAddr = LSA_NONE;
-        dataBufMapPtr->dataBuf[bufEntry].prevEntry        = bufEntry - 1;
-        dataBufMapPtr->dataBuf[bufEntry].nextEntry        = bufEntry + 1;
-        dataBufMapPtr->dataBuf[bufEntry].dirty            = DATA_BUF_CLEAN;
-        dataBufMapPtr->dataBuf[bufEntry].phyReq           = DATA_BUF_FOR_LOG_REQ;
-        dataBufMapPtr->dataBuf[bufEntry].dontCache        = DATA_BUF_KEEP_CACHE;
-        dataBufMapPtr->dataBuf[bufEntry].blockingReqTail  = REQ_SLOT_TAG_NONE;
-
-        dataBufHashTablePtr->dataBufHash[bufEntry].headEntry = DATA_BUF_NONE;
-        dataBufHashTablePtr->dataBufHash[bufEntry].tailEntry = DATA_BUF_NONE;
-        dataBufMapPtr->dataBuf[bufEntry].hashPrevEntry       = DATA_BUF_NONE;
-        dataBufMapPtr->dataBuf[bufEntry].hashNextEntry       = DATA_BUF_NONE;
+        pr_warn("Invalid number of data buffer entries %u, use %u instead", dataBufEntryCount,
+                DATA_BUF_DEFAULT_ENTRY_COUNT);
+        dataBufEntryCount = DATA_BUF_DEFAULT_ENTRY_COUNT;
     }
+    pr_info("Data buffer: %u entries", dataBufEntryCount);
+
+    InitDataBufEntries();
 
-    dataBufMapPtr->dataBuf[0].prevEntry                                     = DATA_BUF_NONE;
-    dataBufMapPtr->dataBuf[AVAILABLE_DATA_BUFFER_ENTRY_COUNT - 1].nextEntry = DATA_BUF_NONE;
-    dataBufLruList.headEntry                                                = 0;
-    dataBufLruList.tailEntry = AVAILABLE_DATA_BUFFER_ENTRY_COUNT - 1;
+    dataBufStat.hitCnt            = 0;
+    dataBufStat.missCnt           = 0;
+    dataBufStat.ghostHitCnt[0]    = 0;
+    dataBufStat.ghostHitCnt[1]    = 0;
+    dataBufStat.readAheadCnt      = 0;
+    dataBufStat.readAheadHitCnt   = 0;
+    dataBufStat.readAheadWasteCnt = 0;
+    dataBufStat.bgFlushCnt        = 0;
+    dataBufStat.coalescedRxDmaCnt = 0;
+    dataBufStat.discardCnt        = 0;
+    dataBufStat.zeroReadCnt       = 0;
+
+    memset((void *)ZERO_DATA_BUFFER_ADDR, 0, BYTES_PER_DATA_REGION_OF_SLICE);
 
     for (bufEntry = 0; bufEntry < AVAILABLE_TEMPORARY_DATA_BUFFER_ENTRY_COUNT; bufEntry++)
         tempDataBufMapPtr->tempDataBuf[bufEntry].blockingReqTail = REQ_SLOT_TAG_NONE;
+    for (bufEntry = 0; bufEntry < USER_DIES; bufEntry++)
+        tempDataBufMapPtr->nextEntry[bufEntry] = 0;
 }
 
+/**
+ * @brief Get the dirty list the given data buffer entry should be linked into.
+ *
+ * @param bufEntry the index of the data buffer entry
+ */
+static P_DATA_BUF_LRU_LIST GetDataBufDirtyList(unsigned int bufEntry)
+{
+    if (BUF_ENTRY(bufEntry)->phyReq)
+        return &dataBufMapPtr->dirtyList[VSA2VDIE(BUF_LSA(bufEntry))];
+
+    return &dataBufMapPtr->dirtyList[DATA_BUF_DIRTY_LIST_LOG];
+}
+
+/**
+ * @brief Mark the given data buffer entry dirty and append it to the tail of its dirty list.
+ *
+ * The `logicalSliceAddr` and `phyReq` of the entry must be set before calling this.
+ *
+ * @param bufEntry the index of the data buffer entry to be marked
+ */
+void MarkDataBufDirty(unsigned int bufEntry)
+{
+    P_DATA_BUF_LRU_LIST dirtyList;
+
+    if (BUF_ENTRY(bufEntry)->dirty == DATA_BUF_DIRTY)
+        return;
+
+    dirtyList = GetDataBufDirtyList(bufEntry);
+
+    BUF_ENTRY(bufEntry)->dirtyPrevEntry = dirtyList->tailEntry;
+    BUF_ENTRY(bufEntry)->dirtyNextEntry = DATA_BUF_NONE;
+    if (dirtyList->tailEntry != DATA_BUF_NONE)
+        BUF_ENTRY(dirtyList->tailEntry)->dirtyNextEntry = bufEntry;
+    else
+        dirtyList->headEntry = bufEntry;
+    dirtyList->tailEntry = bufEntry;
+
+    BUF_ENTRY(bufEntry)->dirty = DATA_BUF_DIRTY;
+    dataBufMapPtr->dirtyCnt++;
+}
+
+/**
+ * @brief Mark the given data buffer entry clean and remove it from its dirty list.
+ *
+ * @param bufEntry the index of the data buffer entry to be marked
+ */
+void MarkDataBufClean(unsigned int bufEntry)
+{
+    P_DATA_BUF_LRU_LIST dirtyList;
+    unsigned int prevBufEntry, nextBufEntry;
+
+    if (BUF_ENTRY(bufEntry)->dirty == DATA_BUF_CLEAN)
+        return;
+
+    dirtyList    = GetDataBufDirtyList(bufEntry);
+    prevBufEntry = BUF_ENTRY(bufEntry)->dirtyPrevEntry;
+    nextBufEntry = BUF_ENTRY(bufEntry)->dirtyNextEntry;
+
+    if (prevBufEntry != DATA_BUF_NONE)
+        BUF_ENTRY(prevBufEntry)->dirtyNextEntry = nextBufEntry;
+    else
+        dirtyList->headEntry = nextBufEntry;
+    if (nextBufEntry != DATA_BUF_NONE)
+        BUF_ENTRY(nextBufEntry)->dirtyPrevEntry = prevBufEntry;
+    else
+        dirtyList->tailEntry = prevBufEntry;
+
+    BUF_ENTRY(bufEntry)->dirtyPrevEntry = DATA_BUF_NONE;
+    BUF_ENTRY(bufEntry)->dirtyNextEntry = DATA_BUF_NONE;
+    BUF_ENTRY(bufEntry)->dirty          = DATA_BUF_CLEAN;
+    dataBufMapPtr->dirtyCnt--;
+}
+
+/**
+ * @brief Issue a flash write request for the given dirty data buffer entry.
+ *
+ * @param cmdSlotTag the NVMe command slot tag the write request belongs to
+ * @param iBufEntry the index of the dirty data buffer entry
+ */
+static void FlushDataBufEntry(uint32_t cmdSlotTag, uint32_t iBufEntry)
+{
+    uint32_t iCh, iWay, iDie, iPBlk, iPage, iReqEntry, vsa;
+    P_DATA_BUF_ENTRY bufEntry = BUF_ENTRY(iBufEntry);
+
+    if (bufEntry->phyReq)
+    {
+        // FIXME: we should program a page once before that page being erased
+        vsa   = bufEntry->logicalSliceAddr;
+        iDie  = VSA2VDIE(vsa);
+        iCh   = VDIE2PCH(iDie);
+        iWay  = VDIE2PWAY(iDie);
+        iPBlk = VSA2VBLK(vsa);
+        iPage = VSA2VPAGE(vsa);
+
+        iReqEntry = GetFromFreeReqQ();
+
+        REQ_ENTRY(iReqEntry)->reqType                       = REQ_TYPE_NAND;
+        REQ_ENTRY(iReqEntry)->reqCode                       = REQ_CODE_WRITE;
+        REQ_ENTRY(iReqEntry)->nvmeCmdSlotTag                = cmdSlotTag;
+        REQ_ENTRY(iReqEntry)->logicalSliceAddr              = bufEntry->logicalSliceAddr;
+        REQ_ENTRY(iReqEntry)->reqOpt.dataBufFormat          = REQ_OPT_DATA_BUF_ENTRY;
+        REQ_ENTRY(iReqEntry)->reqOpt.nandAddr               = REQ_OPT_NAND_ADDR_PHY_ORG;
+        REQ_ENTRY(iReqEntry)->reqOpt.nandEcc                = REQ_OPT_NAND_ECC_ON;
+        REQ_ENTRY(iReqEntry)->reqOpt.nandEccWarning         = REQ_OPT_NAND_ECC_WARNING_ON;
+        REQ_ENTRY(iReqEntry)->reqOpt.rowAddrDependencyCheck = REQ_OPT_ROW_ADDR_DEPENDENCY_NONE;
+        REQ_ENTRY(iReqEntry)->reqOpt.blockSpace             = REQ_OPT_BLOCK_SPACE_TOTAL;
+        REQ_ENTRY(iReqEntry)->dataBufInfo.entry             = iBufEntry;
+        REQ_ENTRY(iReqEntry)->nandInfo.physicalCh           = iCh;
+        REQ_ENTRY(iReqEntry)->nandInfo.physicalWay          = iWay;
+        REQ_ENTRY(iReqEntry)->nandInfo.physicalBlock        = iPBlk;
+        REQ_ENTRY(iReqEntry)->nandInfo.physicalPage         = iPage;
+
+        pr_info("Req[%u]: Write C/W[%u/%u].PBlk[%u].Page[%u]", iReqEntry, iCh, iWay, iPBlk, iPage);
+    }
+    else
+    {
+        // the old content must be read before the old VSA being invalidated
+        DataMergeFromNand(iBufEntry, cmdSlotTag);
+
+        iReqEntry = GetFromFreeReqQ();
+        vsa       = AddrTransWrite(bufEntry->logicalSliceAddr);
+
+        REQ_ENTRY(iReqEntry)->reqType                       = REQ_TYPE_NAND;
+        REQ_ENTRY(iReqEntry)->reqCode                       = REQ_CODE_WRITE;
+        REQ_ENTRY(iReqEntry)->nvmeCmdSlotTag                = cmdSlotTag;
+        REQ_ENTRY(iReqEntry)->logicalSliceAddr              = bufEntry->logicalSliceAddr;
+        REQ_ENTRY(iReqEntry)->reqOpt.dataBufFormat          = REQ_OPT_DATA_BUF_ENTRY;
+        REQ_ENTRY(iReqEntry)->reqOpt.nandAddr               = REQ_OPT_NAND_ADDR_VSA;
+        REQ_ENTRY(iReqEntry)->reqOpt.nandEcc                = REQ_OPT_NAND_ECC_ON;
+        REQ_ENTRY(iReqEntry)->reqOpt.nandEccWarning         = REQ_OPT_NAND_ECC_WARNING_ON;
+        REQ_ENTRY(iReqEntry)->reqOpt.rowAddrDependencyCheck = REQ_OPT_ROW_ADDR_DEPENDENCY_CHECK;
+        REQ_ENTRY(iReqEntry)->reqOpt.blockSpace             = REQ_OPT_BLOCK_SPACE_MAIN;
+        REQ_ENTRY(iReqEntry)->dataBufInfo.entry             = iBufEntry;
+        REQ_ENTRY(iReqEntry)->nandInfo.virtualSliceAddr     = vsa;
+        REQ_ENTRY(iReqEntry)->nandInfo.writeSeq             = addrJournal.writeSeq;
+    }
+
+    UpdateDataBufEntryInfoBlockingReq(iBufEntry, iReqEntry);
+    SelectLowLevelReqQ(iReqEntry);
+
+    MarkDataBufClean(iBufEntry);
+}
+
+/**
+ * @brief Copy the merged NVMe blocks from the merge buffer to the data buffer entry.
+ *
+ * Called when a merge read issued by `DataMergeFromNand()` is completed. Only the blocks
+ * which were missing when the merge read was issued are copied, the other blocks of the
+ * entry hold newer data received from host.
+ *
+ * @param reqSlotTag the request pool entry index of the completed merge read
+ */
+void MergeDataBufEntry(unsigned int reqSlotTag)
+{
+    unsigned int iSector, mergeMask = REQ_ENTRY(reqSlotTag)->reqOpt.dataBufMergeMask;
+    uintptr_t srcAddr = MERGE_BUF_DATA_ENTRY2ADDR(VSA2VDIE(REQ_ENTRY(reqSlotTag)->nandInfo.virtualSliceAddr));
+    uintptr_t dstAddr = BUF_DATA_ENTRY2ADDR(REQ_ENTRY(reqSlotTag)->dataBufInfo.entry);
+
+    for (iSector = 0; iSector < NVME_BLOCKS_PER_SLICE; iSector++)
+        if (mergeMask & (1 << iSector))
+            memcpy((void *)(dstAddr + iSector * BYTES_PER_NVME_BLOCK),
+                   (void *)(srcAddr + iSector * BYTES_PER_NVME_BLOCK), BYTES_PER_NVME_BLOCK);
+
+    memcpy((void *)BUF_SPARE_ENTRY2ADDR(REQ_ENTRY(reqSlotTag)->dataBufInfo.entry),
+           (void *)MERGE_BUF_SPARE_ENTRY2ADDR(VSA2VDIE(REQ_ENTRY(reqSlotTag)->nandInfo.virtualSliceAddr)),
+           BYTES_PER_SPARE_REGION_OF_SLICE);
+}
+
+/**
+ * @brief Write all the dirty data buffer entries back to flash.
+ *
+ * Only the dirty lists are traversed:
+ *
+ * 1. The entries for logical addr are flushed from the oldest one, their VSAs are then
+ *    allocated die by die (check `FindDieForFreeSliceAllocation()`).
+ *
+ * 2. The entries for physical addr are flushed one die at a time in the order of virtual
+ *    die number (channel first), so the writes are spread over all the channels and ways
+ *    instead of being queued on the same die.
+ *
+ * @param cmdSlotTag the NVMe command slot tag of the flush command
+ */
 void FlushDataBuf(uint32_t cmdSlotTag)
 {
-    uint32_t iCh, iWay, iDie, iPBlk, iPage, iBufEntry, iReqEntry, vsa;
-    P_DATA_BUF_ENTRY bufEntry;
+    uint32_t iDie, iBufEntry, issued;
 
     // TODO: NMC: stash current block
-    // traverse data buf LRU list from LRU entry to MRU entry
-    for (iBufEntry = BUF_TAIL_IDX(); iBufEntry != DATA_BUF_NONE; iBufEntry = BUF_PREV_IDX(iBufEntry))
-    {
-        // get corresponding buffer entry
-        bufEntry = BUF_ENTRY(iBufEntry);
+    while ((iBufEntry = dataBufMapPtr->dirtyList[DATA_BUF_DIRTY_LIST_LOG].headEntry) != DATA_BUF_NONE)
+        FlushDataBufEntry(cmdSlotTag, iBufEntry);
 
-        // flush buffer entry
-        if (bufEntry->dirty == DATA_BUF_DIRTY && bufEntry->dontCache == DATA_BUF_KEEP_CACHE)
+    do
+    {
+        issued = 0;
+        for (iDie = 0; iDie < USER_DIES; iDie++)
         {
-            if (bufEntry->phyReq)
+            iBufEntry = dataBufMapPtr->dirtyList[iDie].headEntry;
+            if (iBufEntry != DATA_BUF_NONE)
             {
-                // FIXME: we should program a page once before that page being erased
-                vsa   = bufEntry->logicalSliceAddr;
-                iDie  = VSA2VDIE(vsa);
-                iCh   = VDIE2PCH(iDie);
-                iWay  = VDIE2PWAY(iDie);
-                iPBlk = VSA2VBLK(vsa);
-                iPage = VSA2VPAGE(vsa);
-
-                iReqEntry = GetFromFreeReqQ();
-
-                REQ_ENTRY(iReqEntry)->reqType                       = REQ_TYPE_NAND;
-                REQ_ENTRY(iReqEntry)->reqCode                       = REQ_CODE_WRITE;
-                REQ_ENTRY(iReqEntry)->nvmeCmdSlotTag                = cmdSlotTag;
-                REQ_ENTRY(iReqEntry)->logicalSliceAddr              = bufEntry->logicalSliceAddr;
-                REQ_ENTRY(iReqEntry)->reqOpt.dataBufFormat          = REQ_OPT_DATA_BUF_ENTRY;
-                REQ_ENTRY(iReqEntry)->reqOpt.nandAddr               = REQ_OPT_NAND_ADDR_PHY_ORG;
-                REQ_ENTRY(iReqEntry)->reqOpt.nandEcc                = REQ_OPT_NAND_ECC_ON;
-                REQ_ENTRY(iReqEntry)->reqOpt.nandEccWarning         = REQ_OPT_NAND_ECC_WARNING_ON;
-                REQ_ENTRY(iReqEntry)->reqOpt.rowAddrDependencyCheck = REQ_OPT_ROW_ADDR_DEPENDENCY_NONE;
-                REQ_ENTRY(iReqEntry)->reqOpt.blockSpace             = REQ_OPT_BLOCK_SPACE_TOTAL;
-                REQ_ENTRY(iReqEntry)->dataBufInfo.entry             = iBufEntry;
-                REQ_ENTRY(iReqEntry)->nandInfo.physicalCh           = iCh;
-                REQ_ENTRY(iReqEntry)->nandInfo.physicalWay          = iWay;
-                REQ_ENTRY(iReqEntry)->nandInfo.physicalBlock        = iPBlk;
-                REQ_ENTRY(iReqEntry)->nandInfo.physicalPage         = iPage;
-
-                pr_info("Req[%u]: Write C/W[%u/%u].PBlk[%u].Page[%u]", iReqEntry, iCh, iWay, iPBlk, iPage);
+                FlushDataBufEntry(cmdSlotTag, iBufEntry);
+                issued++;
             }
-            else
+        }
+    } while (issued);
+}
+
+/**
+ * @brief Remove the given data buffer entry from the LRU list.
+ *
+ * @param bufEntry the index of the data buffer entry to be removed
+ */
+static void UnlinkFromDataBufLruList(unsigned int bufEntry)
+{
+    if ((!BUF_ENTRY_IS_HEAD(bufEntry)) && (!BUF_ENTRY_IS_TAIL(bufEntry)))
+    {
+        // body of LRU list
+        BUF_PREV_ENTRY(bufEntry)->nextEntry = BUF_NEXT_IDX(bufEntry);
+        BUF_NEXT_ENTRY(bufEntry)->prevEntry = BUF_PREV_IDX(bufEntry);
+    }
+    else if ((!BUF_ENTRY_IS_HEAD(bufEntry)) && BUF_ENTRY_IS_TAIL(bufEntry))
+    {
+        // tail of LRU list, modify the LRU tail
+        BUF_PREV_ENTRY(bufEntry)->nextEntry = DATA_BUF_NONE;
+        dataBufLruList.tailEntry            = BUF_PREV_IDX(bufEntry);
+    }
+    else if (BUF_ENTRY_IS_HEAD(bufEntry) && (!BUF_ENTRY_IS_TAIL(bufEntry)))
+    {
+        // head of LRU list, modify the LRU head
+        BUF_NEXT_ENTRY(bufEntry)->prevEntry = DATA_BUF_NONE;
+        dataBufLruList.headEntry            = BUF_NEXT_IDX(bufEntry);
+    }
+    else
+    {
+        // the only entry in LRU list, make LRU list empty
+        dataBufLruList.tailEntry = DATA_BUF_NONE;
+        dataBufLruList.headEntry = DATA_BUF_NONE;
+    }
+}
+
+/**
+ * @brief Insert the given data buffer entry into the LRU list before `nextBufEntry`.
+ *
+ * @param bufEntry the index of the data buffer entry to be inserted
+ * @param nextBufEntry the entry to be placed after `bufEntry`, `DATA_BUF_NONE` for tail
+ */
+static void LinkToDataBufLruList(unsigned int bufEntry, unsigned int nextBufEntry)
+{
+    unsigned int prevBufEntry = (nextBufEntry == DATA_BUF_NONE) ? BUF_TAIL_IDX() : BUF_PREV_IDX(nextBufEntry);
+
+    BUF_ENTRY(bufEntry)->prevEntry = prevBufEntry;
+    BUF_ENTRY(bufEntry)->nextEntry = nextBufEntry;
+
+    if (prevBufEntry != DATA_BUF_NONE)
+        BUF_ENTRY(prevBufEntry)->nextEntry = bufEntry;
+    else
+        dataBufLruList.headEntry = bufEntry;
+
+    if (nextBufEntry != DATA_BUF_NONE)
+        BUF_ENTRY(nextBufEntry)->prevEntry = bufEntry;
+    else
+        dataBufLruList.tailEntry = bufEntry;
+}
+
+/**
+ * @brief Get the LRU entry of the LRU list, excluding the entries filled by read-ahead.
+ */
+static unsigned int GetDataBufResidentTail()
+{
+    if (dataBufReadAheadList.headEntry != DATA_BUF_NONE)
+        return BUF_PREV_IDX(dataBufReadAheadList.headEntry);
+
+    return BUF_TAIL_IDX();
+}
+
+/**
+ * @brief Remove the given read-ahead entry from the read-ahead list and the LRU list.
+ *
+ * @param bufEntry the index of the read-ahead entry to be removed
+ */
+static void UnlinkFromReadAheadList(unsigned int bufEntry)
+{
+    // the next entry of the latest read-ahead entry is still a read-ahead entry (or none)
+    if (dataBufReadAheadList.headEntry == bufEntry)
+        dataBufReadAheadList.headEntry = BUF_NEXT_IDX(bufEntry);
+    dataBufReadAheadList.cnt--;
+
+    BUF_ENTRY(bufEntry)->readAhead = 0;
+    UnlinkFromDataBufLruList(bufEntry);
+}
+
+/**
+ * @brief Take the oldest read-ahead entry (tail of the LRU list) to be reused.
+ *
+ * It was never referenced by host, so the read-ahead was wasted.
+ */
+static unsigned int ReuseReadAheadDataBuf()
+{
+    unsigned int bufEntry = BUF_TAIL_IDX();
+
+    dataBufStat.readAheadWasteCnt++;
+    UnlinkFromReadAheadList(bufEntry);
+
+    return bufEntry;
+}
+
+/**
+ * @brief Change the number of data buffer entries.
+ *
+ * All the dirty entries are written back and all the pending requests are completed
+ * first, then the data buffer is rebuilt with the new number of entries, all the cached
+ * data are dropped.
+ *
+ * This should only be called between NVMe commands (e.g. by an admin command), when no
+ * slice request is waiting in `sliceReqQ`.
+ *
+ * @param entryCount the new number of data buffer entries
+ * @return unsigned int 1 if resized, 0 if the number is out of range
+ */
+unsigned int ResizeDataBuf(unsigned int entryCount)
+{
+    if (entryCount < DATA_BUF_MIN_ENTRY_COUNT || entryCount > DATA_BUF_MAX_ENTRY_COUNT)
+    {
+        pr_warn("Data buffer: %u entries not in [%u, %u]", entryCount, DATA_BUF_MIN_ENTRY_COUNT,
+                DATA_BUF_MAX_ENTRY_COUNT);
+        return 0;
+    }
+
+    // not issued for any NVMe command
+    FlushDataBuf(0);
+    SyncAllLowLevelReqDone();
+
+    pr_info("Data buffer: resize from %u to %u entries", dataBufEntryCount, entryCount);
+    dataBufEntryCount = entryCount;
+    InitDataBufEntries();
+
+    return 1;
+}
+
+/**
+ * @brief Drop all the cached data without writing back the dirty entries.
+ *
+ * Used when the data of all the logical slices are to be erased (e.g. by Format NVM), the
+ * pending requests are completed first. Like `ResizeDataBuf()`, this should only be called
+ * between NVMe commands.
+ */
+void DropDataBuf()
+{
+    SyncAllLowLevelReqDone();
+    InitDataBufEntries();
+}
+
+/**
+ * @brief Check whether the given die has nothing to do.
+ *
+ * @param iDie the virtual die number
+ */
+static int DataBufDieIsIdle(unsigned int iDie)
+{
+    unsigned int iCh  = VDIE2PCH(iDie);
+    unsigned int iWay = VDIE2PWAY(iDie);
+
+    return dieStateTablePtr->dieState[iCh][iWay].dieState == DIE_STATE_IDLE && !nandReqQ[iCh][iWay].reqCnt &&
+           blockedByRowAddrDepReqQ[iCh][iWay].headReq == REQ_SLOT_TAG_NONE;
+}
+
+/**
+ * @brief Write back the LRU-most dirty data buffer entries while the fw has nothing to do.
+ *
+ * Called from the idle path of the main loop. Once the number of dirty entries reaches
+ * `DATA_BUF_FLUSH_HIGH_WATERMARK`, the entries near the tail of the LRU list (the next
+ * victims of `AllocateDataBuf()`) are written back until `DATA_BUF_FLUSH_LOW_WATERMARK`
+ * is reached, so a miss usually finds a clean victim instead of waiting for a program.
+ *
+ * To avoid delaying the host requests, each pass issues at most one write per die and
+ * only to the idle dies. The entries for logical addr are written to the die selected by
+ * `sliceAllocationTargetDie`, so they are skipped if that die is busy.
+ *
+ * The entries are not evicted, they stay in the buffer as clean entries.
+ */
+void FlushDataBufInBackground()
+{
+    unsigned char issued[USER_DIES];
+    unsigned int iBufEntry, prevBufEntry, iDie, scanCnt;
+
+    if (dataBufMapPtr->dirtyCnt >= DATA_BUF_FLUSH_HIGH_WATERMARK)
+        dataBufBgFlushing = 1;
+    else if (dataBufMapPtr->dirtyCnt <= DATA_BUF_FLUSH_LOW_WATERMARK)
+        dataBufBgFlushing = 0;
+
+    if (!dataBufBgFlushing)
+        return;
+
+    memset(issued, 0, sizeof(issued));
+
+    iBufEntry = GetDataBufResidentTail();
+    for (scanCnt = 0; iBufEntry != DATA_BUF_NONE && scanCnt < DATA_BUF_FLUSH_SCAN_DEPTH; scanCnt++)
+    {
+        if (dataBufMapPtr->dirtyCnt <= DATA_BUF_FLUSH_LOW_WATERMARK)
+        {
+            dataBufBgFlushing = 0;
+            break;
+        }
+        if (freeReqQ.reqCnt <= DATA_BUF_FLUSH_MIN_FREE_REQ)
+            break;
+
+        prevBufEntry = BUF_PREV_IDX(iBufEntry);
+
+        if (BUF_ENTRY(iBufEntry)->dirty == DATA_BUF_DIRTY && BUF_ENTRY(iBufEntry)->dontCache == DATA_BUF_KEEP_CACHE)
+        {
+            iDie = BUF_ENTRY(iBufEntry)->phyReq ? VSA2VDIE(BUF_LSA(iBufEntry)) : sliceAllocationTargetDie;
+            if (!issued[iDie] && DataBufDieIsIdle(iDie))
             {
-                iReqEntry = GetFromFreeReqQ();
-                vsa       = AddrTransWrite(bufEntry->logicalSliceAddr);
-
-                REQ_ENTRY(iReqEntry)->reqType                       = REQ_TYPE_NAND;
-                REQ_ENTRY(iReqEntry)->reqCode                       = REQ_CODE_WRITE;
-                REQ_ENTRY(iReqEntry)->nvmeCmdSlotTag                = cmdSlotTag;
-                REQ_ENTRY(iReqEntry)->logicalSliceAddr              = bufEntry->logicalSliceAddr;
-                REQ_ENTRY(iReqEntry)->reqOpt.dataBufFormat          = REQ_OPT_DATA_BUF_ENTRY;
-                REQ_ENTRY(iReqEntry)->reqOpt.nandAddr               = REQ_OPT_NAND_ADDR_VSA;
-                REQ_ENTRY(iReqEntry)->reqOpt.nandEcc                = REQ_OPT_NAND_ECC_ON;
-                REQ_ENTRY(iReqEntry)->reqOpt.nandEccWarning         = REQ_OPT_NAND_ECC_WARNING_ON;
-                REQ_ENTRY(iReqEntry)->reqOpt.rowAddrDependencyCheck = REQ_OPT_ROW_ADDR_DEPENDENCY_CHECK;
-                REQ_ENTRY(iReqEntry)->reqOpt.blockSpace             = REQ_OPT_BLOCK_SPACE_MAIN;
-                REQ_ENTRY(iReqEntry)->dataBufInfo.entry             = iBufEntry;
-                REQ_ENTRY(iReqEntry)->nandInfo.virtualSliceAddr     = vsa;
+                pr_debug("Buf[%u]: Background write back LSA[%u] to Die[%u]", iBufEntry, BUF_LSA(iBufEntry), iDie);
+
+                // not issued for any NVMe command
+                FlushDataBufEntry(0, iBufEntry);
+                issued[iDie] = 1;
+                dataBufStat.bgFlushCnt++;
             }
+        }
 
-            UpdateDataBufEntryInfoBlockingReq(iBufEntry, iReqEntry);
-            SelectLowLevelReqQ(iReqEntry);
+        iBufEntry = prevBufEntry;
+    }
+}
 
-            bufEntry->dirty = DATA_BUF_CLEAN;
-        }
+#if (DATA_BUF_POLICY == DATA_BUF_POLICY_ARC)
+
+/**
+ * @brief Remove the given data buffer entry from T1 or T2.
+ *
+ * @param bufEntry the index of the data buffer entry to be removed
+ */
+static void ArcUnlinkDataBuf(unsigned int bufEntry)
+{
+    if (BUF_ENTRY(bufEntry)->arcList == DATA_BUF_ARC_T1)
+    {
+        // the next entry of T1 MRU is still in T1, unless it is a read-ahead entry (or none)
+        if (dataBufArc.t1HeadEntry == bufEntry)
+            dataBufArc.t1HeadEntry = (BUF_NEXT_IDX(bufEntry) == dataBufReadAheadList.headEntry)
+                                         ? DATA_BUF_NONE
+                                         : BUF_NEXT_IDX(bufEntry);
+        dataBufArc.t1Cnt--;
+    }
+    else
+        dataBufArc.t2Cnt--;
+
+    UnlinkFromDataBufLruList(bufEntry);
+}
+
+/**
+ * @brief Make the given data buffer entry the MRU entry of T1 or T2.
+ *
+ * @param bufEntry the index of the data buffer entry to be inserted
+ * @param arcList `DATA_BUF_ARC_T1` or `DATA_BUF_ARC_T2`
+ */
+static void ArcLinkDataBuf(unsigned int bufEntry, unsigned int arcList)
+{
+    BUF_ENTRY(bufEntry)->arcList = arcList;
+
+    if (arcList == DATA_BUF_ARC_T1)
+    {
+        LinkToDataBufLruList(bufEntry, (dataBufArc.t1HeadEntry != DATA_BUF_NONE) ? dataBufArc.t1HeadEntry
+                                                                                 : dataBufReadAheadList.headEntry);
+        dataBufArc.t1HeadEntry = bufEntry;
+        dataBufArc.t1Cnt++;
     }
+    else
+    {
+        LinkToDataBufLruList(bufEntry, BUF_HEAD_IDX());
+        dataBufArc.t2Cnt++;
+    }
+}
+
+/**
+ * @brief Find the ghost entry of the given LSA.
+ *
+ * @param logicalSliceAddr the LSA to be searched
+ * @return unsigned int the index of the ghost entry, or `DATA_BUF_NONE` if not found
+ */
+static unsigned int ArcFindGhost(unsigned int logicalSliceAddr)
+{
+    unsigned int ghostEntry;
+
+    if (logicalSliceAddr == LSA_NONE)
+        return DATA_BUF_NONE;
+
+    ghostEntry = GHOST_H_ENTRY(FindDataBufHashTableEntry(logicalSliceAddr))->headEntry;
+    while (ghostEntry != DATA_BUF_NONE && GHOST_ENTRY(ghostEntry)->logicalSliceAddr != logicalSliceAddr)
+        ghostEntry = GHOST_ENTRY(ghostEntry)->hashNextEntry;
+
+    return ghostEntry;
+}
+
+/**
+ * @brief Remove the given ghost entry from its ghost list and bucket, and release it.
+ *
+ * @param ghostEntry the index of the ghost entry to be released
+ */
+static void ArcReleaseGhost(unsigned int ghostEntry)
+{
+    P_DATA_BUF_GHOST_ENTRY ghost = GHOST_ENTRY(ghostEntry);
+    P_DATA_BUF_LRU_LIST list     = &dataBufArc.ghostList[ghost->ghostList];
+    P_DATA_BUF_HASH_ENTRY bucket = GHOST_H_ENTRY(FindDataBufHashTableEntry(ghost->logicalSliceAddr));
+
+    // remove from the ghost list
+    if (ghost->prevEntry != DATA_BUF_NONE)
+        GHOST_ENTRY(ghost->prevEntry)->nextEntry = ghost->nextEntry;
+    else
+        list->headEntry = ghost->nextEntry;
+    if (ghost->nextEntry != DATA_BUF_NONE)
+        GHOST_ENTRY(ghost->nextEntry)->prevEntry = ghost->prevEntry;
+    else
+        list->tailEntry = ghost->prevEntry;
+    dataBufArc.ghostCnt[ghost->ghostList]--;
+
+    // remove from the bucket
+    if (ghost->hashPrevEntry != DATA_BUF_NONE)
+        GHOST_ENTRY(ghost->hashPrevEntry)->hashNextEntry = ghost->hashNextEntry;
+    else
+        bucket->headEntry = ghost->hashNextEntry;
+    if (ghost->hashNextEntry != DATA_BUF_NONE)
+        GHOST_ENTRY(ghost->hashNextEntry)->hashPrevEntry = ghost->hashPrevEntry;
+
+    // put back to the free ghost list
+    ghost->logicalSliceAddr   = LSA_NONE;
+    ghost->nextEntry          = dataBufArc.freeGhostEntry;
+    dataBufArc.freeGhostEntry = ghostEntry;
+}
+
+/**
+ * @brief Remember the LSA of an evicted data buffer entry as the MRU entry of B1 or B2.
+ *
+ * @param logicalSliceAddr the LSA of the evicted data buffer entry
+ * @param ghostList `DATA_BUF_ARC_T1` for B1, `DATA_BUF_ARC_T2` for B2
+ */
+static void ArcPutGhost(unsigned int logicalSliceAddr, unsigned int ghostList)
+{
+    unsigned int ghostEntry;
+    P_DATA_BUF_GHOST_ENTRY ghost;
+    P_DATA_BUF_LRU_LIST list = &dataBufArc.ghostList[ghostList];
+    P_DATA_BUF_HASH_ENTRY bucket;
+
+    // a buffer entry without valid data leaves no history
+    if (logicalSliceAddr == LSA_NONE)
+        return;
+
+    // should not happen since |B1| + |B2| <= c, just drop the oldest history
+    if (dataBufArc.freeGhostEntry == DATA_BUF_NONE)
+        ArcReleaseGhost(dataBufArc.ghostList[dataBufArc.ghostCnt[DATA_BUF_ARC_T2] ? DATA_BUF_ARC_T2 : DATA_BUF_ARC_T1]
+                            .tailEntry);
+
+    ghostEntry                = dataBufArc.freeGhostEntry;
+    ghost                     = GHOST_ENTRY(ghostEntry);
+    dataBufArc.freeGhostEntry = ghost->nextEntry;
+
+    ghost->logicalSliceAddr = logicalSliceAddr;
+    ghost->ghostList        = ghostList;
+
+    // insert to the head of ghost list
+    ghost->prevEntry = DATA_BUF_NONE;
+    ghost->nextEntry = list->headEntry;
+    if (list->headEntry != DATA_BUF_NONE)
+        GHOST_ENTRY(list->headEntry)->prevEntry = ghostEntry;
+    else
+        list->tailEntry = ghostEntry;
+    list->headEntry = ghostEntry;
+    dataBufArc.ghostCnt[ghostList]++;
+
+    // insert to the head of bucket
+    bucket               = GHOST_H_ENTRY(FindDataBufHashTableEntry(logicalSliceAddr));
+    ghost->hashPrevEntry = DATA_BUF_NONE;
+    ghost->hashNextEntry = bucket->headEntry;
+    if (bucket->headEntry != DATA_BUF_NONE)
+        GHOST_ENTRY(bucket->headEntry)->hashPrevEntry = ghostEntry;
+    bucket->headEntry = ghostEntry;
+}
+
+/**
+ * @brief The REPLACE routine of ARC, choose the victim from T1 or T2.
+ *
+ * The LRU entry of T1 is evicted if T1 exceeds its target size (or reaches it when the
+ * requested LSA was found in B2), otherwise the LRU entry of T2 is evicted. The LSA of
+ * the victim is remembered in the corresponding ghost list.
+ *
+ * @param hitInB2 whether the requested LSA was found in B2
+ * @return unsigned int the victim data buffer entry, already removed from T1/T2
+ */
+static unsigned int ArcReplace(unsigned int hitInB2)
+{
+    unsigned int victimEntry, victimList;
+
+    if (dataBufArc.t1Cnt &&
+        ((dataBufArc.t1Cnt > dataBufArc.t1Target) || (hitInB2 && dataBufArc.t1Cnt == dataBufArc.t1Target) ||
+         !dataBufArc.t2Cnt))
+    {
+        victimEntry = GetDataBufResidentTail();
+        victimList  = DATA_BUF_ARC_T1;
+    }
+    else
+    {
+        victimEntry = (dataBufArc.t1Cnt) ? BUF_PREV_IDX(dataBufArc.t1HeadEntry) : GetDataBufResidentTail();
+        victimList  = DATA_BUF_ARC_T2;
+    }
+
+    ArcUnlinkDataBuf(victimEntry);
+    ArcPutGhost(BUF_LSA(victimEntry), victimList);
+
+    return victimEntry;
+}
+
+#endif /* DATA_BUF_POLICY == DATA_BUF_POLICY_ARC */
+
+/**
+ * @brief Find the data buffer entry of the given LSA in the hash table.
+ *
+ * @param logicalSliceAddr the LSA to be searched
+ * @param isPhyReq whether the LSA is a physical address (OC request)
+ * @return unsigned int the index of the data buffer entry, or `DATA_BUF_NONE` if not found
+ */
+static unsigned int FindDataBufEntry(unsigned int logicalSliceAddr, unsigned int isPhyReq)
+{
+    unsigned int iSlot =
+        DataBufHashLookup(dataBufHashTablePtr->slot, dataBufHashSlotMask, logicalSliceAddr, isPhyReq);
+
+    if (iSlot == DATA_BUF_HASH_SLOT_NONE)
+        return DATA_BUF_NONE;
+
+    return dataBufHashTablePtr->slot[iSlot].bufEntry;
+}
+
+/**
+ * @brief Check whether the given LSA is cached, without counting it as a reference.
+ *
+ * @param logicalSliceAddr the LSA to be searched
+ * @return unsigned int the index of the data buffer entry, or `DATA_BUF_NONE` if not found
+ */
+unsigned int LookupDataBuf(unsigned int logicalSliceAddr)
+{
+    if (logicalSliceAddr == LSA_NONE)
+        return DATA_BUF_NONE;
+
+    return FindDataBufEntry(logicalSliceAddr, DATA_BUF_FOR_LOG_REQ);
+}
+
+/**
+ * @brief Drop the cached data of a deallocated logical slice.
+ *
+ * The entry is marked clean and removed from the hash table, so its dirty data is never
+ * written back and no later request hits it; it stays in its LRU position with `LSA_NONE`
+ * and is reused without leaving a ghost entry.
+ *
+ * The pending requests of the entry are still ordered before its next user by the blocking
+ * queue. But if the data of a write that raced with the deallocate is still being received,
+ * the write is finished first, so that it's ordered before the deallocate as well.
+ *
+ * @param logicalSliceAddr the deallocated LSA
+ */
+void DiscardDataBuf(unsigned int logicalSliceAddr)
+{
+    unsigned int bufEntry = LookupDataBuf(logicalSliceAddr);
+    unsigned int reqSlotTag;
+
+    if (bufEntry == DATA_BUF_NONE)
+        return;
+
+    for (reqSlotTag = BUF_ENTRY(bufEntry)->blockingReqTail; reqSlotTag != REQ_SLOT_TAG_NONE;
+         reqSlotTag = REQ_ENTRY(reqSlotTag)->prevBlockingReq)
+        if (REQ_ENTRY(reqSlotTag)->reqType == REQ_TYPE_NVME_DMA && REQ_CODE_IS(reqSlotTag, REQ_CODE_RxDMA))
+        {
+            SyncAllLowLevelReqDone();
+            break;
+        }
+
+    MarkDataBufClean(bufEntry);
+    SelectiveGetFromDataBufHashList(bufEntry);
+    BUF_ENTRY(bufEntry)->logicalSliceAddr = LSA_NONE;
+    dataBufStat.discardCnt++;
 }
 
 /**
@@ -209,16 +919,21 @@ void FlushDataBuf(uint32_t cmdSlotTag)
  * If the request found, the corresponding data buffer entry become the Most Recently Used
  * entry and should be moved to the head of LRU list.
  *
+ * For ARC, the entry found is moved to the MRU position of T2, unless it is still the MRU
+ * entry of T1. The latter is usually another sub-request of the same slice (e.g. 4KB
+ * sequential writes), which should not be mistaken for a frequently used entry.
+ *
+ * A read-ahead entry found is referenced for the first time, thus it leaves the read-ahead
+ * list and becomes the MRU entry of T1 (or the head of LRU list).
+ *
  * @param reqSlotTag the request pool entry index of the request to be check
  */
 unsigned int CheckDataBufHit(unsigned int reqSlotTag)
 {
     unsigned int bufEntry, logicalSliceAddr;
 
-    // get the bucket index of the given request
-    logicalSliceAddr = REQ_LSA(reqSlotTag);
-    bufEntry         = H_BUF_HEAD_IDX(FindDataBufHashTableEntry(logicalSliceAddr));
     // if LSA is set to LSA_NONE, skip checking buffer
+    logicalSliceAddr = REQ_LSA(reqSlotTag);
     if (logicalSliceAddr == LSA_NONE)
         return DATA_BUF_FAIL;
 
@@ -226,113 +941,183 @@ unsigned int CheckDataBufHit(unsigned int reqSlotTag)
     bool isPhyReq =
         REQ_CODE_IS(reqSlotTag, REQ_CODE_OCSSD_PHY_WRITE) || REQ_CODE_IS(reqSlotTag, REQ_CODE_OCSSD_PHY_READ);
 
-    // traverse the bucket and try to find the data buffer entry of target request
-    while (bufEntry != DATA_BUF_NONE)
+    bufEntry = FindDataBufEntry(logicalSliceAddr, isPhyReq);
+    if (bufEntry == DATA_BUF_NONE)
     {
-        if ((BUF_LSA(bufEntry) == logicalSliceAddr) && (BUF_ENTRY(bufEntry)->phyReq == isPhyReq))
-        {
-            pr_info("%s Req[%u]: Hit Buf[%u]!", isPhyReq ? "Phy" : "Log", reqSlotTag, bufEntry);
-
-            // remove from the LRU list before making it MRU
-            if ((!BUF_ENTRY_IS_HEAD(bufEntry)) && (!BUF_ENTRY_IS_TAIL(bufEntry)))
-            {
-                // body of LRU list
-                BUF_PREV_ENTRY(bufEntry)->nextEntry = BUF_NEXT_IDX(bufEntry);
-                BUF_NEXT_ENTRY(bufEntry)->prevEntry = BUF_PREV_IDX(bufEntry);
-            }
-            else if ((!BUF_ENTRY_IS_HEAD(bufEntry)) && BUF_ENTRY_IS_TAIL(bufEntry))
-            {
-                // tail of LRU list, modify the LRU tail
-                BUF_PREV_ENTRY(bufEntry)->nextEntry = DATA_BUF_NONE;
-                dataBufLruList.tailEntry            = BUF_PREV_IDX(bufEntry);
-            }
-            else if (BUF_ENTRY_IS_HEAD(bufEntry) && (!BUF_ENTRY_IS_TAIL(bufEntry)))
-            {
-                // head of LRU list, modify the LRU head
-                BUF_NEXT_ENTRY(bufEntry)->prevEntry = DATA_BUF_NONE;
-                dataBufLruList.headEntry            = BUF_NEXT_IDX(bufEntry);
-            }
-            else
-            {
-                // the only entry in LRU list, make LRU list empty
-                dataBufLruList.tailEntry = DATA_BUF_NONE;
-                dataBufLruList.headEntry = DATA_BUF_NONE;
-            }
+        dataBufStat.missCnt++;
+        return DATA_BUF_FAIL;
+    }
 
-            // make this entry the MRU entry (move to the head of LRU list)
-            if (BUF_HEAD_IDX() != DATA_BUF_NONE)
-            {
-                BUF_ENTRY(bufEntry)->prevEntry = DATA_BUF_NONE;
-                BUF_ENTRY(bufEntry)->nextEntry = BUF_HEAD_IDX();
-                BUF_HEAD_ENTRY()->prevEntry    = bufEntry;
-                dataBufLruList.headEntry       = bufEntry;
-            }
-            else
-            {
-                BUF_ENTRY(bufEntry)->prevEntry = DATA_BUF_NONE;
-                BUF_ENTRY(bufEntry)->nextEntry = DATA_BUF_NONE;
-                dataBufLruList.headEntry       = bufEntry;
-                dataBufLruList.tailEntry       = bufEntry;
-            }
+    pr_info("%s Req[%u]: Hit Buf[%u]!", isPhyReq ? "Phy" : "Log", reqSlotTag, bufEntry);
+    dataBufStat.hitCnt++;
 
-            return bufEntry;
-        }
+    if (BUF_ENTRY(bufEntry)->readAhead)
+    {
+        dataBufStat.readAheadHitCnt++;
+        UnlinkFromReadAheadList(bufEntry);
+#if (DATA_BUF_POLICY == DATA_BUF_POLICY_ARC)
+        ArcLinkDataBuf(bufEntry, DATA_BUF_ARC_T1);
+#else
+        LinkToDataBufLruList(bufEntry, BUF_HEAD_IDX());
+#endif /* DATA_BUF_POLICY */
+        return bufEntry;
+    }
 
-        // move to next entry in the same hash bucket
-        bufEntry = BUF_ENTRY(bufEntry)->hashNextEntry;
+#if (DATA_BUF_POLICY == DATA_BUF_POLICY_ARC)
+    if (bufEntry != dataBufArc.t1HeadEntry)
+    {
+        ArcUnlinkDataBuf(bufEntry);
+        ArcLinkDataBuf(bufEntry, DATA_BUF_ARC_T2);
     }
+#else
+    // make this entry the MRU entry (move to the head of LRU list)
+    UnlinkFromDataBufLruList(bufEntry);
+    LinkToDataBufLruList(bufEntry, BUF_HEAD_IDX());
+#endif /* DATA_BUF_POLICY */
 
-    return DATA_BUF_FAIL;
+    return bufEntry;
 }
 
 /**
- * @brief Retrieve a LRU data buffer entry from the LRU list.
+ * @brief Choose a data buffer entry to be reused for the given LSA.
+ *
+ * For LRU, the LRU data buffer entry (tail of LRU list) is reused and becomes the MRU
+ * entry (head of LRU list).
  *
- * Choose the LRU data buffer entry from the LRU list, and return it's index.
+ * For ARC, with c data buffer entries:
  *
- * If the `evictedEntry` is `DATA_BUF_NONE`, that's an error or the `dataBufLruList` is
- * empty.
+ * - the LSA is found in B1: T1 was evicted too early, increase the target size of T1 by
+ *   max(|B2| / |B1|, 1) up to c, replace, and the reused entry becomes the MRU of T2.
  *
- * If the `evictedEntry`, namely the last entry of LRU list, exists and:
+ * - the LSA is found in B2: T2 was evicted too early, decrease the target size of T1 by
+ *   max(|B1| / |B2|, 1) down to 0, replace, and the reused entry becomes the MRU of T2.
  *
- * - it's also the head of LRU list:
+ * - otherwise: keep |T1| + |B1| <= c and |T1| + |T2| + |B1| + |B2| <= 2c by dropping the
+ *   oldest history (or evicting the LRU of T1 without history if T1 is full), replace,
+ *   and the reused entry becomes the MRU of T1.
  *
- *      this means that there is only entry in the LRU list, therefore we don't need to
- *      modify the prev/next entry of `evictedEntry`.
+ * Thus a long scan only cycles through T1, and the entries referenced more than once in
+ * T2 survive unless the ghost hits show that T2 is too large.
  *
- * - it's the body of LRU list:
+ * For both policies, the oldest read-ahead entry that is still not referenced is reused
+ * before any other entry, and it leaves no history in the ghost lists.
  *
- *      we have to make the prev entry be the new tail of LRU list, and make the evicted
- *      entry be the new head of the LRU list.
+ * In both cases, the function `SelectiveGetFromDataBufHashList` is called to remove the
+ * reused entry from its bucket of hash table; the caller should evict the dirty data and
+ * insert it back into the hash table with the new LSA.
  *
- * After the evicted entry being moved from the tail of LRU entry to head, we have to call
- * the function `SelectiveGetFromDataBufHashList` to remove the `evictedEntry` from its
- * bucket of hash table.
+ * @param logicalSliceAddr the LSA to be stored in the entry, may be `LSA_NONE`
+ * @return unsigned int the index of the data buffer entry to be reused
  */
-unsigned int AllocateDataBuf()
+unsigned int AllocateDataBuf(unsigned int logicalSliceAddr)
 {
     unsigned int evictedEntry = dataBufLruList.tailEntry;
 
     if (evictedEntry == DATA_BUF_NONE)
         assert(!"[WARNING] There is no valid buffer entry [WARNING]");
 
-    if (dataBufMapPtr->dataBuf[evictedEntry].prevEntry != DATA_BUF_NONE)
+#if (DATA_BUF_POLICY == DATA_BUF_POLICY_ARC)
+    unsigned int ghostEntry = ArcFindGhost(logicalSliceAddr), delta;
+
+    if (ghostEntry != DATA_BUF_NONE)
     {
-        dataBufMapPtr->dataBuf[dataBufMapPtr->dataBuf[evictedEntry].prevEntry].nextEntry = DATA_BUF_NONE;
-        dataBufLruList.tailEntry = dataBufMapPtr->dataBuf[evictedEntry].prevEntry;
+        unsigned int ghostList = GHOST_ENTRY(ghostEntry)->ghostList;
+        unsigned int b1Cnt = dataBufArc.ghostCnt[DATA_BUF_ARC_T1], b2Cnt = dataBufArc.ghostCnt[DATA_BUF_ARC_T2];
 
-        dataBufMapPtr->dataBuf[evictedEntry].prevEntry             = DATA_BUF_NONE;
-        dataBufMapPtr->dataBuf[evictedEntry].nextEntry             = dataBufLruList.headEntry;
-        dataBufMapPtr->dataBuf[dataBufLruList.headEntry].prevEntry = evictedEntry;
-        dataBufLruList.headEntry                                   = evictedEntry;
+        dataBufStat.ghostHitCnt[ghostList]++;
+        if (ghostList == DATA_BUF_ARC_T1)
+        {
+            delta               = (b2Cnt > b1Cnt) ? (b2Cnt / b1Cnt) : 1;
+            dataBufArc.t1Target = (dataBufArc.t1Target + delta < dataBufEntryCount)
+                                      ? dataBufArc.t1Target + delta
+                                      : dataBufEntryCount;
+        }
+        else
+        {
+            delta               = (b1Cnt > b2Cnt) ? (b1Cnt / b2Cnt) : 1;
+            dataBufArc.t1Target = (dataBufArc.t1Target > delta) ? dataBufArc.t1Target - delta : 0;
+        }
+
+        ArcReleaseGhost(ghostEntry);
+        evictedEntry = dataBufReadAheadList.cnt ? ReuseReadAheadDataBuf() : ArcReplace(ghostList == DATA_BUF_ARC_T2);
+        ArcLinkDataBuf(evictedEntry, DATA_BUF_ARC_T2);
     }
     else
     {
-        dataBufMapPtr->dataBuf[evictedEntry].prevEntry = DATA_BUF_NONE;
-        dataBufMapPtr->dataBuf[evictedEntry].nextEntry = DATA_BUF_NONE;
-        dataBufLruList.headEntry                       = evictedEntry;
-        dataBufLruList.tailEntry                       = evictedEntry;
+        unsigned int b1Cnt = dataBufArc.ghostCnt[DATA_BUF_ARC_T1], b2Cnt = dataBufArc.ghostCnt[DATA_BUF_ARC_T2];
+
+        if (dataBufArc.t1Cnt + b1Cnt >= dataBufEntryCount)
+        {
+            if (dataBufArc.t1Cnt < dataBufEntryCount)
+            {
+                ArcReleaseGhost(dataBufArc.ghostList[DATA_BUF_ARC_T1].tailEntry);
+                evictedEntry = dataBufReadAheadList.cnt ? ReuseReadAheadDataBuf() : ArcReplace(false);
+            }
+            else
+            {
+                // T1 occupies the whole buffer, evict its LRU entry without history
+                evictedEntry = BUF_TAIL_IDX();
+                ArcUnlinkDataBuf(evictedEntry);
+            }
+        }
+        else
+        {
+            if (dataBufArc.t1Cnt + dataBufArc.t2Cnt + b1Cnt + b2Cnt >= 2 * dataBufEntryCount)
+                ArcReleaseGhost(dataBufArc.ghostList[DATA_BUF_ARC_T2].tailEntry);
+            evictedEntry = dataBufReadAheadList.cnt ? ReuseReadAheadDataBuf() : ArcReplace(false);
+        }
+
+        ArcLinkDataBuf(evictedEntry, DATA_BUF_ARC_T1);
     }
+#else
+    // the tail is the oldest read-ahead entry if there is any
+    if (BUF_ENTRY(evictedEntry)->readAhead)
+        ReuseReadAheadDataBuf();
+    else
+        UnlinkFromDataBufLruList(evictedEntry);
+    LinkToDataBufLruList(evictedEntry, BUF_HEAD_IDX());
+#endif /* DATA_BUF_POLICY */
+
+    SelectiveGetFromDataBufHashList(evictedEntry);
+
+    return evictedEntry;
+}
+
+/**
+ * @brief Choose a data buffer entry to be filled by read-ahead.
+ *
+ * The read-ahead entries are kept in the tail segment of the LRU list (latest first), so
+ * they are reused before any other entry if host never references them. To prevent them
+ * from flushing the cache, the number of read-ahead entries is limited: once the limit is
+ * reached, the oldest read-ahead entry is reused; otherwise, the entry is taken from T1 or
+ * T2 as `AllocateDataBuf()` does (or the LRU entry for LRU).
+ *
+ * Like `AllocateDataBuf()`, the caller should evict the dirty data and insert the entry
+ * back into the hash table with the new LSA.
+ *
+ * @return unsigned int the index of the data buffer entry to be reused
+ */
+unsigned int AllocateReadAheadDataBuf()
+{
+    unsigned int evictedEntry;
+
+    if (dataBufReadAheadList.cnt >= DATA_BUF_READ_AHEAD_MAX_ENTRY_COUNT)
+        evictedEntry = ReuseReadAheadDataBuf();
+    else
+    {
+#if (DATA_BUF_POLICY == DATA_BUF_POLICY_ARC)
+        evictedEntry = ArcReplace(false);
+#else
+        evictedEntry = GetDataBufResidentTail();
+        UnlinkFromDataBufLruList(evictedEntry);
+#endif /* DATA_BUF_POLICY */
+    }
+
+    LinkToDataBufLruList(evictedEntry, dataBufReadAheadList.headEntry);
+    dataBufReadAheadList.headEntry = evictedEntry;
+    dataBufReadAheadList.cnt++;
+    BUF_ENTRY(evictedEntry)->readAhead = 1;
+    dataBufStat.readAheadCnt++;
 
     SelectiveGetFromDataBufHashList(evictedEntry);
 
@@ -370,14 +1155,50 @@ void UpdateDataBufEntryInfoBlockingReq(unsigned int bufEntry, unsigned int reqSl
 }
 
 /**
- * @brief Retrieve the index of temp buffer entry of the target die.
+ * @brief Retrieve the index of a temp buffer entry of the target die.
  *
- * By default, there is only `NUM_DIES` entries in the `tempDataBuf`, so we can just use
- * the serial number of each die to determine which temp entry should be used.
+ * The entries of the die are tried in turn, and the first one with no blocking request is
+ * taken. If all of them are in use, the next one in turn is taken anyway, and the request
+ * waits in its blocking request queue, so the copies of the die are spread evenly over its
+ * entries and each entry is reused by the copies in the order they are issued.
  *
  * @param dieNo an unique number of the specified die
+ * @return unsigned int the index of the temp buffer entry.
  */
-unsigned int AllocateTempDataBuf(unsigned int dieNo) { return dieNo; }
+unsigned int AllocateTempDataBuf(unsigned int dieNo)
+{
+    unsigned int i, nextEntry, bufEntry;
+
+    nextEntry = tempDataBufMapPtr->nextEntry[dieNo];
+    for (i = 0; i < TEMP_DATA_BUF_ENTRY_COUNT_PER_DIE; i++)
+    {
+        bufEntry = dieNo * TEMP_DATA_BUF_ENTRY_COUNT_PER_DIE + (nextEntry + i) % TEMP_DATA_BUF_ENTRY_COUNT_PER_DIE;
+        if (tempDataBufMapPtr->tempDataBuf[bufEntry].blockingReqTail == REQ_SLOT_TAG_NONE)
+            break;
+    }
+    if (i == TEMP_DATA_BUF_ENTRY_COUNT_PER_DIE)
+        bufEntry = dieNo * TEMP_DATA_BUF_ENTRY_COUNT_PER_DIE + nextEntry;
+
+    tempDataBufMapPtr->nextEntry[dieNo] = (bufEntry + 1) % TEMP_DATA_BUF_ENTRY_COUNT_PER_DIE;
+    return bufEntry;
+}
+
+/**
+ * @brief Count the temp buffer entries of the target die that no request is using.
+ *
+ * @param dieNo an unique number of the specified die
+ * @return unsigned int the number of idle temp buffer entries of the die.
+ */
+unsigned int CountIdleTempDataBuf(unsigned int dieNo)
+{
+    unsigned int bufEntry, idleCnt;
+
+    idleCnt = 0;
+    for (bufEntry = dieNo * TEMP_DATA_BUF_ENTRY_COUNT_PER_DIE;
+         bufEntry < (dieNo + 1) * TEMP_DATA_BUF_ENTRY_COUNT_PER_DIE; bufEntry++)
+        idleCnt += (tempDataBufMapPtr->tempDataBuf[bufEntry].blockingReqTail == REQ_SLOT_TAG_NONE);
+    return idleCnt;
+}
 
 /**
  * @brief Append the request to the blocking queue specified by given temp buffer entry.
@@ -399,107 +1220,166 @@ void UpdateTempDataBufEntryInfoBlockingReq(unsigned int bufEntry, unsigned int r
     tempDataBufMapPtr->tempDataBuf[bufEntry].blockingReqTail = reqSlotTag;
 }
 
+/**
+ * @brief Find the slot of the given key in a data buffer hash table.
+ *
+ * The slots are probed from the home slot of the key, and the probing stops at an empty
+ * slot or a slot whose key is closer to its own home than the probed distance, since the
+ * robin hood insertion would have placed the given key there.
+ *
+ * @param slots the slots of the hash table
+ * @param slotMask the number of slots minus 1, the number of slots must be a power of 2
+ * @param logicalSliceAddr the LSA (or VSA for physical request) to be searched
+ * @param phyReq whether the key is for physical request
+ * @return unsigned int the index of the slot, or DATA_BUF_HASH_SLOT_NONE if not found
+ */
+unsigned int DataBufHashLookup(P_DATA_BUF_HASH_SLOT slots, unsigned int slotMask, unsigned int logicalSliceAddr,
+                               unsigned int phyReq)
+{
+    unsigned int iSlot = DataBufHashMix(logicalSliceAddr, phyReq) & slotMask;
+    unsigned int dist;
+
+    for (dist = 0; slots[iSlot].bufEntry != DATA_BUF_NONE && slots[iSlot].probeDist >= dist; dist++)
+    {
+        if (slots[iSlot].logicalSliceAddr == logicalSliceAddr && slots[iSlot].phyReq == phyReq)
+            return iSlot;
+
+        iSlot = (iSlot + 1) & slotMask;
+    }
+
+    return DATA_BUF_HASH_SLOT_NONE;
+}
+
+/**
+ * @brief Insert a key into a data buffer hash table.
+ *
+ * Robin hood insertion: the key being inserted takes over the first slot whose key is
+ * closer to its own home, and the evicted key continues probing from the next slot.
+ *
+ * @warning The table must have at least one empty slot.
+ *
+ * @param slots the slots of the hash table
+ * @param slotMask the number of slots minus 1, the number of slots must be a power of 2
+ * @param logicalSliceAddr the LSA (or VSA for physical request) of the key
+ * @param phyReq whether the key is for physical request
+ * @param bufEntry the data buffer entry of the key
+ */
+void DataBufHashInsert(P_DATA_BUF_HASH_SLOT slots, unsigned int slotMask, unsigned int logicalSliceAddr,
+                       unsigned int phyReq, unsigned int bufEntry)
+{
+    DATA_BUF_HASH_SLOT carried, swapped;
+    unsigned int iSlot = DataBufHashMix(logicalSliceAddr, phyReq) & slotMask;
+
+    carried.logicalSliceAddr = logicalSliceAddr;
+    carried.bufEntry         = bufEntry;
+    carried.phyReq           = phyReq;
+    carried.probeDist        = 0;
+
+    while (slots[iSlot].bufEntry != DATA_BUF_NONE)
+    {
+        if (slots[iSlot].probeDist < carried.probeDist)
+        {
+            swapped      = slots[iSlot];
+            slots[iSlot] = carried;
+            carried      = swapped;
+        }
+
+        iSlot = (iSlot + 1) & slotMask;
+        carried.probeDist++;
+    }
+
+    slots[iSlot] = carried;
+}
+
+/**
+ * @brief Remove the key in the given slot from a data buffer hash table.
+ *
+ * The following keys which are not in their home slots are shifted back by one slot,
+ * until an empty slot or a key in its home slot is met.
+ *
+ * @param slots the slots of the hash table
+ * @param slotMask the number of slots minus 1, the number of slots must be a power of 2
+ * @param iSlot the index of the slot to be emptied
+ */
+void DataBufHashRemove(P_DATA_BUF_HASH_SLOT slots, unsigned int slotMask, unsigned int iSlot)
+{
+    unsigned int nextSlot = (iSlot + 1) & slotMask;
+
+    while (slots[nextSlot].bufEntry != DATA_BUF_NONE && slots[nextSlot].probeDist)
+    {
+        slots[iSlot] = slots[nextSlot];
+        slots[iSlot].probeDist--;
+
+        iSlot    = nextSlot;
+        nextSlot = (nextSlot + 1) & slotMask;
+    }
+
+    slots[iSlot].logicalSliceAddr = LSA_NONE;
+    slots[iSlot].bufEntry         = DATA_BUF_NONE;
+    slots[iSlot].phyReq           = 0;
+    slots[iSlot].probeDist        = 0;
+}
+
 /**
  * @brief Insert the given data buffer entry into the hash table.
  *
- * Insert the given data buffer entry into the tail of hash table bucket specified by the
- * `logicalSliceAddr` of the given entry, and modify the tail (head as well, if needed) of
- * target hash table bucket.
+ * The key of the entry is its `logicalSliceAddr` and `phyReq`. An entry without LSA holds
+ * no useful data and is not inserted.
  *
  * @note If the `dontCached` flag of the buffer entry is set to true, this insert process
- * will be skipped, since the buffer entry should not be inserted into any hash bucket.
+ * will be skipped, since the buffer entry should not be inserted into the hash table.
  *
  * @param bufEntry the index of the data buffer entry to be inserted
  */
 void PutToDataBufHashList(unsigned int bufEntry)
 {
-    unsigned int hashEntry;
-
     // this buffer entry may not want to be cached (in hash list)
     if (BUF_ENTRY(bufEntry)->dontCache == DATA_BUF_SKIP_CACHE)
     {
         pr_debug("Buf[%u] should not be cached, skipped", bufEntry);
-        BUF_ENTRY(bufEntry)->hashPrevEntry = DATA_BUF_NONE;
-        BUF_ENTRY(bufEntry)->hashNextEntry = DATA_BUF_NONE;
         ASSERT(0, "Currently all buffer entries should be cached");
         return;
     }
 
-    hashEntry = FindDataBufHashTableEntry(dataBufMapPtr->dataBuf[bufEntry].logicalSliceAddr);
+    if (BUF_LSA(bufEntry) == LSA_NONE)
+        return;
 
-    if (dataBufHashTablePtr->dataBufHash[hashEntry].tailEntry != DATA_BUF_NONE)
-    {
-        dataBufMapPtr->dataBuf[bufEntry].hashPrevEntry = dataBufHashTablePtr->dataBufHash[hashEntry].tailEntry;
-        dataBufMapPtr->dataBuf[bufEntry].hashNextEntry = REQ_SLOT_TAG_NONE;
-        dataBufMapPtr->dataBuf[dataBufHashTablePtr->dataBufHash[hashEntry].tailEntry].hashNextEntry = bufEntry;
-        dataBufHashTablePtr->dataBufHash[hashEntry].tailEntry                                       = bufEntry;
-    }
-    else
-    {
-        dataBufMapPtr->dataBuf[bufEntry].hashPrevEntry        = REQ_SLOT_TAG_NONE;
-        dataBufMapPtr->dataBuf[bufEntry].hashNextEntry        = REQ_SLOT_TAG_NONE;
-        dataBufHashTablePtr->dataBufHash[hashEntry].headEntry = bufEntry;
-        dataBufHashTablePtr->dataBufHash[hashEntry].tailEntry = bufEntry;
-    }
+    DataBufHashInsert(dataBufHashTablePtr->slot, dataBufHashSlotMask, BUF_LSA(bufEntry),
+                      BUF_ENTRY(bufEntry)->phyReq, bufEntry);
 }
 
 /**
  * @brief Remove the given data buffer entry from the hash table.
  *
- * We may need to modify the head/tail index of corresponding bucket specified by the
- * `logicalSliceAddr` of the given data buffer entry.
+ * The slot holding the given entry is searched from the home slot of its key, and then
+ * emptied by `DataBufHashRemove()`.
  *
  * @note If the `dontCached` flag of the buffer entry is set to true, this remove process
- * will be skipped, since the buffer entry should not exist in any hash bucket.
+ * will be skipped, since the buffer entry should not exist in the hash table.
  *
  * @param bufEntry the index of the data buffer entry to be removed
  */
 void SelectiveGetFromDataBufHashList(unsigned int bufEntry)
 {
+    unsigned int iSlot;
+
     // this buffer entry may not in cache (hash list)
     if (BUF_ENTRY(bufEntry)->dontCache == DATA_BUF_SKIP_CACHE)
     {
         pr_debug("Buf[%u] not cached, skipped", bufEntry);
-        BUF_ENTRY(bufEntry)->hashPrevEntry = DATA_BUF_NONE;
-        BUF_ENTRY(bufEntry)->hashNextEntry = DATA_BUF_NONE;
         ASSERT(0, "Currently all buffer entries should be cached");
         return;
     }
 
-    if (dataBufMapPtr->dataBuf[bufEntry].logicalSliceAddr != LSA_NONE)
-    {
-        unsigned int prevBufEntry, nextBufEntry, hashEntry;
-
-        prevBufEntry = dataBufMapPtr->dataBuf[bufEntry].hashPrevEntry;
-        nextBufEntry = dataBufMapPtr->dataBuf[bufEntry].hashNextEntry;
-        hashEntry    = FindDataBufHashTableEntry(dataBufMapPtr->dataBuf[bufEntry].logicalSliceAddr);
-
-        // body, no need to modify the head or tail index of this bucket
-        if ((nextBufEntry != DATA_BUF_NONE) && (prevBufEntry != DATA_BUF_NONE))
-        {
-            dataBufMapPtr->dataBuf[prevBufEntry].hashNextEntry = nextBufEntry;
-            dataBufMapPtr->dataBuf[nextBufEntry].hashPrevEntry = prevBufEntry;
-        }
-
-        // tail, don't forget to modify the tail index of this bucket
-        else if ((nextBufEntry == DATA_BUF_NONE) && (prevBufEntry != DATA_BUF_NONE))
-        {
-            dataBufMapPtr->dataBuf[prevBufEntry].hashNextEntry    = DATA_BUF_NONE;
-            dataBufHashTablePtr->dataBufHash[hashEntry].tailEntry = prevBufEntry;
-        }
-
-        // head, don't forget to modify the head index of this bucket
-        else if ((nextBufEntry != DATA_BUF_NONE) && (prevBufEntry == DATA_BUF_NONE))
-        {
-            dataBufMapPtr->dataBuf[nextBufEntry].hashPrevEntry    = DATA_BUF_NONE;
-            dataBufHashTablePtr->dataBufHash[hashEntry].headEntry = nextBufEntry;
-        }
+    if (BUF_LSA(bufEntry) == LSA_NONE)
+        return;
 
-        // bucket with only one entry, both the head and tail index should be modified
-        else
-        {
-            dataBufHashTablePtr->dataBufHash[hashEntry].headEntry = DATA_BUF_NONE;
-            dataBufHashTablePtr->dataBufHash[hashEntry].tailEntry = DATA_BUF_NONE;
-        }
+    iSlot = DataBufHashMix(BUF_LSA(bufEntry), BUF_ENTRY(bufEntry)->phyReq) & dataBufHashSlotMask;
+    while (dataBufHashTablePtr->slot[iSlot].bufEntry != bufEntry)
+    {
+        ASSERT(dataBufHashTablePtr->slot[iSlot].bufEntry != DATA_BUF_NONE, "Buf[%u] is not in the hash table", bufEntry);
+        iSlot = (iSlot + 1) & dataBufHashSlotMask;
     }
+
+    DataBufHashRemove(dataBufHashTablePtr->slot, dataBufHashSlotMask, iSlot);
 }
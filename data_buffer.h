@@ -50,22 +50,104 @@
 #include "ftl_config.h"
 #include "memory_map.h"
 
-// the data buffer entries for each die, default 16
-#define AVAILABLE_DATA_BUFFER_ENTRY_COUNT           (16 * USER_DIES)
-#define AVAILABLE_TEMPORARY_DATA_BUFFER_ENTRY_COUNT (USER_DIES)
+/**
+ * The number of data buffer entries (`dataBufEntryCount`) is set at boot, and can be
+ * changed later by `ResizeDataBuf()`. The first `DATA_BUF_BASE_ENTRY_COUNT` entries are
+ * placed at `DATA_BUFFER_BASE_ADDR`, the others are carved from the reserved DRAM region
+ * at `DATA_BUFFER_EXT_BASE_ADDR` (check `BUF_DATA_ENTRY2ADDR`).
+ *
+ * The metadata of the data buffer (`DATA_BUF_MAP`, hash table and ghost entries) are
+ * allocated for `DATA_BUF_MAX_ENTRY_COUNT` entries, only the first `dataBufEntryCount`
+ * of them are used.
+ */
+#define DATA_BUF_BASE_ENTRY_COUNT (16 * USER_DIES) // 16 entries for each die
+#define DATA_BUF_EXT_ENTRY_COUNT  (7 * DATA_BUF_BASE_ENTRY_COUNT)
+#define DATA_BUF_MAX_ENTRY_COUNT  (DATA_BUF_BASE_ENTRY_COUNT + DATA_BUF_EXT_ENTRY_COUNT)
+#define DATA_BUF_MIN_ENTRY_COUNT  (4 * USER_DIES)
+
+#ifndef DATA_BUF_DEFAULT_ENTRY_COUNT
+#define DATA_BUF_DEFAULT_ENTRY_COUNT DATA_BUF_BASE_ENTRY_COUNT
+#endif
+
+/**
+ * Each die has `TEMP_DATA_BUF_ENTRY_COUNT_PER_DIE` temp buffer entries to stage its GC copies,
+ * so several copies of a die are in flight: the reads run ahead in the NAND request queue of
+ * the die while the programs follow their own reads, check `AllocateTempDataBuf()`.
+ */
+#ifndef TEMP_DATA_BUF_ENTRY_COUNT_PER_DIE
+#define TEMP_DATA_BUF_ENTRY_COUNT_PER_DIE 4
+#endif
+
+#define AVAILABLE_TEMPORARY_DATA_BUFFER_ENTRY_COUNT (USER_DIES * TEMP_DATA_BUF_ENTRY_COUNT_PER_DIE)
+#define AVAILABLE_MERGE_DATA_BUFFER_ENTRY_COUNT     (USER_DIES)
 
 #define DATA_BUF_NONE  0xffff
 #define DATA_BUF_FAIL  0xffff
 #define DATA_BUF_DIRTY 1 // the buffer entry is not clean
 #define DATA_BUF_CLEAN 0 // the buffer entry is not dirty
 
+#define DATA_BUF_ALL_SECTORS_VALID ((1 << NVME_BLOCKS_PER_SLICE) - 1) // every NVMe block of the slice
+#define DATA_BUF_SECTOR_MASK(offset, cnt) ((((1 << (cnt)) - 1) << (offset)) & DATA_BUF_ALL_SECTORS_VALID)
+
+#if NVME_BLOCKS_PER_SLICE > 4
+#error "`DATA_BUF_ENTRY::validSectors` holds at most 4 NVMe blocks per slice"
+#endif
+
 #define DATA_BUF_FOR_PHY_REQ 1 // the data buffer entry is used for physical addr (OC) request
 #define DATA_BUF_FOR_LOG_REQ 0 // the data buffer entry is used for logical addr request
 
 #define DATA_BUF_SKIP_CACHE 1 // this buffer entry should not be cached in hash list
 #define DATA_BUF_KEEP_CACHE 0 // this buffer entry should be cached in hash list (default)
 
-#define FindDataBufHashTableEntry(logicalSliceAddr) ((logicalSliceAddr) % AVAILABLE_DATA_BUFFER_ENTRY_COUNT)
+/**
+ * The replacement policy of the data buffer, selected at build time by defining
+ * `DATA_BUF_POLICY` to one of the following values (default ARC).
+ *
+ * - `DATA_BUF_POLICY_LRU`: plain LRU, a hit is moved to the head of the LRU list and the
+ *   tail entry is reused on miss.
+ *
+ * - `DATA_BUF_POLICY_ARC`: Adaptive Replacement Cache, check `AllocateDataBuf()`.
+ */
+#define DATA_BUF_POLICY_LRU 0
+#define DATA_BUF_POLICY_ARC 1
+
+#ifndef DATA_BUF_POLICY
+#define DATA_BUF_POLICY DATA_BUF_POLICY_ARC
+#endif
+
+#define DATA_BUF_DIRTY_LIST_LOG   (USER_DIES)     // the dirty list of the entries for logical addr
+#define DATA_BUF_DIRTY_LIST_COUNT (USER_DIES + 1) // one list per die for phy addr, plus the above
+
+#define DATA_BUF_ARC_T1 0 // the entry was referenced once recently (recency list)
+#define DATA_BUF_ARC_T2 1 // the entry was referenced at least twice (frequency list)
+
+// at most a quarter of the data buffer entries can be held by unreferenced read-ahead data
+#define DATA_BUF_READ_AHEAD_MAX_ENTRY_COUNT (dataBufEntryCount / 4)
+
+/**
+ * The watermarks of the background flusher (check `FlushDataBufInBackground()`), in the
+ * number of dirty data buffer entries.
+ */
+#define DATA_BUF_FLUSH_HIGH_WATERMARK (dataBufEntryCount / 2)
+#define DATA_BUF_FLUSH_LOW_WATERMARK  (dataBufEntryCount / 4)
+#define DATA_BUF_FLUSH_SCAN_DEPTH     (USER_DIES * 4)  // max entries visited from LRU tail per pass
+#define DATA_BUF_FLUSH_MIN_FREE_REQ   (USER_DIES * 16) // leave the request entries to host commands
+
+/**
+ * The slots of the data buffer hash table, at least twice of the data buffer entries and
+ * rounded up to a power of 2 so the slot index can be masked (check `DATA_BUF_HASH_SLOT`).
+ *
+ * The table is allocated for `DATA_BUF_MAX_ENTRY_COUNT`, only the first
+ * `dataBufHashSlotMask + 1` slots are used for current number of entries.
+ */
+#define DATA_BUF_HASH_SMEAR(x)                                                                                         \
+    ((x) | ((x) >> 1) | ((x) >> 2) | ((x) >> 3) | ((x) >> 4) | ((x) >> 5) | ((x) >> 6) | ((x) >> 7) | ((x) >> 8) |    \
+     ((x) >> 9) | ((x) >> 10) | ((x) >> 11) | ((x) >> 12) | ((x) >> 13) | ((x) >> 14) | ((x) >> 15) | ((x) >> 16))
+#define DATA_BUF_HASH_SLOT_COUNT (DATA_BUF_HASH_SMEAR(2 * DATA_BUF_MAX_ENTRY_COUNT - 1) + 1)
+#define DATA_BUF_HASH_SLOT_NONE  0xffffffff
+
+// the bucket of ghost entries (half the number of slots), the LSA is mixed first so that strided LSAs are spread
+#define FindDataBufHashTableEntry(logicalSliceAddr) (DataBufHashMix((logicalSliceAddr), 0) & (dataBufHashSlotMask >> 1))
 
 /**
  * @brief The structure of the data buffer entry.
@@ -93,8 +175,7 @@
  *    However, if we simply traverse the LRU list every time we want to check the data
  *    buffer, it may be too slow. Therefore, in current implementation, the fw maintains
  *    a hash table to reduce the overhead for searching the target data buffer entry that
- *    owns the data of target LBA. And the nodes of the hash table are linked together by
- *    using the two members `hashPrevEntry` and `hashNextEntry` of this structure.
+ *    owns the data of target LBA (check `DATA_BUF_HASH_TABLE`).
  *
  * @sa `AllocateDataBuf()`, `CheckDataBufHit()`, `EvictDataBufEntry()`.
  *
@@ -104,6 +185,14 @@
  * correct order (check `UpdateDataBufEntryInfoBlockingReq()` for details).
  *
  * @sa `UpdateDataBufEntryInfoBlockingReq()`.
+ *
+ * A write smaller than a slice doesn't read the old slice content before receiving the
+ * host data; the NVMe blocks received are recorded in `validSectors` instead. The other
+ * blocks are merged from flash only when they are needed, namely when the entry is read
+ * by host or written back to flash (check `DataMergeFromNand()` for details).
+ *
+ * The entries filled by read-ahead (`readAhead`) are kept at the tail of the LRU list until
+ * they are referenced, check `AllocateReadAheadDataBuf()` for details.
  */
 
 
@@ -139,25 +228,17 @@ typedef struct _DATA_BUF_ENTRY
     unsigned int prevEntry : 16;       // the index of pref entry in the dataBuf
     unsigned int nextEntry : 16;       // the index of next entry in the dataBuf
     unsigned int blockingReqTail : 16; // the request pool entry index of the last blocking request
-    unsigned int hashPrevEntry : 16;   // the index of the prev data buffer entry in the bucket
-    unsigned int hashNextEntry : 16;   // the index of the next data buffer entry in the bucket
     unsigned int dirty : 1;            // whether this data buffer entry is dirty or not (clean)
     unsigned int phyReq : 1;           // treat LSA as physical address
     unsigned int dontCache : 1;        // do not cache (insert into hash list) this buffer
-    unsigned int reserved0 : 13;
+    unsigned int arcList : 1;          // the ARC list (T1/T2) this entry belongs to
+    unsigned int validSectors : 4;     // the NVMe blocks holding the latest data of the slice
+    unsigned int readAhead : 1;        // filled by read-ahead and not referenced by host yet
+    unsigned int reserved0 : 7;
+    unsigned int dirtyPrevEntry : 16;  // the index of prev entry in the dirty list
+    unsigned int dirtyNextEntry : 16;  // the index of next entry in the dirty list
 } DATA_BUF_ENTRY, *P_DATA_BUF_ENTRY;
 
-/**
- * @brief The structure of data buffer table.
- *
- * A fixed-sized 1D data buffer array. Used for storing a slice command and managing the
- * relation between data buffer entries.
- */
-typedef struct _DATA_BUF_MAP
-{
-    DATA_BUF_ENTRY dataBuf[AVAILABLE_DATA_BUFFER_ENTRY_COUNT];
-} DATA_BUF_MAP, *P_DATA_BUF_MAP;
-
 /**
  * @brief The structure of LRU list that records the head and tail data buffer entry index
  * of the LRU list.
@@ -172,6 +253,33 @@ typedef struct _DATA_BUF_LRU_LIST
     unsigned int tailEntry : 16; // the index of LRU data buffer entry
 } DATA_BUF_LRU_LIST, *P_DATA_BUF_LRU_LIST;
 
+/**
+ * @brief The structure of data buffer table.
+ *
+ * A fixed-sized 1D data buffer array. Used for storing a slice command and managing the
+ * relation between data buffer entries.
+ *
+ * The dirty entries are also linked into the dirty lists (by `dirtyPrevEntry` and
+ * `dirtyNextEntry`) in the order they became dirty, so that `FlushDataBuf()` only visits
+ * the dirty entries:
+ *
+ * - the entries for physical addr (OC) requests are linked into the list of their target
+ *   die, since the target die is already determined by the address.
+ *
+ * - the entries for logical addr requests are linked into `DATA_BUF_DIRTY_LIST_LOG`, the
+ *   target die of them is decided until the VSA being allocated.
+ *
+ * @note A dirty list only uses `headEntry` (oldest) and `tailEntry` (newest).
+ *
+ * @sa `MarkDataBufDirty()`, `MarkDataBufClean()`.
+ */
+typedef struct _DATA_BUF_MAP
+{
+    DATA_BUF_ENTRY dataBuf[DATA_BUF_MAX_ENTRY_COUNT];
+    DATA_BUF_LRU_LIST dirtyList[DATA_BUF_DIRTY_LIST_COUNT];
+    unsigned int dirtyCnt;
+} DATA_BUF_MAP, *P_DATA_BUF_MAP;
+
 /**
  * @brief The structure of data buffer bucket that records the head and tail data buffer
  * entry index in the bucket.
@@ -186,17 +294,124 @@ typedef struct _DATA_BUF_HASH_ENTRY
     unsigned int tailEntry : 16; // the last data buffer entry in this bucket
 } DATA_BUF_HASH_ENTRY, *P_DATA_BUF_HASH_ENTRY;
 
+/**
+ * @brief The slot of data buffer hash table.
+ *
+ * The key (`logicalSliceAddr` and `phyReq`) is stored in the slot itself, so a lookup
+ * compares the slots one by one without touching the data buffer entries.
+ */
+typedef struct _DATA_BUF_HASH_SLOT
+{
+    unsigned int logicalSliceAddr;
+    unsigned int bufEntry : 16;  // the data buffer entry, DATA_BUF_NONE if this slot is empty
+    unsigned int phyReq : 1;     // the `phyReq` of the data buffer entry
+    unsigned int probeDist : 15; // the distance from the home slot of the key
+} DATA_BUF_HASH_SLOT, *P_DATA_BUF_HASH_SLOT;
+
 /**
  * @brief The structure of data buffer hash table.
  *
- * A fixed-sized 1D data buffer bucket array. Used for fast finding the data buffer entry
- * of a given request by the `logicalSliceAddr`.
+ * An open-addressed (robin hood) hash table used for fast finding the data buffer entry of
+ * a given request by the `logicalSliceAddr`.
+ *
+ * The home slot of a key is given by `DataBufHashMix()`, which scatters the strided LSAs
+ * (e.g. one slice per channel) over the whole table. On collision the following slots are
+ * probed linearly, and an inserted key takes over the slot of a key closer to its home,
+ * so the probe distances stay short and even. A lookup can stop once it meets a key
+ * closer to its home than the probed distance, and a removal shifts the following keys
+ * back instead of leaving a tombstone.
+ *
+ * Since the table is at most half full, a lookup usually finishes within the same cache
+ * line.
+ *
+ * @sa `DataBufHashLookup()`, `DataBufHashInsert()`, `DataBufHashRemove()`.
  */
 typedef struct _DATA_BUF_HASH_TABLE
 {
-    DATA_BUF_HASH_ENTRY dataBufHash[AVAILABLE_DATA_BUFFER_ENTRY_COUNT];
+    DATA_BUF_HASH_SLOT slot[DATA_BUF_HASH_SLOT_COUNT];
 } DATA_BUF_HASH_TABLE, *P_DATA_BUF_HASH_TABLE;
 
+/**
+ * @brief The structure of ARC ghost entry.
+ *
+ * A ghost entry only remembers the LSA of a data buffer entry recently evicted from the
+ * T1 (B1) or T2 (B2) list of ARC; it owns no data. A miss that hits a ghost entry tells
+ * which list was evicted too early, and the target size of T1 is adjusted accordingly.
+ */
+typedef struct _DATA_BUF_GHOST_ENTRY
+{
+    unsigned int logicalSliceAddr;
+    unsigned int prevEntry : 16;     // the index of prev entry in the ghost list (B1/B2)
+    unsigned int nextEntry : 16;     // the index of next entry in the ghost list or free list
+    unsigned int hashPrevEntry : 16; // the index of the prev ghost entry in the bucket
+    unsigned int hashNextEntry : 16; // the index of the next ghost entry in the bucket
+    unsigned int ghostList : 1;      // the ghost list (B1/B2) this entry belongs to
+    unsigned int reserved0 : 31;
+} DATA_BUF_GHOST_ENTRY, *P_DATA_BUF_GHOST_ENTRY;
+
+/**
+ * @brief The ghost entries of ARC and their hash buckets.
+ *
+ * The total size of B1 and B2 never exceeds the number of data buffer entries, therefore
+ * the same number of ghost entries is enough. Only `headEntry` of each bucket is used.
+ */
+typedef struct _DATA_BUF_GHOST_MAP
+{
+    DATA_BUF_GHOST_ENTRY ghostBuf[DATA_BUF_MAX_ENTRY_COUNT];
+    DATA_BUF_HASH_ENTRY ghostBufHash[DATA_BUF_HASH_SLOT_COUNT / 2];
+} DATA_BUF_GHOST_MAP, *P_DATA_BUF_GHOST_MAP;
+
+/**
+ * @brief The state of ARC.
+ *
+ * To keep a single list of all the data buffer entries (`dataBufLruList`), the resident
+ * lists T1 and T2 are two segments of the LRU list, followed by the read-ahead entries:
+ *
+ *      head -> [T2 MRU ... T2 LRU] [T1 MRU ... T1 LRU] [read-ahead] <- tail
+ *
+ * and `t1HeadEntry` marks the boundary (the MRU entry of T1).
+ *
+ * `t1Target` is the adaptive target size of T1 ("p" in the ARC paper); a ghost hit in B1
+ * increases it and a ghost hit in B2 decreases it.
+ */
+typedef struct _DATA_BUF_ARC_STATE
+{
+    unsigned int t1HeadEntry : 16; // the MRU entry of T1, DATA_BUF_NONE if T1 is empty
+    unsigned int freeGhostEntry : 16; // the first unused ghost entry
+    unsigned int t1Cnt;
+    unsigned int t2Cnt;
+    unsigned int t1Target;
+    DATA_BUF_LRU_LIST ghostList[2]; // B1 and B2, indexed by `DATA_BUF_ARC_T1/T2`
+    unsigned int ghostCnt[2];
+} DATA_BUF_ARC_STATE, *P_DATA_BUF_ARC_STATE;
+
+/**
+ * @brief The data buffer entries filled by read-ahead but not referenced yet.
+ *
+ * They are the tail segment of the LRU list, from `headEntry` (the latest one) to the tail
+ * of the LRU list, and they are not counted in T1 or T2 of ARC.
+ */
+typedef struct _DATA_BUF_READ_AHEAD_LIST
+{
+    unsigned int headEntry : 16; // the latest read-ahead entry, DATA_BUF_NONE if empty
+    unsigned int reserved0 : 16;
+    unsigned int cnt;
+} DATA_BUF_READ_AHEAD_LIST, *P_DATA_BUF_READ_AHEAD_LIST;
+
+typedef struct _DATA_BUF_STATISTICS
+{
+    unsigned int hitCnt;
+    unsigned int missCnt;
+    unsigned int ghostHitCnt[2];    // B1 and B2
+    unsigned int readAheadCnt;      // the entries filled by read-ahead
+    unsigned int readAheadHitCnt;   // the read-ahead entries referenced by host
+    unsigned int readAheadWasteCnt; // the read-ahead entries reused without being referenced
+    unsigned int bgFlushCnt;        // the dirty entries written back by the background flusher
+    unsigned int coalescedRxDmaCnt; // the RxDMAs coalesced with the prev RxDMA of the same entry
+    unsigned int discardCnt;        // the entries dropped since their slices were deallocated
+    unsigned int zeroReadCnt;       // the slice reads of unmapped slices served from the zero buffer
+} DATA_BUF_STATISTICS, *P_DATA_BUF_STATISTICS;
+
 typedef struct _TEMPORARY_DATA_BUF_ENTRY
 {
     unsigned int blockingReqTail : 16;
@@ -206,31 +421,74 @@ typedef struct _TEMPORARY_DATA_BUF_ENTRY
 /**
  * @brief The structure of the temp data buffer table.
  *
- * A fixed-sized 1D temp data buffer array. The number of buffer entries is exactly the
- * number of dies, therefore just choose the target entry by using the dieNo when
- * allocating a temp buffer entry. (check the implementation of `AllocateTempDataBuf`).
+ * A fixed-sized 1D temp data buffer array. The entries of a die are consecutive, starting
+ * from `dieNo * TEMP_DATA_BUF_ENTRY_COUNT_PER_DIE`, and they are handed out in turn by
+ * `AllocateTempDataBuf()`.
  */
 typedef struct _TEMPORARY_DATA_BUF_MAP
 {
     TEMPORARY_DATA_BUF_ENTRY tempDataBuf[AVAILABLE_TEMPORARY_DATA_BUFFER_ENTRY_COUNT];
+    unsigned int nextEntry[USER_DIES]; // the entry of each die to be tried first, within the die
 } TEMPORARY_DATA_BUF_MAP, *P_TEMPORARY_DATA_BUF_MAP;
 
 void InitDataBuf();
+unsigned int ResizeDataBuf(unsigned int entryCount);
+void DropDataBuf();
 void FlushDataBuf(uint32_t cmdSlotTag);
+void FlushDataBufInBackground();
 unsigned int CheckDataBufHit(unsigned int reqSlotTag);
-unsigned int AllocateDataBuf();
+void MarkDataBufDirty(unsigned int bufEntry);
+void MarkDataBufClean(unsigned int bufEntry);
+void MergeDataBufEntry(unsigned int reqSlotTag);
+unsigned int AllocateDataBuf(unsigned int logicalSliceAddr);
+unsigned int AllocateReadAheadDataBuf();
+unsigned int LookupDataBuf(unsigned int logicalSliceAddr);
+void DiscardDataBuf(unsigned int logicalSliceAddr);
 void UpdateDataBufEntryInfoBlockingReq(unsigned int bufEntry, unsigned int reqSlotTag);
 
 unsigned int AllocateTempDataBuf(unsigned int dieNo);
+unsigned int CountIdleTempDataBuf(unsigned int dieNo);
 void UpdateTempDataBufEntryInfoBlockingReq(unsigned int bufEntry, unsigned int reqSlotTag);
 
 void PutToDataBufHashList(unsigned int bufEntry);
 void SelectiveGetFromDataBufHashList(unsigned int bufEntry);
 
+unsigned int DataBufHashLookup(P_DATA_BUF_HASH_SLOT slots, unsigned int slotMask, unsigned int logicalSliceAddr,
+                               unsigned int phyReq);
+void DataBufHashInsert(P_DATA_BUF_HASH_SLOT slots, unsigned int slotMask, unsigned int logicalSliceAddr,
+                       unsigned int phyReq, unsigned int bufEntry);
+void DataBufHashRemove(P_DATA_BUF_HASH_SLOT slots, unsigned int slotMask, unsigned int iSlot);
+
+/**
+ * @brief Mix the bits of the hash key (murmur3 finalizer).
+ *
+ * @param logicalSliceAddr the LSA (or VSA for physical request) of the key
+ * @param phyReq whether the key is for physical request
+ * @return unsigned int the hash value of the key
+ */
+static inline unsigned int DataBufHashMix(unsigned int logicalSliceAddr, unsigned int phyReq)
+{
+    unsigned int h = logicalSliceAddr ^ (phyReq ? 0x9e3779b9 : 0);
+
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    h ^= h >> 16;
+
+    return h;
+}
+
 extern P_DATA_BUF_MAP dataBufMapPtr;
 extern DATA_BUF_LRU_LIST dataBufLruList;
-extern P_DATA_BUF_HASH_TABLE dataBufHashTable;
+extern P_DATA_BUF_HASH_TABLE dataBufHashTablePtr;
 extern P_TEMPORARY_DATA_BUF_MAP tempDataBufMapPtr;
+extern P_DATA_BUF_GHOST_MAP dataBufGhostMapPtr;
+extern DATA_BUF_ARC_STATE dataBufArc;
+extern DATA_BUF_READ_AHEAD_LIST dataBufReadAheadList;
+extern DATA_BUF_STATISTICS dataBufStat;
+extern unsigned int dataBufEntryCount;
+extern unsigned int dataBufHashSlotMask;
 
 /* -------------------------------------------------------------------------- */
 /*                   util macros for data buffer related ops                  */
@@ -249,13 +507,21 @@ extern P_TEMPORARY_DATA_BUF_MAP tempDataBufMapPtr;
 #define BUF_ENTRY_IS_HEAD(iEntry) (BUF_PREV_IDX((iEntry)) == DATA_BUF_NONE)
 #define BUF_ENTRY_IS_TAIL(iEntry) (BUF_NEXT_IDX((iEntry)) == DATA_BUF_NONE)
 
-#define H_BUF_ENTRY(iEntry)      (&dataBufHashTablePtr->dataBufHash[(iEntry)])
-#define H_BUF_HEAD_ENTRY(iEntry) (BUF_ENTRY(H_BUF_ENTRY((iEntry))->headEntry))
-#define H_BUF_HEAD_IDX(iEntry)   (H_BUF_ENTRY((iEntry))->headEntry)
-
 #define BUF_LSA(iEntry) (BUF_ENTRY((iEntry))->logicalSliceAddr)
 
-#define BUF_DATA_ENTRY2ADDR(iEntry)  (DATA_BUFFER_BASE_ADDR + ((iEntry)*BYTES_PER_DATA_REGION_OF_SLICE))
-#define BUF_SPARE_ENTRY2ADDR(iEntry) (SPARE_DATA_BUFFER_BASE_ADDR + ((iEntry)*BYTES_PER_SPARE_REGION_OF_SLICE))
+#define GHOST_ENTRY(iEntry)   (&dataBufGhostMapPtr->ghostBuf[(iEntry)])
+#define GHOST_H_ENTRY(iEntry) (&dataBufGhostMapPtr->ghostBufHash[(iEntry)])
+
+#define BUF_DATA_ENTRY2ADDR(iEntry)                                                                                    \
+    (((iEntry) < DATA_BUF_BASE_ENTRY_COUNT)                                                                            \
+         ? (DATA_BUFFER_BASE_ADDR + ((iEntry)*BYTES_PER_DATA_REGION_OF_SLICE))                                         \
+         : (DATA_BUFFER_EXT_BASE_ADDR + (((iEntry)-DATA_BUF_BASE_ENTRY_COUNT) * BYTES_PER_DATA_REGION_OF_SLICE)))
+#define BUF_SPARE_ENTRY2ADDR(iEntry)                                                                                   \
+    (((iEntry) < DATA_BUF_BASE_ENTRY_COUNT)                                                                            \
+         ? (SPARE_DATA_BUFFER_BASE_ADDR + ((iEntry)*BYTES_PER_SPARE_REGION_OF_SLICE))                                  \
+         : (DATA_BUFFER_EXT_SPARE_BASE_ADDR + (((iEntry)-DATA_BUF_BASE_ENTRY_COUNT) * BYTES_PER_SPARE_REGION_OF_SLICE)))
+
+#define MERGE_BUF_DATA_ENTRY2ADDR(iDie)  (MERGE_DATA_BUFFER_BASE_ADDR + ((iDie)*BYTES_PER_DATA_REGION_OF_SLICE))
+#define MERGE_BUF_SPARE_ENTRY2ADDR(iDie) (MERGE_SPARE_DATA_BUFFER_BASE_ADDR + ((iDie)*BYTES_PER_SPARE_REGION_OF_SLICE))
 
 #endif /* DATA_BUFFER_H_ */
@@ -48,7 +48,11 @@
 #define __DEBUG_H_
 
 #include "stdint.h"
+#ifdef NSC_SIMULATOR
+#include "sim/xil_printf.h"
+#else
 #include "xil_printf.h"
+#endif
 
 /* -------------------------------------------------------------------------- */
 /*                              ANSI escape code                              */
@@ -48,7 +48,11 @@
 
 #include <assert.h>
 #include "debug.h"
+#ifdef NSC_SIMULATOR
+#include "sim/xil_printf.h"
+#else
 #include "xil_printf.h"
+#endif
 #include "memory_map.h"
 #include "t4nsc_ucode.h"
 #include "nsc_driver.h"
@@ -67,11 +71,15 @@ void InitFTL()
     InitChCtlReg();        // assigned the predefined addresses of channel controllers
     InitReqPool();         //
     InitDependencyTable(); //
+    InitReadAhead();       //
+    InitDeallocate();      //
     InitReqScheduler();    //
     InitNandArray();       // "[ NAND device reset complete. ]"
     InitAddressMap();      // "Press 'X' to re-make the bad block table."
     InitDataBuf();         //
     InitGcVictimMap();     //
+    InitWriteStream();     //
+    RecoverAddrMap();      // "[ address map checkpoint ... loaded ... ]"
 
     bufferinit();
     monitorInit();
@@ -103,6 +111,47 @@ void InitFTL()
     
 }
 
+/**
+ * @brief Erase all the user data and bring the FTL back to an empty drive.
+ *
+ * The buffered writes and pending deallocates are dropped instead of being written, the
+ * used blocks are erased by `FormatBlockMap()`, then the empty address maps are saved in a
+ * new checkpoint, which supersedes the address journal, and the bbt is updated if any
+ * block went bad in the sweep.
+ *
+ * @warning The format is not atomic: if the power is lost before the checkpoint is saved,
+ * the old maps are recovered at next boot with some of their blocks erased, and the format
+ * must be issued again.
+ *
+ * @note Like `ResizeDataBuf()`, this should only be called between NVMe commands.
+ *
+ * @return unsigned int the number of grown bad blocks found in the sweep.
+ */
+unsigned int FormatFTL()
+{
+    unsigned int grownBadCnt;
+
+    DropDataBuf();
+    InitReadAhead();
+    InitDeallocate();
+
+    // no journal record for the rebuilt maps, the checkpoint is saved below
+    addrJournal.enabled = 0;
+    grownBadCnt         = FormatBlockMap();
+    InitSliceMap();
+    InitGcVictimMap();
+    InitWriteStream();
+    ResetTargetDie();
+    addrJournal.enabled = 1;
+
+    SaveAddrMapCheckpoint();
+    if (grownBadCnt)
+        UpdateBadBlockTableForGrownBadBlock(RESERVED_DATA_BUFFER_BASE_ADDR);
+
+    return grownBadCnt;
+}
+
+#ifndef NSC_SIMULATOR
 static void nfc_install_ucode(unsigned int *bram0)
 {
     int i;
@@ -115,6 +164,7 @@ static void nfc_install_ucode(unsigned int *bram0)
         bram0[T4NSCu_Common_CodeWordLength + i] = T4NSCuCode_PlainOps[i];
     }
 }
+#endif
 
 /* the mapped base addresses of NAND Storage Controllers */
 unsigned int NSCS[] = {
@@ -136,7 +186,9 @@ void InitChCtlReg()
 
     for (i = 0; i < USER_CHANNELS; i++)
     {
+#ifndef NSC_SIMULATOR
         nfc_install_ucode((unsigned int *)NSC_UCODES[i]);
+#endif
         V2FInitializeHandle(&chCtlReg[i], (void *)NSCS[i]);
         nfc_set_dqs_delay(i, 28);
     }
@@ -267,9 +319,21 @@ void CheckConfigRestriction()
     if (RESERVED_DATA_BUFFER_BASE_ADDR + 0x00200000 > COMPLETE_FLAG_TABLE_ADDR)
         assert(!"[WARNING] Configuration Error: Data buffer size is too large to be allocated to predefined range "
                 "[WARNING]");
+    if (MONITOR_END_ADDR > CH_INFO_START_ADDR)
+        assert(!"[WARNING] Configuration Error: Temp data buffers are too large to be allocated to predefined range "
+                "[WARNING]");
+    if (ADDR_MAP_BUFFER_END_ADDR > COMPLETE_FLAG_TABLE_ADDR)
+        assert(!"[WARNING] Configuration Error: Address map buffers are too large to be allocated to predefined range "
+                "[WARNING]");
+    if (ZERO_DATA_BUFFER_END_ADDR > COMPLETE_FLAG_TABLE_ADDR)
+        assert(!"[WARNING] Configuration Error: Map cache, deallocate range and zero buffers are too large to be "
+                "allocated to predefined range [WARNING]");
     if (TEMPORARY_PAY_LOAD_ADDR + 0x00001000 > DATA_BUFFER_MAP_ADDR)
         assert(!"[WARNING] Configuration Error: Metadata for NAND request completion process is too large to be "
                 "allocated to predefined range [WARNING]");
+    if (NMC_BUFFERS_END_ADDR > DATA_BUFFER_EXT_BASE_ADDR || DATA_BUFFER_EXT_END_ADDR > PARTIAL_DATA_BUFFER_MAP_ADDR)
+        assert(!"[WARNING] Configuration Error: Extended data buffer is too large to be allocated to predefined range "
+                "[WARNING]");
     if (FTL_MANAGEMENT_END_ADDR > DRAM_END_ADDR)
         assert(!"[WARNING] Configuration Error: Metadata of FTL is too large to be allocated to DRAM [WARNING]");
 }
@@ -48,7 +48,11 @@
 #define FTL_CONFIG_H_
 
 #include "nsc_driver.h"
+#ifdef NSC_SIMULATOR
+#include "sim/xparameters.h"
+#else
 #include "xparameters.h"
+#endif
 #include "nvme/nvme.h"
 
 /* -------------------------------------------------------------------------- */
@@ -242,6 +246,7 @@
 #define MB_PER_OVER_PROVISION_BLOCK_SPACE ((USER_BLOCKS_PER_SSD / 10) * MB_PER_BLOCK)
 
 void InitFTL();
+unsigned int FormatFTL();
 void InitChCtlReg();
 void InitNandArray();
 void CheckConfigRestriction();
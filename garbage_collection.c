@@ -36,6 +36,7 @@
 //   - select a victim block
 //   - collect valid pages to a free block
 //   - erase a victim block to make a free block
+//   - migrate cold blocks for static wear leveling
 //////////////////////////////////////////////////////////////////////////////////
 
 //////////////////////////////////////////////////////////////////////////////////
@@ -45,11 +46,20 @@
 //   - First draft
 //////////////////////////////////////////////////////////////////////////////////
 
+#ifdef NSC_SIMULATOR
+#include "sim/xil_printf.h"
+#else
 #include "xil_printf.h"
+#endif
 #include <assert.h>
+#include "debug.h"
 #include "memory_map.h"
 
 P_GC_VICTIM_MAP gcVictimMapPtr;
+unsigned int gcTriggered; // GC runs since boot
+unsigned int copyCnt;     // valid slices copied by GC since boot
+GC_STATE gcState;
+WEAR_LEVELING_STATE wearLeveling;
 
 void InitGcVictimMap()
 {
@@ -64,81 +74,377 @@ void InitGcVictimMap()
             gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].headBlock = BLOCK_NONE;
             gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].tailBlock = BLOCK_NONE;
         }
+
+        gcState.die[dieNo].victimBlock = BLOCK_NONE;
+        gcState.die[dieNo].nextPage    = 0;
+        gcState.die[dieNo].copiedCnt   = 0;
     }
 }
 
-void GarbageCollection(unsigned int dieNo)
+/**
+ * @brief Copy a valid slice of a GC victim to the GC stream of its die.
+ *
+ * The read and the write share a temp buffer entry of the die, the copies that take the
+ * same entry are done one by one, in the order they are issued. If the target block is on
+ * the same LUN, a single copyback request is issued instead, check `GC_COPYBACK`.
+ *
+ * @param dieNo the die number of the victim block.
+ * @param virtualSliceAddr the valid slice to be copied.
+ * @param logicalSliceAddr the logical slice mapped to the valid slice.
+ */
+static void CopyValidSlice(unsigned int dieNo, unsigned int virtualSliceAddr, unsigned int logicalSliceAddr)
+{
+    unsigned int reqSlotTag, bufEntry, targetVsa, srcLun, targetLun;
+
+    bufEntry  = AllocateTempDataBuf(dieNo);
+    targetVsa = FindFreeVirtualSliceForGc(dieNo);
+    srcLun    = Vblock2PblockOfTbsTranslation(Vsa2VblockTranslation(virtualSliceAddr)) / TOTAL_BLOCKS_PER_LUN;
+    targetLun = Vblock2PblockOfTbsTranslation(Vsa2VblockTranslation(targetVsa)) / TOTAL_BLOCKS_PER_LUN;
+
+    if (GC_COPYBACK && (srcLun == targetLun))
+    {
+        reqSlotTag = GetFromFreeReqQ();
+
+        // the ECC warning makes the copy a write of the temp buffer, check `ExecuteNandReq()`
+        reqPoolPtr->reqPool[reqSlotTag].reqType                       = REQ_TYPE_NAND;
+        reqPoolPtr->reqPool[reqSlotTag].reqCode                       = REQ_CODE_COPYBACK;
+        reqPoolPtr->reqPool[reqSlotTag].logicalSliceAddr              = logicalSliceAddr;
+        reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat          = REQ_OPT_DATA_BUF_TEMP_ENTRY;
+        reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandAddr               = REQ_OPT_NAND_ADDR_VSA;
+        reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandEcc                = REQ_OPT_NAND_ECC_ON;
+        reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandEccWarning         = REQ_OPT_NAND_ECC_WARNING_ON;
+        reqPoolPtr->reqPool[reqSlotTag].reqOpt.rowAddrDependencyCheck = REQ_OPT_ROW_ADDR_DEPENDENCY_CHECK;
+        reqPoolPtr->reqPool[reqSlotTag].reqOpt.blockSpace             = REQ_OPT_BLOCK_SPACE_MAIN;
+        reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.entry             = bufEntry;
+        UpdateTempDataBufEntryInfoBlockingReq(reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.entry, reqSlotTag);
+        reqPoolPtr->reqPool[reqSlotTag].nandInfo.virtualSliceAddr = targetVsa;
+        reqPoolPtr->reqPool[reqSlotTag].nandInfo.copybackSrcVsa   = virtualSliceAddr;
+        gcState.copybackCnt++;
+    }
+    else
+    {
+        // read
+        reqSlotTag = GetFromFreeReqQ();
+
+        reqPoolPtr->reqPool[reqSlotTag].reqType                       = REQ_TYPE_NAND;
+        reqPoolPtr->reqPool[reqSlotTag].reqCode                       = REQ_CODE_READ;
+        reqPoolPtr->reqPool[reqSlotTag].logicalSliceAddr              = logicalSliceAddr;
+        reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat          = REQ_OPT_DATA_BUF_TEMP_ENTRY;
+        reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandAddr               = REQ_OPT_NAND_ADDR_VSA;
+        reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandEcc                = REQ_OPT_NAND_ECC_ON;
+        reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandEccWarning         = REQ_OPT_NAND_ECC_WARNING_OFF;
+        reqPoolPtr->reqPool[reqSlotTag].reqOpt.rowAddrDependencyCheck = REQ_OPT_ROW_ADDR_DEPENDENCY_CHECK;
+        reqPoolPtr->reqPool[reqSlotTag].reqOpt.blockSpace             = REQ_OPT_BLOCK_SPACE_MAIN;
+        reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.entry             = bufEntry;
+        UpdateTempDataBufEntryInfoBlockingReq(reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.entry, reqSlotTag);
+        reqPoolPtr->reqPool[reqSlotTag].nandInfo.virtualSliceAddr = virtualSliceAddr;
+
+        SelectLowLevelReqQ(reqSlotTag);
+
+        // write
+        reqSlotTag = GetFromFreeReqQ();
+
+        reqPoolPtr->reqPool[reqSlotTag].reqType                       = REQ_TYPE_NAND;
+        reqPoolPtr->reqPool[reqSlotTag].reqCode                       = REQ_CODE_WRITE;
+        reqPoolPtr->reqPool[reqSlotTag].logicalSliceAddr              = logicalSliceAddr;
+        reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat          = REQ_OPT_DATA_BUF_TEMP_ENTRY;
+        reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandAddr               = REQ_OPT_NAND_ADDR_VSA;
+        reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandEcc                = REQ_OPT_NAND_ECC_ON;
+        reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandEccWarning         = REQ_OPT_NAND_ECC_WARNING_OFF;
+        reqPoolPtr->reqPool[reqSlotTag].reqOpt.rowAddrDependencyCheck = REQ_OPT_ROW_ADDR_DEPENDENCY_CHECK;
+        reqPoolPtr->reqPool[reqSlotTag].reqOpt.blockSpace             = REQ_OPT_BLOCK_SPACE_MAIN;
+        reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.entry             = bufEntry;
+        UpdateTempDataBufEntryInfoBlockingReq(reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.entry, reqSlotTag);
+        reqPoolPtr->reqPool[reqSlotTag].nandInfo.virtualSliceAddr = targetVsa;
+    }
+
+    SET_LSA2VSA(logicalSliceAddr, reqPoolPtr->reqPool[reqSlotTag].nandInfo.virtualSliceAddr);
+    virtualSliceMapPtr->virtualSlice[reqPoolPtr->reqPool[reqSlotTag].nandInfo.virtualSliceAddr].logicalSliceAddr =
+        logicalSliceAddr;
+    CLEAR_VSA_VALID(virtualSliceAddr);
+    SET_VSA_VALID(reqPoolPtr->reqPool[reqSlotTag].nandInfo.virtualSliceAddr);
+    JournalAddrTrans(logicalSliceAddr, reqPoolPtr->reqPool[reqSlotTag].nandInfo.virtualSliceAddr);
+    reqPoolPtr->reqPool[reqSlotTag].nandInfo.writeSeq = addrJournal.writeSeq;
+
+    SelectLowLevelReqQ(reqSlotTag);
+}
+
+/**
+ * @brief Make the given block the victim of the GC of its die.
+ *
+ * @param dieNo the die number of the victim block.
+ * @param victimBlockNo the victim block, already taken from its GC victim list.
+ */
+static void StartCollecting(unsigned int dieNo, unsigned int victimBlockNo)
 {
-    unsigned int victimBlockNo, pageNo, virtualSliceAddr, logicalSliceAddr, dieNoForGcCopy, reqSlotTag;
+    ASSERT(gcState.die[dieNo].victimBlock == BLOCK_NONE, "Die[%u]: GC of VBlk %u is not finished", dieNo,
+           gcState.die[dieNo].victimBlock);
 
-    victimBlockNo  = GetFromGcVictimList(dieNo);
-    dieNoForGcCopy = dieNo;
+    // the victim may be a current block, the remaining pages must not be used by the copies
+    CloseCurrentBlock(dieNo, victimBlockNo);
+
+    VBLK_ENTRY(dieNo, victimBlockNo)->collecting = 1;
+    gcState.die[dieNo].victimBlock               = victimBlockNo;
+    gcState.die[dieNo].nextPage                  = 0;
+    gcState.die[dieNo].copiedCnt                 = 0;
+}
+
+/**
+ * @brief Copy the next valid slices of the victim of the given die.
+ *
+ * The valid slices are found in the valid slice bitmap of the victim, a word at a time, so
+ * the invalid slices cost nothing. The slices overwritten by host after the GC started are
+ * cleared from the bitmap by `InvalidateOldVsa()`.
+ *
+ * @param dieNo the die number of the victim block.
+ * @param maxCopyCnt the copies to be issued at most.
+ */
+static void CollectVictimSlices(unsigned int dieNo, unsigned int maxCopyCnt)
+{
+    P_GC_DIE_STATE gc = &gcState.die[dieNo];
+    unsigned int virtualSliceAddr, validBits, issuedCnt;
 
-    if (virtualBlockMapPtr->block[dieNo][victimBlockNo].invalidSliceCnt != SLICES_PER_BLOCK)
+    issuedCnt = 0;
+    while (issuedCnt < maxCopyCnt && gc->nextPage < USER_PAGES_PER_BLOCK)
     {
-        for (pageNo = 0; pageNo < USER_PAGES_PER_BLOCK; pageNo++)
+        // the valid slices from the next page to the end of its word
+        validBits = VBLK_VALID_BITS(dieNo, gc->victimBlock)[gc->nextPage / 32] >> (gc->nextPage % 32);
+        if (!validBits)
         {
-            virtualSliceAddr = Vorg2VsaTranslation(dieNo, victimBlockNo, pageNo);
-            logicalSliceAddr = virtualSliceMapPtr->virtualSlice[virtualSliceAddr].logicalSliceAddr;
-
-            if (logicalSliceAddr != LSA_NONE)
-                if (logicalSliceMapPtr->logicalSlice[logicalSliceAddr].virtualSliceAddr ==
-                    virtualSliceAddr) // valid data
-                {
-                    // read
-                    reqSlotTag = GetFromFreeReqQ();
-
-                    reqPoolPtr->reqPool[reqSlotTag].reqType               = REQ_TYPE_NAND;
-                    reqPoolPtr->reqPool[reqSlotTag].reqCode               = REQ_CODE_READ;
-                    reqPoolPtr->reqPool[reqSlotTag].logicalSliceAddr      = logicalSliceAddr;
-                    reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat  = REQ_OPT_DATA_BUF_TEMP_ENTRY;
-                    reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandAddr       = REQ_OPT_NAND_ADDR_VSA;
-                    reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandEcc        = REQ_OPT_NAND_ECC_ON;
-                    reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandEccWarning = REQ_OPT_NAND_ECC_WARNING_OFF;
-                    reqPoolPtr->reqPool[reqSlotTag].reqOpt.rowAddrDependencyCheck =
-                        REQ_OPT_ROW_ADDR_DEPENDENCY_CHECK;
-                    reqPoolPtr->reqPool[reqSlotTag].reqOpt.blockSpace = REQ_OPT_BLOCK_SPACE_MAIN;
-                    reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.entry = AllocateTempDataBuf(dieNo);
-                    UpdateTempDataBufEntryInfoBlockingReq(reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.entry,
-                                                          reqSlotTag);
-                    reqPoolPtr->reqPool[reqSlotTag].nandInfo.virtualSliceAddr = virtualSliceAddr;
-
-                    SelectLowLevelReqQ(reqSlotTag);
-
-                    // write
-                    reqSlotTag = GetFromFreeReqQ();
-
-                    reqPoolPtr->reqPool[reqSlotTag].reqType               = REQ_TYPE_NAND;
-                    reqPoolPtr->reqPool[reqSlotTag].reqCode               = REQ_CODE_WRITE;
-                    reqPoolPtr->reqPool[reqSlotTag].logicalSliceAddr      = logicalSliceAddr;
-                    reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat  = REQ_OPT_DATA_BUF_TEMP_ENTRY;
-                    reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandAddr       = REQ_OPT_NAND_ADDR_VSA;
-                    reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandEcc        = REQ_OPT_NAND_ECC_ON;
-                    reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandEccWarning = REQ_OPT_NAND_ECC_WARNING_OFF;
-                    reqPoolPtr->reqPool[reqSlotTag].reqOpt.rowAddrDependencyCheck =
-                        REQ_OPT_ROW_ADDR_DEPENDENCY_CHECK;
-                    reqPoolPtr->reqPool[reqSlotTag].reqOpt.blockSpace = REQ_OPT_BLOCK_SPACE_MAIN;
-                    reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.entry = AllocateTempDataBuf(dieNo);
-                    UpdateTempDataBufEntryInfoBlockingReq(reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.entry,
-                                                          reqSlotTag);
-                    reqPoolPtr->reqPool[reqSlotTag].nandInfo.virtualSliceAddr =
-                        FindFreeVirtualSliceForGc(dieNoForGcCopy, victimBlockNo);
-
-                    logicalSliceMapPtr->logicalSlice[logicalSliceAddr].virtualSliceAddr =
-                        reqPoolPtr->reqPool[reqSlotTag].nandInfo.virtualSliceAddr;
-                    virtualSliceMapPtr->virtualSlice[reqPoolPtr->reqPool[reqSlotTag].nandInfo.virtualSliceAddr]
-                        .logicalSliceAddr = logicalSliceAddr;
-
-                    SelectLowLevelReqQ(reqSlotTag);
-                }
+            gc->nextPage = (gc->nextPage / 32 + 1) * 32;
+            if (gc->nextPage > USER_PAGES_PER_BLOCK)
+                gc->nextPage = USER_PAGES_PER_BLOCK;
+            continue;
         }
+
+        gc->nextPage += __builtin_ctz(validBits);
+        virtualSliceAddr = Vorg2VsaTranslation(dieNo, gc->victimBlock, gc->nextPage);
+        CopyValidSlice(dieNo, virtualSliceAddr, VSA2LSA(virtualSliceAddr));
+        gc->nextPage++;
+        issuedCnt++;
     }
+    gc->copiedCnt += issuedCnt;
+}
+
+/**
+ * @brief Erase the victim of the given die once all its valid slices are copied.
+ *
+ * @param dieNo the die number of the victim block.
+ * @return unsigned int the number of valid slices copied from the victim.
+ */
+static unsigned int EraseVictim(unsigned int dieNo)
+{
+    P_GC_DIE_STATE gc = &gcState.die[dieNo];
+    unsigned int victimBlockNo, copiedCnt;
 
+    victimBlockNo = gc->victimBlock;
+    copiedCnt     = gc->copiedCnt;
+
+    // the copied slices must be found through the journal once the victim is erased
+    if (copiedCnt)
+        FlushAddrJournal();
+
+    VBLK_ENTRY(dieNo, victimBlockNo)->collecting = 0;
+    gc->victimBlock                              = BLOCK_NONE;
     EraseBlock(dieNo, victimBlockNo);
+    return copiedCnt;
+}
+
+/**
+ * @brief Copy all the remaining valid slices of the victim of the given die and erase it.
+ *
+ * @param dieNo the die number of the victim block.
+ * @return unsigned int the number of valid slices copied from the victim.
+ */
+static unsigned int FinishCollecting(unsigned int dieNo)
+{
+    CollectVictimSlices(dieNo, SLICES_PER_BLOCK);
+    return EraseVictim(dieNo);
+}
+
+/**
+ * @brief Free a block of the given die in the foreground.
+ *
+ * The victim of the background GC of the die is finished if any, since some of its slices
+ * may be copied already, otherwise a new victim is taken and collected at once.
+ *
+ * @param dieNo the die that runs out of free blocks.
+ */
+void GarbageCollection(unsigned int dieNo)
+{
+    if (gcState.die[dieNo].victimBlock == BLOCK_NONE)
+    {
+        StartCollecting(dieNo, GetFromGcVictimList(dieNo));
+        gcTriggered++;
+    }
+    gcState.foregroundCnt++;
+
+    copyCnt += FinishCollecting(dieNo);
+}
+
+/**
+ * @brief Check whether the given die has any block with invalid slices to be collected.
+ */
+static unsigned int HasGcVictim(unsigned int dieNo)
+{
+    unsigned int invalidSliceCnt;
+
+    for (invalidSliceCnt = SLICES_PER_BLOCK; invalidSliceCnt > 0; invalidSliceCnt--)
+        if (gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].headBlock != BLOCK_NONE)
+            return 1;
+    return 0;
+}
+
+/**
+ * @brief Make a bounded progress on the GC of each die, check `GC_STATE`.
+ *
+ * Called from the main loop, after each I/O command and while the host is idle.
+ */
+void GarbageCollectionInBackground()
+{
+    P_GC_DIE_STATE gc;
+    unsigned int dieNo, urgent, idleBufCnt;
+
+    for (dieNo = 0; dieNo < USER_DIES; dieNo++)
+    {
+        gc     = &gcState.die[dieNo];
+        urgent = (VDIE_ENTRY(dieNo)->freeBlockCnt <= GC_URGENT_FREE_BLOCKS);
+
+        if (gc->victimBlock == BLOCK_NONE)
+        {
+            if (VDIE_ENTRY(dieNo)->freeBlockCnt > GC_START_FREE_BLOCKS || !HasGcVictim(dieNo))
+                continue;
+
+            StartCollecting(dieNo, GetFromGcVictimList(dieNo));
+            gcTriggered++;
+            gcState.backgroundCnt++;
+            pr_debug("Die[%u]: Collect VBlk %u in background", dieNo, gc->victimBlock);
+        }
+
+        idleBufCnt = CountIdleTempDataBuf(dieNo);
+
+        if (gc->nextPage == USER_PAGES_PER_BLOCK)
+        {
+            if (idleBufCnt == TEMP_DATA_BUF_ENTRY_COUNT_PER_DIE)
+                copyCnt += EraseVictim(dieNo);
+            continue;
+        }
+
+        if (urgent)
+            idleBufCnt = TEMP_DATA_BUF_ENTRY_COUNT_PER_DIE;
+        else
+        {
+            if (!idleBufCnt)
+                continue;
+            if (nandReqQ[Vdie2PchTranslation(dieNo)][Vdie2PwayTranslation(dieNo)].hostReadReqCnt)
+            {
+                gcState.yieldCnt++;
+                continue;
+            }
+        }
+
+        CollectVictimSlices(dieNo, GC_COPIES_PER_TICK * idleBufCnt);
+    }
+}
+
+/**
+ * @brief Finish the GCs of all the dies, so no victim is out of the victim lists.
+ *
+ * Called before the block maps are saved, check `SaveAddrMapCheckpoint()`.
+ */
+void SyncGarbageCollection()
+{
+    unsigned int dieNo;
+
+    for (dieNo = 0; dieNo < USER_DIES; dieNo++)
+        if (gcState.die[dieNo].victimBlock != BLOCK_NONE)
+            copyCnt += FinishCollecting(dieNo);
+}
+
+/**
+ * @brief Check whether the given block holds data that may be migrated by wear leveling.
+ *
+ * The current blocks are still being written, and the blocks of the NMC files are located
+ * by their physical block numbers, check `nmcRecordBlock()`.
+ */
+static unsigned int IsWearLevelingCandidate(unsigned int dieNo, unsigned int blockNo)
+{
+    unsigned int stream;
+
+    if (VBLK_ENTRY(dieNo, blockNo)->bad || VBLK_ENTRY(dieNo, blockNo)->free ||
+        VBLK_ENTRY(dieNo, blockNo)->deallocating || VBLK_ENTRY(dieNo, blockNo)->stream == WRITE_STREAM_NMC)
+        return 0;
+
+    for (stream = 0; stream < WRITE_STREAM_COUNT; stream++)
+        if (VDIE_ENTRY(dieNo)->currentBlock[stream] == blockNo)
+            return 0;
+    return 1;
+}
+
+/**
+ * @brief Migrate the least worn block holding data of a die if it falls too far behind.
+ *
+ * At most one die is checked per call, the next one with `WEAR_LEVELING_CHECK_ERASES`
+ * erases since its last check, so the migrations cost at most one block copy per that
+ * many erases. The dies with a GC in progress are checked after it is finished, since the
+ * migrated block is collected as a GC victim.
+ */
+void WearLevelingInBackground()
+{
+    unsigned int dieNo, iDie, blockNo, maxEraseCnt, minEraseCnt, coldBlockNo;
+
+    dieNo = wearLeveling.nextDie;
+    for (iDie = 0; iDie < USER_DIES; iDie++)
+    {
+        if (wearLeveling.erasedCnt[dieNo] >= WEAR_LEVELING_CHECK_ERASES &&
+            gcState.die[dieNo].victimBlock == BLOCK_NONE)
+            break;
+        dieNo = (dieNo + 1) % USER_DIES;
+    }
+    if (iDie == USER_DIES)
+        return;
+
+    wearLeveling.nextDie          = (dieNo + 1) % USER_DIES;
+    wearLeveling.erasedCnt[dieNo] = 0;
+    wearLeveling.checkCnt++;
+
+    // the copies may take one more block for the GC stream before the victim is erased
+    if (!VDIE_ENTRY(dieNo)->freeBlockCnt)
+        return;
+
+    maxEraseCnt = 0;
+    minEraseCnt = 0;
+    coldBlockNo = BLOCK_NONE;
+    for (blockNo = 0; blockNo < USER_BLOCKS_PER_DIE; blockNo++)
+    {
+        if (VBLK_ENTRY(dieNo, blockNo)->bad)
+            continue;
+        if (VBLK_ENTRY(dieNo, blockNo)->eraseCnt > maxEraseCnt)
+            maxEraseCnt = VBLK_ENTRY(dieNo, blockNo)->eraseCnt;
+        if (IsWearLevelingCandidate(dieNo, blockNo) &&
+            (coldBlockNo == BLOCK_NONE || VBLK_ENTRY(dieNo, blockNo)->eraseCnt < minEraseCnt))
+        {
+            coldBlockNo = blockNo;
+            minEraseCnt = VBLK_ENTRY(dieNo, blockNo)->eraseCnt;
+        }
+    }
+
+    if (coldBlockNo == BLOCK_NONE || maxEraseCnt - minEraseCnt <= WEAR_LEVELING_THRESHOLD)
+        return;
+
+    pr_debug("Die[%u]: Migrate VBlk %u for wear leveling, erase count %u, max %u", dieNo, coldBlockNo, minEraseCnt,
+             maxEraseCnt);
+
+    SelectiveGetFromGcVictimList(dieNo, coldBlockNo);
+    wearLeveling.migratedCnt++;
+    StartCollecting(dieNo, coldBlockNo);
+    wearLeveling.copyCnt += FinishCollecting(dieNo);
 }
 
 void PutToGcVictimList(unsigned int dieNo, unsigned int blockNo, unsigned int invalidSliceCnt)
 {
+    virtualBlockMapPtr->block[dieNo][blockNo].modifiedSeq = addrJournal.writeSeq;
+
     if (gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].tailBlock != BLOCK_NONE)
     {
         virtualBlockMapPtr->block[dieNo][blockNo].prevBlock =
@@ -157,35 +463,86 @@ void PutToGcVictimList(unsigned int dieNo, unsigned int blockNo, unsigned int in
     }
 }
 
-unsigned int GetFromGcVictimList(unsigned int dieNo)
+#if (GC_VICTIM_POLICY == GC_VICTIM_POLICY_COST_BENEFIT)
+/**
+ * @brief Select the victim with the highest cost-benefit score on the given die.
+ *
+ * The score `(1 - u) / 2u * age` is `invalid * age / (2 * valid)` in slices, the constant
+ * factor is dropped and the scores are compared by cross multiplication. A block without
+ * valid slices costs nothing to collect and is taken first.
+ *
+ * @param dieNo the die number to be collected.
+ * @return unsigned int the victim block, or `BLOCK_NONE` if the victim lists are empty.
+ */
+static unsigned int SelectGcVictim(unsigned int dieNo)
+{
+    unsigned int invalidSliceCnt, blockNo, victimBlockNo, validSliceCnt, victimValidSliceCnt;
+    unsigned long long benefit, victimBenefit;
+
+    victimBlockNo = gcVictimMapPtr->gcVictimList[dieNo][SLICES_PER_BLOCK].headBlock;
+    if (victimBlockNo != BLOCK_NONE)
+        return victimBlockNo;
+
+    victimBenefit       = 0;
+    victimValidSliceCnt = 1;
+    for (invalidSliceCnt = SLICES_PER_BLOCK - 1; invalidSliceCnt > 0; invalidSliceCnt--)
+    {
+        // the head of each list is its least recently invalidated block
+        blockNo = gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].headBlock;
+        if (blockNo == BLOCK_NONE)
+            continue;
+
+        benefit = (unsigned long long)invalidSliceCnt *
+                  (addrJournal.writeSeq - virtualBlockMapPtr->block[dieNo][blockNo].modifiedSeq + 1);
+        validSliceCnt = SLICES_PER_BLOCK - invalidSliceCnt;
+        if (victimBlockNo == BLOCK_NONE || benefit * victimValidSliceCnt > victimBenefit * validSliceCnt)
+        {
+            victimBlockNo       = blockNo;
+            victimBenefit       = benefit;
+            victimValidSliceCnt = validSliceCnt;
+        }
+    }
+
+    return victimBlockNo;
+}
+#else
+/**
+ * @brief Select the victim with the most invalid slices on the given die.
+ *
+ * @param dieNo the die number to be collected.
+ * @return unsigned int the victim block, or `BLOCK_NONE` if the victim lists are empty.
+ */
+static unsigned int SelectGcVictim(unsigned int dieNo)
 {
-    unsigned int evictedBlockNo;
     int invalidSliceCnt;
 
     for (invalidSliceCnt = SLICES_PER_BLOCK; invalidSliceCnt > 0; invalidSliceCnt--)
-    {
         if (gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].headBlock != BLOCK_NONE)
-        {
-            evictedBlockNo = gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].headBlock;
+            return gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].headBlock;
 
-            if (virtualBlockMapPtr->block[dieNo][evictedBlockNo].nextBlock != BLOCK_NONE)
-            {
-                virtualBlockMapPtr->block[dieNo][virtualBlockMapPtr->block[dieNo][evictedBlockNo].nextBlock]
-                    .prevBlock = BLOCK_NONE;
-                gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].headBlock =
-                    virtualBlockMapPtr->block[dieNo][evictedBlockNo].nextBlock;
-            }
-            else
-            {
-                gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].headBlock = BLOCK_NONE;
-                gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].tailBlock = BLOCK_NONE;
-            }
-            return evictedBlockNo;
-        }
+    return BLOCK_NONE;
+}
+#endif /* GC_VICTIM_POLICY */
+
+/**
+ * @brief Take the GC victim of the given die from its victim list, check `GC_VICTIM_POLICY`.
+ *
+ * @param dieNo the die number to be collected.
+ * @return unsigned int the victim block.
+ */
+unsigned int GetFromGcVictimList(unsigned int dieNo)
+{
+    unsigned int victimBlockNo;
+
+    victimBlockNo = SelectGcVictim(dieNo);
+    if (victimBlockNo == BLOCK_NONE)
+    {
+        assert(!"[WARNING] There are no free blocks. Abort terminate this ssd. [WARNING]");
+        return BLOCK_FAIL;
     }
 
-    assert(!"[WARNING] There are no free blocks. Abort terminate this ssd. [WARNING]");
-    return BLOCK_FAIL;
+    SelectiveGetFromGcVictimList(dieNo, victimBlockNo);
+    return victimBlockNo;
 }
 
 void SelectiveGetFromGcVictimList(unsigned int dieNo, unsigned int blockNo)
@@ -59,8 +59,106 @@ typedef struct _GC_VICTIM_MAP
     GC_VICTIM_LIST_ENTRY gcVictimList[USER_DIES][SLICES_PER_BLOCK + 1];
 } GC_VICTIM_MAP, *P_GC_VICTIM_MAP;
 
+/**
+ * The GC victim of a die is selected by `GC_VICTIM_POLICY` (default cost-benefit):
+ *
+ * - `GC_VICTIM_POLICY_GREEDY`: the block with the most invalid slices.
+ * - `GC_VICTIM_POLICY_COST_BENEFIT`: the block with the highest `(1 - u) / 2u * age`, where
+ *   `u` is the ratio of its valid slices and `age` is the number of slices written since
+ *   its last invalidation, so the blocks still being invalidated are left to age.
+ *
+ * A block is appended to the victim list of its invalid slice count at each invalidation,
+ * so each list is sorted by `VIRTUAL_BLOCK_ENTRY::modifiedSeq` and its head has the highest
+ * score of the list. Only the heads are compared, whatever the number of blocks.
+ */
+#define GC_VICTIM_POLICY_GREEDY       0
+#define GC_VICTIM_POLICY_COST_BENEFIT 1
+
+#ifndef GC_VICTIM_POLICY
+#define GC_VICTIM_POLICY GC_VICTIM_POLICY_COST_BENEFIT
+#endif
+
+/**
+ * GC runs in the background, one victim per die at a time, so the host commands are not
+ * held for the copies of a whole victim. A die takes a victim once its free blocks drop to
+ * `GC_START_FREE_BLOCKS`, then each call of `GarbageCollectionInBackground()` copies at most
+ * `GC_COPIES_PER_TICK` valid slices of the victim for each idle temp buffer entry of the die,
+ * unless a host read is queued on the die. So the copies of the die are pipelined over its
+ * `TEMP_DATA_BUF_ENTRY_COUNT_PER_DIE` entries. The victim is erased once its copies are done.
+ *
+ * Once the free blocks drop to `GC_URGENT_FREE_BLOCKS`, the copies are issued for all the
+ * entries without waiting for the previous ones nor the host reads. If a die still runs out
+ * of free blocks, the GC of the die is finished in the foreground, check `GarbageCollection()`.
+ */
+#ifndef GC_START_FREE_BLOCKS
+#define GC_START_FREE_BLOCKS (RESERVED_FREE_BLOCK_COUNT + 3)
+#endif
+#define GC_URGENT_FREE_BLOCKS (RESERVED_FREE_BLOCK_COUNT + 1)
+#define GC_COPIES_PER_TICK    4
+
+/**
+ * A valid slice copied to a block on the same LUN is moved by NAND copyback when `GC_COPYBACK`
+ * is 1: the page is read to the page register and transferred out only for its ECC check,
+ * then programmed from the page register with a new spare region, so the data is not sent
+ * back over the channel. A page whose bit errors exceed the ECC warning threshold is
+ * programmed from the corrected data in the temp buffer instead, like the other copies.
+ *
+ * The copyback sequences are not in the microcode of the NAND controller, so it is only
+ * available to the NAND simulator, and off by default there too to keep the GC data path
+ * of the board. Build with `-DGC_COPYBACK=1` to try it, check `V2FCopybackProgramAsync()`.
+ */
+#ifndef GC_COPYBACK
+#define GC_COPYBACK 0
+#endif
+
+#if GC_COPYBACK && !defined(NSC_SIMULATOR)
+#error "copyback requires microcode support"
+#endif
+
+typedef struct _GC_DIE_STATE
+{
+    unsigned int victimBlock : 16; // the victim being collected, or `BLOCK_NONE`
+    unsigned int nextPage : 16;    // the first page of the victim not checked for valid slices yet
+    unsigned int copiedCnt;        // valid slices of the victim copied so far
+} GC_DIE_STATE, *P_GC_DIE_STATE;
+
+typedef struct _GC_STATE
+{
+    GC_DIE_STATE die[USER_DIES];
+    unsigned int backgroundCnt;   // victims taken in the background since boot
+    unsigned int foregroundCnt;   // GCs finished in the foreground since boot
+    unsigned int yieldCnt;        // calls a die skipped its copies for the host reads since boot
+    unsigned int copybackCnt;     // valid slices copied by NAND copyback since boot
+    unsigned int eccRoundTripCnt; // copybacks programmed from the temp buffer for their bit errors
+} GC_STATE, *P_GC_STATE;
+
+/**
+ * Static wear leveling: a block holding cold data is never chosen by GC, so it stays at a
+ * low erase count while the free blocks are worn by the hot data. A die is checked every
+ * `WEAR_LEVELING_CHECK_ERASES` erases on it, while the host is idle. If its most worn block
+ * has been erased more than `WEAR_LEVELING_THRESHOLD` times more than its least worn block
+ * holding data, the data is copied to the GC stream and the block is erased, so it goes to
+ * the head of the free block list, check `PutToFbList()`.
+ */
+#ifndef WEAR_LEVELING_THRESHOLD
+#define WEAR_LEVELING_THRESHOLD 100
+#endif
+#define WEAR_LEVELING_CHECK_ERASES 16
+
+typedef struct _WEAR_LEVELING_STATE
+{
+    unsigned int erasedCnt[USER_DIES]; // erases on each die since its last check
+    unsigned int nextDie;              // the die to be checked next
+    unsigned int checkCnt;             // dies checked since boot
+    unsigned int migratedCnt;          // cold blocks migrated since boot
+    unsigned int copyCnt;              // valid slices copied by the migrations since boot
+} WEAR_LEVELING_STATE, *P_WEAR_LEVELING_STATE;
+
 void InitGcVictimMap();
 void GarbageCollection(unsigned int dieNo);
+void GarbageCollectionInBackground();
+void SyncGarbageCollection();
+void WearLevelingInBackground();
 
 void PutToGcVictimList(unsigned int dieNo, unsigned int blockNo, unsigned int invalidSliceCnt);
 unsigned int GetFromGcVictimList(unsigned int dieNo);
@@ -69,5 +167,7 @@ void SelectiveGetFromGcVictimList(unsigned int dieNo, unsigned int blockNo);
 extern P_GC_VICTIM_MAP gcVictimMapPtr;
 extern unsigned int gcTriggered;
 extern unsigned int copyCnt;
+extern GC_STATE gcState;
+extern WEAR_LEVELING_STATE wearLeveling;
 
 #endif /* GARBAGE_COLLECTION_H_ */
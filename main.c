@@ -58,6 +58,9 @@
 //   - First draft
 //////////////////////////////////////////////////////////////////////////////////
 
+// the host build of the firmware starts from "nvme/nvme_bench.c" instead
+#ifndef NSC_SIMULATOR
+
 #include "xil_cache.h"
 #include "xil_exception.h"
 #include "xil_mmu.h"
@@ -99,6 +102,8 @@ int main()
             pr_info("TLB attribute: set uncached & nonbuffered at %u MB for NMC", u);
             Xil_SetTlbAttributes(u * MB, 0xC12); // uncached & nonbuffered
         }
+        else if (DATA_BUFFER_EXT_START_MB <= u && u <= DATA_BUFFER_EXT_END_MB)
+            Xil_SetTlbAttributes(u * MB, 0xC12); // uncached & nonbuffered
         else if(u >= 0x2FF && u <= 0x320)
         {
             Xil_SetTlbAttributes(u * MB, 0xC12);
@@ -139,3 +144,5 @@ int main()
 
     return 0;
 }
+
+#endif /* NSC_SIMULATOR */
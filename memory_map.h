@@ -53,6 +53,8 @@
 #include "request_schedule.h"
 #include "request_transform.h"
 #include "garbage_collection.h"
+#include "address_journal.h"
+#include "write_stream.h"
 
 #include "monitor/monitor.h"
 
@@ -78,25 +80,30 @@
 /**
  * @brief The base address of buffer for DMA requests.
  *
- * different from `DATA_BUFFER_MAP_ADDR`, but with the same number of entries (`AVAILABLE_DATA_BUFFER_ENTRY_COUNT`)
+ * different from `DATA_BUFFER_MAP_ADDR`, only the first `DATA_BUF_BASE_ENTRY_COUNT` entries are here, the
+ * others are at `DATA_BUFFER_EXT_BASE_ADDR`.
  */
 #define DATA_BUFFER_BASE_ADDR 0x10000000
 #define TEMPORARY_DATA_BUFFER_BASE_ADDR                                                                           \
-    (DATA_BUFFER_BASE_ADDR + AVAILABLE_DATA_BUFFER_ENTRY_COUNT * BYTES_PER_DATA_REGION_OF_SLICE)
+    (DATA_BUFFER_BASE_ADDR + DATA_BUF_BASE_ENTRY_COUNT * BYTES_PER_DATA_REGION_OF_SLICE)
 #define SPARE_DATA_BUFFER_BASE_ADDR                                                                               \
     (TEMPORARY_DATA_BUFFER_BASE_ADDR +                                                                            \
      AVAILABLE_TEMPORARY_DATA_BUFFER_ENTRY_COUNT * BYTES_PER_DATA_REGION_OF_SLICE)
 #define TEMPORARY_SPARE_DATA_BUFFER_BASE_ADDR                                                                     \
-    (SPARE_DATA_BUFFER_BASE_ADDR + AVAILABLE_DATA_BUFFER_ENTRY_COUNT * BYTES_PER_SPARE_REGION_OF_SLICE)
-#define RESERVED_DATA_BUFFER_BASE_ADDR                                                                            \
+    (SPARE_DATA_BUFFER_BASE_ADDR + DATA_BUF_BASE_ENTRY_COUNT * BYTES_PER_SPARE_REGION_OF_SLICE)
+#define MERGE_DATA_BUFFER_BASE_ADDR                                                                               \
     (TEMPORARY_SPARE_DATA_BUFFER_BASE_ADDR +                                                                      \
      AVAILABLE_TEMPORARY_DATA_BUFFER_ENTRY_COUNT * BYTES_PER_SPARE_REGION_OF_SLICE)
+#define MERGE_SPARE_DATA_BUFFER_BASE_ADDR                                                                         \
+    (MERGE_DATA_BUFFER_BASE_ADDR + AVAILABLE_MERGE_DATA_BUFFER_ENTRY_COUNT * BYTES_PER_DATA_REGION_OF_SLICE)
+#define RESERVED_DATA_BUFFER_BASE_ADDR                                                                            \
+    (MERGE_SPARE_DATA_BUFFER_BASE_ADDR + AVAILABLE_MERGE_DATA_BUFFER_ENTRY_COUNT * BYTES_PER_SPARE_REGION_OF_SLICE)
 
 // dedicated buffers for monitoring
 #define MONITOR_START_ADDR           (RESERVED_DATA_BUFFER_BASE_ADDR + 0x00200000)
 #define MONITOR_DATA_BUFFER_ADDR     (MONITOR_START_ADDR)
 #define MONITOR_DATA_BUFFER_END_ADDR (MONITOR_DATA_BUFFER_ADDR + sizeof(MONITOR_DATA_BUFFER))
-#define MONITOR_END_ADDR             (MONITOR_DATA_BUFFER_END_ADDR)  //MONITOR_END_ADDR: 0x11448000
+#define MONITOR_END_ADDR             (MONITOR_DATA_BUFFER_END_ADDR)  //MONITOR_END_ADDR: 0x1154C000
 
 // check
 #define CH_INFO_START_ADDR         0x12000000
@@ -104,6 +111,26 @@
 #define CH_INFO_BUFFER_END_ADDR    (CH_INFO_START_ADDR + sizeof(CH_INFO))
 #define CH_INFO_END_ADDR           (CH_INFO_BUFFER_END_ADDR)
 
+// page buffers of the address map journal and checkpoints (one page per die)
+#define ADDR_JOURNAL_BUFFER_ADDR     0x12100000
+#define ADDR_MAP_CHECKPOINT_BUF_ADDR (ADDR_JOURNAL_BUFFER_ADDR + ADDR_JOURNAL_BUF_COUNT * ADDR_MAP_PAGE_BUF_BYTES)
+#define ADDR_MAP_BUFFER_END_ADDR     (ADDR_MAP_CHECKPOINT_BUF_ADDR + USER_DIES * ADDR_MAP_PAGE_BUF_BYTES)
+
+// the cached translation pages and the swap page buffers (one page per die) of the demand paged map
+#define ADDR_MAP_CACHE_BUFFER_ADDR (ADDR_MAP_BUFFER_END_ADDR)
+#define ADDR_MAP_SWAP_BUFFER_ADDR                                                                                 \
+    (ADDR_MAP_CACHE_BUFFER_ADDR + ADDR_MAP_CACHE_MAX_ENTRY_COUNT * ADDR_MAP_PAGE_BUF_BYTES)
+#define ADDR_MAP_CACHE_BUFFER_END_ADDR (ADDR_MAP_SWAP_BUFFER_ADDR + USER_DIES * ADDR_MAP_PAGE_BUF_BYTES)
+
+// the range lists of the pending Dataset Management commands (one NVMe block each)
+#define DEALLOCATE_RANGE_BUFFER_ADDR (ADDR_MAP_CACHE_BUFFER_END_ADDR)
+#define DEALLOCATE_RANGE_BUFFER_END_ADDR                                                                          \
+    (DEALLOCATE_RANGE_BUFFER_ADDR + DEALLOCATE_MAX_CMD_COUNT * BYTES_PER_NVME_BLOCK)
+
+// a slice of zeros, transferred to host for the unmapped slices
+#define ZERO_DATA_BUFFER_ADDR     (DEALLOCATE_RANGE_BUFFER_END_ADDR)
+#define ZERO_DATA_BUFFER_END_ADDR (ZERO_DATA_BUFFER_ADDR + BYTES_PER_DATA_REGION_OF_SLICE)
+
 // for nand request completion
 #define COMPLETE_FLAG_TABLE_ADDR 0x17000000
 #define STATUS_REPORT_TABLE_ADDR (COMPLETE_FLAG_TABLE_ADDR + sizeof(COMPLETE_FLAG_TABLE))
@@ -114,18 +141,28 @@
 #define DATA_BUFFER_MAP_ADDR           0x18000000
 #define DATA_BUFFFER_HASH_TABLE_ADDR   (DATA_BUFFER_MAP_ADDR + sizeof(DATA_BUF_MAP))
 #define TEMPORARY_DATA_BUFFER_MAP_ADDR (DATA_BUFFFER_HASH_TABLE_ADDR + sizeof(DATA_BUF_HASH_TABLE))
-// for map tables
-#define LOGICAL_SLICE_MAP_ADDR        (TEMPORARY_DATA_BUFFER_MAP_ADDR + sizeof(TEMPORARY_DATA_BUF_MAP))
+#define DATA_BUFFER_GHOST_MAP_ADDR     (TEMPORARY_DATA_BUFFER_MAP_ADDR + sizeof(TEMPORARY_DATA_BUF_MAP))
+// for map tables, the demand paged map keeps only its directory in place of the logical slice map
+#if (ADDR_MAP_MODE == ADDR_MAP_MODE_DEMAND)
+#define ADDR_MAP_DIR_ADDR             (DATA_BUFFER_GHOST_MAP_ADDR + sizeof(DATA_BUF_GHOST_MAP))
+#define ADDR_MAP_CACHE_MAP_ADDR       (ADDR_MAP_DIR_ADDR + sizeof(ADDR_MAP_DIR))
+#define VIRTUAL_SLICE_MAP_ADDR        (ADDR_MAP_CACHE_MAP_ADDR + sizeof(ADDR_MAP_CACHE_MAP))
+#else
+#define LOGICAL_SLICE_MAP_ADDR        (DATA_BUFFER_GHOST_MAP_ADDR + sizeof(DATA_BUF_GHOST_MAP))
 #define VIRTUAL_SLICE_MAP_ADDR        (LOGICAL_SLICE_MAP_ADDR + sizeof(LOGICAL_SLICE_MAP))
+#endif
 #define VIRTUAL_BLOCK_MAP_ADDR        (VIRTUAL_SLICE_MAP_ADDR + sizeof(VIRTUAL_SLICE_MAP))
-#define PHY_BLOCK_MAP_ADDR            (VIRTUAL_BLOCK_MAP_ADDR + sizeof(VIRTUAL_BLOCK_MAP))
+#define VALID_SLICE_BITMAP_ADDR       (VIRTUAL_BLOCK_MAP_ADDR + sizeof(VIRTUAL_BLOCK_MAP))
+#define PHY_BLOCK_MAP_ADDR            (VALID_SLICE_BITMAP_ADDR + sizeof(VALID_SLICE_BITMAP))
 #define BAD_BLOCK_TABLE_INFO_MAP_ADDR (PHY_BLOCK_MAP_ADDR + sizeof(PHY_BLOCK_MAP))
 #define VIRTUAL_DIE_MAP_ADDR          (BAD_BLOCK_TABLE_INFO_MAP_ADDR + sizeof(BAD_BLOCK_TABLE_INFO_MAP))
 // for GC victim selection
 #define GC_VICTIM_MAP_ADDR (VIRTUAL_DIE_MAP_ADDR + sizeof(VIRTUAL_DIE_MAP))
+// for write stream classification
+#define WRITE_STREAM_HEAT_MAP_ADDR (GC_VICTIM_MAP_ADDR + sizeof(GC_VICTIM_MAP))
 
 // for request pool
-#define REQ_POOL_ADDR (GC_VICTIM_MAP_ADDR + sizeof(GC_VICTIM_MAP))
+#define REQ_POOL_ADDR (WRITE_STREAM_HEAT_MAP_ADDR + sizeof(WRITE_STREAM_HEAT_MAP))
 // for dependency table
 #define ROW_ADDR_DEPENDENCY_TABLE_ADDR (REQ_POOL_ADDR + sizeof(REQ_POOL))
 // for request scheduler
@@ -166,6 +203,16 @@
 #define NMC_BUFFERS_START_MB (NMC_BUFFERS_START_ADDR >> 20)
 #define NMC_BUFFERS_END_MB   (NMC_BUFFERS_END_ADDR >> 20)
 
+// uncached & unbuffered, the data buffer entries beyond `DATA_BUF_BASE_ENTRY_COUNT`
+#define DATA_BUFFER_EXT_BASE_ADDR 0x28C00000
+#define DATA_BUFFER_EXT_SPARE_BASE_ADDR                                                                           \
+    (DATA_BUFFER_EXT_BASE_ADDR + DATA_BUF_EXT_ENTRY_COUNT * BYTES_PER_DATA_REGION_OF_SLICE)
+#define DATA_BUFFER_EXT_END_ADDR                                                                                  \
+    (DATA_BUFFER_EXT_SPARE_BASE_ADDR + DATA_BUF_EXT_ENTRY_COUNT * BYTES_PER_SPARE_REGION_OF_SLICE)
+
+#define DATA_BUFFER_EXT_START_MB (DATA_BUFFER_EXT_BASE_ADDR >> 20)
+#define DATA_BUFFER_EXT_END_MB   ((DATA_BUFFER_EXT_END_ADDR - 1) >> 20)
+
 // #define RESULT_DATA_BUFFER 0x30000000
 #define PARTIAL_DATA_BUFFER_MAP_ADDR 0x2FFFE000
 #define TEST_BUFFER_ADDR 0x2FFFE020
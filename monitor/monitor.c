@@ -105,7 +105,7 @@ void monitor_dump_slice_buffer(uint32_t iDie)
 void monitor_nvme_write_slice_buffer(uint32_t cmdSlotTag, uint32_t iDie)
 {
     uint32_t iReqEntry = GetFromFreeReqQ();
-    uint32_t iBufEntry = AllocateDataBuf();
+    uint32_t iBufEntry = AllocateDataBuf(LSA_NONE);
     void *pBufEntry    = (void *)BUF_DATA_ENTRY2ADDR(iBufEntry);
 
     // clear data buffer
@@ -44,11 +44,10 @@ void monitor_dump_data_buffer_info(MONITOR_MODE mode, uint32_t slsa, uint32_t el
         pr_info("   .dirty              = %u", entry->dirty);
         pr_info("   .prevEntry          = %u", entry->prevEntry);
         pr_info("   .nextEntry          = %u", entry->nextEntry);
-        pr_info("   .hashPrevEntry      = %u", entry->hashPrevEntry);
-        pr_info("   .hashNextEntry      = %u", entry->hashNextEntry);
         pr_info("   .blockingReqTail    = %u", entry->blockingReqTail);
         pr_info("   .phyReq             = %u", entry->phyReq);
         pr_info("   .dontCache          = %u", entry->dontCache);
+        pr_info("   .arcList            = %u", entry->arcList);
     }
 }
 
@@ -82,8 +82,9 @@ void monitor_set_l2v(uint32_t lsa, uint32_t vsa)
 
     if (lsa < SLICES_PER_SSD && vsa < SLICES_PER_SSD)
     {
-        LSA_ENTRY(lsa)->virtualSliceAddr = vsa;
+        SET_LSA2VSA(lsa, vsa);
         VSA_ENTRY(vsa)->logicalSliceAddr = lsa;
+        SET_VSA_VALID(vsa);
         pr_info("MONITOR: Updated LSA[%u] -> VSA[%u] (Die[%u].Blk[%u].Page[%u])", lsa, vsa, iDie, iBlk, iPage);
     }
     else
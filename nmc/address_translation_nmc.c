@@ -41,27 +41,27 @@ void StashCurrentBlock()
     for (uint32_t iDie = 0; iDie < USER_DIES; ++iDie)
     {
         ASSERT(stashedBlocks[iDie] == -1, "Die[%u]: Cannot stash multiple blocks", iDie);
-        stashedBlocks[iDie] = VDIE_ENTRY(iDie)->currentBlock;
+        stashedBlocks[iDie] = VDIE_ENTRY(iDie)->currentBlock[WRITE_STREAM_NMC];
 
 #ifdef DEBUG
         // print free blocks and wait for user input
-        VDIE_ENTRY(iDie)->currentBlock = SelectiveGetFromFbList(iDie, 1000, GET_FREE_BLOCK_NORMAL);
+        VDIE_ENTRY(iDie)->currentBlock[WRITE_STREAM_NMC] = SelectiveGetFromFbList(iDie, 1000, GET_FREE_BLOCK_NORMAL);
 #else
-        VDIE_ENTRY(iDie)->currentBlock = GetFromFbList(iDie, GET_FREE_BLOCK_NORMAL);
+        VDIE_ENTRY(iDie)->currentBlock[WRITE_STREAM_NMC] = GetFromFbList(iDie, GET_FREE_BLOCK_NORMAL);
 #endif
-        if (VDIE_ENTRY(iDie)->currentBlock == BLOCK_FAIL)
+        if (VDIE_ENTRY(iDie)->currentBlock[WRITE_STREAM_NMC] == BLOCK_FAIL)
         {
             pr_error("Die[%u]: Failed to allocate new block, restore stashed blocks", iDie);
             for (int iStashed = 0; iStashed <= iDie; ++iStashed)
             {
-                VDIE_ENTRY(iDie)->currentBlock = stashedBlocks[iStashed];
+                VDIE_ENTRY(iDie)->currentBlock[WRITE_STREAM_NMC] = stashedBlocks[iStashed];
                 stashedBlocks[iStashed]        = -1;
             }
             break;
         }
         else
             pr_debug("Die[%u]: Replace working block %u -> %u", iDie, stashedBlocks[iDie],
-                     VDIE_ENTRY(iDie)->currentBlock);
+                     VDIE_ENTRY(iDie)->currentBlock[WRITE_STREAM_NMC]);
     }
 }
 
@@ -73,7 +73,7 @@ void UnstashCurrentBlock()
     for (uint32_t iDie = 0; iDie < USER_DIES; ++iDie)
     {
         ASSERT(stashedBlocks[iDie] != -1, "Die[%u]: No Stashed Block", iDie);
-        VDIE_ENTRY(iDie)->currentBlock = stashedBlocks[iDie];
+        VDIE_ENTRY(iDie)->currentBlock[WRITE_STREAM_NMC] = stashedBlocks[iDie];
         stashedBlocks[iDie]            = -1;
     }
 }
@@ -88,7 +88,7 @@ uint32_t SelectiveGetFromFbList(uint32_t dieNo, uint32_t targetBlk, uint32_t mod
             return BLOCK_FAIL;
         }
     }
-    else
+    else if (mode != GET_FREE_BLOCK_GC)
     {
         pr_error("Die[%u]: Unexpected mode: %u!!", dieNo, mode);
         return BLOCK_FAIL;
@@ -100,7 +100,8 @@ uint32_t SelectiveGetFromFbList(uint32_t dieNo, uint32_t targetBlk, uint32_t mod
         if (vba == targetBlk)
         {
             // update fb info
-            VBLK_ENTRY(dieNo, vba)->free = 0;
+            VBLK_ENTRY(dieNo, vba)->free        = 0;
+            VBLK_ENTRY(dieNo, vba)->pendingFree = 0;
             VDIE_ENTRY(dieNo)->freeBlockCnt--;
 
             // update neighbor blocks or head/tail
@@ -179,24 +179,12 @@ int nmcNewMapping(const char *filename, uint32_t filetype, uint32_t nblks)
 
     nmcEnableBlkInterleaving();
 
-    // assert all the current blocks are empty
-    VIRTUAL_BLOCK_ENTRY *currentBlk;
+    /*
+     * The file is written by its own write stream, start it on fresh blocks. They are taken
+     * at the first write of the stream on each die and recorded by `nmcRecordBlock()`.
+     */
     for (uint32_t iDie = 0; iDie < USER_DIES; ++iDie)
-    {
-        currentBlk = VBLK_ENTRY(iDie, VDIE_ENTRY(iDie)->currentBlock);
-        ASSERT(!currentBlk->currentPage, "Die[%u]: Current block is not Empty...");
-    }
-
-    // Add the current blocks as first blocks
-    for (uint32_t iCh = 0, iDie, iPBlk; iCh < USER_CHANNELS; ++iCh)
-    {
-        iDie  = PCH2VDIE(iCh, 0);
-        iPBlk = PBLK_ENTRY(iDie, VDIE_ENTRY(iDie)->currentBlock)->remappedPhyBlock;
-
-        NMC_CH_MAP_LIST(iCh, 0).blkNo   = iPBlk;
-        NMC_CH_MAP_LIST(iCh, 0).wayNo   = 0;
-        NMC_CH_MAP_PRE_INFO(iCh)->count = 1;
-    }
+        VDIE_ENTRY(iDie)->currentBlock[WRITE_STREAM_NMC] = BLOCK_NONE;
 
     return SC_VENDOR_NMC_SUCCESS;
 }
@@ -607,7 +595,7 @@ static void nmcCheckBlockStatus(uint8_t iCh){
     unsigned char *markPointer1;
 
     iReqEntry = GetFromFreeReqQ();
-    dataBufEntry = AllocateDataBuf();
+    dataBufEntry = AllocateDataBuf(LSA_NONE);
 
     REQ_ENTRY(iReqEntry)->reqType                       = REQ_TYPE_NAND;
     REQ_ENTRY(iReqEntry)->reqCode                       = REQ_CODE_READ;
@@ -649,7 +637,7 @@ static void nmcMappingTableBlockCheck(uint8_t iCh){
     uintptr_t dataBufEntry;
 
     iReqEntry = GetFromFreeReqQ();
-    dataBufEntry = AllocateDataBuf();
+    dataBufEntry = AllocateDataBuf(LSA_NONE);
 
     REQ_ENTRY(iReqEntry)->reqType                       = REQ_TYPE_NAND;
     REQ_ENTRY(iReqEntry)->reqCode                       = REQ_CODE_READ;
@@ -48,11 +48,18 @@
 //////////////////////////////////////////////////////////////////////////////////
 
 #include "nsc_driver.h"
+#ifdef NSC_SIMULATOR
+#include "sim/xparameters.h"
+#else
 #include "xparameters.h"
+#endif
 #include <assert.h>
 
 #include "debug.h"
 
+// the simulated backend in "nsc_driver_sim.c" replaces this driver on host builds
+#ifndef NSC_SIMULATOR
+
 typedef struct
 {
     unsigned char delayVal[32];
@@ -368,3 +375,5 @@ unsigned int __attribute__((optimize("O0"))) V2FReadyBusyAsync(T4REGS *t4regs)
 
     return readyBusy;
 }
+
+#endif /* NSC_SIMULATOR */
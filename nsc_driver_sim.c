@@ -0,0 +1,528 @@
+//////////////////////////////////////////////////////////////////////////////////
+// nsc_driver_sim.c for Cosmos+ OpenSSD
+// Copyright (c) 2016 Hanyang University ENC Lab.
+// Contributed by Yong Ho Song <yhsong@enc.hanyang.ac.kr>
+//				  Kibin Park <kbpark@enc.hanyang.ac.kr>
+//				  Jaewook Kwak <jwkwak@enc.hanyang.ac.kr>
+//
+// This file is part of Cosmos+ OpenSSD.
+//
+// Cosmos+ OpenSSD is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3, or (at your option)
+// any later version.
+//
+// Cosmos+ OpenSSD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Cosmos+ OpenSSD; see the file COPYING.
+// If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Company: ENC Lab. <http://enc.hanyang.ac.kr>
+// Engineer: Kibin Park <kbpark@enc.hanyang.ac.kr>
+//
+// Project Name: Cosmos+ OpenSSD
+// Design Name: Cosmos+ Firmware
+// Module Name: NAND Storage Controller Simulator
+// File Name: nsc_driver_sim.c
+//
+// Version: v1.0.0
+//
+// Description:
+//   - host-side replacement of the low level driver for NAND storage controller
+//   - models tR/tPROG/tBERS per way, channel bus occupancy, ready/busy and ECC info
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Revision History:
+//
+// * v1.0.0
+//   - First draft
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifdef NSC_SIMULATOR
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "nsc_driver.h"
+#include "nsc_driver_sim.h"
+#include "request_schedule.h"
+
+#include "debug.h"
+
+/**
+ * The registers of the simulated controllers.
+ *
+ * The macros in "nsc_driver.h" (e.g. `V2FIsControllerBusy()`) access the registers
+ * through the `T4REGS` handle directly, so each channel still owns a set of registers.
+ * The command queue of the simulated controller never becomes full.
+ */
+static T4REG_ID simRegId[USER_CHANNELS];
+static T4REG_CFG simRegCfg[USER_CHANNELS];
+static T4REG_EXT simRegExt[USER_CHANNELS];
+static T4REG_CC simRegCc[USER_CHANNELS];
+static T4REG_BP simRegBp[USER_CHANNELS];
+static T4REG_SP simRegSp[USER_CHANNELS];
+
+static SIM_NAND_CHANNEL simNandCh[USER_CHANNELS];
+static SIM_NAND_BLOCK simNandBlock[USER_CHANNELS][USER_WAYS][TOTAL_BLOCKS_PER_DIE];
+static unsigned int simRandSeed = 1;
+
+SIM_NAND_STATISTICS simNandStat;
+
+/**
+ * @brief Get the current time of the simulator in nanoseconds.
+ *
+ * The simulator runs on the wall clock, so the firmware and the simulated flash array
+ * progress concurrently just like the real board does.
+ */
+unsigned long long V2FSimGetTimeNs()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static unsigned int SimRand()
+{
+    simRandSeed = simRandSeed * 1103515245 + 12345;
+    return (simRandSeed >> 16) & 0x7fff;
+}
+
+static unsigned long long SimMax(unsigned long long a, unsigned long long b)
+{
+    return (a > b) ? a : b;
+}
+
+static unsigned int SimChannelOf(T4REGS *t4regs)
+{
+    unsigned int chNo = (T4REG_ID *)t4regs->t4regID - simRegId;
+
+    ASSERT(chNo < USER_CHANNELS, "unknown channel handle 0x%p", t4regs);
+    return chNo;
+}
+
+/**
+ * @brief Convert the row address generated by `GenerateNandRowAddr()` to the block of die.
+ */
+static P_SIM_NAND_BLOCK SimRowToBlock(unsigned int chNo, unsigned int wayNo, unsigned int rowAddress)
+{
+    unsigned int lun, blockNo;
+
+    lun     = (LUNS_PER_DIE > 1) ? (rowAddress / LUN_1_BASE_ADDR) : 0;
+    blockNo = (rowAddress % LUN_1_BASE_ADDR) / PAGES_PER_MLC_BLOCK + lun * TOTAL_BLOCKS_PER_LUN;
+
+    ASSERT(blockNo < TOTAL_BLOCKS_PER_DIE, "row 0x%x out of range", rowAddress);
+    return &simNandBlock[chNo][wayNo][blockNo];
+}
+
+static unsigned char *SimRowToData(P_SIM_NAND_BLOCK block, unsigned int rowAddress)
+{
+    if (block->data == NULL)
+        return NULL;
+
+    return block->data + (rowAddress % PAGES_PER_MLC_BLOCK) * SIM_BYTES_PER_ROW;
+}
+
+/**
+ * @brief Copy the content of the given row, erased area and bad block marks included.
+ *
+ * @param spareBytes how many bytes of spare region should be copied, the bytes exceeds
+ * `BYTES_PER_SPARE_REGION_OF_PAGE` are ECC parity and always read as clean data.
+ */
+static void SimCopyRow(P_SIM_NAND_BLOCK block, unsigned int rowAddress, unsigned char *pageBuf,
+                       unsigned char *spareBuf, unsigned int spareBytes)
+{
+    unsigned char *row = SimRowToData(block, rowAddress);
+    unsigned int page  = rowAddress % PAGES_PER_MLC_BLOCK;
+
+    if (row)
+    {
+        memcpy(pageBuf, row, BYTES_PER_DATA_REGION_OF_NAND_ROW);
+        if (spareBuf)
+        {
+            memcpy(spareBuf, row + BYTES_PER_DATA_REGION_OF_NAND_ROW, BYTES_PER_SPARE_REGION_OF_PAGE);
+            if (spareBytes > BYTES_PER_SPARE_REGION_OF_PAGE)
+                memset(spareBuf + BYTES_PER_SPARE_REGION_OF_PAGE, 0xff,
+                       spareBytes - BYTES_PER_SPARE_REGION_OF_PAGE);
+        }
+    }
+    else
+    {
+        memset(pageBuf, 0xff, BYTES_PER_DATA_REGION_OF_NAND_ROW);
+        if (spareBuf)
+            memset(spareBuf, 0xff, spareBytes);
+    }
+
+    // factory bad blocks carry non-0xFF marks on their first and last row
+    if (block->bad && ((page == BAD_BLOCK_MARK_PAGE0) || (page == BAD_BLOCK_MARK_PAGE1)))
+    {
+        pageBuf[BAD_BLOCK_MARK_BYTE0] = 0;
+        if (spareBuf)
+            spareBuf[0] = 0;
+    }
+}
+
+/**
+ * @brief Generate the ECC error information of a read.
+ *
+ * The worst chunk bit error count grows with the erase count of the block, plus a small
+ * random jitter. If it exceeds the correction capability, the CRC valid flag is cleared
+ * and the read will be reported as failed by `CheckEccErrorInfo()`.
+ */
+static void SimFillErrorInfo(P_SIM_NAND_BLOCK block, unsigned int *errorInformation)
+{
+    unsigned int bitErrors, i;
+
+    bitErrors = SIM_BASE_BIT_ERRORS_PER_CHUNK + block->eraseCnt / SIM_PE_CYCLES_PER_BIT_ERROR;
+    if (SIM_BIT_ERROR_JITTER)
+        bitErrors += SimRand() % SIM_BIT_ERROR_JITTER;
+    if (bitErrors > 0xff)
+        bitErrors = 0xff;
+
+    for (i = 0; i < ERROR_INFO_WORD_COUNT; i++)
+        errorInformation[i] = 0;
+
+    errorInformation[0] = bitErrors << 16;
+    if (bitErrors <= SIM_ECC_CORRECTABLE_BITS_PER_CHUNK)
+        errorInformation[0] |= 0x10000000;
+    else
+        simNandStat.eccFailCnt++;
+}
+
+/**
+ * @brief Write back the completion flags of the transfers that have finished by now.
+ */
+static void SimRetireTransfers(unsigned int chNo, unsigned long long now)
+{
+    unsigned int wayNo;
+    P_SIM_NAND_WAY way;
+
+    for (wayNo = 0; wayNo < USER_WAYS; wayNo++)
+    {
+        way = &simNandCh[chNo].way[wayNo];
+        if (way->pendingCompletion && (way->completionTime <= now))
+        {
+            *way->pendingCompletion = 1;
+            way->pendingCompletion  = NULL;
+        }
+    }
+}
+
+/**
+ * @brief Schedule a data transfer on the channel bus of the given way.
+ *
+ * @return unsigned long long the time the transfer is finished.
+ */
+static unsigned long long SimOccupyChannel(unsigned int chNo, unsigned int wayNo, unsigned int bytes)
+{
+    unsigned long long start;
+
+    start = SimMax(V2FSimGetTimeNs(), simNandCh[chNo].busUntil);
+    start = SimMax(start, simNandCh[chNo].way[wayNo].busyUntil);
+
+    simNandCh[chNo].busUntil = start + SIM_XFER_NS(bytes);
+    simNandStat.busNs += SIM_XFER_NS(bytes);
+    return simNandCh[chNo].busUntil;
+}
+
+static void SimOccupyWay(unsigned int chNo, unsigned int wayNo, unsigned long long start, unsigned long long latency)
+{
+    simNandCh[chNo].way[wayNo].busyUntil = SimMax(start, simNandCh[chNo].way[wayNo].busyUntil) + latency;
+}
+
+void nfc_set_dqs_delay(int channel, unsigned int newValue) {}
+
+void nfc_set_dq_delay(int channel, unsigned int newValue) {}
+
+void V2FInitializeHandle(T4REGS *t4regs, void *t4nscRegisterBaseAddress)
+{
+    unsigned int chNo, wayNo, blockNo;
+    unsigned int badBlockPermille = SIM_FACTORY_BAD_BLOCK_PERMILLE; // may be 0, keep -Wtype-limits quiet
+
+    chNo = t4regs - chCtlReg;
+    ASSERT(chNo < USER_CHANNELS, "unknown channel handle 0x%p", t4regs);
+
+    t4regs->t4regID  = &simRegId[chNo];
+    t4regs->t4regCFG = &simRegCfg[chNo];
+    t4regs->t4regEXT = &simRegExt[chNo];
+    t4regs->t4regCC  = &simRegCc[chNo];
+    t4regs->t4regBP  = &simRegBp[chNo];
+    t4regs->t4regSP  = &simRegSp[chNo];
+
+    simRegId[chNo].queueNotFull  = 1;
+    simRegId[chNo].queueCount    = 0;
+    simRegBp[chNo].nandReadyBusy = (1 << USER_WAYS) - 1;
+
+    simNandCh[chNo].busUntil = 0;
+    for (wayNo = 0; wayNo < USER_WAYS; wayNo++)
+    {
+        simNandCh[chNo].way[wayNo].busyUntil         = 0;
+        simNandCh[chNo].way[wayNo].pendingCompletion = NULL;
+        simNandCh[chNo].way[wayNo].latchedRow        = 0;
+        simNandCh[chNo].way[wayNo].nandStatus        = SIM_NAND_STATUS_READY;
+
+        // the first block keeps the bad block table, never make it bad
+        for (blockNo = 1; blockNo < TOTAL_BLOCKS_PER_DIE; blockNo++)
+            if ((SimRand() % 1000) < badBlockPermille)
+                simNandBlock[chNo][wayNo][blockNo].bad = 1;
+    }
+}
+
+void V2FSetScramblerState(T4REGS *t4regs, int enable) {}
+
+void V2FResetSync(T4REGS *t4regs, int way)
+{
+    unsigned int chNo = SimChannelOf(t4regs);
+
+    simNandCh[chNo].way[way].busyUntil  = V2FSimGetTimeNs();
+    simNandCh[chNo].way[way].nandStatus = SIM_NAND_STATUS_READY;
+}
+
+void V2FSetFeaturesSync(T4REGS *t4regs, int way, unsigned int feature0x02, unsigned int feature0x10,
+                        unsigned int feature0x01, unsigned int payLoadAddr)
+{
+    SimChannelOf(t4regs);
+}
+
+void V2FGetReadyBusy(T4REGS *t4regs, unsigned int *report)
+{
+    *report = (V2FReadyBusyAsync(t4regs) << 16) | 1;
+}
+
+void V2FReadPageTriggerAsync(T4REGS *t4regs, int way, unsigned int rowAddress)
+{
+    unsigned int chNo = SimChannelOf(t4regs);
+
+    pr_debug("SimCh %u Way %u Row %u", chNo, way, rowAddress);
+    SimRowToBlock(chNo, way, rowAddress);
+    SimOccupyWay(chNo, way, V2FSimGetTimeNs(), SIM_T_R_NS);
+    simNandCh[chNo].way[way].latchedRow = rowAddress;
+    simNandCh[chNo].way[way].nandStatus = SIM_NAND_STATUS_READY;
+    simNandStat.readCnt++;
+}
+
+void V2FReadPageTransferAsync(T4REGS *t4regs, int way, void *pageDataBuffer, void *spareDataBuffer,
+                              unsigned int *errorInformation, unsigned int *completion, unsigned int rowAddress)
+{
+    unsigned int chNo = SimChannelOf(t4regs);
+    P_SIM_NAND_BLOCK block;
+
+    pr_debug("SimCh %u Way %u Row %u | 0x%p 0x%p", chNo, way, rowAddress, pageDataBuffer, spareDataBuffer);
+    block = SimRowToBlock(chNo, way, rowAddress);
+    SimCopyRow(block, rowAddress, pageDataBuffer, spareDataBuffer, BYTES_PER_SPARE_REGION_OF_PAGE);
+    SimFillErrorInfo(block, errorInformation);
+
+    *completion                                = SIM_COMPLETION_NONE;
+    simNandCh[chNo].way[way].pendingCompletion = completion;
+    simNandCh[chNo].way[way].completionTime    = SimOccupyChannel(chNo, way, SIM_BYTES_PER_ROW);
+}
+
+void V2FReadPageTransferRawAsync(T4REGS *t4regs, int way, void *pageDataBuffer, unsigned int *completion)
+{
+    unsigned int chNo = SimChannelOf(t4regs);
+    unsigned int row  = simNandCh[chNo].way[way].latchedRow;
+
+    SimCopyRow(SimRowToBlock(chNo, way, row), row, pageDataBuffer,
+               (unsigned char *)pageDataBuffer + BYTES_PER_DATA_REGION_OF_NAND_ROW, BYTES_PER_SPARE_REGION_OF_NAND_ROW);
+
+    *completion                                = SIM_COMPLETION_NONE;
+    simNandCh[chNo].way[way].pendingCompletion = completion;
+    simNandCh[chNo].way[way].completionTime =
+        SimOccupyChannel(chNo, way, BYTES_PER_DATA_REGION_OF_NAND_ROW + BYTES_PER_SPARE_REGION_OF_NAND_ROW);
+}
+
+/**
+ * @brief Program a row of the simulated array.
+ *
+ * The transferred bytes go over the channel bus first, then the way stays busy for tPROG.
+ * Programming a row that is not erased, or a row of a bad block, fails the status check.
+ *
+ * @param pageData the data region to be programmed, NULL for an erased one.
+ * @param busBytes the bytes transferred over the channel bus for this program.
+ */
+static void SimProgramRow(unsigned int chNo, unsigned int wayNo, unsigned int rowAddress, unsigned char *pageData,
+                          unsigned char *spareData, unsigned int busBytes)
+{
+    P_SIM_NAND_BLOCK block;
+    unsigned char *row;
+    unsigned int i, programmed;
+
+    block = SimRowToBlock(chNo, wayNo, rowAddress);
+    if (block->data == NULL)
+    {
+        block->data = malloc(SIM_BYTES_PER_BLOCK);
+        ASSERT(block->data, "out of host memory for simulated block");
+        memset(block->data, 0xff, SIM_BYTES_PER_BLOCK);
+    }
+
+    row        = SimRowToData(block, rowAddress);
+    programmed = 0;
+    for (i = 0; i < SIM_BYTES_PER_ROW && !programmed; i += sizeof(unsigned int))
+        programmed = (*(unsigned int *)(row + i) != 0xffffffff);
+
+    simNandCh[chNo].way[wayNo].nandStatus = SIM_NAND_STATUS_READY;
+    if (programmed || block->bad)
+        simNandCh[chNo].way[wayNo].nandStatus |= SIM_NAND_STATUS_FAIL;
+    else
+    {
+        if (pageData)
+            memcpy(row, pageData, BYTES_PER_DATA_REGION_OF_NAND_ROW);
+        memcpy(row + BYTES_PER_DATA_REGION_OF_NAND_ROW, spareData, BYTES_PER_SPARE_REGION_OF_PAGE);
+    }
+
+    SimOccupyWay(chNo, wayNo, SimOccupyChannel(chNo, wayNo, busBytes), SIM_T_PROG_NS);
+    simNandStat.programCnt++;
+}
+
+void V2FProgramPageAsync(T4REGS *t4regs, int way, unsigned int rowAddress, void *pageDataBuffer, void *spareDataBuffer)
+{
+    unsigned int chNo = SimChannelOf(t4regs);
+
+    pr_debug("SimCh %u Way %u Row %u", chNo, way, rowAddress);
+    SimProgramRow(chNo, way, rowAddress, pageDataBuffer, spareDataBuffer, SIM_BYTES_PER_ROW);
+}
+
+/**
+ * @brief Latch a row for the following copyback program, just like a read trigger.
+ */
+void V2FCopybackReadTriggerAsync(T4REGS *t4regs, int way, unsigned int rowAddress)
+{
+    V2FReadPageTriggerAsync(t4regs, way, rowAddress);
+}
+
+/**
+ * @brief Program the latched row to another row of the same LUN.
+ *
+ * The data region never leaves the die, only the spare region goes over the channel bus.
+ */
+void V2FCopybackProgramAsync(T4REGS *t4regs, int way, unsigned int rowAddress, void *spareDataBuffer)
+{
+    unsigned int chNo   = SimChannelOf(t4regs);
+    unsigned int srcRow = simNandCh[chNo].way[way].latchedRow;
+
+    pr_debug("SimCh %u Way %u Row %u <- Row %u", chNo, way, rowAddress, srcRow);
+    ASSERT(srcRow / LUN_1_BASE_ADDR == rowAddress / LUN_1_BASE_ADDR, "copyback across LUNs: row %u to %u", srcRow,
+           rowAddress);
+
+    SimProgramRow(chNo, way, rowAddress, SimRowToData(SimRowToBlock(chNo, way, srcRow), srcRow), spareDataBuffer,
+                  BYTES_PER_SPARE_REGION_OF_PAGE);
+    simNandStat.copybackCnt++;
+}
+
+/**
+ * @brief Erase a block of the simulated array.
+ *
+ * The host memory of the block is released, and the block fails to erase once it has
+ * reached `SIM_MAX_PE_CYCLES`.
+ */
+void V2FEraseBlockAsync(T4REGS *t4regs, int way, unsigned int rowAddress)
+{
+    unsigned int chNo = SimChannelOf(t4regs);
+    P_SIM_NAND_BLOCK block;
+
+    pr_debug("SimCh %u Way %u Row %u", chNo, way, rowAddress);
+    assert((rowAddress & 0xFF) == 0);
+
+    block = SimRowToBlock(chNo, way, rowAddress);
+    free(block->data);
+    block->data = NULL;
+    block->eraseCnt++;
+
+    simNandCh[chNo].way[way].nandStatus = SIM_NAND_STATUS_READY;
+    if (block->bad || (block->eraseCnt > SIM_MAX_PE_CYCLES))
+        simNandCh[chNo].way[way].nandStatus |= SIM_NAND_STATUS_FAIL;
+
+    SimOccupyWay(chNo, way, V2FSimGetTimeNs(), SIM_T_BERS_NS);
+    simNandStat.eraseCnt++;
+}
+
+/**
+ * @brief Report the NAND status of the given way in the format of T4NSC status report.
+ *
+ * The report is always done immediately (bit 0), and the NAND status register follows.
+ * A busy way reports neither RDY nor ARDY, so `V2FRequestComplete()` is false.
+ */
+void V2FStatusCheckAsync(T4REGS *t4regs, int way, unsigned int *statusReport)
+{
+    unsigned int chNo = SimChannelOf(t4regs);
+    unsigned int status;
+
+    if (simNandCh[chNo].way[way].busyUntil > V2FSimGetTimeNs())
+        status = 0;
+    else
+        status = simNandCh[chNo].way[way].nandStatus;
+
+    *statusReport = (status << 1) | 1;
+}
+
+void V2FReadIdAsync(T4REGS *t4regs, int way, unsigned int *statusReport, unsigned int *completion)
+{
+    // a fixed device id, one byte per half word like the controller reports
+    const unsigned char id[6] = {0x98, 0x3a, 0x98, 0xa3, 0x76, 0x51};
+    unsigned int i;
+
+    SimChannelOf(t4regs);
+    for (i = 0; i < 6; i++)
+        ((unsigned char *)statusReport)[i * 2] = id[i];
+    *completion = 1;
+}
+
+void V2FReadIdSync(T4REGS *t4regs, int way, unsigned int *statusReport)
+{
+    unsigned char buf[8] = {0};
+    unsigned int completion;
+    int i;
+
+    for (i = 0; i < 8; i++)
+        ((unsigned char *)statusReport)[i] = 0;
+    V2FReadIdAsync(t4regs, way, statusReport, &completion);
+
+    for (i = 0; i < 6; i++)
+        buf[i] = ((unsigned char *)statusReport)[i * 2];
+    for (i = 0; i < 8; i++)
+        ((unsigned char *)statusReport)[i] = buf[i];
+}
+
+/**
+ * @brief Get the ready/busy bits of all the ways of the given channel.
+ *
+ * Since the scheduler always samples the ready/busy bits before checking the completion
+ * flags, this is also the place where finished transfers write back their completion.
+ */
+unsigned int V2FReadyBusyAsync(T4REGS *t4regs)
+{
+    unsigned int chNo = SimChannelOf(t4regs);
+    unsigned long long now;
+    unsigned int wayNo, readyBusy;
+
+    now = V2FSimGetTimeNs();
+    SimRetireTransfers(chNo, now);
+
+    readyBusy = 0;
+    for (wayNo = 0; wayNo < USER_WAYS; wayNo++)
+        if (simNandCh[chNo].way[wayNo].busyUntil <= now)
+            readyBusy |= (1 << wayNo);
+
+    t4regs->t4regBP->nandReadyBusy = readyBusy;
+    return readyBusy;
+}
+
+void V2FSimReportStatistics()
+{
+    xil_printf("[ NAND simulator ] read %llu, program %llu (copyback %llu), erase %llu, ecc fail %llu\r\n",
+               simNandStat.readCnt, simNandStat.programCnt, simNandStat.copybackCnt, simNandStat.eraseCnt,
+               simNandStat.eccFailCnt);
+    xil_printf("[ NAND simulator ] channel bus busy %llu us in total\r\n", simNandStat.busNs / 1000);
+}
+
+#endif /* NSC_SIMULATOR */
@@ -0,0 +1,171 @@
+//////////////////////////////////////////////////////////////////////////////////
+// nsc_driver_sim.h for Cosmos+ OpenSSD
+// Copyright (c) 2016 Hanyang University ENC Lab.
+// Contributed by Yong Ho Song <yhsong@enc.hanyang.ac.kr>
+//				  Kibin Park <kbpark@enc.hanyang.ac.kr>
+//				  Jaewook Kwak <jwkwak@enc.hanyang.ac.kr>
+//
+// This file is part of Cosmos+ OpenSSD.
+//
+// Cosmos+ OpenSSD is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3, or (at your option)
+// any later version.
+//
+// Cosmos+ OpenSSD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Cosmos+ OpenSSD; see the file COPYING.
+// If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Company: ENC Lab. <http://enc.hanyang.ac.kr>
+// Engineer: Kibin Park <kbpark@enc.hanyang.ac.kr>
+//
+// Project Name: Cosmos+ OpenSSD
+// Design Name: Cosmos+ Firmware
+// Module Name: NAND Storage Controller Simulator
+// File Name: nsc_driver_sim.h
+//
+// Version: v1.0.0
+//
+// Description:
+//   - timing and reliability parameters of the simulated NAND array
+//   - data structures used to model the state of each channel and way
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Revision History:
+//
+// * v1.0.0
+//   - First draft
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef NSC_DRIVER_SIM_H_
+#define NSC_DRIVER_SIM_H_
+
+#include "ftl_config.h"
+
+/**
+ * The simulated backend replaces the T4NSC register interface when `NSC_SIMULATOR` is
+ * defined. All of the parameters below can be overridden from the compiler command line
+ * to model a different flash part.
+ *
+ * The firmware is then built as a host program driven by "nvme/nvme_bench.c", the BSP
+ * headers are replaced by the ones in "sim/". Check "README.txt" for the build command.
+ */
+
+/* -------------------------------------------------------------------------- */
+/*                            timing of flash array                           */
+/* -------------------------------------------------------------------------- */
+
+#ifndef SIM_T_R_NS
+#define SIM_T_R_NS 25000 /* page read (array to page register), pSLC */
+#endif
+#ifndef SIM_T_PROG_NS
+#define SIM_T_PROG_NS 300000 /* page program (page register to array), pSLC */
+#endif
+#ifndef SIM_T_BERS_NS
+#define SIM_T_BERS_NS 3000000 /* block erase */
+#endif
+#ifndef SIM_CHANNEL_MB_PER_SEC
+#define SIM_CHANNEL_MB_PER_SEC 200 /* toggle DDR bus bandwidth of a single channel */
+#endif
+
+#define SIM_XFER_NS(bytes) (((unsigned long long)(bytes)*1000) / SIM_CHANNEL_MB_PER_SEC)
+
+/* -------------------------------------------------------------------------- */
+/*                          reliability of flash array                        */
+/* -------------------------------------------------------------------------- */
+
+#ifndef SIM_BASE_BIT_ERRORS_PER_CHUNK
+#define SIM_BASE_BIT_ERRORS_PER_CHUNK 0 /* worst chunk bit errors of a fresh block */
+#endif
+#ifndef SIM_PE_CYCLES_PER_BIT_ERROR
+#define SIM_PE_CYCLES_PER_BIT_ERROR 1000 /* one more worst chunk bit error every N erases */
+#endif
+#ifndef SIM_BIT_ERROR_JITTER
+#define SIM_BIT_ERROR_JITTER 4 /* random [0, N) bit errors added to every read */
+#endif
+#ifndef SIM_ECC_CORRECTABLE_BITS_PER_CHUNK
+#define SIM_ECC_CORRECTABLE_BITS_PER_CHUNK 40 /* beyond this the CRC check fails */
+#endif
+#ifndef SIM_MAX_PE_CYCLES
+#define SIM_MAX_PE_CYCLES 30000 /* erase fails (grown bad block) after N erases */
+#endif
+#ifndef SIM_FACTORY_BAD_BLOCK_PERMILLE
+#define SIM_FACTORY_BAD_BLOCK_PERMILLE 0 /* factory bad blocks per thousand blocks */
+#endif
+
+/* -------------------------------------------------------------------------- */
+/*                        layout of the simulated array                       */
+/* -------------------------------------------------------------------------- */
+
+#define SIM_BYTES_PER_ROW   (BYTES_PER_DATA_REGION_OF_NAND_ROW + BYTES_PER_SPARE_REGION_OF_PAGE)
+#define SIM_BYTES_PER_BLOCK (SIM_BYTES_PER_ROW * ROWS_PER_MLC_BLOCK)
+
+#define SIM_NAND_STATUS_READY 0x60 // RDY | ARDY
+#define SIM_NAND_STATUS_FAIL  0x01
+
+#define SIM_COMPLETION_NONE 0
+
+/**
+ * @brief The state of a simulated flash die (way).
+ *
+ * @note the way is busy until `busyUntil` (array operation), and the channel bus is busy
+ * until `SIM_NAND_CHANNEL::busUntil` (data transfer); the completion flag of an ongoing
+ * transfer is written back when the transfer time is reached.
+ */
+typedef struct _SIM_NAND_WAY
+{
+    unsigned long long busyUntil;
+    unsigned long long completionTime;
+    unsigned int *pendingCompletion;
+    unsigned int latchedRow;
+    unsigned int nandStatus;
+} SIM_NAND_WAY, *P_SIM_NAND_WAY;
+
+typedef struct _SIM_NAND_CHANNEL
+{
+    unsigned long long busUntil;
+    SIM_NAND_WAY way[USER_WAYS];
+} SIM_NAND_CHANNEL, *P_SIM_NAND_CHANNEL;
+
+/**
+ * @brief The content and wear state of a simulated flash block.
+ *
+ * The data of a block is allocated on its first program and released on erase, thus an
+ * erased block costs nothing and reads back as `0xFF`.
+ */
+typedef struct _SIM_NAND_BLOCK
+{
+    unsigned char *data;
+    unsigned int eraseCnt : 30;
+    unsigned int bad : 1;
+    unsigned int reserved0 : 1;
+} SIM_NAND_BLOCK, *P_SIM_NAND_BLOCK;
+
+typedef struct _SIM_NAND_STATISTICS
+{
+    unsigned long long readCnt;
+    unsigned long long programCnt;
+    unsigned long long eraseCnt;
+    unsigned long long eccFailCnt;
+    unsigned long long copybackCnt; // programs of a latched row, counted in `programCnt` too
+    unsigned long long busNs;       // data transfer time on the channel buses
+} SIM_NAND_STATISTICS, *P_SIM_NAND_STATISTICS;
+
+unsigned long long V2FSimGetTimeNs();
+void V2FSimReportStatistics();
+
+// the copyback sequences are not in the microcode of the T4NSC, check `GC_COPYBACK`
+void V2FCopybackReadTriggerAsync(T4REGS *t4regs, int way, unsigned int rowAddress);
+void V2FCopybackProgramAsync(T4REGS *t4regs, int way, unsigned int rowAddress, void *spareDataBuffer);
+
+extern SIM_NAND_STATISTICS simNandStat;
+
+#endif /* NSC_DRIVER_SIM_H_ */
@@ -51,8 +51,12 @@
 //////////////////////////////////////////////////////////////////////////////////
 
 #include "stdio.h"
+#ifdef NSC_SIMULATOR
+#include "../sim/xil_printf.h"
+#else
 #include "xil_exception.h"
 #include "xil_printf.h"
+#endif
 #include "debug.h"
 #include "io_access.h"
 
@@ -63,6 +67,9 @@ extern NVME_CONTEXT g_nvmeTask;
 HOST_DMA_STATUS g_hostDmaStatus;
 HOST_DMA_ASSIST_STATUS g_hostDmaAssistStatus;
 
+// the host side of the NVMe controller is replaced by "host_lld_sim.c" on host builds
+#ifndef NSC_SIMULATOR
+
 void dev_irq_init()
 {
     DEV_IRQ_REG devReg;
@@ -390,9 +397,9 @@ void set_auto_tx_dma(unsigned int cmdSlotTag, unsigned int cmd4KBOffset, unsigne
 
     ASSERT(cmd4KBOffset < 256);
 
-    g_hostDmaStatus.fifoHead.dword = IO_READ32(HOST_DMA_FIFO_CNT_REG_ADDR);
+    g_hostDmaStatus.fifoHead.dword = HOST_DMA_FIFO_CNT_READ();
     while ((g_hostDmaStatus.fifoTail.autoDmaTx + 1) % 256 == g_hostDmaStatus.fifoHead.autoDmaTx)
-        g_hostDmaStatus.fifoHead.dword = IO_READ32(HOST_DMA_FIFO_CNT_REG_ADDR);
+        g_hostDmaStatus.fifoHead.dword = HOST_DMA_FIFO_CNT_READ();
 
     hostDmaReg.devAddr = devAddr;
 
@@ -432,9 +439,9 @@ void set_auto_rx_dma(unsigned int cmdSlotTag, unsigned int cmd4KBOffset, unsigne
 
     ASSERT(cmd4KBOffset < 256);
 
-    g_hostDmaStatus.fifoHead.dword = IO_READ32(HOST_DMA_FIFO_CNT_REG_ADDR);
+    g_hostDmaStatus.fifoHead.dword = HOST_DMA_FIFO_CNT_READ();
     while ((g_hostDmaStatus.fifoTail.autoDmaRx + 1) % 256 == g_hostDmaStatus.fifoHead.autoDmaRx)
-        g_hostDmaStatus.fifoHead.dword = IO_READ32(HOST_DMA_FIFO_CNT_REG_ADDR);
+        g_hostDmaStatus.fifoHead.dword = HOST_DMA_FIFO_CNT_READ();
 
     hostDmaReg.devAddr = devAddr;
 
@@ -458,11 +465,13 @@ void set_auto_rx_dma(unsigned int cmdSlotTag, unsigned int cmd4KBOffset, unsigne
     g_hostDmaStatus.autoDmaRxCnt++;
 }
 
+#endif /* NSC_SIMULATOR */
+
 void check_direct_tx_dma_done()
 {
     while (g_hostDmaStatus.fifoHead.directDmaTx != g_hostDmaStatus.fifoTail.directDmaTx)
     {
-        g_hostDmaStatus.fifoHead.dword = IO_READ32(HOST_DMA_FIFO_CNT_REG_ADDR);
+        g_hostDmaStatus.fifoHead.dword = HOST_DMA_FIFO_CNT_READ();
     }
 }
 
@@ -470,7 +479,7 @@ void check_direct_rx_dma_done()
 {
     while (g_hostDmaStatus.fifoHead.directDmaRx != g_hostDmaStatus.fifoTail.directDmaRx)
     {
-        g_hostDmaStatus.fifoHead.dword = IO_READ32(HOST_DMA_FIFO_CNT_REG_ADDR);
+        g_hostDmaStatus.fifoHead.dword = HOST_DMA_FIFO_CNT_READ();
     }
 }
 
@@ -478,7 +487,7 @@ void check_auto_tx_dma_done()
 {
     while (g_hostDmaStatus.fifoHead.autoDmaTx != g_hostDmaStatus.fifoTail.autoDmaTx)
     {
-        g_hostDmaStatus.fifoHead.dword = IO_READ32(HOST_DMA_FIFO_CNT_REG_ADDR);
+        g_hostDmaStatus.fifoHead.dword = HOST_DMA_FIFO_CNT_READ();
     }
 }
 
@@ -486,7 +495,7 @@ void check_auto_rx_dma_done()
 {
     while (g_hostDmaStatus.fifoHead.autoDmaRx != g_hostDmaStatus.fifoTail.autoDmaRx)
     {
-        g_hostDmaStatus.fifoHead.dword = IO_READ32(HOST_DMA_FIFO_CNT_REG_ADDR);
+        g_hostDmaStatus.fifoHead.dword = HOST_DMA_FIFO_CNT_READ();
     }
 }
 
@@ -494,7 +503,7 @@ unsigned int check_auto_tx_dma_partial_done(unsigned int tailIndex, unsigned int
 {
     // xil_printf("check_auto_tx_dma_partial_done \r\n");
 
-    g_hostDmaStatus.fifoHead.dword = IO_READ32(HOST_DMA_FIFO_CNT_REG_ADDR);
+    g_hostDmaStatus.fifoHead.dword = HOST_DMA_FIFO_CNT_READ();
 
     if (g_hostDmaStatus.fifoHead.autoDmaTx == g_hostDmaStatus.fifoTail.autoDmaTx)
         return 1;
@@ -533,7 +542,7 @@ unsigned int check_auto_rx_dma_partial_done(unsigned int tailIndex, unsigned int
 {
     // xil_printf("check_auto_rx_dma_partial_done \r\n");
 
-    g_hostDmaStatus.fifoHead.dword = IO_READ32(HOST_DMA_FIFO_CNT_REG_ADDR);
+    g_hostDmaStatus.fifoHead.dword = HOST_DMA_FIFO_CNT_READ();
 
     if (g_hostDmaStatus.fifoHead.autoDmaRx == g_hostDmaStatus.fifoTail.autoDmaRx)
         return 1;
@@ -75,6 +75,12 @@
 
 #define NVME_CMD_SRAM_ADDR (HOST_IP_ADDR + 0x10000)
 
+#ifdef NSC_SIMULATOR
+#define HOST_DMA_FIFO_CNT_READ() SimReadHostDmaFifoCnt()
+#else
+#define HOST_DMA_FIFO_CNT_READ() IO_READ32(HOST_DMA_FIFO_CNT_REG_ADDR)
+#endif
+
 #define HOST_DMA_DIRECT_TYPE (1)
 #define HOST_DMA_AUTO_TYPE   (0)
 
@@ -393,6 +399,10 @@ unsigned int check_auto_tx_dma_partial_done(unsigned int tailIndex, unsigned int
 
 unsigned int check_auto_rx_dma_partial_done(unsigned int tailIndex, unsigned int tailAssistIndex);
 
+#ifdef NSC_SIMULATOR
+unsigned int SimReadHostDmaFifoCnt();
+#endif
+
 extern HOST_DMA_STATUS g_hostDmaStatus;
 extern HOST_DMA_ASSIST_STATUS g_hostDmaAssistStatus;
 
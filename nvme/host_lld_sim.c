@@ -0,0 +1,517 @@
+//////////////////////////////////////////////////////////////////////////////////
+// host_lld_sim.c for Cosmos+ OpenSSD
+// Copyright (c) 2016 Hanyang University ENC Lab.
+// Contributed by Yong Ho Song <yhsong@enc.hanyang.ac.kr>
+//				  Youngjin Jo <yjjo@enc.hanyang.ac.kr>
+//				  Sangjin Lee <sjlee@enc.hanyang.ac.kr>
+//				  Jaewook Kwak <jwkwak@enc.hanyang.ac.kr>
+//
+// This file is part of Cosmos+ OpenSSD.
+//
+// Cosmos+ OpenSSD is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3, or (at your option)
+// any later version.
+//
+// Cosmos+ OpenSSD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Cosmos+ OpenSSD; see the file COPYING.
+// If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Company: ENC Lab. <http://enc.hanyang.ac.kr>
+// Engineer: Sangjin Lee <sjlee@enc.hanyang.ac.kr>
+//			 Jaewook Kwak <jwkwak@enc.hanyang.ac.kr>
+//
+// Project Name: Cosmos+ OpenSSD
+// Design Name: Cosmos+ Firmware
+// Module Name: NVMe Low Level Driver Simulator
+// File Name: host_lld_sim.c
+//
+// Version: v1.0.0
+//
+// Description:
+//   - host-side replacement of the NVMe low level driver
+//   - fetches commands from the benchmark driver and models the host DMA engine
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Revision History:
+//
+// * v1.0.0
+//   - First draft
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifdef NSC_SIMULATOR
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "debug.h"
+
+#include "nvme.h"
+#include "host_lld.h"
+#include "nvme_bench.h"
+
+#include "../ftl_config.h"
+#include "../nsc_driver_sim.h"
+
+#ifndef SIM_PCIE_MB_PER_SEC
+#define SIM_PCIE_MB_PER_SEC 3200 /* effective bandwidth of the PCIe Gen2 x8 link */
+#endif
+
+#define SIM_DMA_NS_PER_NVME_BLOCK (((unsigned long long)BYTES_PER_NVME_BLOCK * 1000) / SIM_PCIE_MB_PER_SEC)
+#define SIM_DMA_FIFO_SIZE         256 // the fifo indices of `HOST_DMA_FIFO_CNT_REG` are 8 bits
+#define SIM_CMD_SLOT_COUNT        BENCH_MAX_QUEUE_DEPTH
+#define SIM_DSM_MAX_RANGES        256
+
+/**
+ * @brief The state of an outstanding NVMe command.
+ *
+ * An I/O command completes automatically after all of its 4KB blocks are transferred by
+ * the auto DMA, or explicitly by `set_auto_nvme_cpl()`.
+ */
+typedef struct _SIM_NVME_CMD_SLOT
+{
+    unsigned int valid;
+    unsigned int opc;
+    unsigned int nlb; // not zero-based
+    unsigned int slba;
+    unsigned int remainingDmaCnt;
+    unsigned int deallocate; // a Dataset Management command with the deallocate attribute
+    unsigned long long fetchTime;
+    unsigned int fetchWriteGeneration;                     // `simWriteGeneration` when a read is fetched
+    unsigned int fetchGeneration[256];                     // the generation of each block when a read is fetched
+    DATASET_MANAGEMENT_RANGE dsmRange[SIM_DSM_MAX_RANGES]; // the range list of a Dataset Management command
+} SIM_NVME_CMD_SLOT;
+
+typedef struct _SIM_DMA_ENTRY
+{
+    unsigned int cmdSlotTag;
+    unsigned int autoCompletion;
+    unsigned long long doneTime;
+} SIM_DMA_ENTRY;
+
+typedef struct _SIM_DMA_FIFO
+{
+    SIM_DMA_ENTRY entry[SIM_DMA_FIFO_SIZE];
+    unsigned char head;
+    unsigned char tail;
+    unsigned long long busUntil;
+} SIM_DMA_FIFO;
+
+extern NVME_CONTEXT g_nvmeTask;
+
+static SIM_NVME_CMD_SLOT simCmdSlot[SIM_CMD_SLOT_COUNT];
+static SIM_DMA_FIFO simDmaRxFifo, simDmaTxFifo;
+static unsigned int simOutstandingCmdCnt;
+
+/**
+ * The generation of the latest data written to each LBA, zero if never written. Every
+ * written block is stamped with its LBA and generation, and every block read back is
+ * checked against them, so a stale or misplaced block is reported by the benchmark.
+ * A block zeroed by Write Zeroes or Format NVM has `SIM_GENERATION_ZERO` and must be read
+ * as zeros.
+ */
+#define SIM_GENERATION_ZERO 0xffffffff
+
+static unsigned int *simLbaGeneration;
+static unsigned int simLbaGenerationCnt;
+static unsigned int simWriteGeneration;
+
+static unsigned int *sim_lba_generation(unsigned int lba)
+{
+    if (simLbaGeneration == NULL)
+    {
+        simLbaGenerationCnt = bench_lba_count();
+        simLbaGeneration    = calloc(simLbaGenerationCnt, sizeof(unsigned int));
+        ASSERT(simLbaGeneration != NULL, "failed to allocate the LBA generation table");
+    }
+
+    return (lba < simLbaGenerationCnt) ? &simLbaGeneration[lba] : NULL;
+}
+
+static void sim_set_generation(unsigned int slba, unsigned int nlb, unsigned int value)
+{
+    unsigned int iBlock, *generation;
+
+    for (iBlock = 0; iBlock < nlb; iBlock++)
+    {
+        if ((generation = sim_lba_generation(slba + iBlock)) == NULL)
+            break;
+        *generation = value;
+    }
+}
+
+/**
+ * @brief Take the generations of the blocks of a read when it is fetched.
+ *
+ * A block written, zeroed or deallocated while the read is outstanding may legally be read
+ * as it was when the read was fetched or as any of its later versions, check `sim_check_tx_block()`.
+ */
+static void sim_snapshot_generation(SIM_NVME_CMD_SLOT *slot)
+{
+    unsigned int iBlock, *generation;
+
+    slot->fetchWriteGeneration = simWriteGeneration;
+    for (iBlock = 0; iBlock < slot->nlb; iBlock++)
+    {
+        generation                    = sim_lba_generation(slot->slba + iBlock);
+        slot->fetchGeneration[iBlock] = generation ? *generation : 0;
+    }
+}
+
+/**
+ * @brief Apply the effect of a deallocate, Write Zeroes or Format NVM command to the expected data.
+ *
+ * The blocks are unchecked while the command is in flight, since the writes fetched before
+ * it may still be transferring. On success, the deallocated blocks stay unchecked and the
+ * zeroed blocks are expected to be read as zeros.
+ */
+static void sim_update_generation(SIM_NVME_CMD_SLOT *slot, unsigned int done)
+{
+    unsigned int iRange;
+
+    if (slot->opc == IO_NVM_WRITE_ZEROES)
+        sim_set_generation(slot->slba, slot->nlb, done ? SIM_GENERATION_ZERO : 0);
+    else if (slot->opc == IO_NVM_DATASET_MANAGEMENT && slot->deallocate)
+        for (iRange = 0; iRange < SIM_DSM_MAX_RANGES; iRange++)
+            sim_set_generation(slot->dsmRange[iRange].startingLBA[0], slot->dsmRange[iRange].lengthInLogicalBlocks, 0);
+    else if (slot->opc == ADMIN_FORMAT_NVM) // the only admin command issued by the benchmark
+        sim_set_generation(0, bench_lba_count(), done ? SIM_GENERATION_ZERO : 0);
+}
+
+static void sim_complete_cmd(unsigned int cmdSlotTag, unsigned int statusFieldWord)
+{
+    SIM_NVME_CMD_SLOT *slot = &simCmdSlot[cmdSlotTag];
+
+    ASSERT(slot->valid, "completion of an idle command slot %u", cmdSlotTag);
+
+    if (!((statusFieldWord >> 1) & 0x7ff)) // SC and SCT are clear
+        sim_update_generation(slot, 1);
+
+    bench_record_cpl(slot->opc, slot->nlb, statusFieldWord, V2FSimGetTimeNs() - slot->fetchTime);
+    slot->valid = 0;
+    simOutstandingCmdCnt--;
+}
+
+/**
+ * @brief Retire the DMA entries that have finished by now.
+ */
+static void sim_retire_dma(SIM_DMA_FIFO *fifo, unsigned long long now)
+{
+    SIM_DMA_ENTRY *entry;
+
+    while (fifo->head != fifo->tail)
+    {
+        entry = &fifo->entry[fifo->head];
+        if (entry->doneTime > now)
+            break;
+
+        if (entry->autoCompletion && simCmdSlot[entry->cmdSlotTag].valid)
+            if (--simCmdSlot[entry->cmdSlotTag].remainingDmaCnt == 0)
+                sim_complete_cmd(entry->cmdSlotTag, 0);
+
+        fifo->head++;
+    }
+}
+
+static void sim_push_dma(SIM_DMA_FIFO *fifo, unsigned int cmdSlotTag, unsigned int autoCompletion)
+{
+    SIM_DMA_ENTRY *entry;
+    unsigned long long now;
+
+    // wait until the fifo has a free entry, like the real driver does
+    while ((unsigned char)(fifo->tail + 1) == fifo->head)
+        sim_retire_dma(fifo, V2FSimGetTimeNs());
+
+    now                   = V2FSimGetTimeNs();
+    fifo->busUntil        = ((fifo->busUntil > now) ? fifo->busUntil : now) + SIM_DMA_NS_PER_NVME_BLOCK;
+    entry                 = &fifo->entry[fifo->tail];
+    entry->cmdSlotTag     = cmdSlotTag;
+    entry->autoCompletion = autoCompletion;
+    entry->doneTime       = fifo->busUntil;
+    fifo->tail++;
+}
+
+/**
+ * @brief Get the head indices of the DMA fifos in the format of `HOST_DMA_FIFO_CNT_REG`.
+ *
+ * Direct DMAs are done synchronously in the simulator, so their heads equal the tails.
+ */
+unsigned int SimReadHostDmaFifoCnt()
+{
+    HOST_DMA_FIFO_CNT_REG fifoCnt;
+    unsigned long long now = V2FSimGetTimeNs();
+
+    sim_retire_dma(&simDmaRxFifo, now);
+    sim_retire_dma(&simDmaTxFifo, now);
+
+    fifoCnt.directDmaRx = g_hostDmaStatus.fifoTail.directDmaRx;
+    fifoCnt.directDmaTx = g_hostDmaStatus.fifoTail.directDmaTx;
+    fifoCnt.autoDmaRx   = simDmaRxFifo.head;
+    fifoCnt.autoDmaTx   = simDmaTxFifo.head;
+
+    return fifoCnt.dword;
+}
+
+void dev_irq_init() { g_nvmeTask.status = NVME_TASK_WAIT_CC_EN; }
+
+void dev_irq_handler() {}
+
+unsigned int check_nvme_cc_en() { return 1; }
+
+void pcie_async_reset(unsigned int rstCnt) {}
+
+void set_link_width(unsigned int linkNum) {}
+
+void set_nvme_csts_rdy(unsigned int rdy) {}
+
+void set_nvme_csts_shst(unsigned int shst) {}
+
+void set_nvme_admin_queue(unsigned int sqValid, unsigned int cqValid, unsigned int cqIrqEn) {}
+
+/**
+ * @brief Copy the range list of a Dataset Management command from the host memory.
+ *
+ * The list is received later by the auto RxDMA of the fw. If the ranges are to be
+ * deallocated, their blocks are no longer checked when being read back.
+ */
+static void sim_fetch_dsm_ranges(SIM_NVME_CMD_SLOT *slot, NVME_IO_COMMAND *nvmeIOCmd)
+{
+    DATASET_MANAGEMENT_RANGE *range;
+    unsigned int rangeCnt, iRange;
+
+    range    = (DATASET_MANAGEMENT_RANGE *)(uintptr_t)(((unsigned long long)nvmeIOCmd->PRP1[1] << 32) |
+                                                    nvmeIOCmd->PRP1[0]);
+    rangeCnt = (nvmeIOCmd->dword[10] & 0xff) + 1;
+
+    memset(slot->dsmRange, 0, sizeof(slot->dsmRange));
+    memcpy(slot->dsmRange, range, rangeCnt * sizeof(DATASET_MANAGEMENT_RANGE));
+
+    slot->nlb             = 0;
+    slot->slba            = 0;
+    slot->remainingDmaCnt = 0;
+    slot->deallocate      = (nvmeIOCmd->dword[11] & 0x4) ? 1 : 0; // AD
+    for (iRange = 0; iRange < rangeCnt; iRange++)
+        slot->nlb += range[iRange].lengthInLogicalBlocks;
+
+    sim_update_generation(slot, 0);
+}
+
+/**
+ * @brief Fetch the next command of the benchmark workload.
+ *
+ * A new command is fetched only if the number of outstanding commands is less than the
+ * queue depth of the workload. After the workload is exhausted and all the outstanding
+ * commands are completed, the report is printed and the simulation ends.
+ */
+unsigned int get_nvme_cmd(unsigned short *qID, unsigned short *cmdSlotTag, unsigned int *cmdSeqNum,
+                          unsigned int *cmdDword)
+{
+    static unsigned int seqNum;
+    NVME_COMMAND nvmeCmd;
+    NVME_IO_COMMAND *nvmeIOCmd = (NVME_IO_COMMAND *)nvmeCmd.cmdDword;
+    unsigned int slot;
+
+    SimReadHostDmaFifoCnt();
+
+    if (simOutstandingCmdCnt >= bench_queue_depth() || !bench_next_cmd(&nvmeCmd))
+    {
+        if (bench_workload_done() && simOutstandingCmdCnt == 0)
+        {
+            bench_report();
+            if (!bench_power_cycle())
+                exit(0);
+        }
+        return 0;
+    }
+
+    for (slot = 0; slot < SIM_CMD_SLOT_COUNT; slot++)
+        if (!simCmdSlot[slot].valid)
+            break;
+    ASSERT(slot < SIM_CMD_SLOT_COUNT, "no free command slot");
+
+    simCmdSlot[slot].valid           = 1;
+    simCmdSlot[slot].opc             = nvmeIOCmd->OPC;
+    simCmdSlot[slot].nlb             = (nvmeIOCmd->OPC == IO_NVM_FLUSH || nvmeIOCmd->OPC == ADMIN_FORMAT_NVM)
+                                           ? 0
+                                           : (nvmeIOCmd->dword[12] & 0xffff) + 1;
+    simCmdSlot[slot].slba            = nvmeIOCmd->dword[10];
+    simCmdSlot[slot].remainingDmaCnt = simCmdSlot[slot].nlb;
+    simCmdSlot[slot].fetchTime       = V2FSimGetTimeNs();
+    simOutstandingCmdCnt++;
+
+    if (nvmeIOCmd->OPC == IO_NVM_READ)
+        sim_snapshot_generation(&simCmdSlot[slot]);
+    else if (nvmeIOCmd->OPC == IO_NVM_DATASET_MANAGEMENT)
+        sim_fetch_dsm_ranges(&simCmdSlot[slot], nvmeIOCmd);
+    else if (nvmeIOCmd->OPC == IO_NVM_WRITE_ZEROES || nvmeIOCmd->OPC == ADMIN_FORMAT_NVM)
+    {
+        // no data is transferred
+        simCmdSlot[slot].remainingDmaCnt = 0;
+        sim_update_generation(&simCmdSlot[slot], 0);
+    }
+
+    *qID        = nvmeCmd.qID;
+    *cmdSlotTag = slot;
+    *cmdSeqNum  = seqNum++;
+    memcpy(cmdDword, nvmeCmd.cmdDword, sizeof(nvmeCmd.cmdDword));
+
+    return 1;
+}
+
+void set_auto_nvme_cpl(unsigned int cmdSlotTag, unsigned int specific, unsigned int statusFieldWord)
+{
+    sim_complete_cmd(cmdSlotTag, statusFieldWord);
+}
+
+void set_nvme_slot_release(unsigned int cmdSlotTag)
+{
+    if (simCmdSlot[cmdSlotTag].valid)
+        sim_complete_cmd(cmdSlotTag, 0);
+}
+
+void set_nvme_cpl(unsigned int sqId, unsigned int cid, unsigned int specific, unsigned int statusFieldWord) {}
+
+void set_io_sq(unsigned int ioSqIdx, unsigned int valid, unsigned int cqVector, unsigned int qSzie,
+               unsigned int pcieBaseAddrL, unsigned int pcieBaseAddrH)
+{
+}
+
+void set_io_cq(unsigned int ioCqIdx, unsigned int valid, unsigned int irqEn, unsigned int irqVector,
+               unsigned int qSzie, unsigned int pcieBaseAddrL, unsigned int pcieBaseAddrH)
+{
+}
+
+void set_direct_tx_dma(unsigned int devAddr, unsigned int pcieAddrH, unsigned int pcieAddrL, unsigned int len)
+{
+    g_hostDmaStatus.fifoTail.directDmaTx++;
+    g_hostDmaStatus.directDmaTxCnt++;
+}
+
+void set_direct_rx_dma(unsigned int devAddr, unsigned int pcieAddrH, unsigned int pcieAddrL, unsigned int len)
+{
+    g_hostDmaStatus.fifoTail.directDmaRx++;
+    g_hostDmaStatus.directDmaRxCnt++;
+}
+
+/**
+ * @brief Check whether a block read back is all zeros.
+ */
+static unsigned int sim_is_zero_block(unsigned int *block)
+{
+    unsigned int i;
+
+    for (i = 0; i < BYTES_PER_NVME_BLOCK / sizeof(unsigned int); i++)
+        if (block[i])
+            return 0;
+    return 1;
+}
+
+/**
+ * @brief Check a block of a read against the generations the block has had since the read was fetched.
+ *
+ * If the block is unchanged since then, it must be read as its latest data, or as zeros if
+ * it has been zeroed. Otherwise the data of any generation from the fetch on is legal, as
+ * are zeros, since a deallocate or a Write Zeroes may have been ordered before the read.
+ */
+static void sim_check_tx_block(SIM_NVME_CMD_SLOT *slot, unsigned int cmd4KBOffset, unsigned int *stamp)
+{
+    unsigned int lba, *generation, fetchGeneration, oldestGeneration;
+
+    lba        = slot->slba + cmd4KBOffset;
+    generation = sim_lba_generation(lba);
+    if (generation == NULL)
+        return;
+
+    fetchGeneration = (slot->opc == IO_NVM_READ) ? slot->fetchGeneration[cmd4KBOffset] : *generation;
+    if (fetchGeneration == *generation)
+    {
+        if (*generation == SIM_GENERATION_ZERO)
+        {
+            if (!sim_is_zero_block(stamp))
+                bench_record_mismatch(lba, 0, stamp[0], stamp[1]);
+        }
+        else if (*generation && (stamp[0] != lba || stamp[1] != *generation))
+            bench_record_mismatch(lba, *generation, stamp[0], stamp[1]);
+        return;
+    }
+
+    // the block was unchecked when the read was fetched
+    if (fetchGeneration == 0)
+        return;
+
+    oldestGeneration = (fetchGeneration == SIM_GENERATION_ZERO) ? slot->fetchWriteGeneration + 1 : fetchGeneration;
+    if (!sim_is_zero_block(stamp) &&
+        (stamp[0] != lba || stamp[1] < oldestGeneration || stamp[1] > simWriteGeneration))
+        bench_record_mismatch(lba, *generation, stamp[0], stamp[1]);
+}
+
+/**
+ * @brief Transfer a 4KB block from the data buffer to the host.
+ *
+ * Only the transfer time on the link is modeled, but the stamp of the block is checked
+ * if the LBA has been written, or the whole block if it has been zeroed, check
+ * `sim_check_tx_block()`.
+ */
+void set_auto_tx_dma(unsigned int cmdSlotTag, unsigned int cmd4KBOffset, unsigned int devAddr,
+                     unsigned int autoCompletion)
+{
+    unsigned char tempTail;
+
+    ASSERT(cmd4KBOffset < 256);
+
+    sim_check_tx_block(&simCmdSlot[cmdSlotTag], cmd4KBOffset, (unsigned int *)(uintptr_t)devAddr);
+
+    sim_push_dma(&simDmaTxFifo, cmdSlotTag, autoCompletion);
+
+    tempTail = g_hostDmaStatus.fifoTail.autoDmaTx++;
+    if (tempTail > g_hostDmaStatus.fifoTail.autoDmaTx)
+        g_hostDmaAssistStatus.autoDmaTxOverFlowCnt++;
+
+    g_hostDmaStatus.autoDmaTxCnt++;
+}
+
+/**
+ * @brief Transfer a 4KB block from the host to the data buffer.
+ *
+ * The block is filled with its LBA offset in the command, so the written data is not all
+ * zero (or all 0xFF) and looks like a real payload to the NAND simulator, then stamped
+ * with its LBA and a new generation. The range list is transferred instead for a Dataset
+ * Management command.
+ */
+void set_auto_rx_dma(unsigned int cmdSlotTag, unsigned int cmd4KBOffset, unsigned int devAddr,
+                     unsigned int autoCompletion)
+{
+    unsigned char tempTail;
+    unsigned int lba, *generation, *stamp;
+
+    ASSERT(cmd4KBOffset < 256);
+
+    lba   = simCmdSlot[cmdSlotTag].slba + cmd4KBOffset;
+    stamp = (unsigned int *)(uintptr_t)devAddr;
+    memset(stamp, cmd4KBOffset, BYTES_PER_NVME_BLOCK);
+    if (simCmdSlot[cmdSlotTag].opc == IO_NVM_DATASET_MANAGEMENT)
+        memcpy(stamp, simCmdSlot[cmdSlotTag].dsmRange, sizeof(simCmdSlot[cmdSlotTag].dsmRange));
+    else if ((generation = sim_lba_generation(lba)) != NULL)
+    {
+        *generation = ++simWriteGeneration;
+        stamp[0]    = lba;
+        stamp[1]    = *generation;
+    }
+    sim_push_dma(&simDmaRxFifo, cmdSlotTag, autoCompletion);
+
+    tempTail = g_hostDmaStatus.fifoTail.autoDmaRx++;
+    if (tempTail > g_hostDmaStatus.fifoTail.autoDmaRx)
+        g_hostDmaAssistStatus.autoDmaRxOverFlowCnt++;
+
+    g_hostDmaStatus.autoDmaRxCnt++;
+}
+
+#endif /* NSC_SIMULATOR */
@@ -95,7 +95,8 @@
 #define IO_NVM_READ                0x02
 #define IO_NVM_WRITE_UNCORRECTABLE 0x04 /* Not acceptable yet */
 #define IO_NVM_COMPARE             0x05 /* Not acceptable yet */
-#define IO_NVM_DATASET_MANAGEMENT  0x09 /* Not acceptable yet */
+#define IO_NVM_WRITE_ZEROES        0x08
+#define IO_NVM_DATASET_MANAGEMENT  0x09
 
 /* customized io commands (>= 0x90) for monitoring */
 
@@ -246,6 +247,10 @@
 #define Timestamp                        0x0E
 #define SOFTWARE_PROGRESS_MARKER         0x80
 
+/* customized features identifiers (>= 0xC0) */
+
+#define VENDOR_DATA_BUFFER_ENTRY_COUNT 0xC0 // number of data buffer entries
+
 #define NVME_TASK_IDLE       0x0
 #define NVME_TASK_WAIT_CC_EN 0x1
 #define NVME_TASK_RUNNING    0x2
@@ -587,6 +592,24 @@ typedef struct _ADMIN_GET_LOG_PAGE_DW10
     };
 } ADMIN_GET_LOG_PAGE_DW10;
 
+/* Format NVM Command */
+typedef struct _ADMIN_FORMAT_NVM_DW10
+{
+    union
+    {
+        unsigned int dword;
+        struct
+        {
+            unsigned int LBAF : 4;
+            unsigned int MSET : 1;
+            unsigned int PI : 3;
+            unsigned int PIL : 1;
+            unsigned int SES : 3;
+            unsigned int reserved0 : 20;
+        };
+    };
+} ADMIN_FORMAT_NVM_DW10;
+
 /* Identify - Power State Descriptor Data Structure */
 typedef struct _ADMIN_IDENTIFY_POWER_STATE_DESCRIPTOR
 {
@@ -686,7 +709,8 @@ typedef struct _ADMIN_IDENTIFY_CONTROLLER
         unsigned short supportsCompare : 1;
         unsigned short supportsWriteUncorrectable : 1;
         unsigned short supportsDataSetManagement : 1;
-        unsigned short reserved0 : 13;
+        unsigned short supportsWriteZeroes : 1;
+        unsigned short reserved0 : 12;
     } ONCS;
 
     struct
@@ -822,6 +846,9 @@ typedef struct _ADMIN_IDENTIFY_NAMESPACE
 
 /* IO Write Command */
 
+#define NVME_DIRECTIVE_TYPE_IDENTIFY 0x0
+#define NVME_DIRECTIVE_TYPE_STREAMS  0x1
+
 /**
  * For read and write commands, CDW[12] was used for:
  *
@@ -844,7 +871,10 @@ typedef struct _IO_WRITE_COMMAND_DW12
         struct
         {
             unsigned short NLB;
-            unsigned short reserved0 : 10;
+            unsigned short reserved0 : 4;
+            unsigned short DTYPE : 4; // Directive Type, `NVME_DIRECTIVE_TYPE_*`
+            unsigned short STC : 1;
+            unsigned short reserved1 : 1;
             unsigned short PRINFO : 4;
             unsigned short FUA : 1;
             unsigned short LR : 1;
@@ -874,7 +904,8 @@ typedef struct _IO_WRITE_COMMAND_DW13
                 unsigned char SequentialRequest : 1; // seq request or not
                 unsigned char Incompressible : 1;    // could be compressed or not
             } DSM;
-            unsigned char reserved0[3];
+            unsigned char reserved0;
+            unsigned short DSPEC; // Directive Specific, the stream identifier for `NVME_DIRECTIVE_TYPE_STREAMS`
         };
     };
 } IO_WRITE_COMMAND_DW13;
@@ -948,16 +979,34 @@ typedef struct _IO_READ_COMMAND_DW15
 /* IO Dataset Management Command */
 typedef struct _IO_DATASET_MANAGEMENT_COMMAND_DW10
 {
-    unsigned int NR : 8;
-    unsigned int reserved0 : 24;
+    union
+    {
+        unsigned int dword;
+        struct
+        {
+            /* Number of ranges, 0's based */
+            unsigned int NR : 8;
+            unsigned int reserved0 : 24;
+        };
+    };
 } _IO_DATASET_MANAGEMENT_COMMAND_DW10;
 
 typedef struct _IO_DATASET_MANAGEMENT_COMMAND_DW11
 {
-    unsigned int IDR : 1;
-    unsigned int IDW : 1;
-    unsigned int AD : 1;
-    unsigned int reserved0 : 29;
+    union
+    {
+        unsigned int dword;
+        struct
+        {
+            /* Integral Dataset for Read */
+            unsigned int IDR : 1;
+            /* Integral Dataset for Write */
+            unsigned int IDW : 1;
+            /* Attribute - Deallocate */
+            unsigned int AD : 1;
+            unsigned int reserved0 : 29;
+        };
+    };
 } _IO_DATASET_MANAGEMENT_COMMAND_DW11;
 
 typedef struct _DATASET_MANAGEMENT_CONTEXT_ATTRIBUTES
@@ -44,7 +44,11 @@
 //   - First draft
 //////////////////////////////////////////////////////////////////////////////////
 
+#ifdef NSC_SIMULATOR
+#include "../sim/xil_printf.h"
+#else
 #include "xil_printf.h"
+#endif
 #include "debug.h"
 #include "string.h"
 #include "io_access.h"
@@ -56,6 +60,7 @@
 #include "nvme_admin_cmd.h"
 #include "ftl_config.h"
 #include "address_translation.h"
+#include "data_buffer.h"
 
 #include "nmc/nmc_mapping.h"
 
@@ -218,6 +223,17 @@ void handle_set_features(NVME_ADMIN_COMMAND *nvmeAdminCmd, NVME_COMPLETION *nvme
         nvmeCPL->specific = 0x0;
         break;
     }
+    case VENDOR_DATA_BUFFER_ENTRY_COUNT:
+    {
+        NVME_COMPLETION cpl;
+
+        cpl.dword[0] = 0x0;
+        if (!ResizeDataBuf(nvmeAdminCmd->dword11))
+            cpl.statusField.SC = SC_INVALID_FIELD_IN_COMMAND;
+        nvmeCPL->dword[0] = cpl.dword[0];
+        nvmeCPL->specific = dataBufEntryCount;
+        break;
+    }
     default:
     {
         xil_printf("Not Support FID (Set): %X\r\n", features.FID);
@@ -273,6 +289,12 @@ void handle_get_features(NVME_ADMIN_COMMAND *nvmeAdminCmd, NVME_COMPLETION *nvme
         nvmeCPL->specific = 0x0;
         break;
     }
+    case VENDOR_DATA_BUFFER_ENTRY_COUNT:
+    {
+        nvmeCPL->dword[0] = 0x0;
+        nvmeCPL->specific = dataBufEntryCount;
+        break;
+    }
     case 0xD0:
     {
         nvmeCPL->dword[0] = 0x0;
@@ -491,6 +513,40 @@ void handle_get_log_page(NVME_ADMIN_COMMAND *nvmeAdminCmd, NVME_COMPLETION *nvme
     nvmeCPL->specific = 0x9; // invalid log page
 }
 
+/**
+ * @brief Erase all the user data of the only namespace.
+ *
+ * Only the single 4KB LBA format without metadata is supported. All the used blocks are
+ * erased whether a secure erase is requested or not (SES 0 or 1), the cryptographic erase
+ * (SES 2) is not supported. The progress of the erase is printed on the console.
+ */
+void handle_format_nvm(NVME_ADMIN_COMMAND *nvmeAdminCmd, NVME_COMPLETION *nvmeCPL)
+{
+    ADMIN_FORMAT_NVM_DW10 formatInfo;
+    NVME_COMPLETION cpl;
+    unsigned int grownBadCnt;
+
+    formatInfo.dword = nvmeAdminCmd->dword10;
+
+    cpl.dword[0] = 0x0;
+    if (formatInfo.LBAF || formatInfo.MSET || formatInfo.PI || formatInfo.PIL)
+    {
+        cpl.statusField.SCT = SCT_COMMAND_SPECIFIC_STATUS;
+        cpl.statusField.SC  = SC_INVALID_FORMAT;
+    }
+    else if (formatInfo.SES > 1)
+        cpl.statusField.SC = SC_INVALID_FIELD_IN_COMMAND;
+    else
+    {
+        xil_printf("[ format NVM (SES %u) started. ]\r\n", formatInfo.SES);
+        grownBadCnt = FormatFTL();
+        xil_printf("[ format NVM done, %u grown bad blocks. ]\r\n", grownBadCnt);
+    }
+
+    nvmeCPL->dword[0] = cpl.dword[0];
+    nvmeCPL->specific = 0x0;
+}
+
 void handle_nvme_admin_cmd(NVME_COMMAND *nvmeCmd)
 {
     NVME_ADMIN_COMMAND *nvmeAdminCmd;
@@ -573,6 +629,11 @@ void handle_nvme_admin_cmd(NVME_COMMAND *nvmeCmd)
         handle_get_log_page(nvmeAdminCmd, &nvmeCPL);
         break;
     }
+    case ADMIN_FORMAT_NVM:
+    {
+        handle_format_nvm(nvmeAdminCmd, &nvmeCPL);
+        break;
+    }
     case ADMIN_SECURITY_RECEIVE:
     {
         needCpl          = 0;
@@ -0,0 +1,724 @@
+//////////////////////////////////////////////////////////////////////////////////
+// nvme_bench.c for Cosmos+ OpenSSD
+// Copyright (c) 2016 Hanyang University ENC Lab.
+// Contributed by Yong Ho Song <yhsong@enc.hanyang.ac.kr>
+//				  Youngjin Jo <yjjo@enc.hanyang.ac.kr>
+//				  Sangjin Lee <sjlee@enc.hanyang.ac.kr>
+//				  Jaewook Kwak <jwkwak@enc.hanyang.ac.kr>
+//
+// This file is part of Cosmos+ OpenSSD.
+//
+// Cosmos+ OpenSSD is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3, or (at your option)
+// any later version.
+//
+// Cosmos+ OpenSSD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Cosmos+ OpenSSD; see the file COPYING.
+// If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Company: ENC Lab. <http://enc.hanyang.ac.kr>
+// Engineer: Sangjin Lee <sjlee@enc.hanyang.ac.kr>
+//			 Jaewook Kwak <jwkwak@enc.hanyang.ac.kr>
+//
+// Project Name: Cosmos+ OpenSSD
+// Design Name: Cosmos+ Firmware
+// Module Name: NVMe Benchmark Driver
+// File Name: nvme_bench.c
+//
+// Version: v1.0.0
+//
+// Description:
+//   - host entry of the simulated firmware
+//   - replays NVMe I/O traces or generates fio-style workloads
+//   - reports IOPS, bandwidth and completion latency per command type
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Revision History:
+//
+// * v1.0.0
+//   - First draft
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifdef NSC_SIMULATOR
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "debug.h"
+
+#include "nvme.h"
+#include "host_lld.h"
+#include "nvme_bench.h"
+#include "nvme_main.h"
+
+#include "../memory_map.h"
+#include "../nsc_driver_sim.h"
+
+#define BENCH_DRAM_START_ADDR 0x10000000 // DATA_BUFFER_BASE_ADDR
+#define BENCH_DRAM_END_ADDR   0x3FFFFFFF
+
+static BENCH_WORKLOAD benchWorkload;
+static BENCH_STAT benchStat[BENCH_TYPE_COUNT];
+static unsigned long long benchStartTime;
+static unsigned long long benchMismatchCnt;
+
+static const char *benchTypeName[BENCH_TYPE_COUNT] = {"read", "write", "flush", "trim", "zero", "format"};
+
+// the range list of the latest deallocate, copied by the simulated controller on fetch
+static DATASET_MANAGEMENT_RANGE benchTrimRange;
+
+static unsigned int bench_rand()
+{
+    benchWorkload.seed = benchWorkload.seed * 1103515245 + 12345;
+    return benchWorkload.seed >> 1;
+}
+
+static unsigned int bench_type_of(unsigned int opc)
+{
+    if (opc == IO_NVM_READ)
+        return BENCH_TYPE_READ;
+    else if (opc == IO_NVM_WRITE)
+        return BENCH_TYPE_WRITE;
+    else if (opc == IO_NVM_DATASET_MANAGEMENT)
+        return BENCH_TYPE_TRIM;
+    else if (opc == IO_NVM_WRITE_ZEROES)
+        return BENCH_TYPE_ZERO;
+    else if (opc == ADMIN_FORMAT_NVM)
+        return BENCH_TYPE_FORMAT;
+
+    return BENCH_TYPE_FLUSH;
+}
+
+/**
+ * @brief Get the next command of the trace file.
+ *
+ * @return unsigned int 1 if a command is parsed, 0 if the trace is exhausted.
+ */
+static unsigned int bench_next_trace_cmd(unsigned int *opc, unsigned int *startLba, unsigned int *blocks)
+{
+    char line[128], op;
+
+    while (fgets(line, sizeof(line), benchWorkload.trace))
+    {
+        if (line[0] == '#' || line[0] == '\n')
+            continue;
+
+        *startLba = 0;
+        *blocks   = 1;
+        if (sscanf(line, " %c %u %u", &op, startLba, blocks) < 1)
+            continue;
+
+        if (op == 'R' || op == 'r')
+            *opc = IO_NVM_READ;
+        else if (op == 'W' || op == 'w')
+            *opc = IO_NVM_WRITE;
+        else if (op == 'F' || op == 'f')
+            *opc = IO_NVM_FLUSH;
+        else if (op == 'D' || op == 'd')
+            *opc = IO_NVM_DATASET_MANAGEMENT;
+        else if (op == 'Z' || op == 'z')
+            *opc = IO_NVM_WRITE_ZEROES;
+        else if (op == 'X' || op == 'x')
+            *opc = ADMIN_FORMAT_NVM;
+        else
+        {
+            pr_warn("unknown trace op '%c', skipped", op);
+            continue;
+        }
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Build the next NVMe I/O command of the workload.
+ *
+ * @param nvmeCmd the command to be filled, the slot tag is assigned by the caller.
+ * @return unsigned int 1 if a command is built, 0 if the workload is exhausted.
+ */
+unsigned int bench_next_cmd(NVME_COMMAND *nvmeCmd)
+{
+    NVME_IO_COMMAND *nvmeIOCmd = (NVME_IO_COMMAND *)nvmeCmd->cmdDword;
+    unsigned int opc, startLba, blocks, r;
+
+    if (benchWorkload.done)
+        return 0;
+
+    if (benchWorkload.pattern == BENCH_PATTERN_TRACE)
+    {
+        if (!bench_next_trace_cmd(&opc, &startLba, &blocks))
+        {
+            benchWorkload.done = 1;
+            return 0;
+        }
+    }
+    else
+    {
+        // the capacity is determined by FTL, thus unknown until `InitFTL()` is done
+        if (benchWorkload.lbaSpan == 0 || benchWorkload.lbaSpan > storageCapacity_L)
+            benchWorkload.lbaSpan = storageCapacity_L;
+
+        if (benchWorkload.issuedCnt >= benchWorkload.cmdCount)
+        {
+            benchWorkload.done = 1;
+            return 0;
+        }
+
+        r = bench_rand() % 100;
+        if (r < benchWorkload.readPercent)
+            opc = IO_NVM_READ;
+        else if (r < benchWorkload.readPercent + benchWorkload.trimPercent)
+            opc = IO_NVM_DATASET_MANAGEMENT;
+        else if (r < benchWorkload.readPercent + benchWorkload.trimPercent + benchWorkload.zeroPercent)
+            opc = IO_NVM_WRITE_ZEROES;
+        else
+            opc = IO_NVM_WRITE;
+        blocks = benchWorkload.blocksPerCmd;
+
+        if (benchWorkload.pattern == BENCH_PATTERN_SEQ)
+        {
+            if (benchWorkload.nextSeqLba + blocks > benchWorkload.lbaSpan)
+                benchWorkload.nextSeqLba = 0;
+            startLba = benchWorkload.nextSeqLba;
+            benchWorkload.nextSeqLba += blocks;
+        }
+        else
+            startLba = (bench_rand() % (benchWorkload.lbaSpan / blocks)) * blocks;
+    }
+
+    // out-of-range deallocates are issued to check the error status of the fw
+    if (opc != IO_NVM_FLUSH && opc != IO_NVM_DATASET_MANAGEMENT && opc != ADMIN_FORMAT_NVM &&
+        (blocks == 0 || startLba + blocks > storageCapacity_L))
+    {
+        pr_warn("command out of range (LBA %u, %u blocks), skipped", startLba, blocks);
+        return bench_next_cmd(nvmeCmd);
+    }
+
+    memset(nvmeCmd->cmdDword, 0, sizeof(nvmeCmd->cmdDword));
+    nvmeCmd->qID         = 1;
+    nvmeIOCmd->OPC       = opc;
+    nvmeIOCmd->dword[10] = startLba;
+    nvmeIOCmd->dword[11] = 0;
+    nvmeIOCmd->dword[12] = (opc == IO_NVM_FLUSH) ? 0 : (blocks - 1); // NLB is zero-based
+
+    if (opc == IO_NVM_DATASET_MANAGEMENT)
+    {
+        memset(&benchTrimRange, 0, sizeof(benchTrimRange));
+        benchTrimRange.startingLBA[0]        = startLba;
+        benchTrimRange.lengthInLogicalBlocks = blocks;
+
+        nvmeIOCmd->PRP1[0]   = (unsigned int)(uintptr_t)&benchTrimRange;
+        nvmeIOCmd->PRP1[1]   = (unsigned int)((unsigned long long)(uintptr_t)&benchTrimRange >> 32);
+        nvmeIOCmd->dword[10] = 0;   // one range, NR is zero-based
+        nvmeIOCmd->dword[11] = 0x4; // AD
+        nvmeIOCmd->dword[12] = 0;
+    }
+    else if (opc == ADMIN_FORMAT_NVM)
+    {
+        // on the admin queue, with a user data erase (SES 1)
+        nvmeCmd->qID         = 0;
+        nvmeIOCmd->dword[10] = 0x1 << 9;
+        nvmeIOCmd->dword[12] = 0;
+    }
+    else if (opc != IO_NVM_FLUSH && startLba + blocks > benchWorkload.maxLba)
+        benchWorkload.maxLba = startLba + blocks;
+
+    benchWorkload.issuedCnt++;
+    if (benchWorkload.issuedCnt == 1)
+        benchStartTime = V2FSimGetTimeNs();
+
+    return 1;
+}
+
+unsigned int bench_queue_depth() { return benchWorkload.queueDepth; }
+
+unsigned int bench_workload_done() { return benchWorkload.done; }
+
+unsigned int bench_lba_count() { return storageCapacity_L; }
+
+/**
+ * @brief Record a block read back with a stamp different from the latest write.
+ *
+ * @param lba the LBA of the block.
+ * @param generation the generation of the latest write to the LBA.
+ * @param stampLba the LBA stamped in the block.
+ * @param stampGeneration the generation stamped in the block.
+ */
+void bench_record_mismatch(unsigned int lba, unsigned int generation, unsigned int stampLba,
+                           unsigned int stampGeneration)
+{
+    if (benchMismatchCnt++ < 16)
+        pr_warn("data mismatch at LBA %u: expected (%u, %u), got (%u, %u)", lba, lba, generation, stampLba,
+                stampGeneration);
+}
+
+/**
+ * @brief Record the completion of a command.
+ *
+ * @param opc the opcode of the completed command.
+ * @param nlb the number of 4KB blocks of the command (not zero-based).
+ * @param statusFieldWord the status field posted to the completion queue.
+ * @param latency the time from the command being fetched to being completed, in ns.
+ */
+void bench_record_cpl(unsigned int opc, unsigned int nlb, unsigned int statusFieldWord, unsigned long long latency)
+{
+    BENCH_STAT *stat = &benchStat[bench_type_of(opc)];
+
+    if (stat->cmdCnt == stat->latencyCap)
+    {
+        stat->latencyCap = stat->latencyCap ? stat->latencyCap * 2 : 4096;
+        stat->latency    = realloc(stat->latency, stat->latencyCap * sizeof(unsigned long long));
+        ASSERT(stat->latency, "out of host memory for latency samples");
+    }
+
+    stat->latency[stat->cmdCnt++] = latency;
+    stat->blockCnt += nlb;
+    if ((statusFieldWord >> 1) & 0x7ff) // SC or SCT is set
+        stat->errorCnt++;
+}
+
+static int bench_compare_latency(const void *a, const void *b)
+{
+    unsigned long long x = *(const unsigned long long *)a, y = *(const unsigned long long *)b;
+
+    return (x > y) - (x < y);
+}
+
+static unsigned long long bench_percentile(BENCH_STAT *stat, unsigned int permille)
+{
+    unsigned long long idx = (stat->cmdCnt * permille + 999) / 1000;
+
+    return stat->latency[idx ? idx - 1 : 0];
+}
+
+/**
+ * @brief Print the erase count spread of the good user blocks and the wear leveling work.
+ */
+static void bench_report_wear()
+{
+    unsigned int dieNo, blockNo, eraseCnt, minEraseCnt, maxEraseCnt, blockCnt;
+    unsigned long long eraseSum;
+
+    minEraseCnt = 0xffffffff;
+    maxEraseCnt = 0;
+    blockCnt    = 0;
+    eraseSum    = 0;
+    for (dieNo = 0; dieNo < USER_DIES; dieNo++)
+        for (blockNo = 0; blockNo < USER_BLOCKS_PER_DIE; blockNo++)
+        {
+            if (VBLK_ENTRY(dieNo, blockNo)->bad)
+                continue;
+            eraseCnt = VBLK_ENTRY(dieNo, blockNo)->eraseCnt;
+            if (eraseCnt < minEraseCnt)
+                minEraseCnt = eraseCnt;
+            if (eraseCnt > maxEraseCnt)
+                maxEraseCnt = eraseCnt;
+            eraseSum += eraseCnt;
+            blockCnt++;
+        }
+
+    xil_printf("[ wear leveling ] erase count min/avg/max %u/%.1f/%u, checks %u, migrated %u blocks, %u slices\r\n",
+               blockCnt ? minEraseCnt : 0, blockCnt ? (double)eraseSum / blockCnt : 0.0, maxEraseCnt,
+               wearLeveling.checkCnt, wearLeveling.migratedCnt, wearLeveling.copyCnt);
+}
+
+/**
+ * @brief Print the throughput and the latency distribution of each command type.
+ */
+void bench_report()
+{
+    unsigned long long elapsed;
+    double sec;
+    BENCH_STAT *stat;
+    unsigned int type;
+
+    elapsed = V2FSimGetTimeNs() - benchStartTime;
+    sec     = elapsed / 1e9;
+
+    xil_printf("\r\n[ benchmark finished: %u commands in %.3f s ]\r\n", benchWorkload.issuedCnt, sec);
+    xil_printf("%-6s %10s %10s %10s %10s %10s %10s %10s %8s\r\n", "type", "cmds", "IOPS", "MB/s", "avg(us)",
+               "p50(us)", "p99(us)", "p99.9(us)", "errors");
+
+    for (type = 0; type < BENCH_TYPE_COUNT; type++)
+    {
+        unsigned long long sum = 0, i;
+
+        stat = &benchStat[type];
+        if (stat->cmdCnt == 0)
+            continue;
+
+        qsort(stat->latency, stat->cmdCnt, sizeof(unsigned long long), bench_compare_latency);
+        for (i = 0; i < stat->cmdCnt; i++)
+            sum += stat->latency[i];
+
+        xil_printf("%-6s %10llu %10.0f %10.1f %10.1f %10.1f %10.1f %10.1f %8llu\r\n", benchTypeName[type],
+                   stat->cmdCnt, stat->cmdCnt / sec, stat->blockCnt * BYTES_PER_NVME_BLOCK / sec / (1024 * 1024),
+                   sum / 1e3 / stat->cmdCnt, bench_percentile(stat, 500) / 1e3, bench_percentile(stat, 990) / 1e3,
+                   bench_percentile(stat, 999) / 1e3, stat->errorCnt);
+    }
+
+    xil_printf("[ data buffer ] %s x %u, hit %u, miss %u (%.1f%%), ghost hit B1 %u B2 %u\r\n",
+               (DATA_BUF_POLICY == DATA_BUF_POLICY_ARC) ? "ARC" : "LRU", dataBufEntryCount, dataBufStat.hitCnt,
+               dataBufStat.missCnt,
+               (dataBufStat.hitCnt + dataBufStat.missCnt)
+                   ? 100.0 * dataBufStat.hitCnt / (dataBufStat.hitCnt + dataBufStat.missCnt)
+                   : 0.0,
+               dataBufStat.ghostHitCnt[0], dataBufStat.ghostHitCnt[1]);
+    xil_printf("[ read-ahead ] issued %u, hit %u, wasted %u, depth %u\r\n", dataBufStat.readAheadCnt,
+               dataBufStat.readAheadHitCnt, dataBufStat.readAheadWasteCnt, readAheadState.depth);
+    xil_printf("[ write-back ] background %u, dirty %u, coalesced RxDMA %u\r\n", dataBufStat.bgFlushCnt,
+               dataBufMapPtr->dirtyCnt, dataBufStat.coalescedRxDmaCnt);
+    xil_printf("[ deallocate ] commands %u, slices %u, discarded buffer entries %u\r\n", deallocateState.doneCmdCnt,
+               deallocateState.sliceCnt, dataBufStat.discardCnt);
+    xil_printf("[ unmapped read ] %u slices served from the zero buffer\r\n", dataBufStat.zeroReadCnt);
+    xil_printf("[ write stream ] blocks/slices hot %u/%u, cold %u/%u, gc %u/%u, nmc %u/%u, hinted %u\r\n",
+               writeStream.blockCnt[WRITE_STREAM_HOST_HOT], writeStream.sliceCnt[WRITE_STREAM_HOST_HOT],
+               writeStream.blockCnt[WRITE_STREAM_HOST_COLD], writeStream.sliceCnt[WRITE_STREAM_HOST_COLD],
+               writeStream.blockCnt[WRITE_STREAM_GC], writeStream.sliceCnt[WRITE_STREAM_GC],
+               writeStream.blockCnt[WRITE_STREAM_NMC], writeStream.sliceCnt[WRITE_STREAM_NMC], writeStream.hintedCnt);
+    xil_printf("[ gc ] %u victims, %u valid slices copied, background %u, foreground %u, yields %u\r\n", gcTriggered,
+               copyCnt, gcState.backgroundCnt, gcState.foregroundCnt, gcState.yieldCnt);
+    xil_printf("[ gc ] %u copies by copyback, %u of them programmed from the temp buffer for bit errors\r\n",
+               gcState.copybackCnt, gcState.eccRoundTripCnt);
+    bench_report_wear();
+    xil_printf("[ die selection ] %s, %u writes steered off the round robin die\r\n",
+               (DIE_SELECTION_POLICY == DIE_SELECTION_LOAD_AWARE) ? "load aware" : "round robin", dieSelectionSkipCnt);
+    xil_printf("[ map journal ] records %u, pages %u, checkpoints %u, replayed pages %u, scanned slices %u\r\n",
+               addrJournal.recordCnt, addrJournal.pageCnt, addrJournal.checkpointCnt, addrJournal.replayedCnt,
+               addrJournal.scannedCnt);
+#if (ADDR_MAP_MODE == ADDR_MAP_MODE_DEMAND)
+    xil_printf("[ map cache ] %u of %u pages, hit %u, miss %u (%.2f%%), written back %u, relocated %u\r\n",
+               addrMapCacheEntryCount, ADDR_MAP_TRANS_PAGES, addrMapCache.hitCnt, addrMapCache.missCnt,
+               (addrMapCache.hitCnt + addrMapCache.missCnt)
+                   ? 100.0 * addrMapCache.hitCnt / (addrMapCache.hitCnt + addrMapCache.missCnt)
+                   : 0.0,
+               addrMapCache.writeBackCnt, addrMapCache.relocateCnt);
+#endif
+    xil_printf("[ data check ] %llu mismatched blocks\r\n", benchMismatchCnt);
+    V2FSimReportStatistics();
+}
+
+/**
+ * @brief Power cycle the fw after the workload and read back all the accessed LBAs.
+ *
+ * The data buffer is written back first, then the address maps are either checkpointed
+ * (`BENCH_POWER_CYCLE_CLEAN`), only journaled (`BENCH_POWER_CYCLE_FLUSH`) or left in the
+ * spare regions of the written slices (`BENCH_POWER_CYCLE_CRASH`). The maps and the data buffer
+ * in DRAM are trashed before `RecoverAddrMap()`, the flash is kept.
+ *
+ * @return unsigned int 1 if the verification pass is scheduled, 0 if nothing to do.
+ */
+unsigned int bench_power_cycle()
+{
+    unsigned long long startTime;
+    unsigned int type, verifyCmdCnt;
+
+    if (benchWorkload.powerCycle == BENCH_POWER_CYCLE_NONE)
+        return 0;
+
+    FlushDataBuf(0);
+    if (benchWorkload.powerCycle == BENCH_POWER_CYCLE_CLEAN)
+        SaveAddrMapCheckpoint();
+    else if (benchWorkload.powerCycle == BENCH_POWER_CYCLE_FLUSH)
+        FlushAddrJournal();
+    SyncAllLowLevelReqDone();
+
+    xil_printf("\r\n[ power cycle (%s) ]\r\n",
+               (benchWorkload.powerCycle == BENCH_POWER_CYCLE_CLEAN)   ? "clean"
+               : (benchWorkload.powerCycle == BENCH_POWER_CYCLE_FLUSH) ? "flush"
+                                                                       : "crash");
+    benchWorkload.powerCycle = BENCH_POWER_CYCLE_NONE;
+
+#if (ADDR_MAP_MODE == ADDR_MAP_MODE_DEMAND)
+    memset((void *)ADDR_MAP_DIR_ADDR, 0xa5, VALID_SLICE_BITMAP_ADDR + sizeof(VALID_SLICE_BITMAP) - ADDR_MAP_DIR_ADDR);
+    memset((void *)ADDR_JOURNAL_BUFFER_ADDR, 0xa5, ADDR_MAP_CACHE_BUFFER_END_ADDR - ADDR_JOURNAL_BUFFER_ADDR);
+#else
+    memset((void *)LOGICAL_SLICE_MAP_ADDR, 0xa5,
+           VALID_SLICE_BITMAP_ADDR + sizeof(VALID_SLICE_BITMAP) - LOGICAL_SLICE_MAP_ADDR);
+    memset((void *)ADDR_JOURNAL_BUFFER_ADDR, 0xa5, ADDR_MAP_BUFFER_END_ADDR - ADDR_JOURNAL_BUFFER_ADDR);
+#endif
+    memset((void *)VIRTUAL_DIE_MAP_ADDR, 0xa5, GC_VICTIM_MAP_ADDR + sizeof(GC_VICTIM_MAP) - VIRTUAL_DIE_MAP_ADDR);
+    InitGcVictimMap();
+    InitReadAhead();
+    InitDeallocate();
+    InitDataBuf();
+
+    startTime = V2FSimGetTimeNs();
+    RecoverAddrMap();
+    xil_printf("[ address maps recovered in %.3f ms ]\r\n", (V2FSimGetTimeNs() - startTime) / 1e6);
+
+    // read back everything written so far
+    for (type = 0; type < BENCH_TYPE_COUNT; type++)
+        benchStat[type].cmdCnt = benchStat[type].blockCnt = benchStat[type].errorCnt = 0;
+    verifyCmdCnt              = (benchWorkload.maxLba + benchWorkload.blocksPerCmd - 1) / benchWorkload.blocksPerCmd;
+    benchWorkload.pattern     = BENCH_PATTERN_SEQ;
+    benchWorkload.readPercent = 100;
+    benchWorkload.trimPercent = 0;
+    benchWorkload.zeroPercent = 0;
+    benchWorkload.lbaSpan     = verifyCmdCnt * benchWorkload.blocksPerCmd;
+    benchWorkload.nextSeqLba  = 0;
+    benchWorkload.cmdCount    = benchWorkload.issuedCnt + verifyCmdCnt;
+    benchWorkload.done        = 0;
+    benchStartTime            = V2FSimGetTimeNs();
+
+    return 1;
+}
+
+static void bench_usage(const char *prog)
+{
+    xil_printf("usage: %s [-t trace] [-p seq|rand] [-r read%%] [-T trim%%] [-Z zero%%] [-b blocks] [-q depth] "
+               "[-n cmds] [-s span] [-S seed] [-B entries] [-M entries] [-P clean|flush|crash] [-H]\r\n",
+               prog);
+    exit(1);
+}
+
+/**
+ * @brief The data buffer entry before the open-addressed hash table, only for comparison.
+ */
+typedef struct _BENCH_CHAINED_BUF_ENTRY
+{
+    unsigned int logicalSliceAddr;
+    unsigned int prevEntry : 16;
+    unsigned int nextEntry : 16;
+    unsigned int blockingReqTail : 16;
+    unsigned int hashPrevEntry : 16;
+    unsigned int hashNextEntry : 16;
+    unsigned int flags : 16;
+    unsigned int dirtyPrevEntry : 16;
+    unsigned int dirtyNextEntry : 16;
+} BENCH_CHAINED_BUF_ENTRY;
+
+/**
+ * @brief Generate the `idx`-th key of the given hash microbenchmark pattern.
+ *
+ * - 0: sequential LSAs
+ * - 1: one slice per die, like the stripes of a NMC file
+ * - 2: random LSAs
+ */
+static unsigned int bench_hash_key(unsigned int pattern, unsigned int idx)
+{
+    if (pattern == 0)
+        return idx;
+    else if (pattern == 1)
+        return idx * USER_DIES;
+
+    return bench_rand() % SLICES_PER_SSD;
+}
+
+/**
+ * @brief Measure the lookup cost of the data buffer hash table at different buffer sizes.
+ *
+ * For each buffer size, the table is filled with one key per entry and then the present
+ * keys are looked up in random order. The open-addressed table of the fw (check
+ * `DATA_BUF_HASH_TABLE`) is compared with the previous modulo bucketing, whose buckets
+ * were linked lists threaded through the buffer entries.
+ *
+ * The reported probes are the slots (or list nodes) visited per lookup.
+ */
+static void bench_hash()
+{
+    static const char *patternName[] = {"seq", "stride", "rand"};
+    const unsigned int lookupCnt     = 4000000;
+    unsigned int entryCnt, slotCnt, pattern, i, j, iSlot, node;
+    unsigned int *keys, *order;
+    BENCH_CHAINED_BUF_ENTRY *entries;
+    DATA_BUF_HASH_ENTRY *buckets;
+    unsigned long long startTime, probes, checksum = 0;
+    P_DATA_BUF_HASH_SLOT slots;
+
+    xil_printf("%-8s %-7s %10s %10s %10s %10s\r\n", "entries", "pattern", "chain(ns)", "probes", "open(ns)",
+               "probes");
+
+    for (entryCnt = 256; entryCnt <= 16384; entryCnt *= 4)
+    {
+        for (slotCnt = 1; slotCnt < 2 * entryCnt; slotCnt <<= 1)
+            ;
+
+        keys    = malloc(entryCnt * sizeof(unsigned int));
+        order   = malloc(entryCnt * sizeof(unsigned int));
+        entries = malloc(entryCnt * sizeof(BENCH_CHAINED_BUF_ENTRY));
+        buckets = malloc(entryCnt * sizeof(DATA_BUF_HASH_ENTRY));
+        slots   = malloc(slotCnt * sizeof(DATA_BUF_HASH_SLOT));
+
+        for (pattern = 0; pattern < 3; pattern++)
+        {
+            for (i = 0; i < entryCnt; i++)
+                buckets[i].headEntry = DATA_BUF_NONE;
+            for (i = 0; i < slotCnt; i++)
+                slots[i].bufEntry = DATA_BUF_NONE;
+
+            for (i = 0; i < entryCnt; i++)
+            {
+                do
+                {
+                    keys[i] = bench_hash_key(pattern, i);
+                } while (DataBufHashLookup(slots, slotCnt - 1, keys[i], 0) != DATA_BUF_HASH_SLOT_NONE);
+
+                entries[i].logicalSliceAddr           = keys[i];
+                entries[i].hashNextEntry              = buckets[keys[i] % entryCnt].headEntry;
+                buckets[keys[i] % entryCnt].headEntry = i;
+                DataBufHashInsert(slots, slotCnt - 1, keys[i], 0, i);
+            }
+
+            // shuffled lookup order, so the accesses can not be prefetched by stride
+            for (i = 0; i < entryCnt; i++)
+                order[i] = i;
+            for (i = entryCnt - 1; i > 0; i--)
+            {
+                j        = bench_rand() % (i + 1);
+                node     = order[i];
+                order[i] = order[j];
+                order[j] = node;
+            }
+
+            xil_printf("%-8u %-7s", entryCnt, patternName[pattern]);
+
+            // previous: modulo bucket + list threaded through the entries
+            probes    = 0;
+            startTime = V2FSimGetTimeNs();
+            for (i = 0; i < lookupCnt; i++)
+            {
+                j = order[i & (entryCnt - 1)];
+                for (node = buckets[keys[j] % entryCnt].headEntry; entries[node].logicalSliceAddr != keys[j];
+                     node = entries[node].hashNextEntry)
+                    probes++;
+                checksum += node;
+            }
+            xil_printf(" %10.1f %10.2f", (double)(V2FSimGetTimeNs() - startTime) / lookupCnt,
+                       (double)(probes + lookupCnt) / lookupCnt);
+
+            // open-addressed table
+            probes    = 0;
+            startTime = V2FSimGetTimeNs();
+            for (i = 0; i < lookupCnt; i++)
+            {
+                j     = order[i & (entryCnt - 1)];
+                iSlot = DataBufHashLookup(slots, slotCnt - 1, keys[j], 0);
+                probes += slots[iSlot].probeDist;
+                checksum += slots[iSlot].bufEntry;
+            }
+            xil_printf(" %10.1f %10.2f\r\n", (double)(V2FSimGetTimeNs() - startTime) / lookupCnt,
+                       (double)(probes + lookupCnt) / lookupCnt);
+        }
+
+        free(keys);
+        free(order);
+        free(entries);
+        free(buckets);
+        free(slots);
+    }
+
+    xil_printf("[ checksum ] %llu\r\n", checksum);
+}
+
+/**
+ * @brief Host entry of the simulated firmware.
+ *
+ * The firmware addresses its DRAM with fixed 32-bit addresses (see "memory_map.h"), so the
+ * same range is mapped at the same place before `nvme_main()` starts.
+ *
+ * @note The program must be linked as non-PIE above the firmware DRAM, otherwise its heap
+ * may be placed inside that range, e.g. `-no-pie -Wl,-Ttext-segment=0x40000000`.
+ */
+int main(int argc, char *argv[])
+{
+    void *dram;
+    int opt;
+
+    benchWorkload.pattern      = BENCH_PATTERN_RAND;
+    benchWorkload.readPercent  = 0;
+    benchWorkload.blocksPerCmd = 1;
+    benchWorkload.queueDepth   = 32;
+    benchWorkload.cmdCount     = 100000;
+    benchWorkload.lbaSpan      = 0; // whole capacity
+    benchWorkload.seed         = 1;
+
+    while ((opt = getopt(argc, argv, "t:p:r:T:Z:b:q:n:s:S:B:M:P:Hh")) != -1)
+    {
+        switch (opt)
+        {
+        case 't':
+            benchWorkload.trace   = fopen(optarg, "r");
+            benchWorkload.pattern = BENCH_PATTERN_TRACE;
+            ASSERT(benchWorkload.trace, "cannot open trace %s", optarg);
+            break;
+        case 'p':
+            benchWorkload.pattern = strcmp(optarg, "seq") ? BENCH_PATTERN_RAND : BENCH_PATTERN_SEQ;
+            break;
+        case 'r':
+            benchWorkload.readPercent = atoi(optarg);
+            break;
+        case 'T':
+            benchWorkload.trimPercent = atoi(optarg);
+            break;
+        case 'Z':
+            benchWorkload.zeroPercent = atoi(optarg);
+            break;
+        case 'b':
+            benchWorkload.blocksPerCmd = atoi(optarg);
+            break;
+        case 'q':
+            benchWorkload.queueDepth = atoi(optarg);
+            break;
+        case 'n':
+            benchWorkload.cmdCount = atoi(optarg);
+            break;
+        case 's':
+            benchWorkload.lbaSpan = atoi(optarg);
+            break;
+        case 'S':
+            benchWorkload.seed = atoi(optarg);
+            break;
+        case 'B':
+            dataBufEntryCount = atoi(optarg); // validated by `InitDataBuf()`
+            break;
+        case 'M':
+            addrMapCacheEntryCount = atoi(optarg); // validated by `InitAddrMapCache()`
+            break;
+        case 'P':
+            if (!strcmp(optarg, "clean"))
+                benchWorkload.powerCycle = BENCH_POWER_CYCLE_CLEAN;
+            else if (!strcmp(optarg, "crash"))
+                benchWorkload.powerCycle = BENCH_POWER_CYCLE_CRASH;
+            else
+                benchWorkload.powerCycle = BENCH_POWER_CYCLE_FLUSH;
+            break;
+        case 'H':
+            bench_hash();
+            return 0;
+        default:
+            bench_usage(argv[0]);
+        }
+    }
+
+    if (benchWorkload.queueDepth == 0 || benchWorkload.queueDepth > BENCH_MAX_QUEUE_DEPTH ||
+        benchWorkload.blocksPerCmd == 0 ||
+        benchWorkload.readPercent + benchWorkload.trimPercent + benchWorkload.zeroPercent > 100)
+        bench_usage(argv[0]);
+
+    setvbuf(stdout, NULL, _IOLBF, 0); // keep the console output in order with the firmware progress
+
+    dram = mmap((void *)BENCH_DRAM_START_ADDR, BENCH_DRAM_END_ADDR - BENCH_DRAM_START_ADDR + 1,
+                PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE | MAP_NORESERVE, -1, 0);
+    ASSERT(dram == (void *)BENCH_DRAM_START_ADDR, "cannot map firmware DRAM at 0x%x, overlapped with the program?",
+           BENCH_DRAM_START_ADDR);
+
+    dev_irq_init();
+    nvme_main(); // never returns, `bench_report()` is called when the workload is done
+
+    return 0;
+}
+
+#endif /* NSC_SIMULATOR */
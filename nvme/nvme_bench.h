@@ -0,0 +1,133 @@
+//////////////////////////////////////////////////////////////////////////////////
+// nvme_bench.h for Cosmos+ OpenSSD
+// Copyright (c) 2016 Hanyang University ENC Lab.
+// Contributed by Yong Ho Song <yhsong@enc.hanyang.ac.kr>
+//				  Youngjin Jo <yjjo@enc.hanyang.ac.kr>
+//				  Sangjin Lee <sjlee@enc.hanyang.ac.kr>
+//				  Jaewook Kwak <jwkwak@enc.hanyang.ac.kr>
+//
+// This file is part of Cosmos+ OpenSSD.
+//
+// Cosmos+ OpenSSD is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3, or (at your option)
+// any later version.
+//
+// Cosmos+ OpenSSD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Cosmos+ OpenSSD; see the file COPYING.
+// If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Company: ENC Lab. <http://enc.hanyang.ac.kr>
+// Engineer: Sangjin Lee <sjlee@enc.hanyang.ac.kr>
+//			 Jaewook Kwak <jwkwak@enc.hanyang.ac.kr>
+//
+// Project Name: Cosmos+ OpenSSD
+// Design Name: Cosmos+ Firmware
+// Module Name: NVMe Benchmark Driver
+// File Name: nvme_bench.h
+//
+// Version: v1.0.0
+//
+// Description:
+//   - defines the workload and statistics of the host-side benchmark driver
+//   - declares functions used by the simulated NVMe low level driver
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Revision History:
+//
+// * v1.0.0
+//   - First draft
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __NVME_BENCH_H_
+#define __NVME_BENCH_H_
+
+#include <stdio.h>
+
+#include "nvme.h"
+
+#define BENCH_PATTERN_SEQ   0
+#define BENCH_PATTERN_RAND  1
+#define BENCH_PATTERN_TRACE 2
+
+#define BENCH_TYPE_READ   0
+#define BENCH_TYPE_WRITE  1
+#define BENCH_TYPE_FLUSH  2
+#define BENCH_TYPE_TRIM   3
+#define BENCH_TYPE_ZERO   4
+#define BENCH_TYPE_FORMAT 5
+#define BENCH_TYPE_COUNT  6
+
+#define BENCH_MAX_QUEUE_DEPTH 128 // the size of the command SRAM of NVMe controller
+
+#define BENCH_POWER_CYCLE_NONE  0
+#define BENCH_POWER_CYCLE_CLEAN 1 // normal shutdown, the address maps are checkpointed
+#define BENCH_POWER_CYCLE_FLUSH 2 // power loss right after a flush, the address maps are replayed
+#define BENCH_POWER_CYCLE_CRASH 3 // power loss with an unflushed journal, the open blocks are scanned
+
+/**
+ * @brief The description of the workload to be replayed or generated.
+ *
+ * A trace file has one command per line, `#` starts a comment:
+ *
+ *      <R|W|F|D|Z|X> <start LBA> <number of 4KB blocks>
+ *
+ * where `D` deallocates (trims) the blocks with a Dataset Management command, `Z` zeroes
+ * them with a Write Zeroes command, and `X` erases the whole namespace with a Format NVM
+ * admin command (the LBAs are ignored).
+ *
+ * Without a trace file, `cmdCount` commands of `blocksPerCmd` blocks are generated,
+ * `readPercent` percent of them are reads, `trimPercent` percent are deallocates and
+ * `zeroPercent` percent are Write Zeroes; the LBAs are either sequential or uniformly
+ * random within `lbaSpan`.
+ *
+ * With `powerCycle`, the fw loses its DRAM after the workload and recovers the address maps
+ * from flash, then all the LBAs up to `maxLba` are read back and checked.
+ */
+typedef struct _BENCH_WORKLOAD
+{
+    FILE *trace;
+    unsigned int pattern;
+    unsigned int readPercent;
+    unsigned int trimPercent;
+    unsigned int zeroPercent;
+    unsigned int blocksPerCmd;
+    unsigned int queueDepth;
+    unsigned int cmdCount;
+    unsigned int lbaSpan;
+    unsigned int issuedCnt;
+    unsigned int nextSeqLba;
+    unsigned int seed;
+    unsigned int done;
+    unsigned int powerCycle;
+    unsigned int maxLba; // the end of the LBAs accessed so far
+} BENCH_WORKLOAD;
+
+typedef struct _BENCH_STAT
+{
+    unsigned long long cmdCnt;
+    unsigned long long blockCnt;
+    unsigned long long errorCnt;
+    unsigned long long *latency; // completion latency of each command in ns
+    unsigned int latencyCap;
+} BENCH_STAT;
+
+unsigned int bench_next_cmd(NVME_COMMAND *nvmeCmd);
+unsigned int bench_queue_depth();
+unsigned int bench_workload_done();
+unsigned int bench_lba_count();
+void bench_record_cpl(unsigned int opc, unsigned int nlb, unsigned int statusFieldWord, unsigned long long latency);
+void bench_record_mismatch(unsigned int lba, unsigned int generation, unsigned int stampLba,
+                           unsigned int stampGeneration);
+void bench_report();
+unsigned int bench_power_cycle();
+
+#endif //__NVME_BENCH_H_
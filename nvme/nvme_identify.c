@@ -48,7 +48,11 @@
 //   - First draft
 //////////////////////////////////////////////////////////////////////////////////
 
+#ifdef NSC_SIMULATOR
+#include "../sim/xil_printf.h"
+#else
 #include "xil_printf.h"
+#endif
 #include "debug.h"
 #include "string.h"
 
@@ -86,7 +90,7 @@ void identify_controller(unsigned int pBuffer)
     identifyCNTL->CNTLID  = 0x9;
 
     identifyCNTL->OACS.supportsSecuritySendSecurityReceive      = 0x0;
-    identifyCNTL->OACS.supportsFormatNVM                        = 0x0;
+    identifyCNTL->OACS.supportsFormatNVM                        = 0x1;
     identifyCNTL->OACS.supportsFirmwareActivateFirmwareDownload = 0x0;
 
     identifyCNTL->ACL  = 0x3;
@@ -112,12 +116,13 @@ void identify_controller(unsigned int pBuffer)
 
     identifyCNTL->ONCS.supportsCompare            = 0x0;
     identifyCNTL->ONCS.supportsWriteUncorrectable = 0x0;
-    identifyCNTL->ONCS.supportsDataSetManagement  = 0x0;
+    identifyCNTL->ONCS.supportsDataSetManagement  = 0x1;
+    identifyCNTL->ONCS.supportsWriteZeroes        = 0x1;
 
     identifyCNTL->FUSES.supportsCompareWrite = 0x0;
 
-    identifyCNTL->FNA.formatAppliesToAllNamespaces      = 0x0;
-    identifyCNTL->FNA.secureEraseAppliesToAllNamespaces = 0x0;
+    identifyCNTL->FNA.formatAppliesToAllNamespaces      = 0x1;
+    identifyCNTL->FNA.secureEraseAppliesToAllNamespaces = 0x1;
     identifyCNTL->FNA.supportsCryptographicErase        = 0x0;
 
     identifyCNTL->VWC.present = 0x1;
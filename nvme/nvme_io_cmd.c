@@ -49,7 +49,11 @@
 //   - First draft
 //////////////////////////////////////////////////////////////////////////////////
 
+#ifdef NSC_SIMULATOR
+#include "../sim/xil_printf.h"
+#else
 #include "xil_printf.h"
+#endif
 #include "debug.h"
 #include "io_access.h"
 #include "monitor/monitor.h"
@@ -61,6 +65,8 @@
 
 #include "../ftl_config.h"
 #include "../request_transform.h"
+#include "../address_journal.h"
+#include "../write_stream.h"
 #include "nmc/nmc_mapping.h"
 #include "nmc/nmc_requests.h"
 extern P_PARTIAL_DATA_MAP dataPartialResult;
@@ -158,7 +164,14 @@ void handle_nvme_io_write(unsigned int cmdSlotTag, NVME_IO_COMMAND *nvmeIOCmd)
     case IO_NVM_NMC_WRITE:
     case IO_NVM_NMC_ALLOC:
     case IO_NVM_WRITE_PHY:
+        ReqTransNvmeToSlice(cmdSlotTag, startLba[0], nlb, nvmeIOCmd->OPC);
+        break;
+
     case IO_NVM_WRITE:
+        // the lifetime hint is taken when the slices are flushed, check `ClassifyWriteStream()`
+        HintWriteStream(startLba[0] / NVME_BLOCKS_PER_SLICE,
+                        (startLba[0] % NVME_BLOCKS_PER_SLICE + nlb) / NVME_BLOCKS_PER_SLICE + 1,
+                        GetWriteStreamHint(nvmeIOCmd->dword[12], nvmeIOCmd->dword[13]));
         ReqTransNvmeToSlice(cmdSlotTag, startLba[0], nlb, nvmeIOCmd->OPC);
         break;
 
@@ -168,6 +181,62 @@ void handle_nvme_io_write(unsigned int cmdSlotTag, NVME_IO_COMMAND *nvmeIOCmd)
     }
 }
 
+/**
+ * @brief Entry point for Dataset Management commands.
+ *
+ * Only the deallocate attribute is handled, the ranges are deallocated in background by
+ * `DeallocateInBackground()` which also completes the command. The other attributes are
+ * only hints and completed immediately.
+ */
+void handle_nvme_io_dataset_management(unsigned int cmdSlotTag, NVME_IO_COMMAND *nvmeIOCmd)
+{
+    _IO_DATASET_MANAGEMENT_COMMAND_DW10 dsmInfo10;
+    _IO_DATASET_MANAGEMENT_COMMAND_DW11 dsmInfo11;
+
+    dsmInfo10.dword = nvmeIOCmd->dword[10];
+    dsmInfo11.dword = nvmeIOCmd->dword[11];
+
+    ASSERT((nvmeIOCmd->PRP1[0] & 0xF) == 0 && (nvmeIOCmd->PRP2[0] & 0xF) == 0);
+    ASSERT(nvmeIOCmd->PRP1[1] < 0x10000 && nvmeIOCmd->PRP2[1] < 0x10000);
+
+    if (dsmInfo11.AD)
+        ReqTransDeallocate(cmdSlotTag, dsmInfo10.NR + 1);
+    else
+        set_auto_nvme_cpl(cmdSlotTag, 0, 0);
+}
+
+/**
+ * @brief Entry point for Write Zeroes commands.
+ *
+ * No data is transferred, the range is zeroed by `ReqTransWriteZeroes()` and the command
+ * is completed once the range was deallocated in background.
+ */
+void handle_nvme_io_write_zeroes(unsigned int cmdSlotTag, NVME_IO_COMMAND *nvmeIOCmd)
+{
+    IO_WRITE_COMMAND_DW12 writeZeroesInfo12;
+    NVME_COMPLETION nvmeCPL;
+    unsigned int startLba[2];
+    unsigned int nlb;
+
+    writeZeroesInfo12.dword = nvmeIOCmd->dword[12];
+
+    startLba[0] = nvmeIOCmd->dword[10];
+    startLba[1] = nvmeIOCmd->dword[11];
+    nlb         = writeZeroesInfo12.NLB;
+
+    if (startLba[1] != 0 || startLba[0] >= storageCapacity_L || nlb >= storageCapacity_L - startLba[0])
+    {
+        pr_warn("Write Zeroes out of range: LBA 0x%08x%08x, %u blocks", startLba[1], startLba[0], nlb + 1);
+        nvmeCPL.dword[0]        = 0;
+        nvmeCPL.statusField.SCT = SCT_GENERIC_COMMAND_STATUS;
+        nvmeCPL.statusField.SC  = SC_LBA_OUT_OF_RANGE;
+        set_auto_nvme_cpl(cmdSlotTag, 0, nvmeCPL.statusFieldWord);
+        return;
+    }
+
+    ReqTransWriteZeroes(cmdSlotTag, startLba[0], nlb);
+}
+
 extern int* timer_reg;
 extern u32 tbegin_l,tbegin_h;
 extern int time_flag;
@@ -177,7 +246,7 @@ extern int* count_address;
 void handle_nvme_io_cmd(NVME_COMMAND *nvmeCmd)
 {
     
-    pr_info("nvmeCmd->cmdSlotTag: %d",nvmeCmd->cmdSlotTag);
+    pr_debug("nvmeCmd->cmdSlotTag: %d",nvmeCmd->cmdSlotTag);
     NVME_IO_COMMAND *nvmeIOCmd;
     NVME_COMPLETION nvmeCPL;
     unsigned int opc;
@@ -201,7 +270,9 @@ void handle_nvme_io_cmd(NVME_COMMAND *nvmeCmd)
     {
         monitor_dump_data_buffer_info(MONITOR_MODE_DUMP_DIRTY, 0, 0);
         pr_debug("IO Flush Command");
+        SyncDeallocate(0, SLICES_PER_SSD);
         FlushDataBuf(nvmeCmd->cmdSlotTag);
+        FlushAddrJournal();
         monitor_dump_data_buffer_info(MONITOR_MODE_DUMP_DIRTY, 0, 0);
 
         nvmeCPL.dword[0] = 0;
@@ -209,6 +280,18 @@ void handle_nvme_io_cmd(NVME_COMMAND *nvmeCmd)
         set_auto_nvme_cpl(nvmeCmd->cmdSlotTag, nvmeCPL.specific, nvmeCPL.statusFieldWord);
         break;
     }
+    case IO_NVM_DATASET_MANAGEMENT:
+    {
+        pr_debug("IO Dataset Management Command");
+        handle_nvme_io_dataset_management(nvmeCmd->cmdSlotTag, nvmeIOCmd);
+        break;
+    }
+    case IO_NVM_WRITE_ZEROES:
+    {
+        pr_debug("IO Write Zeroes Command");
+        handle_nvme_io_write_zeroes(nvmeCmd->cmdSlotTag, nvmeIOCmd);
+        break;
+    }
     case IO_NVM_WRITE_BUFFER:
         cdma_flag = 1;
         pr_info("IO_NVM_WRITE_BUFFER in handle_nvme_io_cmd");
@@ -284,6 +367,10 @@ void handle_nvme_io_cmd(NVME_COMMAND *nvmeCmd)
     {
         pr_debug("IO Read Command");
         handle_nvme_io_read(nvmeCmd->cmdSlotTag, nvmeIOCmd);
+
+        // the stream detector needs the submission queue id, which is only known here
+        if (nvmeIOCmd->OPC == IO_NVM_READ)
+            ReqTransReadAhead(nvmeCmd->qID, nvmeCmd->cmdSlotTag, nvmeIOCmd->dword[10], nvmeIOCmd->dword[12] & 0xffff);
         break;
     }
     case IO_NVM_NMC_ALLOC:
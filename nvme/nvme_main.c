@@ -56,7 +56,11 @@
 //   - First draft
 //////////////////////////////////////////////////////////////////////////////////
 
+#ifdef NSC_SIMULATOR
+#include "../sim/xil_printf.h"
+#else
 #include "xil_printf.h"
+#endif
 #include "debug.h"
 #include "io_access.h"
 
@@ -69,7 +73,9 @@
 #include "../memory_map.h"
 
 #include "nmc/nmc_requests.h"
+#ifndef NSC_SIMULATOR
 #include "xtime_l.h"
+#endif
 #include "time.h"
 #include "cdma/cdma.h"
 volatile NVME_CONTEXT g_nvmeTask;
@@ -155,6 +161,9 @@ void nvme_main()
                     cdma_flag = 0;
                     handle_nvme_io_cmd(&nvmeCmd);
                     ReqTransSliceToLowLevel();
+                    GarbageCollectionInBackground();
+                    DeallocateInBackground();
+                    SaveAddrMapInBackground(0);
                     if(time_flag == 1){
                         check_auto_tx_dma_done();
                         tend_l = *(volatile u32 *)(timer_reg);
@@ -167,6 +176,15 @@ void nvme_main()
                     exeLlr = 0;
                 }
             }
+            else
+            {
+                // no new command, deallocate, write back dirty entries, collect garbage and level the wear in advance
+                DeallocateInBackground();
+                FlushDataBufInBackground();
+                GarbageCollectionInBackground();
+                WearLevelingInBackground();
+                SaveAddrMapInBackground(1);
+            }
         }
         else if (g_nvmeTask.status == NVME_TASK_SHUTDOWN)
         {
@@ -185,12 +203,21 @@ void nvme_main()
 
                 set_nvme_admin_queue(0, 0, 0);
                 g_nvmeTask.cacheEn = 0;
-                set_nvme_csts_shst(2);
-                g_nvmeTask.status = NVME_TASK_WAIT_RESET;
+
+                /*
+                 * Persist the pending deallocates, the buffered data and the address maps while
+                 * the shutdown is still processing, the host may cut the power once it is complete.
+                 */
+                SyncDeallocate(0, SLICES_PER_SSD);
+                FlushDataBuf(0);
+                SaveAddrMapCheckpoint();
 
                 // flush grown bad block info
                 UpdateBadBlockTableForGrownBadBlock(RESERVED_DATA_BUFFER_BASE_ADDR);
 
+                set_nvme_csts_shst(2);
+                g_nvmeTask.status = NVME_TASK_WAIT_RESET;
+
                 xil_printf("\r\nNVMe shutdown!!!\r\n");
             }
         }
@@ -252,6 +279,7 @@ void nvme_main()
             SchedulingNandReq();
         }
 
+#ifndef NSC_SIMULATOR // the AXI CDMA and the global timer of the PS are not simulated
         if (cdma_flag == 1)
         {
             check_auto_rx_dma_done();
@@ -276,5 +304,6 @@ void nvme_main()
             cdma_flag = 0;
             count++;
         }
+#endif
     }
 }
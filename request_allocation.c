@@ -43,7 +43,11 @@
 //   - First draft
 //////////////////////////////////////////////////////////////////////////////////
 
+#ifdef NSC_SIMULATOR
+#include "sim/xil_printf.h"
+#else
 #include "xil_printf.h"
+#endif
 #include <assert.h>
 #include "memory_map.h"
 
@@ -56,6 +60,7 @@ NVME_DMA_REQUEST_QUEUE nvmeDmaReqQ;
 NAND_REQUEST_QUEUE nandReqQ[USER_CHANNELS][USER_WAYS];
 
 unsigned int notCompletedNandReqCnt;
+unsigned int notCompletedProgramReqCnt; // the programs and erases issued, check `SyncAllProgramReqDone()`
 unsigned int blockedReqCnt;
 
 /**
@@ -98,13 +103,16 @@ void InitReqPool()
     for (chNo = 0; chNo < USER_CHANNELS; chNo++)
         for (wayNo = 0; wayNo < USER_WAYS; wayNo++)
         {
-            blockedByRowAddrDepReqQ[chNo][wayNo].headReq = REQ_SLOT_TAG_NONE;
-            blockedByRowAddrDepReqQ[chNo][wayNo].tailReq = REQ_SLOT_TAG_NONE;
-            blockedByRowAddrDepReqQ[chNo][wayNo].reqCnt  = 0;
-
-            nandReqQ[chNo][wayNo].headReq = REQ_SLOT_TAG_NONE;
-            nandReqQ[chNo][wayNo].tailReq = REQ_SLOT_TAG_NONE;
-            nandReqQ[chNo][wayNo].reqCnt  = 0;
+            blockedByRowAddrDepReqQ[chNo][wayNo].headReq     = REQ_SLOT_TAG_NONE;
+            blockedByRowAddrDepReqQ[chNo][wayNo].tailReq     = REQ_SLOT_TAG_NONE;
+            blockedByRowAddrDepReqQ[chNo][wayNo].reqCnt      = 0;
+            blockedByRowAddrDepReqQ[chNo][wayNo].eraseReqCnt = 0;
+
+            nandReqQ[chNo][wayNo].headReq        = REQ_SLOT_TAG_NONE;
+            nandReqQ[chNo][wayNo].tailReq        = REQ_SLOT_TAG_NONE;
+            nandReqQ[chNo][wayNo].reqCnt         = 0;
+            nandReqQ[chNo][wayNo].eraseReqCnt    = 0;
+            nandReqQ[chNo][wayNo].hostReadReqCnt = 0;
         }
 
     for (reqSlotTag = 0; reqSlotTag < AVAILABLE_OUNTSTANDING_REQ_COUNT; reqSlotTag++)
@@ -120,8 +128,9 @@ void InitReqPool()
     reqPoolPtr->reqPool[AVAILABLE_OUNTSTANDING_REQ_COUNT - 1].nextReq = REQ_SLOT_TAG_NONE;
     freeReqQ.reqCnt = AVAILABLE_OUNTSTANDING_REQ_COUNT; // TODO: move this up ?
 
-    notCompletedNandReqCnt = 0;
-    blockedReqCnt          = 0;
+    notCompletedNandReqCnt    = 0;
+    notCompletedProgramReqCnt = 0;
+    blockedReqCnt             = 0;
 }
 
 /**
@@ -194,7 +203,10 @@ unsigned int GetFromFreeReqQ()
         freeReqQ.tailReq = REQ_SLOT_TAG_NONE;
     }
 
-    reqPoolPtr->reqPool[reqSlotTag].reqQueueType = REQ_QUEUE_TYPE_NONE;
+    reqPoolPtr->reqPool[reqSlotTag].reqQueueType            = REQ_QUEUE_TYPE_NONE;
+    reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufMergeMask = REQ_OPT_DATA_BUF_MERGE_NONE;
+    reqPoolPtr->reqPool[reqSlotTag].nvmeDmaInfo.coalescedReq = REQ_SLOT_TAG_NONE;
+    reqPoolPtr->reqPool[reqSlotTag].nvmeDmaInfo.coalescedCnt = 0;
     freeReqQ.reqCnt--;
 
     return reqSlotTag;
@@ -373,6 +385,7 @@ void PutToBlockedByRowAddrDepReqQ(unsigned int reqSlotTag, unsigned int chNo, un
 
     reqPoolPtr->reqPool[reqSlotTag].reqQueueType = REQ_QUEUE_TYPE_BLOCKED_BY_ROW_ADDR_DEP;
     blockedByRowAddrDepReqQ[chNo][wayNo].reqCnt++;
+    blockedByRowAddrDepReqQ[chNo][wayNo].eraseReqCnt += (reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_ERASE);
     blockedReqCnt++;
 }
 
@@ -418,6 +431,7 @@ void SelectiveGetFromBlockedByRowAddrDepReqQ(unsigned int reqSlotTag, unsigned i
 
     reqPoolPtr->reqPool[reqSlotTag].reqQueueType = REQ_QUEUE_TYPE_NONE;
     blockedByRowAddrDepReqQ[chNo][wayNo].reqCnt--;
+    blockedByRowAddrDepReqQ[chNo][wayNo].eraseReqCnt -= (reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_ERASE);
     blockedReqCnt--;
 }
 
@@ -528,6 +542,8 @@ void PutToNandReqQ(unsigned int reqSlotTag, unsigned chNo, unsigned wayNo)
 
     reqPoolPtr->reqPool[reqSlotTag].reqQueueType = REQ_QUEUE_TYPE_NAND;
     nandReqQ[chNo][wayNo].reqCnt++;
+    nandReqQ[chNo][wayNo].eraseReqCnt += (reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_ERASE);
+    nandReqQ[chNo][wayNo].hostReadReqCnt += REQ_IS_HOST_READ(reqSlotTag);
     notCompletedNandReqCnt++;
 }
 
@@ -566,7 +582,14 @@ void GetFromNandReqQ(unsigned int chNo, unsigned int wayNo, unsigned int reqStat
 
     reqPoolPtr->reqPool[reqSlotTag].reqQueueType = REQ_QUEUE_TYPE_NONE;
     nandReqQ[chNo][wayNo].reqCnt--;
+    nandReqQ[chNo][wayNo].eraseReqCnt -= (reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_ERASE);
+    nandReqQ[chNo][wayNo].hostReadReqCnt -= REQ_IS_HOST_READ(reqSlotTag);
     notCompletedNandReqCnt--;
+    notCompletedProgramReqCnt -= REQ_IS_PROGRAM(reqSlotTag);
+
+    // the merged data must be ready before the blocked requests on the same buffer
+    if (reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufMergeMask != REQ_OPT_DATA_BUF_MERGE_NONE)
+        MergeDataBufEntry(reqSlotTag);
 
     PutToFreeReqQ(reqSlotTag);
     ReleaseBlockedByBufDepReq(reqSlotTag);
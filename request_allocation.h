@@ -103,6 +103,7 @@ extern NVME_DMA_REQUEST_QUEUE nvmeDmaReqQ;
 extern NAND_REQUEST_QUEUE nandReqQ[USER_CHANNELS][USER_WAYS];
 
 extern unsigned int notCompletedNandReqCnt;
+extern unsigned int notCompletedProgramReqCnt;
 extern unsigned int blockedReqCnt;
 
 /* -------------------------------------------------------------------------- */
@@ -147,4 +148,43 @@ extern unsigned int blockedReqCnt;
  */
 #define REQ_QUEUE_TYPE_IS(idx, qType) (REQ_ENTRY((idx))->reqQueueType == (qType))
 
+/**
+ * @brief Check whether the given request is a NAND read for the host
+ *
+ * The reads to the data buffer entries are issued for the host reads and their read-ahead,
+ * while the GC copies and the address maps use the temp buffers or raw addresses. A read
+ * is turned into `REQ_CODE_READ_TRANSFER` in its queue once its data is read on the die.
+ *
+ * @param idx the request pool entry index of the request to be checked
+ * @return bool true if the request reads a slice to a data buffer entry, otherwise false
+ */
+#define REQ_IS_HOST_READ(idx)                                                                                     \
+    ((REQ_CODE_IS((idx), REQ_CODE_READ) || REQ_CODE_IS((idx), REQ_CODE_READ_TRANSFER)) &&                         \
+     REQ_ENTRY((idx))->reqOpt.dataBufFormat == REQ_OPT_DATA_BUF_ENTRY)
+
+/**
+ * @brief Check whether the given copyback request is still reading its source slice
+ *
+ * A copyback request is addressed by its target slice, but its read trigger and data out
+ * work on `NAND_INFO::copybackSrcVsa`, check `GenerateNandRowAddr()`.
+ *
+ * @param idx the request pool entry index of the request to be checked
+ * @return bool true if the request is a copyback before its program, otherwise false
+ */
+#define REQ_IS_COPYBACK_READ(idx) (REQ_CODE_IS((idx), REQ_CODE_COPYBACK) || REQ_CODE_IS((idx), REQ_CODE_COPYBACK_XFER))
+
+/**
+ * @brief Check whether the given request programs or erases a NAND block
+ *
+ * A copyback request stays a program whatever code it is turned into in its queue, since
+ * it ends with `REQ_CODE_COPYBACK_PROG` or falls back to `REQ_CODE_WRITE`.
+ *
+ * @param idx the request pool entry index of the request to be checked
+ * @return bool true if the request is counted by `notCompletedProgramReqCnt`, otherwise false
+ */
+#define REQ_IS_PROGRAM(idx)                                                                                       \
+    (REQ_ENTRY((idx))->reqType == REQ_TYPE_NAND &&                                                                \
+     (REQ_CODE_IS((idx), REQ_CODE_WRITE) || REQ_CODE_IS((idx), REQ_CODE_ERASE) || REQ_IS_COPYBACK_READ(idx) ||    \
+      REQ_CODE_IS((idx), REQ_CODE_COPYBACK_PROG)))
+
 #endif /* REQUEST_ALLOCATION_H_ */
@@ -46,6 +46,7 @@
 #ifndef REQUEST_FORMAT_H_
 #define REQUEST_FORMAT_H_
 
+#include "ftl_config.h"
 #include "nvme/nvme.h"
 
 #define REQ_TYPE_SLICE    0x0
@@ -70,8 +71,13 @@
  */
 
 #define REQ_CODE_WRITE         0x00
+#define REQ_CODE_WRITE_ZEROES  0x01 // zero the blocks in the data buffer, no NVMe DMA
+#define REQ_CODE_COPYBACK      0x04 // copyback read trigger of a GC copy, check `NAND_INFO::copybackSrcVsa`
+#define REQ_CODE_COPYBACK_XFER 0x05 // copyback data out to the temp buffer, for the ECC check only
+#define REQ_CODE_COPYBACK_PROG 0x06 // copyback program, only the spare region is transferred
 #define REQ_CODE_READ          0x08 // read trigger
 #define REQ_CODE_READ_TRANSFER 0x09 // read transfer
+#define REQ_CODE_READ_AHEAD    0x0A // speculative slice read, no NVMe DMA
 #define REQ_CODE_ERASE         0x0C
 #define REQ_CODE_RESET         0x0D // currently only used in FTL initialization stage
 #define REQ_CODE_SET_FEATURE   0x0E // currently only used in FTL initialization stage
@@ -115,6 +121,12 @@
 #define REQ_OPT_DATA_BUF_ADDR       2 // View `dataBufFormat` as DRAM address, currently used by BBT only.
 #define REQ_OPT_DATA_BUF_NONE       3 // for ERASE, RESET, SET_FEATURE (no buffer needed).
 
+#define REQ_OPT_DATA_BUF_MERGE_NONE 0 // for `dataBufMergeMask`, not a merge read
+
+#if NVME_BLOCKS_PER_SLICE > 4
+#error "`REQ_OPTION::dataBufMergeMask` holds at most 4 NVMe blocks per slice"
+#endif
+
 #define REQ_OPT_NAND_ADDR_VSA     0 // the data stored in `nandInfo` is Virtual Slice Address.
 #define REQ_OPT_NAND_ADDR_PHY_ORG 1 // the data stored in `nandInfo` is Physical Flash Info.
 
@@ -194,8 +206,10 @@ typedef struct _NVME_DMA_INFO
     unsigned int nvmeBlockOffset : 16; // which slice request offset should the first NVMe block aligned to
     unsigned int numOfNvmeBlock : 16;  // how many NVMe blocks should be transferred, 1 based
     unsigned int reqTail : 8;          // the tail index of the NVMe auto DMA queue
-    unsigned int reserved0 : 8;        // reserved
+    unsigned int coalescedCnt : 8;     // how many RxDMAs are linked by `coalescedReq`
     unsigned int overFlowCnt;          // TODO
+    unsigned int coalescedReq : 16;    // the prev RxDMA coalesced into this one and not issued yet
+    unsigned int reserved0 : 16;       // reserved
 } NVME_DMA_INFO, *P_NVME_DMA_INFO;
 
 typedef struct _NAND_INFO
@@ -213,13 +227,15 @@ typedef struct _NAND_INFO
     };
     union
     {
-        unsigned int programmedPageCnt;
+        unsigned int programmedPageCnt; // for ERASE
+        unsigned int writeSeq;          // for WRITE on VSA, stored in the spare region, check `SLICE_SPARE_INFO`
         struct
         {
             unsigned int physicalPage : 16;
             unsigned int phyReserved1 : 16;
         };
     };
+    unsigned int copybackSrcVsa; // for COPYBACK, the slice copied to `virtualSliceAddr` on the same die
 } NAND_INFO, *P_NAND_INFO;
 
 typedef struct _REQ_OPTION
@@ -241,7 +257,18 @@ typedef struct _REQ_OPTION
     unsigned int nandEccWarning : 1;         // 0 for OFF, 1 for ON
     unsigned int rowAddrDependencyCheck : 1; // whether this request needs to check dependency.
     unsigned int blockSpace : 1;             // 0 for MAIN, 1 for TOTAL
-    unsigned int reserved0 : 24;
+
+    /**
+     * @brief The NVMe blocks to be merged into the data buffer entry after this read.
+     *
+     * A merge read transfers the slice to the merge buffer of the target die instead of
+     * the data buffer entry, and only the blocks in this mask are copied to the entry on
+     * completion, thus the newer host data in the entry will not be overwritten.
+     *
+     * @sa `DataMergeFromNand()`, `MergeDataBufEntry()`.
+     */
+    unsigned int dataBufMergeMask : 4;
+    unsigned int reserved0 : 20;
 } REQ_OPTION, *P_REQ_OPTION; /* NOTE: 32 bits */
 
 /**
@@ -76,7 +76,7 @@ typedef struct _BLOCKED_BY_ROW_ADDR_DEPENDENCY_REQUEST_QUEUE
     unsigned int headReq : 16;
     unsigned int tailReq : 16;
     unsigned int reqCnt : 16;
-    unsigned int reserved0 : 16;
+    unsigned int eraseReqCnt : 16; // the erase requests in this queue
 } BLOCKED_BY_ROW_ADDR_DEPENDENCY_REQUEST_QUEUE, *PBLOCKED_BY_ROW_ADDR_DEPENDENCY_REQUEST_QUEUE;
 
 typedef struct _NVME_DMA_REQUEST_QUEUE
@@ -92,6 +92,8 @@ typedef struct _NAND_REQUEST_QUEUE
     unsigned int headReq : 16;
     unsigned int tailReq : 16;
     unsigned int reqCnt : 16;
+    unsigned int eraseReqCnt : 16;    // the erase requests in this queue
+    unsigned int hostReadReqCnt : 16; // the reads to data buffer entries in this queue, check `REQ_IS_HOST_READ()`
     unsigned int reserved0 : 16;
 } NAND_REQUEST_QUEUE, *P_NAND_REQUEST_QUEUE;
 
@@ -47,10 +47,18 @@
 //////////////////////////////////////////////////////////////////////////////////
 
 #include <assert.h>
+#ifdef NSC_SIMULATOR
+#include "sim/xil_printf.h"
+#else
 #include "xil_printf.h"
+#endif
 #include "memory_map.h"
 #include "debug.h"
 
+#ifdef NSC_SIMULATOR
+#include "nsc_driver_sim.h"
+#endif
+
 P_COMPLETE_FLAG_TABLE completeFlagTablePtr;
 P_STATUS_REPORT_TABLE statusReportTablePtr;
 P_ERROR_INFO_TABLE eccErrorInfoTablePtr;
@@ -141,6 +149,21 @@ void SyncAllLowLevelReqDone()
     }
 }
 
+/**
+ * @brief Do schedule until all the programs and erases issued so far are done.
+ *
+ * Similar to `SyncAllLowLevelReqDone()`, but the reads and the NVMe DMAs not blocking any
+ * program may still be pending, so the dies busy with reads are not drained.
+ */
+void SyncAllProgramReqDone()
+{
+    while (notCompletedProgramReqCnt)
+    {
+        CheckDoneNvmeDmaReq();
+        SchedulingNandReq();
+    }
+}
+
 /**
  * @brief Try release request entries by doing scheduling (both NVMe and NAND).
  *
@@ -510,11 +533,14 @@ void SchedulingNandReqPerCh(unsigned int chNo)
  */
 void PutToNandWayPriorityTable(unsigned int reqSlotTag, unsigned int chNo, unsigned int wayNo)
 {
-    if (reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_READ)
+    if ((reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_READ) ||
+        (reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_COPYBACK))
         PutToNandReadTriggerList(chNo, wayNo);
-    else if (reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_READ_TRANSFER)
+    else if ((reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_READ_TRANSFER) ||
+             (reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_COPYBACK_XFER))
         PutToNandReadTransferList(chNo, wayNo);
-    else if (reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_WRITE)
+    else if ((reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_WRITE) ||
+             (reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_COPYBACK_PROG))
         PutToNandWriteList(chNo, wayNo);
     else if (reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_ERASE)
         PutToNandEraseList(chNo, wayNo);
@@ -1029,7 +1055,16 @@ void IssueNandReq(unsigned int chNo, unsigned int wayNo)
 
         V2FReadPageTriggerAsync(&chCtlReg[chNo], wayNo, rowAddr);
     }
-    else if (reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_READ_TRANSFER)
+#ifdef NSC_SIMULATOR
+    else if (reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_COPYBACK)
+    {
+        dieStateTablePtr->dieState[chNo][wayNo].reqStatusCheckOpt = REQ_STATUS_CHECK_OPT_CHECK;
+
+        V2FCopybackReadTriggerAsync(&chCtlReg[chNo], wayNo, rowAddr);
+    }
+#endif
+    else if ((reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_READ_TRANSFER) ||
+             (reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_COPYBACK_XFER))
     {
         dieStateTablePtr->dieState[chNo][wayNo].reqStatusCheckOpt = REQ_STATUS_CHECK_OPT_COMPLETION_FLAG;
 
@@ -1046,8 +1081,19 @@ void IssueNandReq(unsigned int chNo, unsigned int wayNo)
     {
         dieStateTablePtr->dieState[chNo][wayNo].reqStatusCheckOpt = REQ_STATUS_CHECK_OPT_CHECK;
 
+        if (reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandAddr == REQ_OPT_NAND_ADDR_VSA)
+            StampSliceSpare(reqSlotTag, (unsigned int)spareDataBufAddr);
         V2FProgramPageAsync(&chCtlReg[chNo], wayNo, rowAddr, dataBufAddr, spareDataBufAddr);
     }
+#ifdef NSC_SIMULATOR
+    else if (reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_COPYBACK_PROG)
+    {
+        dieStateTablePtr->dieState[chNo][wayNo].reqStatusCheckOpt = REQ_STATUS_CHECK_OPT_CHECK;
+
+        StampSliceSpare(reqSlotTag, (unsigned int)spareDataBufAddr);
+        V2FCopybackProgramAsync(&chCtlReg[chNo], wayNo, rowAddr, spareDataBufAddr);
+    }
+#endif
     else if (reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_ERASE)
     {
         dieStateTablePtr->dieState[chNo][wayNo].reqStatusCheckOpt = REQ_STATUS_CHECK_OPT_CHECK;
@@ -1084,16 +1130,22 @@ void IssueNandReq(unsigned int chNo, unsigned int wayNo)
  */
 unsigned int GenerateNandRowAddr(unsigned int reqSlotTag)
 {
-    unsigned int rowAddr, lun, virtualBlockNo, tempBlockNo, phyBlockNo, tempPageNo, dieNo;
+    unsigned int rowAddr, lun, virtualBlockNo, tempBlockNo, phyBlockNo, tempPageNo, dieNo, virtualSliceAddr;
 
     if (reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandAddr == REQ_OPT_NAND_ADDR_VSA)
     {
-        dieNo          = Vsa2VdieTranslation(reqPoolPtr->reqPool[reqSlotTag].nandInfo.virtualSliceAddr);
-        virtualBlockNo = Vsa2VblockTranslation(reqPoolPtr->reqPool[reqSlotTag].nandInfo.virtualSliceAddr);
+        // a copyback reads its source slice before it programs its target slice
+        if (REQ_IS_COPYBACK_READ(reqSlotTag))
+            virtualSliceAddr = reqPoolPtr->reqPool[reqSlotTag].nandInfo.copybackSrcVsa;
+        else
+            virtualSliceAddr = reqPoolPtr->reqPool[reqSlotTag].nandInfo.virtualSliceAddr;
+
+        dieNo          = Vsa2VdieTranslation(virtualSliceAddr);
+        virtualBlockNo = Vsa2VblockTranslation(virtualSliceAddr);
         phyBlockNo     = Vblock2PblockOfTbsTranslation(virtualBlockNo);
         lun            = phyBlockNo / TOTAL_BLOCKS_PER_LUN;
         tempBlockNo    = phyBlockMapPtr->phyBlock[dieNo][phyBlockNo].remappedPhyBlock % TOTAL_BLOCKS_PER_LUN;
-        tempPageNo     = Vsa2VpageTranslation(reqPoolPtr->reqPool[reqSlotTag].nandInfo.virtualSliceAddr);
+        tempPageNo     = Vsa2VpageTranslation(virtualSliceAddr);
 
         // if(BITS_PER_FLASH_CELL == SLC_MODE)
         //	tempPageNo = Vpage2PlsbPageTranslation(tempPageNo);
@@ -1147,9 +1199,11 @@ unsigned int GenerateNandRowAddr(unsigned int reqSlotTag)
  *
  *      Since the two real data buffer have same number of entries with its corresponding
  *      request data buffer, `AVAILABLE_TEMPORARY_DATA_BUFFER_ENTRY_COUNT` for temp buffer
- *      and `AVAILABLE_DATA_BUFFER_ENTRY_COUNT` for normal buffer, we can just simply use
- *      the index of the request data buffer entry to find the corresponding index of real
- *      data buffer entry.
+ *      and `dataBufEntryCount` for normal buffer, we can just simply use the index of the
+ *      request data buffer entry to find the corresponding index of real data buffer entry.
+ *
+ *      Note that the normal buffer entries beyond `DATA_BUF_BASE_ENTRY_COUNT` are placed
+ *      at `DATA_BUFFER_EXT_BASE_ADDR`, so `BUF_DATA_ENTRY2ADDR()` is used to locate them.
  *
  * - get the address of real data buffer entry:
  *
@@ -1170,9 +1224,11 @@ unsigned int GenerateDataBufAddr(unsigned int reqSlotTag)
 {
     if (reqPoolPtr->reqPool[reqSlotTag].reqType == REQ_TYPE_NAND)
     {
-        if (reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat == REQ_OPT_DATA_BUF_ENTRY)
-            return (DATA_BUFFER_BASE_ADDR +
-                    reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.entry * BYTES_PER_DATA_REGION_OF_SLICE);
+        if (reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufMergeMask != REQ_OPT_DATA_BUF_MERGE_NONE)
+            return MERGE_BUF_DATA_ENTRY2ADDR(
+                Vsa2VdieTranslation(reqPoolPtr->reqPool[reqSlotTag].nandInfo.virtualSliceAddr));
+        else if (reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat == REQ_OPT_DATA_BUF_ENTRY)
+            return BUF_DATA_ENTRY2ADDR(reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.entry);
         else if (reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat == REQ_OPT_DATA_BUF_TEMP_ENTRY)
             return (TEMPORARY_DATA_BUFFER_BASE_ADDR +
                     reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.entry * BYTES_PER_DATA_REGION_OF_SLICE);
@@ -1189,8 +1245,7 @@ unsigned int GenerateDataBufAddr(unsigned int reqSlotTag)
     {
         // similar to NAND request, but may have offset
         if (reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat == REQ_OPT_DATA_BUF_ENTRY)
-            return (DATA_BUFFER_BASE_ADDR +
-                    reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.entry * BYTES_PER_DATA_REGION_OF_SLICE +
+            return (BUF_DATA_ENTRY2ADDR(reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.entry) +
                     reqPoolPtr->reqPool[reqSlotTag].nvmeDmaInfo.nvmeBlockOffset * BYTES_PER_NVME_BLOCK);
         else if (reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat == REQ_OPT_DATA_BUF_ADDR){
             return reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.addr;
@@ -1220,9 +1275,11 @@ unsigned int GenerateSpareDataBufAddr(unsigned int reqSlotTag)
 {
     if (reqPoolPtr->reqPool[reqSlotTag].reqType == REQ_TYPE_NAND)
     {
-        if (reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat == REQ_OPT_DATA_BUF_ENTRY)
-            return (SPARE_DATA_BUFFER_BASE_ADDR +
-                    reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.entry * BYTES_PER_SPARE_REGION_OF_SLICE);
+        if (reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufMergeMask != REQ_OPT_DATA_BUF_MERGE_NONE)
+            return MERGE_BUF_SPARE_ENTRY2ADDR(
+                Vsa2VdieTranslation(reqPoolPtr->reqPool[reqSlotTag].nandInfo.virtualSliceAddr));
+        else if (reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat == REQ_OPT_DATA_BUF_ENTRY)
+            return BUF_SPARE_ENTRY2ADDR(reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.entry);
         else if (reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat == REQ_OPT_DATA_BUF_TEMP_ENTRY)
             return (TEMPORARY_SPARE_DATA_BUFFER_BASE_ADDR +
                     reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.entry * BYTES_PER_SPARE_REGION_OF_SLICE);
@@ -1235,8 +1292,7 @@ unsigned int GenerateSpareDataBufAddr(unsigned int reqSlotTag)
     else if (reqPoolPtr->reqPool[reqSlotTag].reqType == REQ_TYPE_NVME_DMA)
     {
         if (reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat == REQ_OPT_DATA_BUF_ENTRY)
-            return (SPARE_DATA_BUFFER_BASE_ADDR +
-                    reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.entry * BYTES_PER_SPARE_REGION_OF_SLICE);
+            return BUF_SPARE_ENTRY2ADDR(reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.entry);
         else
             assert(!"[WARNING] wrong reqOpt-dataBufFormat [WARNING]");
     }
@@ -1405,6 +1461,14 @@ void ExecuteNandReq(unsigned int chNo, unsigned int wayNo, unsigned int reqStatu
         {
             if (reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_READ)
                 reqPoolPtr->reqPool[reqSlotTag].reqCode = REQ_CODE_READ_TRANSFER;
+            else if (reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_COPYBACK)
+                reqPoolPtr->reqPool[reqSlotTag].reqCode = REQ_CODE_COPYBACK_XFER;
+            else if (reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_COPYBACK_XFER)
+            {
+                // the data passed the ECC check, program it from the page register
+                retryLimitTablePtr->retryLimit[chNo][wayNo] = RETRY_LIMIT;
+                reqPoolPtr->reqPool[reqSlotTag].reqCode     = REQ_CODE_COPYBACK_PROG;
+            }
             else
             {
                 retryLimitTablePtr->retryLimit[chNo][wayNo] = RETRY_LIMIT;
@@ -1416,13 +1480,15 @@ void ExecuteNandReq(unsigned int chNo, unsigned int wayNo, unsigned int reqStatu
         else if (reqStatus == REQ_STATUS_FAIL)
         {
             if ((reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_READ) ||
-                (reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_READ_TRANSFER))
+                (reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_READ_TRANSFER) || REQ_IS_COPYBACK_READ(reqSlotTag))
                 if (retryLimitTablePtr->retryLimit[chNo][wayNo] > 0)
                 {
                     retryLimitTablePtr->retryLimit[chNo][wayNo]--;
                     // FIXME: why not just use READ_TRANSFER
                     if (reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_READ_TRANSFER)
                         reqPoolPtr->reqPool[reqSlotTag].reqCode = REQ_CODE_READ;
+                    else if (reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_COPYBACK_XFER)
+                        reqPoolPtr->reqPool[reqSlotTag].reqCode = REQ_CODE_COPYBACK;
 
                     dieStateTablePtr->dieState[chNo][wayNo].dieState = DIE_STATE_IDLE;
                     return;
@@ -1436,6 +1502,10 @@ void ExecuteNandReq(unsigned int chNo, unsigned int wayNo, unsigned int reqStatu
                 pr_warn("Write FAIL on             ");
             else if (reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_ERASE)
                 pr_warn("Erase FAIL on             ");
+            else if (REQ_IS_COPYBACK_READ(reqSlotTag))
+                pr_warn("Copyback Read FAIL on     ");
+            else if (reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_COPYBACK_PROG)
+                pr_warn("Copyback Program FAIL on  ");
 
             rowAddr = GenerateNandRowAddr(reqSlotTag);
             pr_warn("ch %x way %x rowAddr 0x%x: completeFlag 0x%x statusReport 0x%x", chNo, wayNo, rowAddr,
@@ -1456,9 +1526,28 @@ void ExecuteNandReq(unsigned int chNo, unsigned int wayNo, unsigned int reqStatu
             UpdatePhyBlockMapForGrownBadBlock(Pcw2VdieTranslation(chNo, wayNo), phyBlockNo);
 
             retryLimitTablePtr->retryLimit[chNo][wayNo] = RETRY_LIMIT;
+            if (REQ_IS_COPYBACK_READ(reqSlotTag))
+            {
+                // like a GC read, the target page is still programmed to keep its block in order
+                reqPoolPtr->reqPool[reqSlotTag].reqCode          = REQ_CODE_WRITE;
+                dieStateTablePtr->dieState[chNo][wayNo].dieState = DIE_STATE_IDLE;
+                return;
+            }
             GetFromNandReqQ(chNo, wayNo, reqStatus, reqPoolPtr->reqPool[reqSlotTag].reqCode);
             dieStateTablePtr->dieState[chNo][wayNo].dieState = DIE_STATE_IDLE;
         }
+        else if ((reqStatus == REQ_STATUS_WARNING) &&
+                 (reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_COPYBACK_XFER))
+        {
+            /*
+             * The bit errors in the page register would be programmed as they are, so the
+             * data corrected by the controller is programmed from the temp buffer instead.
+             */
+            gcState.eccRoundTripCnt++;
+            retryLimitTablePtr->retryLimit[chNo][wayNo]      = RETRY_LIMIT;
+            reqPoolPtr->reqPool[reqSlotTag].reqCode          = REQ_CODE_WRITE;
+            dieStateTablePtr->dieState[chNo][wayNo].dieState = DIE_STATE_IDLE;
+        }
         else if (reqStatus == REQ_STATUS_WARNING)
         {
             rowAddr = GenerateNandRowAddr(reqSlotTag);
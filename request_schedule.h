@@ -186,6 +186,7 @@ typedef struct _WAY_PRIORITY_TABLE
 void InitReqScheduler();
 
 void SyncAllLowLevelReqDone();
+void SyncAllProgramReqDone();
 void SyncAvailFreeReq();
 void SyncReleaseEraseReq(unsigned int chNo, unsigned int wayNo, unsigned int blockNo);
 void SchedulingNandReq();
@@ -220,7 +221,7 @@ extern P_COMPLETE_FLAG_TABLE completeFlagTablePtr;
 extern P_STATUS_REPORT_TABLE statusReportTablePtr;
 extern P_ERROR_INFO_TABLE eccErrorInfoTablePtr;
 extern P_RETRY_LIMIT_TABLE retryLimitTablePtr;
-extern P_DIE_STATE_TABLE dieStatusTablePtr;
+extern P_DIE_STATE_TABLE dieStateTablePtr;
 extern P_WAY_PRIORITY_TABLE wayPriorityTablePtr;
 
 #endif /* REQUEST_SCHEDULE_H_ */
@@ -46,8 +46,13 @@
 //   - First draft
 //////////////////////////////////////////////////////////////////////////////////
 
+#ifdef NSC_SIMULATOR
+#include "sim/xil_printf.h"
+#else
 #include "xil_printf.h"
+#endif
 #include <assert.h>
+#include <string.h>
 #include "debug.h"
 
 #include "nvme/nvme.h"
@@ -66,6 +71,8 @@ extern int nvme_complete_flag;
 extern int *testBufferPtr;
 extern FILENAME_BUFFER *nmcMappingFilenameBufPtr;
 P_ROW_ADDR_DEPENDENCY_TABLE rowAddrDependencyTablePtr;
+READ_AHEAD_STATE readAheadState;
+DEALLOCATE_STATE deallocateState;
 
 bool verify_img_flag = false;
 extern NMC_MAPPING_TABLE *nmcMappingTableBufPtr;
@@ -91,6 +98,36 @@ void InitDependencyTable()
     }
 }
 
+/**
+ * @brief Reset the sequential read streams of all the I/O submission queues.
+ */
+void InitReadAhead()
+{
+    unsigned int iStream;
+
+    for (iStream = 0; iStream < MAX_NUM_OF_IO_SQ; iStream++)
+    {
+        readAheadState.stream[iStream].lastLsa   = LSA_NONE;
+        readAheadState.stream[iStream].raNextLsa = 0;
+        readAheadState.stream[iStream].seqCmdCnt = 0;
+    }
+
+    readAheadState.depth        = READ_AHEAD_INIT_DEPTH;
+    readAheadState.lastHitCnt   = 0;
+    readAheadState.lastWasteCnt = 0;
+}
+
+/**
+ * @brief Drop all the pending deallocate commands and reset the statistics.
+ */
+void InitDeallocate()
+{
+    deallocateState.headCmd    = 0;
+    deallocateState.cmdCnt     = 0;
+    deallocateState.doneCmdCnt = 0;
+    deallocateState.sliceCnt   = 0;
+}
+
 /**
  * @brief Split NVMe command into slice requests.
  *
@@ -245,6 +282,10 @@ void ReqTransNvmeToSlice(unsigned int cmdSlotTag, unsigned int startLba, unsigne
         break;
     }
 
+    // a pending deallocate of these slices must not be reordered after this command
+    if (reqCode == REQ_CODE_READ || reqCode == REQ_CODE_WRITE)
+        SyncDeallocate(tempLsa, (startLba + nlb) / NVME_BLOCKS_PER_SLICE + 1);
+
     // first transform
     nvmeBlockOffset = (startLba % NVME_BLOCKS_PER_SLICE);
     if (loop)
@@ -322,6 +363,442 @@ void ReqTransNvmeToSlice(unsigned int cmdSlotTag, unsigned int startLba, unsigne
     PutToSliceReqQ(reqSlotTag);
 }
 
+/**
+ * @brief Adjust the read-ahead depth by the ratio of the read-ahead entries being wasted.
+ *
+ * @sa `READ_AHEAD_STATE`.
+ */
+static void AdaptReadAheadDepth()
+{
+    unsigned int hitCnt   = dataBufStat.readAheadHitCnt - readAheadState.lastHitCnt;
+    unsigned int wasteCnt = dataBufStat.readAheadWasteCnt - readAheadState.lastWasteCnt;
+
+    if (hitCnt + wasteCnt < READ_AHEAD_ADAPT_WINDOW)
+        return;
+
+    if (wasteCnt * 16 <= hitCnt + wasteCnt)
+    {
+        // almost all of them were referenced, read further ahead
+        if (readAheadState.depth * 2 <= READ_AHEAD_MAX_DEPTH)
+            readAheadState.depth *= 2;
+    }
+    else if (wasteCnt * 4 >= hitCnt + wasteCnt)
+    {
+        if (readAheadState.depth / 2 >= READ_AHEAD_MIN_DEPTH)
+            readAheadState.depth /= 2;
+    }
+
+    pr_debug("read-ahead: hit %u, waste %u, depth %u", hitCnt, wasteCnt, readAheadState.depth);
+
+    readAheadState.lastHitCnt   = dataBufStat.readAheadHitCnt;
+    readAheadState.lastWasteCnt = dataBufStat.readAheadWasteCnt;
+}
+
+/**
+ * @brief Detect the sequential read stream of the given queue and generate read-ahead.
+ *
+ * Called after the slice requests of a logical read command being generated by
+ * `ReqTransNvmeToSlice()`. Once `READ_AHEAD_TRIGGER_CMDS` read commands of the same queue
+ * were found ascending, speculative slice requests (`REQ_CODE_READ_AHEAD`) are generated
+ * for the slices after this command, so that the next `depth` slices are always being
+ * read. Since consecutive slices are written to different dies, these reads overlap on
+ * all the channels and ways.
+ *
+ * The read-ahead requests are appended after the slice requests of the command, they are
+ * turned into flash reads by `ReqTransSliceToLowLevel()`. No read-ahead is generated when
+ * the free request entries are running out.
+ *
+ * @param qID the submission queue the read command was fetched from
+ * @param cmdSlotTag the NVMe command slot tag of the read command
+ * @param startLba address of the first logical NVMe block to read.
+ * @param nlb number of logical NVMe blocks to read, 0's based.
+ */
+void ReqTransReadAhead(unsigned int qID, unsigned int cmdSlotTag, unsigned int startLba, unsigned int nlb)
+{
+    P_READ_AHEAD_STREAM stream;
+    unsigned int reqSlotTag, startLsa, endLsa, lastRaLsa, lsa;
+
+    if (qID == 0 || qID > MAX_NUM_OF_IO_SQ)
+        return;
+
+    AdaptReadAheadDepth();
+
+    stream   = &readAheadState.stream[qID - 1];
+    startLsa = startLba / NVME_BLOCKS_PER_SLICE;
+    endLsa   = (startLba + nlb) / NVME_BLOCKS_PER_SLICE;
+
+    if (stream->lastLsa != LSA_NONE && (startLsa == stream->lastLsa || startLsa == stream->lastLsa + 1))
+        stream->seqCmdCnt++;
+    else
+    {
+        stream->seqCmdCnt = 1;
+        stream->raNextLsa = endLsa + 1;
+    }
+    stream->lastLsa = endLsa;
+
+    if (stream->seqCmdCnt < READ_AHEAD_TRIGGER_CMDS)
+        return;
+
+    lastRaLsa = endLsa + readAheadState.depth;
+    if (lastRaLsa >= storageCapacity_L / NVME_BLOCKS_PER_SLICE)
+        lastRaLsa = storageCapacity_L / NVME_BLOCKS_PER_SLICE - 1;
+
+    lsa = (stream->raNextLsa > endLsa) ? stream->raNextLsa : endLsa + 1;
+    for (; lsa <= lastRaLsa && freeReqQ.reqCnt > READ_AHEAD_MIN_FREE_REQ; lsa++)
+    {
+        reqSlotTag = GetFromFreeReqQ();
+
+        REQ_ENTRY(reqSlotTag)->reqType                     = REQ_TYPE_SLICE;
+        REQ_ENTRY(reqSlotTag)->reqCode                     = REQ_CODE_READ_AHEAD;
+        REQ_ENTRY(reqSlotTag)->nvmeCmdSlotTag              = cmdSlotTag;
+        REQ_ENTRY(reqSlotTag)->logicalSliceAddr            = lsa;
+        REQ_ENTRY(reqSlotTag)->nvmeDmaInfo.startIndex      = 0;
+        REQ_ENTRY(reqSlotTag)->nvmeDmaInfo.nvmeBlockOffset = 0;
+        REQ_ENTRY(reqSlotTag)->nvmeDmaInfo.numOfNvmeBlock  = 0;
+
+        PutToSliceReqQ(reqSlotTag);
+    }
+    stream->raNextLsa = lsa;
+}
+
+#define DEALLOCATE_RANGE_BUF(iCmd) \
+    ((DATASET_MANAGEMENT_RANGE *)(DEALLOCATE_RANGE_BUFFER_ADDR + (iCmd) * BYTES_PER_NVME_BLOCK))
+
+/**
+ * @brief Get the first whole slice covered by the given range.
+ */
+static unsigned int DeallocateRangeStartLsa(DATASET_MANAGEMENT_RANGE *range)
+{
+    return (range->startingLBA[0] + NVME_BLOCKS_PER_SLICE - 1) / NVME_BLOCKS_PER_SLICE;
+}
+
+/**
+ * @brief Get the slice after the last whole slice covered by the given range.
+ *
+ * @note Less than or equal to the start slice if the range covers no whole slice.
+ */
+static unsigned int DeallocateRangeEndLsa(DATASET_MANAGEMENT_RANGE *range)
+{
+    return (range->startingLBA[0] + range->lengthInLogicalBlocks) / NVME_BLOCKS_PER_SLICE;
+}
+
+/**
+ * @brief Append a command to the pending deallocate commands, the oldest ones are
+ * deallocated first if there are too many.
+ *
+ * @return unsigned int the index of the new command, also the index of its range buffer.
+ */
+static unsigned int PushDeallocateCmd(unsigned int cmdSlotTag, unsigned int rangeCnt)
+{
+    P_DEALLOCATE_CMD cmd;
+    unsigned int iCmd;
+
+    while (deallocateState.cmdCnt == DEALLOCATE_MAX_CMD_COUNT)
+        DeallocateInBackground();
+
+    iCmd = (deallocateState.headCmd + deallocateState.cmdCnt) % DEALLOCATE_MAX_CMD_COUNT;
+    cmd  = &deallocateState.cmd[iCmd];
+
+    cmd->cmdSlotTag = cmdSlotTag;
+    cmd->rangeCnt   = rangeCnt;
+    cmd->rangeReady = 0;
+    deallocateState.cmdCnt++;
+
+    return iCmd;
+}
+
+/**
+ * @brief Receive the range list of a Dataset Management command and deallocate it later.
+ *
+ * The range list (at most 256 ranges, one NVMe block) is received into the range buffer of
+ * the command, the command is completed by `DeallocateInBackground()` once all of its
+ * ranges were deallocated.
+ *
+ * @param cmdSlotTag the NVMe command slot tag of the Dataset Management command.
+ * @param rangeCnt the number of ranges, not 0's based.
+ */
+void ReqTransDeallocate(unsigned int cmdSlotTag, unsigned int rangeCnt)
+{
+    P_DEALLOCATE_CMD cmd;
+    unsigned int iCmd;
+
+    iCmd = PushDeallocateCmd(cmdSlotTag, rangeCnt);
+    cmd  = &deallocateState.cmd[iCmd];
+
+    set_auto_rx_dma(cmdSlotTag, 0, (unsigned int)DEALLOCATE_RANGE_BUF(iCmd), NVME_COMMAND_AUTO_COMPLETION_OFF);
+
+    cmd->reqTail     = g_hostDmaStatus.fifoTail.autoDmaRx;
+    cmd->overFlowCnt = g_hostDmaAssistStatus.autoDmaRxOverFlowCnt;
+}
+
+/**
+ * @brief Check the received range list of the given command.
+ *
+ * @return unsigned int 1 if all the ranges are in the namespace, otherwise 0.
+ */
+static unsigned int PrepareDeallocateRanges(unsigned int iCmd)
+{
+    P_DEALLOCATE_CMD cmd            = &deallocateState.cmd[iCmd];
+    DATASET_MANAGEMENT_RANGE *range = DEALLOCATE_RANGE_BUF(iCmd);
+    unsigned int iRange, startLsa, endLsa;
+
+    cmd->startLsa = LSA_NONE;
+    cmd->endLsa   = 0;
+    for (iRange = 0; iRange < cmd->rangeCnt; iRange++)
+    {
+        if (range[iRange].startingLBA[1] != 0 || range[iRange].lengthInLogicalBlocks > storageCapacity_L ||
+            range[iRange].startingLBA[0] > storageCapacity_L - range[iRange].lengthInLogicalBlocks)
+        {
+            pr_warn("Deallocate[%u]: range %u (LBA 0x%08x%08x, %u blocks) is out of range", cmd->cmdSlotTag, iRange,
+                    range[iRange].startingLBA[1], range[iRange].startingLBA[0], range[iRange].lengthInLogicalBlocks);
+            return 0;
+        }
+
+        startLsa = DeallocateRangeStartLsa(&range[iRange]);
+        endLsa   = DeallocateRangeEndLsa(&range[iRange]);
+        if (startLsa < endLsa)
+        {
+            cmd->startLsa = (startLsa < cmd->startLsa) ? startLsa : cmd->startLsa;
+            cmd->endLsa   = (endLsa > cmd->endLsa) ? endLsa : cmd->endLsa;
+        }
+    }
+
+    cmd->iRange     = 0;
+    cmd->nextLsa    = DeallocateRangeStartLsa(&range[0]);
+    cmd->rangeReady = 1;
+    return 1;
+}
+
+/**
+ * @brief Generate a slice request to zero some blocks of a slice in the data buffer.
+ *
+ * @param cmdSlotTag the NVMe command slot tag of the Write Zeroes command.
+ * @param startLba address of the first logical NVMe block to be zeroed.
+ * @param blockCnt number of logical NVMe blocks to be zeroed, all in the same slice.
+ */
+static void ReqTransZeroBlocks(unsigned int cmdSlotTag, unsigned int startLba, unsigned int blockCnt)
+{
+    unsigned int reqSlotTag = GetFromFreeReqQ();
+
+    REQ_ENTRY(reqSlotTag)->reqType                     = REQ_TYPE_SLICE;
+    REQ_ENTRY(reqSlotTag)->reqCode                     = REQ_CODE_WRITE_ZEROES;
+    REQ_ENTRY(reqSlotTag)->nvmeCmdSlotTag              = cmdSlotTag;
+    REQ_ENTRY(reqSlotTag)->logicalSliceAddr            = startLba / NVME_BLOCKS_PER_SLICE;
+    REQ_ENTRY(reqSlotTag)->nvmeDmaInfo.startIndex      = 0;
+    REQ_ENTRY(reqSlotTag)->nvmeDmaInfo.nvmeBlockOffset = startLba % NVME_BLOCKS_PER_SLICE;
+    REQ_ENTRY(reqSlotTag)->nvmeDmaInfo.numOfNvmeBlock  = blockCnt;
+
+    PutToSliceReqQ(reqSlotTag);
+}
+
+/**
+ * @brief Zero a range of logical blocks for a Write Zeroes command.
+ *
+ * Since the unmapped slices are read as zeros, the whole slices of the range are simply
+ * deallocated in background, like a Dataset Management range. The blocks in the partially
+ * covered slices at both ends are zeroed in the data buffer by `REQ_CODE_WRITE_ZEROES`
+ * slice requests, which are handled by `ReqTransSliceToLowLevel()` before the command is
+ * completed by `DeallocateInBackground()`.
+ *
+ * @param cmdSlotTag the NVMe command slot tag of the Write Zeroes command.
+ * @param startLba address of the first logical NVMe block to be zeroed.
+ * @param nlb number of logical NVMe blocks to be zeroed, 0's based.
+ */
+void ReqTransWriteZeroes(unsigned int cmdSlotTag, unsigned int startLba, unsigned int nlb)
+{
+    DATASET_MANAGEMENT_RANGE *range;
+    unsigned int iCmd, endLba, headEndLba, tailStartLba;
+
+    endLba       = startLba + nlb + 1;
+    headEndLba   = (startLba / NVME_BLOCKS_PER_SLICE + 1) * NVME_BLOCKS_PER_SLICE;
+    tailStartLba = endLba - endLba % NVME_BLOCKS_PER_SLICE;
+
+    if (startLba % NVME_BLOCKS_PER_SLICE)
+        ReqTransZeroBlocks(cmdSlotTag, startLba, ((endLba < headEndLba) ? endLba : headEndLba) - startLba);
+    if (endLba % NVME_BLOCKS_PER_SLICE && (startLba % NVME_BLOCKS_PER_SLICE == 0 || endLba > headEndLba))
+        ReqTransZeroBlocks(cmdSlotTag, tailStartLba, endLba - tailStartLba);
+
+    iCmd  = PushDeallocateCmd(cmdSlotTag, 1);
+    range = DEALLOCATE_RANGE_BUF(iCmd);
+    memset(range, 0, sizeof(DATASET_MANAGEMENT_RANGE));
+    range->startingLBA[0]        = startLba;
+    range->lengthInLogicalBlocks = nlb + 1;
+
+    ASSERT(PrepareDeallocateRanges(iCmd), "Write Zeroes out of range: LBA %u, %u blocks", startLba, nlb + 1);
+}
+
+/**
+ * @brief Skip the finished ranges of the given command.
+ *
+ * @return unsigned int 1 if all the ranges of the command were deallocated, otherwise 0.
+ */
+static unsigned int NextDeallocateRange(unsigned int iCmd)
+{
+    P_DEALLOCATE_CMD cmd            = &deallocateState.cmd[iCmd];
+    DATASET_MANAGEMENT_RANGE *range = DEALLOCATE_RANGE_BUF(iCmd);
+
+    while (cmd->iRange < cmd->rangeCnt)
+    {
+        if (cmd->nextLsa < DeallocateRangeEndLsa(&range[cmd->iRange]))
+            return 0;
+
+        if (++cmd->iRange < cmd->rangeCnt)
+            cmd->nextLsa = DeallocateRangeStartLsa(&range[cmd->iRange]);
+    }
+    return 1;
+}
+
+static void CompleteDeallocate(unsigned int statusFieldWord)
+{
+    set_auto_nvme_cpl(deallocateState.cmd[deallocateState.headCmd].cmdSlotTag, 0, statusFieldWord);
+
+    deallocateState.headCmd = (deallocateState.headCmd + 1) % DEALLOCATE_MAX_CMD_COUNT;
+    deallocateState.cmdCnt--;
+    deallocateState.doneCmdCnt++;
+}
+
+/**
+ * @brief Deallocate a part of the oldest pending deallocate command.
+ *
+ * Once the range list of the command was received, at most `DEALLOCATE_SLICES_PER_PASS`
+ * slices of one range are deallocated in each call: their data buffer entries are dropped
+ * by `DiscardDataBuf()`, then `DeallocateLogicalSlices()` unmaps them, invalidates their
+ * virtual slices and moves the touched blocks between the GC victim lists in one go.
+ *
+ * Only the slices entirely covered by a range are deallocated, the partially covered ones
+ * keep their data, which is allowed since deallocate is only a hint.
+ *
+ * The command is completed when all of its ranges were deallocated, or with the status
+ * `SC_LBA_OUT_OF_RANGE` if any range exceeds the namespace.
+ */
+void DeallocateInBackground()
+{
+    P_DEALLOCATE_CMD cmd;
+    NVME_COMPLETION nvmeCPL;
+    unsigned int iCmd, endLsa, sliceCnt, lsa;
+
+    if (deallocateState.cmdCnt == 0)
+        return;
+
+    iCmd = deallocateState.headCmd;
+    cmd  = &deallocateState.cmd[iCmd];
+
+    if (!cmd->rangeReady)
+    {
+        if (!check_auto_rx_dma_partial_done(cmd->reqTail, cmd->overFlowCnt))
+            return;
+
+        if (!PrepareDeallocateRanges(iCmd))
+        {
+            nvmeCPL.statusFieldWord = 0;
+            nvmeCPL.statusField.SCT = SCT_GENERIC_COMMAND_STATUS;
+            nvmeCPL.statusField.SC  = SC_LBA_OUT_OF_RANGE;
+            CompleteDeallocate(nvmeCPL.statusFieldWord);
+            return;
+        }
+    }
+
+    if (!NextDeallocateRange(iCmd))
+    {
+        endLsa   = DeallocateRangeEndLsa(&DEALLOCATE_RANGE_BUF(iCmd)[cmd->iRange]);
+        sliceCnt = endLsa - cmd->nextLsa;
+        if (sliceCnt > DEALLOCATE_SLICES_PER_PASS)
+            sliceCnt = DEALLOCATE_SLICES_PER_PASS;
+
+        for (lsa = cmd->nextLsa; lsa < cmd->nextLsa + sliceCnt; lsa++)
+            DiscardDataBuf(lsa);
+        deallocateState.sliceCnt += DeallocateLogicalSlices(cmd->nextLsa, sliceCnt);
+        cmd->nextLsa += sliceCnt;
+    }
+
+    if (NextDeallocateRange(iCmd))
+        CompleteDeallocate(0);
+}
+
+/**
+ * @brief Deallocate the pending commands overlapping the given slices.
+ *
+ * A read or write must observe the deallocates received before it, so the pending
+ * deallocate commands are processed in order until none of them covers the given slices.
+ * A command whose range list is still being received is assumed to cover them.
+ *
+ * @param startLsa the first slice to be accessed.
+ * @param endLsa the slice after the last one to be accessed.
+ */
+void SyncDeallocate(unsigned int startLsa, unsigned int endLsa)
+{
+    P_DEALLOCATE_CMD cmd;
+    unsigned int iCmd, overlap;
+
+    do
+    {
+        overlap = 0;
+        for (iCmd = 0; iCmd < deallocateState.cmdCnt && !overlap; iCmd++)
+        {
+            cmd     = &deallocateState.cmd[(deallocateState.headCmd + iCmd) % DEALLOCATE_MAX_CMD_COUNT];
+            overlap = !cmd->rangeReady || (cmd->startLsa < endLsa && startLsa < cmd->endLsa);
+        }
+
+        if (overlap)
+            DeallocateInBackground();
+    } while (overlap);
+}
+
+/**
+ * @brief Handle a slice request of an unmapped slice without a data buffer entry.
+ *
+ * The slice is read as zeros, so a read is served by transferring the shared zero buffer
+ * to host directly, and there is nothing to do for `REQ_CODE_WRITE_ZEROES`. Neither a data
+ * buffer entry nor a flash read is needed.
+ *
+ * @param reqSlotTag the request pool entry index of the slice request.
+ */
+static void ReqTransUnmappedSlice(unsigned int reqSlotTag)
+{
+    if (REQ_CODE_IS(reqSlotTag, REQ_CODE_WRITE_ZEROES))
+    {
+        PutToFreeReqQ(reqSlotTag);
+        return;
+    }
+
+    REQ_ENTRY(reqSlotTag)->reqType              = REQ_TYPE_NVME_DMA;
+    REQ_ENTRY(reqSlotTag)->reqCode              = REQ_CODE_TxDMA;
+    REQ_ENTRY(reqSlotTag)->reqOpt.dataBufFormat = REQ_OPT_DATA_BUF_ADDR;
+    REQ_ENTRY(reqSlotTag)->dataBufInfo.addr     = ZERO_DATA_BUFFER_ADDR;
+    dataBufStat.zeroReadCnt++;
+
+    SelectLowLevelReqQ(reqSlotTag);
+}
+
+/**
+ * @brief Zero the blocks of a `REQ_CODE_WRITE_ZEROES` slice request in its data buffer entry.
+ *
+ * The entry is written by the CPU instead of a DMA, so the requests still pending on it
+ * (e.g. a RxDMA of the same blocks, or a flash write reading it) are finished first. This
+ * only happens to the partially covered slices of a Write Zeroes command.
+ *
+ * @param reqSlotTag the request pool entry index of the slice request.
+ */
+static void DataZeroInBuf(unsigned int reqSlotTag)
+{
+    unsigned int dataBufEntry = REQ_ENTRY(reqSlotTag)->dataBufInfo.entry;
+
+    if (BUF_ENTRY(dataBufEntry)->blockingReqTail != REQ_SLOT_TAG_NONE)
+        SyncAllLowLevelReqDone();
+
+    memset((void *)(BUF_DATA_ENTRY2ADDR(dataBufEntry) +
+                    REQ_ENTRY(reqSlotTag)->nvmeDmaInfo.nvmeBlockOffset * BYTES_PER_NVME_BLOCK),
+           0, REQ_ENTRY(reqSlotTag)->nvmeDmaInfo.numOfNvmeBlock * BYTES_PER_NVME_BLOCK);
+
+    BUF_ENTRY(dataBufEntry)->phyReq = DATA_BUF_FOR_LOG_REQ;
+    BUF_ENTRY(dataBufEntry)->validSectors |= DATA_BUF_SECTOR_MASK(
+        REQ_ENTRY(reqSlotTag)->nvmeDmaInfo.nvmeBlockOffset, REQ_ENTRY(reqSlotTag)->nvmeDmaInfo.numOfNvmeBlock);
+    BUF_ENTRY(dataBufEntry)->dontCache = DATA_BUF_KEEP_CACHE;
+    MarkDataBufDirty(dataBufEntry);
+
+    PutToFreeReqQ(reqSlotTag);
+}
+
 /**
  * @brief Clear the specified data buffer entry and sync dirty data if needed.
  *
@@ -376,6 +853,9 @@ void EvictDataBufEntry(unsigned int originReqSlotTag)
         }
         else
         {
+            // the old content must be read before the old VSA being invalidated
+            DataMergeFromNand(dataBufEntry, REQ_ENTRY(originReqSlotTag)->nvmeCmdSlotTag);
+
             reqSlotTag       = GetFromFreeReqQ();
             virtualSliceAddr = AddrTransWrite(BUF_LSA(dataBufEntry));
 
@@ -391,12 +871,13 @@ void EvictDataBufEntry(unsigned int originReqSlotTag)
             REQ_ENTRY(reqSlotTag)->reqOpt.blockSpace             = REQ_OPT_BLOCK_SPACE_MAIN;
             REQ_ENTRY(reqSlotTag)->dataBufInfo.entry             = dataBufEntry;
             REQ_ENTRY(reqSlotTag)->nandInfo.virtualSliceAddr     = virtualSliceAddr;
+            REQ_ENTRY(reqSlotTag)->nandInfo.writeSeq             = addrJournal.writeSeq;
         }
 
         UpdateDataBufEntryInfoBlockingReq(dataBufEntry, reqSlotTag);
         SelectLowLevelReqQ(reqSlotTag);
 
-        BUF_ENTRY(dataBufEntry)->dirty = DATA_BUF_CLEAN;
+        MarkDataBufClean(dataBufEntry);
     }
 }
 
@@ -429,9 +910,10 @@ void DataReadFromNand(unsigned int originReqSlotTag)
              * but the target pages may not have been programmed yet.
              *
              * To handle this and similar situations, the fw should just skip to read the
-             * target page and return garbage data, instead of stucking here.
+             * target page and return garbage data, instead of stucking here. Reading the
+             * deallocated slices is also common, so don't warn about it.
              */
-            pr_warn("Req[%u]: No mapping info for LSA[%u]!", originReqSlotTag, REQ_LSA(originReqSlotTag));
+            pr_debug("Req[%u]: No mapping info for LSA[%u]!", originReqSlotTag, REQ_LSA(originReqSlotTag));
             return;
         }
 
@@ -494,6 +976,193 @@ void DataReadFromNand(unsigned int originReqSlotTag)
         ASSERT(0, "Req[%u]: Unexpected reqCode: %u", originReqSlotTag, REQ_ENTRY(originReqSlotTag)->reqCode);
 }
 
+/**
+ * @brief Turn the given read-ahead slice request into a flash read.
+ *
+ * Nothing to do if the slice is already cached or has never been written, and the slice
+ * request is released directly. Otherwise, a read-ahead data buffer entry is allocated
+ * (check `AllocateReadAheadDataBuf()`) and the slice request itself becomes the flash read
+ * request, since there is no NVMe DMA to be done for it.
+ *
+ * A host request hitting the entry later is appended to its blocking queue, thus it waits
+ * for this flash read if it is not done yet.
+ *
+ * @param reqSlotTag the request pool entry index of the read-ahead slice request
+ */
+void DataReadAheadFromNand(unsigned int reqSlotTag)
+{
+    unsigned int dataBufEntry, vsa;
+
+    if (LookupDataBuf(REQ_LSA(reqSlotTag)) != DATA_BUF_NONE || (vsa = AddrTransRead(REQ_LSA(reqSlotTag))) == VSA_FAIL)
+    {
+        PutToFreeReqQ(reqSlotTag);
+        return;
+    }
+
+    dataBufEntry                             = AllocateReadAheadDataBuf();
+    REQ_ENTRY(reqSlotTag)->dataBufInfo.entry = dataBufEntry;
+
+    EvictDataBufEntry(reqSlotTag);
+    BUF_ENTRY(dataBufEntry)->logicalSliceAddr = REQ_LSA(reqSlotTag);
+    BUF_ENTRY(dataBufEntry)->validSectors     = DATA_BUF_ALL_SECTORS_VALID;
+    BUF_ENTRY(dataBufEntry)->phyReq           = DATA_BUF_FOR_LOG_REQ;
+    BUF_ENTRY(dataBufEntry)->dontCache        = DATA_BUF_KEEP_CACHE;
+    PutToDataBufHashList(dataBufEntry);
+
+    REQ_ENTRY(reqSlotTag)->reqType                       = REQ_TYPE_NAND;
+    REQ_ENTRY(reqSlotTag)->reqCode                       = REQ_CODE_READ;
+    REQ_ENTRY(reqSlotTag)->reqOpt.dataBufFormat          = REQ_OPT_DATA_BUF_ENTRY;
+    REQ_ENTRY(reqSlotTag)->reqOpt.dataBufMergeMask       = REQ_OPT_DATA_BUF_MERGE_NONE;
+    REQ_ENTRY(reqSlotTag)->reqOpt.nandAddr               = REQ_OPT_NAND_ADDR_VSA;
+    REQ_ENTRY(reqSlotTag)->reqOpt.nandEcc                = REQ_OPT_NAND_ECC_ON;
+    REQ_ENTRY(reqSlotTag)->reqOpt.nandEccWarning         = REQ_OPT_NAND_ECC_WARNING_ON;
+    REQ_ENTRY(reqSlotTag)->reqOpt.rowAddrDependencyCheck = REQ_OPT_ROW_ADDR_DEPENDENCY_CHECK;
+    REQ_ENTRY(reqSlotTag)->reqOpt.blockSpace             = REQ_OPT_BLOCK_SPACE_MAIN;
+    REQ_ENTRY(reqSlotTag)->nandInfo.virtualSliceAddr     = vsa;
+
+    pr_debug("Req[%u]: Read ahead LSA[%u] into Buf[%u]", reqSlotTag, REQ_LSA(reqSlotTag), dataBufEntry);
+
+    UpdateDataBufEntryInfoBlockingReq(dataBufEntry, reqSlotTag);
+    SelectLowLevelReqQ(reqSlotTag);
+}
+
+/**
+ * @brief Generate and dispatch a merge read for the missing NVMe blocks of a buffer entry.
+ *
+ * A write smaller than a slice only fills part of its data buffer entry (`validSectors`),
+ * the missing blocks must be merged from flash before:
+ *
+ * - the entry being written back to flash, since a slice is always programmed as a whole.
+ *   In this case the merge read must be issued before `AddrTransWrite()` invalidates the
+ *   old VSA.
+ *
+ * - the host reading the entry, if the blocks to be read are not all valid.
+ *
+ * The merge read is appended to the blocking queue of the entry, so the requests issued
+ * after it on the same entry (NVMe Tx/Rx or flash write) will wait for the merge to be
+ * done. Its data is transferred to the merge buffer of the target die, and the missing
+ * blocks are copied to the entry by `MergeDataBufEntry()` on completion.
+ *
+ * If the slice is unmapped (never written or deallocated), the missing blocks are zeroed by
+ * the CPU right away. The requests of the previous slice of the entry (e.g. its flash write
+ * not yet issued) may still use these blocks, so they are finished first; the RxDMAs of
+ * this slice only touch the valid blocks and don't need to be waited for.
+ *
+ * @param bufEntry the data buffer entry to be merged
+ * @param nvmeCmdSlotTag the NVMe command slot tag the merge read belongs to
+ */
+void DataMergeFromNand(unsigned int bufEntry, unsigned int nvmeCmdSlotTag)
+{
+    uint32_t reqSlotTag, vsa, mergeMask, iBlock;
+
+    mergeMask = DATA_BUF_ALL_SECTORS_VALID & ~BUF_ENTRY(bufEntry)->validSectors;
+    if (mergeMask == 0)
+        return;
+
+    // the entry will be fully valid when the requests after the merge read are executed
+    BUF_ENTRY(bufEntry)->validSectors = DATA_BUF_ALL_SECTORS_VALID;
+
+    vsa = AddrTransRead(BUF_LSA(bufEntry));
+    if (vsa == VSA_FAIL)
+    {
+        for (reqSlotTag = BUF_ENTRY(bufEntry)->blockingReqTail; reqSlotTag != REQ_SLOT_TAG_NONE;
+             reqSlotTag = REQ_ENTRY(reqSlotTag)->prevBlockingReq)
+            if (REQ_ENTRY(reqSlotTag)->reqType != REQ_TYPE_NVME_DMA || !REQ_CODE_IS(reqSlotTag, REQ_CODE_RxDMA))
+            {
+                SyncAllLowLevelReqDone();
+                break;
+            }
+
+        for (iBlock = 0; iBlock < NVME_BLOCKS_PER_SLICE; iBlock++)
+            if (mergeMask & DATA_BUF_SECTOR_MASK(iBlock, 1))
+                memset((void *)(BUF_DATA_ENTRY2ADDR(bufEntry) + iBlock * BYTES_PER_NVME_BLOCK), 0,
+                       BYTES_PER_NVME_BLOCK);
+        return;
+    }
+
+    reqSlotTag = GetFromFreeReqQ();
+
+    REQ_ENTRY(reqSlotTag)->reqType                       = REQ_TYPE_NAND;
+    REQ_ENTRY(reqSlotTag)->reqCode                       = REQ_CODE_READ;
+    REQ_ENTRY(reqSlotTag)->nvmeCmdSlotTag                = nvmeCmdSlotTag;
+    REQ_ENTRY(reqSlotTag)->logicalSliceAddr              = BUF_LSA(bufEntry);
+    REQ_ENTRY(reqSlotTag)->reqOpt.dataBufFormat          = REQ_OPT_DATA_BUF_ENTRY;
+    REQ_ENTRY(reqSlotTag)->reqOpt.dataBufMergeMask       = mergeMask;
+    REQ_ENTRY(reqSlotTag)->reqOpt.nandAddr               = REQ_OPT_NAND_ADDR_VSA;
+    REQ_ENTRY(reqSlotTag)->reqOpt.nandEcc                = REQ_OPT_NAND_ECC_ON;
+    REQ_ENTRY(reqSlotTag)->reqOpt.nandEccWarning         = REQ_OPT_NAND_ECC_WARNING_ON;
+    REQ_ENTRY(reqSlotTag)->reqOpt.rowAddrDependencyCheck = REQ_OPT_ROW_ADDR_DEPENDENCY_CHECK;
+    REQ_ENTRY(reqSlotTag)->reqOpt.blockSpace             = REQ_OPT_BLOCK_SPACE_MAIN;
+    REQ_ENTRY(reqSlotTag)->dataBufInfo.entry             = bufEntry;
+    REQ_ENTRY(reqSlotTag)->nandInfo.virtualSliceAddr     = vsa;
+
+    pr_debug("Req[%u]: Merge Buf[%u] (mask 0x%x) from VSA[%u]", reqSlotTag, bufEntry, mergeMask, vsa);
+
+    UpdateDataBufEntryInfoBlockingReq(bufEntry, reqSlotTag);
+    SelectLowLevelReqQ(reqSlotTag);
+}
+
+/**
+ * @brief Coalesce the given RxDMA with the RxDMA at the tail of the blocking queue.
+ *
+ * A host writing a slice in several small commands (e.g. 4K sequential writes) generates
+ * several RxDMAs on the same data buffer entry. Since the auto Rx DMA queue is executed in
+ * order, these RxDMAs don't need to wait for each other, but only for the requests before
+ * them (e.g. merge read or flash write of the entry).
+ *
+ * So, if the tail of the blocking queue of the entry is an RxDMA not yet done, the given
+ * RxDMA takes over its position in the blocking queue instead of being appended after it:
+ *
+ * - If the tail RxDMA is still blocked, it is linked by `nvmeDmaInfo.coalescedReq` of the
+ *   given RxDMA and will be issued right before it (check `IssueNvmeDmaReqGroup()`).
+ *
+ * - If the tail RxDMA is already issued, the given RxDMA can be issued immediately.
+ *
+ * In both cases the requests appended later wait for the given RxDMA, whose completion
+ * implies the completion of the RxDMAs coalesced into it, and thus the blocking queue only
+ * grows once for all the small writes of a slice. Each NVMe command is still completed by
+ * its own RxDMA.
+ *
+ * At most `RX_DMA_COALESCE_MAX_REQ` blocked RxDMAs are coalesced into one group.
+ *
+ * @param bufEntry the data buffer entry index of the given RxDMA
+ * @param reqSlotTag the request pool entry index of the RxDMA to be dispatched
+ * @return unsigned int 1 if coalesced, 0 if the RxDMA should be appended to the blocking queue
+ */
+static unsigned int CoalesceNvmeRxDmaReq(unsigned int bufEntry, unsigned int reqSlotTag)
+{
+    unsigned int tailReqSlotTag, prevReqSlotTag;
+
+    tailReqSlotTag = BUF_ENTRY(bufEntry)->blockingReqTail;
+    if (tailReqSlotTag == REQ_SLOT_TAG_NONE || REQ_ENTRY(tailReqSlotTag)->reqType != REQ_TYPE_NVME_DMA ||
+        !REQ_CODE_IS(tailReqSlotTag, REQ_CODE_RxDMA))
+        return 0;
+
+    if (REQ_ENTRY(tailReqSlotTag)->reqQueueType == REQ_QUEUE_TYPE_BLOCKED_BY_BUF_DEP)
+    {
+        if (REQ_ENTRY(tailReqSlotTag)->nvmeDmaInfo.coalescedCnt + 1 >= RX_DMA_COALESCE_MAX_REQ)
+            return 0;
+
+        REQ_ENTRY(reqSlotTag)->nvmeDmaInfo.coalescedReq = tailReqSlotTag;
+        REQ_ENTRY(reqSlotTag)->nvmeDmaInfo.coalescedCnt = REQ_ENTRY(tailReqSlotTag)->nvmeDmaInfo.coalescedCnt + 1;
+    }
+    else
+        ASSERT(REQ_ENTRY(tailReqSlotTag)->reqQueueType == REQ_QUEUE_TYPE_NVME_DMA);
+
+    // take over the position of the tail request in the blocking queue
+    prevReqSlotTag                                   = REQ_ENTRY(tailReqSlotTag)->prevBlockingReq;
+    REQ_ENTRY(reqSlotTag)->prevBlockingReq           = prevReqSlotTag;
+    REQ_ENTRY(tailReqSlotTag)->prevBlockingReq       = REQ_SLOT_TAG_NONE;
+    if (prevReqSlotTag != REQ_SLOT_TAG_NONE)
+        REQ_ENTRY(prevReqSlotTag)->nextBlockingReq = reqSlotTag;
+    BUF_ENTRY(bufEntry)->blockingReqTail = reqSlotTag;
+
+    dataBufStat.coalescedRxDmaCnt++;
+    pr_debug("Req[%u]: Coalesced with Req[%u] on Buf[%u]", reqSlotTag, tailReqSlotTag, bufEntry);
+
+    return 1;
+}
+
 /**
  * @brief Data Buffer Manager. Handle all the pending slice requests.
  *
@@ -529,6 +1198,13 @@ void ReqTransSliceToLowLevel()
         if (reqSlotTag == REQ_SLOT_TAG_FAIL)
             return;
 
+        // speculative read, no NVMe request to be generated
+        if (REQ_CODE_IS(reqSlotTag, REQ_CODE_READ_AHEAD))
+        {
+            DataReadAheadFromNand(reqSlotTag);
+            continue;
+        }
+
         /*
          * In current implementation, the data buffer to be used is determined on the
          * `logicalSliceAddr` of this request, so the data buffer may already be allocated
@@ -570,7 +1246,14 @@ void ReqTransSliceToLowLevel()
         }
         else{  
             dataBufEntry = CheckDataBufHit(reqSlotTag);
-            if (dataBufEntry != DATA_BUF_FAIL)
+            if (dataBufEntry == DATA_BUF_FAIL &&
+                (REQ_CODE_IS(reqSlotTag, REQ_CODE_READ) || REQ_CODE_IS(reqSlotTag, REQ_CODE_WRITE_ZEROES)) &&
+                LSA2VSA(REQ_LSA(reqSlotTag)) == VSA_NONE)
+            {
+                ReqTransUnmappedSlice(reqSlotTag);
+                continue;
+            }
+            else if (dataBufEntry != DATA_BUF_FAIL)
             {
                 // data buffer hit
                 REQ_ENTRY(reqSlotTag)->dataBufInfo.entry = dataBufEntry;
@@ -579,13 +1262,20 @@ void ReqTransSliceToLowLevel()
             else
             {
                 // data buffer miss, allocate a new buffer entry
-                dataBufEntry                             = AllocateDataBuf();
+                dataBufEntry                             = AllocateDataBuf(REQ_LSA(reqSlotTag));
                 REQ_ENTRY(reqSlotTag)->dataBufInfo.entry = dataBufEntry;
                 pr_debug("Cache Miss! Allocate new Buffer[%u] for Req[%u]", dataBufEntry, reqSlotTag);
 
                 // initialize the newly allocated data buffer entry for this request
                 EvictDataBufEntry(reqSlotTag);
                 BUF_ENTRY(dataBufEntry)->logicalSliceAddr = REQ_LSA(reqSlotTag);
+                BUF_ENTRY(dataBufEntry)->validSectors     = DATA_BUF_ALL_SECTORS_VALID;
+
+                // `phyReq` is a part of the hash key, set it before inserting
+                if (REQ_CODE_IS(reqSlotTag, REQ_CODE_OCSSD_PHY_WRITE) || REQ_CODE_IS(reqSlotTag, REQ_CODE_OCSSD_PHY_READ))
+                    BUF_ENTRY(dataBufEntry)->phyReq = DATA_BUF_FOR_PHY_REQ;
+                else
+                    BUF_ENTRY(dataBufEntry)->phyReq = DATA_BUF_FOR_LOG_REQ;
                 PutToDataBufHashList(dataBufEntry);
 
                 /*
@@ -601,10 +1291,9 @@ void ReqTransSliceToLowLevel()
                     break;
 
                 case REQ_CODE_WRITE:
-                    // in case of not overwriting a whole page, read current page content for migration
-                    if (REQ_ENTRY(reqSlotTag)->nvmeDmaInfo.numOfNvmeBlock != NVME_BLOCKS_PER_SLICE)
-                        // for read modify write
-                        DataReadFromNand(reqSlotTag);
+                case REQ_CODE_WRITE_ZEROES:
+                    // no read-modify-write here, only the NVMe blocks received from host are valid
+                    BUF_ENTRY(dataBufEntry)->validSectors = 0;
                     break;
 
                 default:
@@ -633,23 +1322,30 @@ void ReqTransSliceToLowLevel()
             if (REQ_CODE_IS(reqSlotTag, REQ_CODE_NMC_NEW_MAPPING))
             {
                 REQ_ENTRY(reqSlotTag)->reqOpt.dataBufFormat = REQ_OPT_DATA_BUF_ENTRY;
-                BUF_ENTRY(dataBufEntry)->dirty = DATA_BUF_CLEAN; /* don't flush this */
+                MarkDataBufClean(dataBufEntry); /* don't flush this */
                 if (!nmcRegisterNewMappingReqDone(reqSlotTag))
                     continue;
             }
             else if (REQ_CODE_IS(reqSlotTag, REQ_CODE_NMC_INFERENCE))
             {
                 ASSERT(nmcRegisterInferenceReq(reqSlotTag), "Too many inference request...");
-                BUF_ENTRY(dataBufEntry)->dirty = DATA_BUF_CLEAN; /* don't flush this */
+                MarkDataBufClean(dataBufEntry); /* don't flush this */
             }
             else if (REQ_CODE_IS(reqSlotTag, REQ_CODE_VERIFY_IMG))
             {   
                 ASSERT(nmcRegisterInferenceReq(reqSlotTag), "verify register failed...");
                 verify_img_flag = true;
-                BUF_ENTRY(dataBufEntry)->dirty = DATA_BUF_CLEAN; /* don't flush this */
+                MarkDataBufClean(dataBufEntry); /* don't flush this */
             }
             else
-                BUF_ENTRY(dataBufEntry)->dirty = DATA_BUF_DIRTY;
+                MarkDataBufDirty(dataBufEntry);
+
+            if (REQ_CODE_IS(reqSlotTag, REQ_CODE_WRITE))
+                BUF_ENTRY(dataBufEntry)->validSectors |=
+                    DATA_BUF_SECTOR_MASK(REQ_ENTRY(reqSlotTag)->nvmeDmaInfo.nvmeBlockOffset,
+                                         REQ_ENTRY(reqSlotTag)->nvmeDmaInfo.numOfNvmeBlock);
+            else
+                BUF_ENTRY(dataBufEntry)->validSectors = DATA_BUF_ALL_SECTORS_VALID;
 
             // generate NVMe Rx
             BUF_ENTRY(dataBufEntry)->dontCache = DATA_BUF_KEEP_CACHE;
@@ -671,10 +1367,22 @@ void ReqTransSliceToLowLevel()
             else
                 BUF_ENTRY(dataBufEntry)->phyReq = DATA_BUF_FOR_LOG_REQ;
 
+            // the blocks to be read may not be received from host yet
+            if ((BUF_ENTRY(dataBufEntry)->validSectors &
+                 DATA_BUF_SECTOR_MASK(REQ_ENTRY(reqSlotTag)->nvmeDmaInfo.nvmeBlockOffset,
+                                      REQ_ENTRY(reqSlotTag)->nvmeDmaInfo.numOfNvmeBlock)) !=
+                DATA_BUF_SECTOR_MASK(REQ_ENTRY(reqSlotTag)->nvmeDmaInfo.nvmeBlockOffset,
+                                     REQ_ENTRY(reqSlotTag)->nvmeDmaInfo.numOfNvmeBlock))
+                DataMergeFromNand(dataBufEntry, REQ_ENTRY(reqSlotTag)->nvmeCmdSlotTag);
+
             BUF_ENTRY(dataBufEntry)->dontCache = DATA_BUF_KEEP_CACHE;
             REQ_ENTRY(reqSlotTag)->reqCode     = REQ_CODE_TxDMA;
             break;
 
+        case REQ_CODE_WRITE_ZEROES:
+            DataZeroInBuf(reqSlotTag);
+            continue;
+
         case REQ_CODE_WRITE_BUFFER:
             pr_info("test input buffer request");
             REQ_ENTRY(reqSlotTag)->reqCode     = REQ_CODE_RxDMA;
@@ -710,7 +1418,8 @@ void ReqTransSliceToLowLevel()
             pr_debug("NVMe request (%X) generated:", REQ_ENTRY(reqSlotTag)->reqCode);
             pr_debug("\t reqCode = 0x%x", REQ_ENTRY(reqSlotTag)->reqCode);
             pr_debug("\t dataBufEntry = 0x%x", REQ_ENTRY(reqSlotTag)->dataBufInfo.entry);
-            UpdateDataBufEntryInfoBlockingReq(dataBufEntry, reqSlotTag);
+            if (!REQ_CODE_IS(reqSlotTag, REQ_CODE_RxDMA) || !CoalesceNvmeRxDmaReq(dataBufEntry, reqSlotTag))
+                UpdateDataBufEntryInfoBlockingReq(dataBufEntry, reqSlotTag);
         }
         SelectLowLevelReqQ(reqSlotTag);
     }
@@ -766,6 +1475,11 @@ unsigned int CheckBufDep(unsigned int reqSlotTag)
  *      Before performing read operation the a block, we should ensure the pending write
  *      and erase requests are already finished.
  *
+ * - For a copyback request:
+ *
+ *      Its source slice is checked like a read and its target slice like a write, both
+ *      blocks are on the same die.
+ *
  * @todo Why the address info of the specified request must be VSA.
  *
  * @warning This function may update the count of corresponding block info, but won't add
@@ -780,7 +1494,7 @@ unsigned int CheckBufDep(unsigned int reqSlotTag)
  */
 unsigned int CheckRowAddrDep(unsigned int reqSlotTag, unsigned int checkRowAddrDepOpt)
 {
-    unsigned int dieNo, chNo, wayNo, blockNo, pageNo;
+    unsigned int dieNo, chNo, wayNo, blockNo, pageNo, srcBlockNo, srcPageNo;
 
     if (reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandAddr == REQ_OPT_NAND_ADDR_VSA)
     {
@@ -802,7 +1516,7 @@ unsigned int CheckRowAddrDep(unsigned int reqSlotTag, unsigned int checkRowAddrD
                 SyncReleaseEraseReq(chNo, wayNo, blockNo);
 
             // already programed
-            if (pageNo <= rowAddrDependencyTablePtr->block[chNo][wayNo][blockNo].permittedProgPage) // TEST
+            if (pageNo < rowAddrDependencyTablePtr->block[chNo][wayNo][blockNo].permittedProgPage)
                 return ROW_ADDR_DEPENDENCY_REPORT_PASS;
 
             pr_debug("READ Req[%u] (VSA[%u]) is blocked:", reqSlotTag, REQ_VSA(reqSlotTag));
@@ -835,6 +1549,33 @@ unsigned int CheckRowAddrDep(unsigned int reqSlotTag, unsigned int checkRowAddrD
         pr_debug("BLOCKED, permittedProgPage = %u, pageNo = %u",
                  ROW_ADDR_DEP_ENTRY(chNo, wayNo, blockNo)->permittedProgPage, pageNo);
     }
+    else if (reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_COPYBACK)
+    {
+        // the source slice is read like a READ, and the target slice is programmed like a WRITE
+        srcBlockNo = Vsa2VblockTranslation(reqPoolPtr->reqPool[reqSlotTag].nandInfo.copybackSrcVsa);
+        srcPageNo  = Vsa2VpageTranslation(reqPoolPtr->reqPool[reqSlotTag].nandInfo.copybackSrcVsa);
+
+        if (checkRowAddrDepOpt == ROW_ADDR_DEPENDENCY_CHECK_OPT_SELECT)
+        {
+            if (rowAddrDependencyTablePtr->block[chNo][wayNo][srcBlockNo].blockedEraseReqFlag)
+                SyncReleaseEraseReq(chNo, wayNo, srcBlockNo);
+        }
+        else if (checkRowAddrDepOpt != ROW_ADDR_DEPENDENCY_CHECK_OPT_RELEASE)
+            assert(!"[WARNING] Not supported checkRowAddrDepOpt [WARNING]");
+
+        if ((srcPageNo < rowAddrDependencyTablePtr->block[chNo][wayNo][srcBlockNo].permittedProgPage) &&
+            (pageNo == rowAddrDependencyTablePtr->block[chNo][wayNo][blockNo].permittedProgPage))
+        {
+            rowAddrDependencyTablePtr->block[chNo][wayNo][blockNo].permittedProgPage++;
+            if (checkRowAddrDepOpt == ROW_ADDR_DEPENDENCY_CHECK_OPT_RELEASE)
+                rowAddrDependencyTablePtr->block[chNo][wayNo][srcBlockNo].blockedReadReqCnt--;
+            return ROW_ADDR_DEPENDENCY_REPORT_PASS;
+        }
+
+        // hold the erase of the source block until this request is dispatched
+        if (checkRowAddrDepOpt == ROW_ADDR_DEPENDENCY_CHECK_OPT_SELECT)
+            rowAddrDependencyTablePtr->block[chNo][wayNo][srcBlockNo].blockedReadReqCnt++;
+    }
     else if (reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_ERASE)
     {
         // FIXME: why check this
@@ -888,7 +1629,7 @@ unsigned int CheckRowAddrDep(unsigned int reqSlotTag, unsigned int checkRowAddrD
  */
 unsigned int UpdateRowAddrDepTableForBufBlockedReq(unsigned int reqSlotTag)
 {
-    unsigned int dieNo, chNo, wayNo, blockNo, pageNo, bufDepCheckReport;
+    unsigned int dieNo, chNo, wayNo, blockNo, pageNo, srcBlockNo, bufDepCheckReport;
 
     if (reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandAddr == REQ_OPT_NAND_ADDR_VSA)
     {
@@ -927,12 +1668,73 @@ unsigned int UpdateRowAddrDepTableForBufBlockedReq(unsigned int reqSlotTag)
         // still blocked by data buffer
         rowAddrDependencyTablePtr->block[chNo][wayNo][blockNo].blockedReadReqCnt++;
     }
+    else if (reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_COPYBACK)
+    {
+        srcBlockNo = Vsa2VblockTranslation(reqPoolPtr->reqPool[reqSlotTag].nandInfo.copybackSrcVsa);
+        if (rowAddrDependencyTablePtr->block[chNo][wayNo][srcBlockNo].blockedEraseReqFlag)
+        {
+            SyncReleaseEraseReq(chNo, wayNo, srcBlockNo);
+
+            // same as READ, the blocking request may be done while syncing
+            if (CheckBufDep(reqSlotTag) == BUF_DEPENDENCY_REPORT_PASS)
+            {
+                if (CheckRowAddrDep(reqSlotTag, ROW_ADDR_DEPENDENCY_CHECK_OPT_SELECT) ==
+                    ROW_ADDR_DEPENDENCY_REPORT_PASS)
+                    PutToNandReqQ(reqSlotTag, chNo, wayNo);
+                else
+                    PutToBlockedByRowAddrDepReqQ(reqSlotTag, chNo, wayNo);
+
+                return ROW_ADDR_DEPENDENCY_TABLE_UPDATE_REPORT_SYNC;
+            }
+        }
+        // still blocked by data buffer
+        rowAddrDependencyTablePtr->block[chNo][wayNo][srcBlockNo].blockedReadReqCnt++;
+    }
     else if (reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_ERASE)
         rowAddrDependencyTablePtr->block[chNo][wayNo][blockNo].blockedEraseReqFlag = 1;
 
     return ROW_ADDR_DEPENDENCY_TABLE_UPDATE_REPORT_DONE;
 }
 
+/**
+ * @brief Issue the given NVMe DMA request and the RxDMAs coalesced into it.
+ *
+ * The coalesced RxDMAs are linked from the newest to the oldest, but they must be issued
+ * in the order they were generated, so the list is reversed before issuing. The given
+ * request is issued last.
+ *
+ * @sa `CoalesceNvmeRxDmaReq()`.
+ *
+ * @param reqSlotTag the request pool entry index of the NVMe DMA request to be issued
+ */
+static void IssueNvmeDmaReqGroup(unsigned int reqSlotTag)
+{
+    unsigned int coalescedReqs[RX_DMA_COALESCE_MAX_REQ];
+    unsigned int iReq, coalescedCnt = 0;
+
+    for (iReq = REQ_ENTRY(reqSlotTag)->nvmeDmaInfo.coalescedReq; iReq != REQ_SLOT_TAG_NONE;
+         iReq = REQ_ENTRY(iReq)->nvmeDmaInfo.coalescedReq)
+    {
+        ASSERT(coalescedCnt < RX_DMA_COALESCE_MAX_REQ);
+        coalescedReqs[coalescedCnt++] = iReq;
+    }
+    REQ_ENTRY(reqSlotTag)->nvmeDmaInfo.coalescedReq = REQ_SLOT_TAG_NONE;
+    REQ_ENTRY(reqSlotTag)->nvmeDmaInfo.coalescedCnt = 0;
+
+    while (coalescedCnt--)
+    {
+        iReq = coalescedReqs[coalescedCnt];
+        SelectiveGetFromBlockedByBufDepReqQ(iReq);
+        REQ_ENTRY(iReq)->nvmeDmaInfo.coalescedReq = REQ_SLOT_TAG_NONE;
+        REQ_ENTRY(iReq)->nvmeDmaInfo.coalescedCnt = 0;
+        IssueNvmeDmaReq(iReq);
+        PutToNvmeDmaReqQ(iReq);
+    }
+
+    IssueNvmeDmaReq(reqSlotTag);
+    PutToNvmeDmaReqQ(reqSlotTag);
+}
+
 /**
  * @brief Dispatch given NVMe/NAND request to corresponding request queue.
  *
@@ -977,15 +1779,15 @@ void SelectLowLevelReqQ(unsigned int reqSlotTag)
 {
     unsigned int dieNo, chNo, wayNo, bufDepCheckReport, rowAddrDepCheckReport, rowAddrDepTableUpdateReport;
 
+    // counted until `GetFromNandReqQ()`, whichever queue the request is put to first
+    notCompletedProgramReqCnt += REQ_IS_PROGRAM(reqSlotTag);
+
     bufDepCheckReport = CheckBufDep(reqSlotTag);
 
     if (bufDepCheckReport == BUF_DEPENDENCY_REPORT_PASS)
     {
         if (reqPoolPtr->reqPool[reqSlotTag].reqType == REQ_TYPE_NVME_DMA)
-        {
-            IssueNvmeDmaReq(reqSlotTag);
-            PutToNvmeDmaReqQ(reqSlotTag);
-        }
+            IssueNvmeDmaReqGroup(reqSlotTag);
         else if (reqPoolPtr->reqPool[reqSlotTag].reqType == REQ_TYPE_NAND)
         {
             // get physical organization info from VSA
@@ -1109,10 +1911,7 @@ void ReleaseBlockedByBufDepReq(unsigned int reqSlotTag)
         SelectiveGetFromBlockedByBufDepReqQ(targetReqSlotTag);
 
         if (reqPoolPtr->reqPool[targetReqSlotTag].reqType == REQ_TYPE_NVME_DMA)
-        {
-            IssueNvmeDmaReq(targetReqSlotTag);
-            PutToNvmeDmaReqQ(targetReqSlotTag);
-        }
+            IssueNvmeDmaReqGroup(targetReqSlotTag);
         else if (reqPoolPtr->reqPool[targetReqSlotTag].reqType == REQ_TYPE_NAND)
         {
             if (reqPoolPtr->reqPool[targetReqSlotTag].reqOpt.nandAddr == REQ_OPT_NAND_ADDR_VSA)
@@ -64,6 +64,17 @@
 #define ROW_ADDR_DEPENDENCY_TABLE_UPDATE_REPORT_DONE 0 // still blocked by buffer dependency
 #define ROW_ADDR_DEPENDENCY_TABLE_UPDATE_REPORT_SYNC 1 // buffer dependency info updated
 
+#define READ_AHEAD_MIN_DEPTH       1                // slices
+#define READ_AHEAD_MAX_DEPTH       (USER_DIES)      // slices, one per die
+#define READ_AHEAD_INIT_DEPTH      (USER_CHANNELS)  // slices, one per channel
+#define READ_AHEAD_TRIGGER_CMDS    2                // sequential commands needed to start read-ahead
+#define READ_AHEAD_ADAPT_WINDOW    64               // read-ahead entries judged before adapting depth
+#define READ_AHEAD_MIN_FREE_REQ    (USER_DIES * 16) // keep enough request entries for host commands
+
+#define RX_DMA_COALESCE_MAX_REQ (NVME_BLOCKS_PER_SLICE) // RxDMAs waiting in a coalesced group
+
+#define DEALLOCATE_MAX_CMD_COUNT 8 // Dataset Management commands waiting to be deallocated
+
 /**
  * @brief The dependency info of this physical block.
  *
@@ -93,9 +104,83 @@ typedef struct _ROW_ADDR_DEPENDENCY_TABLE
     ROW_ADDR_DEPENDENCY_ENTRY block[USER_CHANNELS][USER_WAYS][MAIN_BLOCKS_PER_DIE];
 } ROW_ADDR_DEPENDENCY_TABLE, *P_ROW_ADDR_DEPENDENCY_TABLE;
 
+/**
+ * @brief The sequential read stream detected on a submission queue.
+ *
+ * A read command starting at the slice where the previous read command of the same queue
+ * ended (or right after it) continues the stream. `raNextLsa` is the first slice not yet
+ * requested by read-ahead.
+ *
+ * @sa `ReqTransReadAhead()`.
+ */
+typedef struct _READ_AHEAD_STREAM
+{
+    unsigned int lastLsa;   // the last slice read by the previous command
+    unsigned int raNextLsa; // the next slice to be read ahead
+    unsigned int seqCmdCnt; // the number of sequential commands in this stream
+} READ_AHEAD_STREAM, *P_READ_AHEAD_STREAM;
+
+/**
+ * @brief The read-ahead streams of all the I/O submission queues and the adaptive depth.
+ *
+ * The depth (number of slices read ahead of the host) is shared by all the streams. After
+ * every `READ_AHEAD_ADAPT_WINDOW` read-ahead entries were either referenced or reused
+ * without being referenced, the depth is doubled if nearly all of them were referenced
+ * and halved if many of them were wasted.
+ */
+typedef struct _READ_AHEAD_STATE
+{
+    READ_AHEAD_STREAM stream[MAX_NUM_OF_IO_SQ];
+    unsigned int depth;
+    unsigned int lastHitCnt;   // `DATA_BUF_STATISTICS::readAheadHitCnt` at the last adaption
+    unsigned int lastWasteCnt; // `DATA_BUF_STATISTICS::readAheadWasteCnt` at the last adaption
+} READ_AHEAD_STATE, *P_READ_AHEAD_STATE;
+
+/**
+ * @brief A Dataset Management command with the deallocate attribute.
+ *
+ * The range list of the command is received into its range buffer, then the whole slices
+ * of the ranges are deallocated at most `DEALLOCATE_SLICES_PER_PASS` at a time, so a large
+ * deallocate doesn't stall the main loop.
+ *
+ * @sa `DeallocateInBackground()`.
+ */
+typedef struct _DEALLOCATE_CMD
+{
+    unsigned int cmdSlotTag;
+    unsigned int rangeCnt;    // the number of ranges (not zero based)
+    unsigned int rangeReady;  // the range list was received and checked
+    unsigned int reqTail;     // the auto RxDMA tail after receiving the range list
+    unsigned int overFlowCnt; // the auto RxDMA overflow count after receiving the range list
+    unsigned int iRange;      // the range being deallocated
+    unsigned int nextLsa;     // the next slice of the range to be deallocated
+    unsigned int startLsa;    // the first slice covered by the ranges
+    unsigned int endLsa;      // the slice after the last one covered by the ranges
+} DEALLOCATE_CMD, *P_DEALLOCATE_CMD;
+
+/**
+ * @brief The pending deallocate commands, a ring handled in arrival order.
+ */
+typedef struct _DEALLOCATE_STATE
+{
+    DEALLOCATE_CMD cmd[DEALLOCATE_MAX_CMD_COUNT];
+    unsigned int headCmd;
+    unsigned int cmdCnt;
+    unsigned int doneCmdCnt; // the deallocate commands completed
+    unsigned int sliceCnt;   // the mapped slices deallocated
+} DEALLOCATE_STATE, *P_DEALLOCATE_STATE;
+
 void InitDependencyTable();
+void InitReadAhead();
 void ReqTransNvmeToSlice(unsigned int cmdSlotTag, unsigned int startLba, unsigned int nlb, unsigned int cmdCode);
+void ReqTransReadAhead(unsigned int qID, unsigned int cmdSlotTag, unsigned int startLba, unsigned int nlb);
 void ReqTransSliceToLowLevel();
+void InitDeallocate();
+void ReqTransDeallocate(unsigned int cmdSlotTag, unsigned int rangeCnt);
+void ReqTransWriteZeroes(unsigned int cmdSlotTag, unsigned int startLba, unsigned int nlb);
+void DeallocateInBackground();
+void SyncDeallocate(unsigned int startLsa, unsigned int endLsa);
+void DataMergeFromNand(unsigned int bufEntry, unsigned int nvmeCmdSlotTag);
 void IssueNvmeDmaReq(unsigned int reqSlotTag);
 void CheckDoneNvmeDmaReq();
 
@@ -104,6 +189,8 @@ void ReleaseBlockedByBufDepReq(unsigned int reqSlotTag);
 void ReleaseBlockedByRowAddrDepReq(unsigned int chNo, unsigned int wayNo);
 
 extern P_ROW_ADDR_DEPENDENCY_TABLE rowAddrDependencyTablePtr;
+extern READ_AHEAD_STATE readAheadState;
+extern DEALLOCATE_STATE deallocateState;
 
 /* -------------------------------------------------------------------------- */
 /*                     util macros for request scheduling                     */
@@ -0,0 +1,75 @@
+//////////////////////////////////////////////////////////////////////////////////
+// xparameters.h for Cosmos+ OpenSSD
+// Copyright (c) 2016 Hanyang University ENC Lab.
+// Contributed by Yong Ho Song <yhsong@enc.hanyang.ac.kr>
+//				  Kibin Park <kbpark@enc.hanyang.ac.kr>
+//				  Jaewook Kwak <jwkwak@enc.hanyang.ac.kr>
+//
+// This file is part of Cosmos+ OpenSSD.
+//
+// Cosmos+ OpenSSD is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3, or (at your option)
+// any later version.
+//
+// Cosmos+ OpenSSD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Cosmos+ OpenSSD; see the file COPYING.
+// If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Company: ENC Lab. <http://enc.hanyang.ac.kr>
+// Engineer: Kibin Park <kbpark@enc.hanyang.ac.kr>
+//
+// Project Name: Cosmos+ OpenSSD
+// Design Name: Cosmos+ Firmware
+// Module Name: NAND Storage Controller Simulator
+// File Name: xparameters.h
+//
+// Version: v1.0.0
+//
+// Description:
+//   - host replacement of the BSP "xparameters.h" for the `NSC_SIMULATOR` build
+//   - base addresses of the NVMe controller and the 8 NAND storage controllers
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Revision History:
+//
+// * v1.0.0
+//   - First draft
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SIM_XPARAMETERS_H_
+#define SIM_XPARAMETERS_H_
+
+/*
+ * The addresses follow the board design, but they are never accessed by the simulator,
+ * they only tell "ftl_config.h" that all the 8 channels are connected.
+ */
+#define XPAR_NVME_CTRL_0_BASEADDR 0x83C00000
+
+#define XPAR_T4NFC_HLPER_0_BASEADDR 0x43C00000
+#define XPAR_T4NFC_HLPER_1_BASEADDR 0x43C10000
+#define XPAR_T4NFC_HLPER_2_BASEADDR 0x43C20000
+#define XPAR_T4NFC_HLPER_3_BASEADDR 0x43C30000
+#define XPAR_T4NFC_HLPER_4_BASEADDR 0x43C40000
+#define XPAR_T4NFC_HLPER_5_BASEADDR 0x43C50000
+#define XPAR_T4NFC_HLPER_6_BASEADDR 0x43C60000
+#define XPAR_T4NFC_HLPER_7_BASEADDR 0x43C70000
+
+#define XPAR_AXI_BRAM_CTRL_0_S_AXI_BASEADDR 0x40000000
+#define XPAR_AXI_BRAM_CTRL_1_S_AXI_BASEADDR 0x40010000
+#define XPAR_AXI_BRAM_CTRL_2_S_AXI_BASEADDR 0x40020000
+#define XPAR_AXI_BRAM_CTRL_3_S_AXI_BASEADDR 0x40030000
+#define XPAR_AXI_BRAM_CTRL_4_S_AXI_BASEADDR 0x40040000
+#define XPAR_AXI_BRAM_CTRL_5_S_AXI_BASEADDR 0x40050000
+#define XPAR_AXI_BRAM_CTRL_6_S_AXI_BASEADDR 0x40060000
+#define XPAR_AXI_BRAM_CTRL_7_S_AXI_BASEADDR 0x40070000
+
+#endif /* SIM_XPARAMETERS_H_ */
@@ -0,0 +1,172 @@
+//////////////////////////////////////////////////////////////////////////////////
+// write_stream.c for Cosmos+ OpenSSD
+// Copyright (c) 2017 Hanyang University ENC Lab.
+// Contributed by Yong Ho Song <yhsong@enc.hanyang.ac.kr>
+//				  Jaewook Kwak <jwkwak@enc.hanyang.ac.kr>
+//
+// This file is part of Cosmos+ OpenSSD.
+//
+// Cosmos+ OpenSSD is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3, or (at your option)
+// any later version.
+//
+// Cosmos+ OpenSSD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Cosmos+ OpenSSD; see the file COPYING.
+// If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Company: ENC Lab. <http://enc.hanyang.ac.kr>
+// Engineer: Jaewook Kwak <jwkwak@enc.hanyang.ac.kr>
+//
+// Project Name: Cosmos+ OpenSSD
+// Design Name: Cosmos+ Firmware
+// Module Name: Write Stream
+// File Name: write_stream.c
+//
+// Version: v1.0.0
+//
+// Description:
+//   - take the lifetime hints of host writes
+//   - classify host writes into hot and cold streams by update frequency
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Revision History:
+//
+// * v1.0.0
+//   - First draft
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+#include "debug.h"
+
+#include "memory_map.h"
+#include "nvme/nvme.h"
+
+P_WRITE_STREAM_HEAT_MAP writeStreamHeatMapPtr;
+WRITE_STREAM_STATE writeStream;
+
+// the DSM access frequency values of write commands, check the NVMe spec
+#define DSM_ACCESS_FREQ_INFREQ_WRITE_INFREQ_READ 0x2
+#define DSM_ACCESS_FREQ_INFREQ_WRITE_FREQ_READ   0x3
+#define DSM_ACCESS_FREQ_FREQ_WRITE_INFREQ_READ   0x4
+#define DSM_ACCESS_FREQ_FREQ_WRITE_FREQ_READ     0x5
+#define DSM_ACCESS_FREQ_OVERWRITE_SOON           0x8
+
+void InitWriteStream()
+{
+    writeStreamHeatMapPtr = (P_WRITE_STREAM_HEAT_MAP)WRITE_STREAM_HEAT_MAP_ADDR;
+    memset(writeStreamHeatMapPtr, 0, sizeof(WRITE_STREAM_HEAT_MAP));
+    memset(&writeStream, 0, sizeof(WRITE_STREAM_STATE));
+}
+
+/**
+ * @brief Get the lifetime hint of a write command.
+ *
+ * The stream identifiers of the Streams directive follow the write life hints of Linux,
+ * which are assigned from 1 for the shortest lifetime, so stream 1 is taken as hot and the
+ * others as cold. Without a stream, the DSM access frequency is used.
+ *
+ * @param dword12 the CDW12 of the write command, check `IO_WRITE_COMMAND_DW12`.
+ * @param dword13 the CDW13 of the write command, check `IO_WRITE_COMMAND_DW13`.
+ * @return unsigned int `WRITE_STREAM_HINT_*`.
+ */
+unsigned int GetWriteStreamHint(unsigned int dword12, unsigned int dword13)
+{
+    IO_WRITE_COMMAND_DW12 writeInfo12;
+    IO_WRITE_COMMAND_DW13 writeInfo13;
+
+    writeInfo12.dword = dword12;
+    writeInfo13.dword = dword13;
+
+    if (writeInfo12.DTYPE == NVME_DIRECTIVE_TYPE_STREAMS && writeInfo13.DSPEC)
+        return (writeInfo13.DSPEC == 1) ? WRITE_STREAM_HINT_HOT : WRITE_STREAM_HINT_COLD;
+
+    switch (writeInfo13.DSM.AccessFrequency)
+    {
+    case DSM_ACCESS_FREQ_FREQ_WRITE_INFREQ_READ:
+    case DSM_ACCESS_FREQ_FREQ_WRITE_FREQ_READ:
+    case DSM_ACCESS_FREQ_OVERWRITE_SOON:
+        return WRITE_STREAM_HINT_HOT;
+    case DSM_ACCESS_FREQ_INFREQ_WRITE_INFREQ_READ:
+    case DSM_ACCESS_FREQ_INFREQ_WRITE_FREQ_READ:
+        return WRITE_STREAM_HINT_COLD;
+    default:
+        return WRITE_STREAM_HINT_NONE;
+    }
+}
+
+/**
+ * @brief Record the lifetime hint of a write command on the regions it covers.
+ *
+ * The slices are flushed from the data buffer long after the command, so the hint is kept
+ * in the heat map instead of following the slices, and the latest hint of a region wins.
+ *
+ * @param startLsa the first slice of the write command.
+ * @param sliceCnt number of slices of the write command.
+ * @param hint `WRITE_STREAM_HINT_*`.
+ */
+void HintWriteStream(unsigned int startLsa, unsigned int sliceCnt, unsigned int hint)
+{
+    unsigned int region, endRegion;
+
+    if (startLsa >= SLICES_PER_SSD || !sliceCnt)
+        return;
+    if (sliceCnt > SLICES_PER_SSD - startLsa)
+        sliceCnt = SLICES_PER_SSD - startLsa;
+
+    endRegion = (startLsa + sliceCnt - 1) / WRITE_STREAM_REGION_SLICES;
+    for (region = startLsa / WRITE_STREAM_REGION_SLICES; region <= endRegion; region++)
+        writeStreamHeatMapPtr->region[region].hint = hint;
+}
+
+/**
+ * @brief Select the write stream of a host write.
+ *
+ * The slices are classified by the hint of their region if any, or by the heat of their
+ * region otherwise, which is then increased if the slice is overwritten.
+ *
+ * @param logicalSliceAddr the slice to be written.
+ * @param overwrite whether the slice is mapped before this write.
+ * @return unsigned int `WRITE_STREAM_HOST_HOT` or `WRITE_STREAM_HOST_COLD`.
+ */
+unsigned int ClassifyWriteStream(unsigned int logicalSliceAddr, unsigned int overwrite)
+{
+    P_WRITE_STREAM_REGION_ENTRY region;
+    unsigned int age;
+
+    region = &writeStreamHeatMapPtr->region[logicalSliceAddr / WRITE_STREAM_REGION_SLICES];
+
+    // halve the heat once for each epoch passed since its last update
+    age = (writeStream.epoch - region->epoch) & WRITE_STREAM_EPOCH_MASK;
+    if (age)
+    {
+        region->heat  = (age < 8) ? (region->heat >> age) : 0;
+        region->epoch = writeStream.epoch & WRITE_STREAM_EPOCH_MASK;
+    }
+
+    if (overwrite)
+    {
+        if (region->heat < WRITE_STREAM_HEAT_MAX)
+            region->heat++;
+        if (++writeStream.updateCnt == WRITE_STREAM_EPOCH_UPDATES)
+        {
+            writeStream.updateCnt = 0;
+            writeStream.epoch++;
+        }
+    }
+
+    if (region->hint != WRITE_STREAM_HINT_NONE)
+    {
+        writeStream.hintedCnt++;
+        return (region->hint == WRITE_STREAM_HINT_HOT) ? WRITE_STREAM_HOST_HOT : WRITE_STREAM_HOST_COLD;
+    }
+    return (region->heat >= WRITE_STREAM_HOT_HEAT) ? WRITE_STREAM_HOST_HOT : WRITE_STREAM_HOST_COLD;
+}
@@ -0,0 +1,128 @@
+//////////////////////////////////////////////////////////////////////////////////
+// write_stream.h for Cosmos+ OpenSSD
+// Copyright (c) 2017 Hanyang University ENC Lab.
+// Contributed by Yong Ho Song <yhsong@enc.hanyang.ac.kr>
+//				  Jaewook Kwak <jwkwak@enc.hanyang.ac.kr>
+//
+// This file is part of Cosmos+ OpenSSD.
+//
+// Cosmos+ OpenSSD is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3, or (at your option)
+// any later version.
+//
+// Cosmos+ OpenSSD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Cosmos+ OpenSSD; see the file COPYING.
+// If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Company: ENC Lab. <http://enc.hanyang.ac.kr>
+// Engineer: Jaewook Kwak <jwkwak@enc.hanyang.ac.kr>
+//
+// Project Name: Cosmos+ OpenSSD
+// Design Name: Cosmos+ Firmware
+// Module Name: Write Stream
+// File Name: write_stream.h
+//
+// Version: v1.0.0
+//
+// Description:
+//   - the write streams that own the open blocks of each die
+//   - data structures of the temperature classifier of host writes
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Revision History:
+//
+// * v1.0.0
+//   - First draft
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef WRITE_STREAM_H_
+#define WRITE_STREAM_H_
+
+#include "ftl_config.h"
+
+/**
+ * Each die keeps one current block per write stream, so the slices expected to die at
+ * different times do not share blocks, and GC finds victims with fewer valid slices:
+ *
+ * - `WRITE_STREAM_HOST_HOT`: host writes expected to be overwritten soon.
+ * - `WRITE_STREAM_HOST_COLD`: the other host writes.
+ * - `WRITE_STREAM_GC`: the valid slices copied by GC, which survived a whole block.
+ * - `WRITE_STREAM_NMC`: the NMC files, written while the NMC block interleaving is on.
+ *
+ * The current blocks are opened on their first write, check `FindFreeVirtualSlice()`.
+ */
+#define WRITE_STREAM_HOST_HOT  0
+#define WRITE_STREAM_HOST_COLD 1
+#define WRITE_STREAM_GC        2
+#define WRITE_STREAM_NMC       3
+#define WRITE_STREAM_COUNT     4
+
+/**
+ * The lifetime hint of a host write, given by the Streams directive or the DSM access
+ * frequency of the write command, check `GetWriteStreamHint()`.
+ */
+#define WRITE_STREAM_HINT_NONE 0
+#define WRITE_STREAM_HINT_HOT  1
+#define WRITE_STREAM_HINT_COLD 2
+
+/**
+ * The host writes without hint are classified by the update frequency of their region of
+ * `WRITE_STREAM_REGION_SLICES` logical slices. The heat of a region is increased by each
+ * overwrite of its slices and halved every `WRITE_STREAM_EPOCH_UPDATES` overwrites on the
+ * whole SSD, and the region is hot while its heat is at least `WRITE_STREAM_HOT_HEAT`.
+ *
+ * The halving is applied lazily when a region is accessed, from the epoch of its last
+ * update, so no pass over the whole map is needed.
+ */
+#define WRITE_STREAM_REGION_SLICES 64
+#define WRITE_STREAM_REGIONS       (SLICES_PER_SSD / WRITE_STREAM_REGION_SLICES)
+#define WRITE_STREAM_EPOCH_UPDATES (SLICES_PER_SSD / 16)
+#define WRITE_STREAM_HEAT_MAX      0xff
+#define WRITE_STREAM_EPOCH_MASK    0x3f
+
+#ifndef WRITE_STREAM_HOT_HEAT
+#define WRITE_STREAM_HOT_HEAT 8
+#endif
+
+typedef struct _WRITE_STREAM_REGION_ENTRY
+{
+    unsigned short heat : 8;  // overwrites of the region, halved every epoch
+    unsigned short epoch : 6; // the epoch of the last update of `heat`, modulo 64
+    unsigned short hint : 2;  // `WRITE_STREAM_HINT_*` of the latest write command on the region
+} WRITE_STREAM_REGION_ENTRY, *P_WRITE_STREAM_REGION_ENTRY;
+
+/**
+ * @brief The temperature of all the logical slice regions, not persisted.
+ */
+typedef struct _WRITE_STREAM_HEAT_MAP
+{
+    WRITE_STREAM_REGION_ENTRY region[WRITE_STREAM_REGIONS];
+} WRITE_STREAM_HEAT_MAP, *P_WRITE_STREAM_HEAT_MAP;
+
+typedef struct _WRITE_STREAM_STATE
+{
+    unsigned int epoch;                        // advanced every `WRITE_STREAM_EPOCH_UPDATES` overwrites
+    unsigned int updateCnt;                    // overwrites in the current epoch
+    unsigned int blockCnt[WRITE_STREAM_COUNT]; // blocks opened by each stream
+    unsigned int sliceCnt[WRITE_STREAM_COUNT]; // slices allocated by each stream
+    unsigned int hintedCnt;                    // host writes classified by their hint
+} WRITE_STREAM_STATE, *P_WRITE_STREAM_STATE;
+
+void InitWriteStream();
+unsigned int GetWriteStreamHint(unsigned int dword12, unsigned int dword13);
+void HintWriteStream(unsigned int startLsa, unsigned int sliceCnt, unsigned int hint);
+unsigned int ClassifyWriteStream(unsigned int logicalSliceAddr, unsigned int overwrite);
+
+extern P_WRITE_STREAM_HEAT_MAP writeStreamHeatMapPtr;
+extern WRITE_STREAM_STATE writeStream;
+
+#endif /* WRITE_STREAM_H_ */